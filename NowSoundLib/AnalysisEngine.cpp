@@ -0,0 +1,139 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "AnalysisEngine.h"
+#include "Check.h"
+#include "MagicConstants.h"
+#include "NowSoundFrequencyTracker.h"
+
+using namespace NowSound;
+
+AnalysisEngine::AnalysisEngine(
+    const std::vector<RosettaFFT::FrequencyBinBounds>& binBounds,
+    int fftSize,
+    int hopSize,
+    RosettaFFT::RescaleOptions rescaleOptions,
+    int workerCount)
+    : _fft{ fftSize },
+    _window(fftSize),
+    _hopSize{ hopSize },
+    _binMap{},
+    _rescaleOptions{ rescaleOptions },
+    _trackersMutex{},
+    _trackers{},
+    _stopping{ false },
+    _scratches(workerCount),
+    _workers{}
+{
+    Check(hopSize > 0);
+    Check(workerCount > 0);
+
+    // Normalize the window to an average of 1, so windowing doesn't change the overall level of the bins.
+    std::vector<double> window(fftSize);
+    RosettaFFT::CreateBlackmanHarrisWindow(fftSize, window.data());
+    double windowTotal = 0;
+    for (double value : window)
+    {
+        windowTotal += value;
+    }
+    for (int i = 0; i < fftSize; i++)
+    {
+        _window[i] = (float)(window[i] * fftSize / windowTotal);
+    }
+
+    RosettaFFT::MakeBinMap(binBounds, _binMap);
+    Check(_binMap.FftBinCount <= _fft.BinCount());
+
+    for (Scratch& scratch : _scratches)
+    {
+        scratch.WindowedFrame.resize(fftSize);
+        scratch.FftOutput.resize(_fft.BinCount());
+        scratch.Magnitudes.resize(_binMap.FftBinCount);
+    }
+
+    for (int i = 0; i < workerCount; i++)
+    {
+        _workers.push_back(std::thread([this, i]() { WorkerLoop(i); }));
+    }
+}
+
+AnalysisEngine::~AnalysisEngine()
+{
+    _stopping = true;
+    for (std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+void AnalysisEngine::AnalyzeFrame(const float* frame, Scratch& scratch, float* peaks, float* output) const
+{
+    int fftSize = _fft.Size();
+
+    // window it!
+    const float* window = _window.data();
+    float* windowedFrame = scratch.WindowedFrame.data();
+    for (int i = 0; i < fftSize; i++)
+    {
+        windowedFrame[i] = frame[i] * window[i];
+    }
+
+    // run the FFT!
+    _fft.Transform(windowedFrame, scratch.FftOutput.data());
+
+    // and rescale it!
+    RosettaFFT::RescaleFFT(
+        _binMap,
+        scratch.FftOutput.data(),
+        _rescaleOptions,
+        scratch.Magnitudes.data(),
+        peaks,
+        output,
+        _binMap.OutputBinCount());
+}
+
+void AnalysisEngine::Register(NowSoundFrequencyTracker* tracker)
+{
+    std::unique_lock<std::shared_mutex> guard(_trackersMutex);
+    _trackers.push_back(tracker);
+}
+
+void AnalysisEngine::Unregister(NowSoundFrequencyTracker* tracker)
+{
+    std::unique_lock<std::shared_mutex> guard(_trackersMutex);
+    auto position = std::find(_trackers.begin(), _trackers.end(), tracker);
+    Check(position != _trackers.end());
+    _trackers.erase(position);
+}
+
+void AnalysisEngine::WorkerLoop(int workerIndex)
+{
+    Scratch& scratch = _scratches[workerIndex];
+    while (!_stopping)
+    {
+        bool analyzedAnything = false;
+        {
+            std::shared_lock<std::shared_mutex> guard(_trackersMutex);
+            size_t trackerCount = _trackers.size();
+            for (size_t i = 0; i < trackerCount; i++)
+            {
+                // TryAnalyze skips trackers that are disabled, or that another worker is already analyzing
+                if (_trackers[(i + workerIndex) % trackerCount]->TryAnalyze(scratch))
+                {
+                    analyzedAnything = true;
+                }
+            }
+        }
+
+        if (!analyzedAnything)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(MagicConstants::AnalysisWorkerIdleMsec));
+        }
+    }
+}
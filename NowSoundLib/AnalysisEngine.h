@@ -0,0 +1,110 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "stdafx.h"
+
+#include "RealFft.h"
+#include "rosetta_fft.h"
+
+namespace NowSound
+{
+    class NowSoundFrequencyTracker;
+
+    // The frequency analysis shared by the whole graph: one FFT plan, window and bin map for every
+    // NowSoundFrequencyTracker, plus the background threads that run it, so that the audio thread only ever
+    // copies samples into each tracker's queue.
+    //
+    // Each worker repeatedly sweeps over all registered trackers, running every frame each enabled tracker has
+    // due, back to back through the one plan and the worker's own scratch buffers; so FFT memory grows with
+    // the number of workers rather than the number of trackers, and the plan's tables stay in cache.
+    // A tracker is only ever analyzed by one worker at a time.  Workers sleep briefly when a sweep finds
+    // nothing to do.
+    class AnalysisEngine
+    {
+    public:
+        // One worker's buffers for transforming a frame; these hold nothing from one frame to the next.
+        struct Scratch
+        {
+            std::vector<float> WindowedFrame;
+            std::vector<std::complex<float>> FftOutput;
+            std::vector<float> Magnitudes;
+        };
+
+    private:
+        // The FFT plan.
+        const RealFft _fft;
+
+        // The window applied to each frame, normalized to an average of 1.
+        std::vector<float> _window;
+
+        // The number of samples from the start of one frame to the start of the next.
+        const int _hopSize;
+
+        // The compiled output bins.
+        RosettaFFT::FrequencyBinMap _binMap;
+
+        // The post-processing of the output bins.
+        const RosettaFFT::RescaleOptions _rescaleOptions;
+
+        // The registered trackers; workers hold this shared while sweeping, so (un)registration waits for
+        // any in-progress sweep.
+        std::shared_mutex _trackersMutex;
+        std::vector<NowSoundFrequencyTracker*> _trackers;
+
+        // Set to stop the workers.
+        std::atomic<bool> _stopping;
+
+        // One per worker.
+        std::vector<Scratch> _scratches;
+
+        std::vector<std::thread> _workers;
+
+        // Worker thread body; workerIndex staggers where each worker starts its sweep.
+        void WorkerLoop(int workerIndex);
+
+    public:
+        // Set up analysis for the given bins, and start workerCount worker threads.
+        AnalysisEngine(
+            const std::vector<RosettaFFT::FrequencyBinBounds>& binBounds,
+            int fftSize,
+            int hopSize,
+            RosettaFFT::RescaleOptions rescaleOptions,
+            int workerCount);
+
+        // no copying this
+        AnalysisEngine(const AnalysisEngine&) = delete;
+
+        // Stop and join all worker threads.
+        ~AnalysisEngine();
+
+        // The number of samples in each frame.
+        int FftSize() const { return _fft.Size(); }
+
+        // The number of samples from the start of one frame to the start of the next.
+        int HopSize() const { return _hopSize; }
+
+        // The number of output bins.
+        int OutputBinCount() const { return _binMap.OutputBinCount(); }
+
+        // The post-processing of the output bins.
+        const RosettaFFT::RescaleOptions& Options() const { return _rescaleOptions; }
+
+        // Window and transform FftSize() samples of frame, and rescale into OutputBinCount() output values,
+        // holding peaks in peaks if the options say to.
+        void AnalyzeFrame(const float* frame, Scratch& scratch, float* peaks, float* output) const;
+
+        // Start analyzing this tracker.
+        void Register(NowSoundFrequencyTracker* tracker);
+
+        // Stop analyzing this tracker; once this returns, no worker is touching it.
+        void Unregister(NowSoundFrequencyTracker* tracker);
+    };
+}
@@ -0,0 +1,128 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include "AudioTiming.h"
+#include "Check.h"
+#include "MagicConstants.h"
+
+using namespace juce;
+
+namespace NowSound
+{
+    // Microseconds from CycleTimer ticks.
+    static float TicksToMicroseconds(uint64_t ticks)
+    {
+        return (float)(ticks * 1000000.0 / CycleTimer::TicksPerSecond());
+    }
+
+    NowSoundNodeTimingInfo NodeTiming::Info() const
+    {
+        NowSoundNodeTimingInfo info{};
+        info.CallCount = (int64_t)Histogram.Count();
+        info.AverageMicroseconds = info.CallCount == 0 ? 0 : TicksToMicroseconds(Histogram.TotalTicks()) / info.CallCount;
+        info.MedianMicroseconds = TicksToMicroseconds(Histogram.PercentileTicks(0.5));
+        info.Percentile99Microseconds = TicksToMicroseconds(Histogram.PercentileTicks(0.99));
+        info.MaximumMicroseconds = TicksToMicroseconds(Histogram.MaximumTicks());
+        return info;
+    }
+
+    TimedAudioProcessorPlayer::TimedAudioProcessorPlayer()
+        : AudioProcessorPlayer(),
+        _callbackTiming{},
+        _budgetTicks{ 0 },
+        _overBudgetCount{ 0 },
+        _xrunCount{ 0 },
+        _deviceXrunCount{ -1 },
+        _device{ nullptr },
+        _ticksPerSecond{ 0 },
+        _sampleRate{ 0 },
+        _lastCallbackStart{ 0 },
+        _clock{ nullptr }
+    {
+    }
+
+    void TimedAudioProcessorPlayer::audioDeviceAboutToStart(AudioIODevice* device)
+    {
+        _device = device;
+        _ticksPerSecond = CycleTimer::TicksPerSecond();
+        _sampleRate = device->getCurrentSampleRate();
+        _lastCallbackStart = 0;
+
+        AudioProcessorPlayer::audioDeviceAboutToStart(device);
+    }
+
+    void TimedAudioProcessorPlayer::audioDeviceStopped()
+    {
+        AudioProcessorPlayer::audioDeviceStopped();
+
+        _device = nullptr;
+    }
+
+    void TimedAudioProcessorPlayer::audioDeviceIOCallback(
+        const float** inputChannelData,
+        int numInputChannels,
+        float** outputChannelData,
+        int numOutputChannels,
+        int numSamples)
+    {
+        uint64_t start = CycleTimer::Now();
+
+        Clock* clock = _clock.load(std::memory_order_acquire);
+        if (clock != nullptr)
+        {
+            clock->BeginAudioBlock();
+        }
+
+        AudioProcessorPlayer::audioDeviceIOCallback(
+            inputChannelData,
+            numInputChannels,
+            outputChannelData,
+            numOutputChannels,
+            numSamples);
+
+        uint64_t end = CycleTimer::Now();
+        uint64_t elapsed = end - start;
+        _callbackTiming.Record(elapsed);
+
+        if (_sampleRate <= 0)
+        {
+            return;
+        }
+
+        // only the audio thread writes these counters, so no read-modify-write instructions are needed
+        uint64_t budget = (uint64_t)(numSamples * _ticksPerSecond / _sampleRate);
+        _budgetTicks.store(budget, std::memory_order_relaxed);
+        if (elapsed > budget)
+        {
+            _overBudgetCount.store(_overBudgetCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        if (_lastCallbackStart != 0 && start - _lastCallbackStart > budget * MagicConstants::XrunCallbackGapFactor)
+        {
+            _xrunCount.store(_xrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        _lastCallbackStart = start;
+
+        if (_device != nullptr)
+        {
+            _deviceXrunCount.store(_device->getXRunCount(), std::memory_order_relaxed);
+        }
+    }
+
+    NowSoundCallbackTimingInfo TimedAudioProcessorPlayer::Info() const
+    {
+        NowSoundCallbackTimingInfo info{};
+        info.CallCount = (int64_t)_callbackTiming.Count();
+        info.AverageMicroseconds = info.CallCount == 0 ? 0 : TicksToMicroseconds(_callbackTiming.TotalTicks()) / info.CallCount;
+        info.MedianMicroseconds = TicksToMicroseconds(_callbackTiming.PercentileTicks(0.5));
+        info.Percentile99Microseconds = TicksToMicroseconds(_callbackTiming.PercentileTicks(0.99));
+        info.MaximumMicroseconds = TicksToMicroseconds(_callbackTiming.MaximumTicks());
+        info.BudgetMicroseconds = TicksToMicroseconds(_budgetTicks.load(std::memory_order_relaxed));
+        info.OverBudgetCount = (int64_t)_overBudgetCount.load(std::memory_order_relaxed);
+        info.XrunCount = (int64_t)_xrunCount.load(std::memory_order_relaxed);
+        info.DeviceXrunCount = _deviceXrunCount.load(std::memory_order_relaxed);
+        return info;
+    }
+}
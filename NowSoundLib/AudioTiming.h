@@ -0,0 +1,93 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <string>
+
+#include "stdint.h"
+
+#include "Clock.h"
+#include "NowSoundLibTypes.h"
+#include "TimingHistogram.h"
+
+#include "JuceHeader.h"
+
+namespace NowSound
+{
+    // The processing time of one node in the graph, recorded by the audio thread and read by anyone.
+    struct NodeTiming
+    {
+        NodeTiming(const std::wstring& name) : Name{ name }, Histogram{} {}
+
+        // The name of the node's processor.
+        const std::wstring Name;
+
+        // The time taken by each block the node processed.
+        TimingHistogram Histogram;
+
+        // Summarize the histogram.
+        NowSoundNodeTimingInfo Info() const;
+    };
+
+    // An AudioProcessorPlayer which times every device callback (that is, the whole graph's processing of each
+    // block), compares it against the block's duration, and watches the gaps between callbacks for lost blocks.
+    // It also marks the start of each block on the graph's clock, once the clock exists.
+    class TimedAudioProcessorPlayer : public juce::AudioProcessorPlayer
+    {
+    private:
+        // The time taken by each callback.
+        TimingHistogram _callbackTiming;
+
+        // The budget of the most recent callback, in ticks.
+        std::atomic<uint64_t> _budgetTicks;
+
+        // The number of callbacks which took longer than their budget.
+        std::atomic<uint64_t> _overBudgetCount;
+
+        // The number of callbacks which started too long after the one before.
+        std::atomic<uint64_t> _xrunCount;
+
+        // The device's own xrun count as of the most recent callback, or -1 if it does not count them.
+        std::atomic<int64_t> _deviceXrunCount;
+
+        // The device being played; set before it starts calling back, so the audio thread may use it freely.
+        juce::AudioIODevice* _device;
+
+        // CycleTimer::TicksPerSecond(), fetched when the device starts so the audio thread never calibrates.
+        double _ticksPerSecond;
+
+        // The device's sample rate.
+        double _sampleRate;
+
+        // When the previous callback started, or 0 if there has been none since the device started.
+        // Touched only by the audio thread.
+        uint64_t _lastCallbackStart;
+
+        // The clock whose blocks we mark; null until set.
+        std::atomic<Clock*> _clock;
+
+    public:
+        TimedAudioProcessorPlayer();
+
+        virtual void audioDeviceIOCallback(
+            const float** inputChannelData,
+            int numInputChannels,
+            float** outputChannelData,
+            int numOutputChannels,
+            int numSamples) override;
+
+        virtual void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+
+        virtual void audioDeviceStopped() override;
+
+        // Start marking each block's start on this clock.
+        void SetClock(Clock* clock) { _clock.store(clock, std::memory_order_release); }
+
+        // Summarize the callback timings so far.
+        NowSoundCallbackTimingInfo Info() const;
+    };
+}
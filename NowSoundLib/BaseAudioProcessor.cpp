@@ -3,15 +3,39 @@
 
 #include "stdafx.h"
 #include "BaseAudioProcessor.h"
+#include "Clock.h"
+#include "MagicConstants.h"
 #include "NowSoundGraph.h"
 #include <iostream>
 
 NowSound::BaseAudioProcessor::BaseAudioProcessor(NowSoundGraph* graph, const std::wstring& name)
     : _graph{ graph },
     _name { name },
-    _nodeId{}
+    _timing{ graph->RegisterNodeTiming(name) },
+    _nodeId{},
+    _logThrottlingCounter{ 0 },
+    _logCounter{ 0 }
 {}
 
+NowSound::BaseAudioProcessor::~BaseAudioProcessor()
+{
+    _graph->UnregisterNodeTiming(_timing);
+}
+
+void NowSound::BaseAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    uint64_t start = CycleTimer::Now();
+
+    ProcessBlock(buffer, midiMessages);
+
+    _timing->Histogram.Record(CycleTimer::Now() - start);
+}
+
+int NowSound::BaseAudioProcessor::ParameterRampSamples() const
+{
+    return (int)_graph->Clock()->TimeToRoundedUpSamples(MagicConstants::ParameterSmoothingDuration).Value();
+}
+
 bool NowSound::BaseAudioProcessor::CheckLogThrottle()
 {
     // TODO: revive if necessary... for now, always false
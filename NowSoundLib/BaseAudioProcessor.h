@@ -6,11 +6,13 @@
 #include "stdafx.h"
 
 #include <string>
+#include "AudioTiming.h"
 #include "NowSoundGraph.h"
 
 namespace NowSound
 {
-    // Simple audio processor with empty implementations for almost everything but processBlock and getName.
+    // Simple audio processor with empty implementations for almost everything but ProcessBlock and getName.
+    // Every block a derived processor handles is timed, and the timings are kept by the graph.
     class BaseAudioProcessor : public juce::AudioProcessor
     {
         // Inherited via AudioProcessor
@@ -21,8 +23,8 @@ namespace NowSound
         virtual void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
         virtual void releaseResources() override;
 
-        // Deliberately do not implement this processBlock; that's just about all a derived class has to do.
-        // virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer & midiMessages) override;
+        // Time the derived class's ProcessBlock.
+        virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) final override;
 
         virtual double getTailLengthSeconds() const override;
         virtual bool acceptsMidi() const override;
@@ -41,6 +43,10 @@ namespace NowSound
         // NowSoundGraph we're part of
         NowSoundGraph* _graph;
 
+        // Where this processor's processing times are recorded; owned by the graph (which outlives us) until we
+        // unregister it on destruction.
+        NodeTiming* _timing;
+
         // Our node ID in that graph if any; this gets assigned post-construction after the node gets added to
         // (and becomes owned by) the graph
         juce::AudioProcessorGraph::NodeID _nodeId;
@@ -55,6 +61,10 @@ namespace NowSound
         // the max counter at which _logThrottlingCounter rolls over
         static const int LogThrottle = 1000;
 
+        // The most samples of smoothed parameter values a processor renders at once; longer blocks are
+        // processed in chunks of this size, so the values fit in stack buffers.
+        static constexpr int ParameterChunkSamples = 256;
+
         // The graph this processor is part of.
         NowSoundGraph* Graph() const { return _graph; }
 
@@ -74,9 +84,18 @@ namespace NowSound
 
         BaseAudioProcessor(NowSoundGraph* graph, const std::wstring& name);
 
+        // Drops this processor's timings from the graph.
+        ~BaseAudioProcessor();
+
+        // Process one block of audio; that's just about all a derived class has to do.
+        virtual void ProcessBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) = 0;
+
         // Return true if it is appropriate to emit a log message (happens every MaxCounter calls to this method).
         bool CheckLogThrottle();
 
         int NextCounter() { return ++_logCounter; }
+
+        // How many samples each SmoothedParameter ramp takes at the graph's sample rate.
+        int ParameterRampSamples() const;
     };
 }
@@ -20,6 +20,10 @@ namespace NowSound
 
         // Set the dry/wet level.
         virtual void SetDryWetLevel(int dryWetLevel) = 0;
+
+        // Start moving to the dry/wet level at exactly the given audio time.
+        // Returns false if too many changes are already waiting.
+        virtual bool ScheduleDryWetLevel(Time<AudioSample> time, int dryWetLevel) = 0;
     };
 }
 
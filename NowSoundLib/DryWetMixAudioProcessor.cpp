@@ -8,22 +8,21 @@ using namespace std;
 #include "Clock.h"
 #include "MagicConstants.h"
 #include "DryWetMixAudioProcessor.h"
+#include "Kernels.h"
 
 using namespace NowSound;
 
 DryWetMixAudioProcessor::DryWetMixAudioProcessor(NowSoundGraph* graph, const wstring& name)
     : BaseAudioProcessor(graph, name),
-    dryWetLevel(0)
+    _mix{ 0, ParameterRampSamples(), SmoothingCurve::Linear, MagicConstants::ParameterScheduleCapacity }
 {}
 
-void DryWetMixAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
+void DryWetMixAudioProcessor::ProcessBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
 {
     // temporary debugging code: see if processBlock is ever being called under Holofunk
     if (CheckLogThrottle())
     {
-        std::wstringstream wstr{};
-        wstr << getName() << L"::processBlock: count " << NextCounter();
-        NowSoundGraph::Instance()->Log(wstr.str());
+        Graph()->Events().Log(Graph()->ProcessBlockFormat(), NodeId().uid, NextCounter());
     }
 
     Check(audioBuffer.getNumChannels() == 4);
@@ -31,36 +30,42 @@ void DryWetMixAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, Midi
     int numSamples = audioBuffer.getNumSamples();
 
     // channels 0 and 1 are dry, channels 2 and 3 are wet
-    const float* outputBufferChannel0 = audioBuffer.getReadPointer(0);
-    const float* outputBufferChannel1 = audioBuffer.getReadPointer(1);
+    float* outputBufferChannel0 = audioBuffer.getWritePointer(0);
+    float* outputBufferChannel1 = audioBuffer.getWritePointer(1);
     const float* outputBufferChannel2 = audioBuffer.getReadPointer(2);
     const float* outputBufferChannel3 = audioBuffer.getReadPointer(3);
 
-    // Pan each mono sample (and track its volume), if we're not muted.
+    // Crossfade the wet channels into the dry ones, in place, a sample at a time while the mix is moving.
+    float mixes[ParameterChunkSamples];
+    Time<AudioSample> blockStart = Graph()->Clock()->BlockStart();
+    for (int offset = 0; offset < numSamples; offset += ParameterChunkSamples)
     {
-        for (int i = 0; i < numSamples; i++)
+        int count = std::min(ParameterChunkSamples, numSamples - offset);
+        if (_mix.Advance(blockStart + Duration<AudioSample>(offset), count, mixes))
         {
-            // we average the stereo channels when computing the histogram values to add
-            float value0 = outputBufferChannel0[i];
-            float value1 = outputBufferChannel1[i];
-
-            float value2 = outputBufferChannel2[i];
-            float value3 = outputBufferChannel3[i];
-
-            float mix = (float)dryWetLevel / (float)100.0;
-
-            audioBuffer.getWritePointer(0)[i] = (value0 * (1 - mix)) + (value2 * mix);
-            audioBuffer.getWritePointer(1)[i] = (value1 * (1 - mix)) + (value3 * mix);
+            Kernels::CrossfadePerSample(outputBufferChannel0 + offset, outputBufferChannel2 + offset, count, mixes, outputBufferChannel0 + offset);
+            Kernels::CrossfadePerSample(outputBufferChannel1 + offset, outputBufferChannel3 + offset, count, mixes, outputBufferChannel1 + offset);
+        }
+        else
+        {
+            float mix = _mix.Current();
+            Kernels::Crossfade(outputBufferChannel0 + offset, outputBufferChannel2 + offset, count, mix, outputBufferChannel0 + offset);
+            Kernels::Crossfade(outputBufferChannel1 + offset, outputBufferChannel3 + offset, count, mix, outputBufferChannel1 + offset);
         }
     }
 }
 
 int DryWetMixAudioProcessor::GetDryWetLevel()
 {
-    return dryWetLevel;
+    return (int)std::round(_mix.Target() * 100);
 }
 
 void DryWetMixAudioProcessor::SetDryWetLevel(int dryWetLevel)
 {
-    this->dryWetLevel = dryWetLevel;
+    _mix.SetTarget((float)dryWetLevel / (float)100.0);
+}
+
+bool DryWetMixAudioProcessor::ScheduleDryWetLevel(Time<AudioSample> time, int dryWetLevel)
+{
+    return _mix.Schedule(time, (float)dryWetLevel / (float)100.0);
 }
@@ -9,25 +9,26 @@
 #include "NowSoundGraph.h"
 #include "BaseAudioProcessor.h"
 #include "DryWetAudio.h"
+#include "SmoothedParameter.h"
 
 namespace NowSound
 {
     // Takes 4 input channels (0/1 = dry, 2/3 = wet) and mixes them using a DryWetMixer.
     class DryWetMixAudioProcessor : public BaseAudioProcessor, public DryWetAudio
     {
-        // The dry/wet level, as an integer from 0 (dry) to 100 (wet).
-        // Should really be a float but we can change that later.
-        int dryWetLevel;
+        // The wet proportion of the mix, from 0 (dry) to 1 (wet); set as an integer dry/wet level from 0 to 100.
+        SmoothedParameter<float> _mix;
 
     public:
         DryWetMixAudioProcessor(NowSoundGraph* graph, const std::wstring& name);
 
         // Process the given buffer; use the number of output channels as the channel count.
         // This locks the info mutex.
-        virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+        virtual void ProcessBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
 
         virtual int GetDryWetLevel();
         virtual void SetDryWetLevel(int dryWetLevel);
+        virtual bool ScheduleDryWetLevel(Time<AudioSample> time, int dryWetLevel);
     };
 }
 
@@ -22,13 +22,69 @@ const int MagicConstants::BeatsPerMeasure{ 4 };
 // Could be much larger but not really any reason to
 const int MagicConstants::InitialAudioBufferCount{ 8 };
 
-// 1 second of stereo float audio at 48Khz is only 384KB.  One second buffer ensures minimal fragmentation
+// A minute of one-second mono buffers is about 11MB, a reasonable amount to lock into physical memory
+const int MagicConstants::AudioBufferArenaCount{ 60 };
+
+// Worth trying; fewer TLB misses when many loops are playing, and harmless when unavailable
+const bool MagicConstants::UseLargeAudioBufferPages{ true };
+
+// Over an hour of one-second buffers; the free list node table for these is only 64KB
+const int MagicConstants::MaximumAudioBufferCount{ 4096 };
+
+// Grow two at a time; cheap, and halves the number of refills when many tracks record at once
+const int MagicConstants::AudioBufferGrowthStep{ 2 };
+
+// Refill happens every few milliseconds, so even a dozen tracks recording at once will not drain this
+const int MagicConstants::AudioBufferLowWaterMark{ 4 };
+
+// 1 second of mono float audio at 48Khz is only 192KB.  One second buffer ensures minimal fragmentation
 // regardless of loop length.
 const Duration<Second> MagicConstants::AudioBufferSizeInSeconds{ 1 };
 
 // This could easily be huge but 1000 is fine for getting at least a second's worth of per-track history at audio rate.
 const int MagicConstants::DebugLogCapacity{ 1000 };
 
+// Two workers keep up with dozens of trackers at typical FFT sizes, without competing much with the audio thread.
+const int MagicConstants::AnalysisWorkerCount{ 2 };
+
+// Frequency displays update at UI rates, so a few milliseconds of extra analysis latency is invisible.
+const int MagicConstants::AnalysisWorkerIdleMsec{ 5 };
+
+// Enough slack for the workers to fall a few FFTs behind (e.g. while starting up) without dropping audio.
+const int MagicConstants::AnalysisQueueFftCount{ 4 };
+
+// 50% overlap: twice the spectrum refresh rate of back-to-back frames, and with the window applied, every
+// sample still contributes to some frame at close to full weight.
+const int MagicConstants::FftHopDivisor{ 2 };
+
+// Comfortably more than the usual OS sleep overshoot (about a millisecond without raised timer resolution), so
+// blocks start on time, while still sleeping through most of any block of 64 samples or more.
+const int MagicConstants::SoftwareDeviceSpinMicroseconds{ 1500 };
+
+// Concert A: easy to recognize by ear in a bounce, and well inside every frequency bin layout we use.
+const float MagicConstants::OfflineTestToneHz{ 440 };
+
+// About -12 dB, leaving headroom for several loops of it to mix without clipping.
+const float MagicConstants::OfflineTestToneLevel{ 0.25f };
+
+// Devices deliver callbacks with some jitter, but a gap of one and a half blocks means a block went missing
+const float MagicConstants::XrunCallbackGapFactor{ 1.5f };
+
+// The audio thread, the UI thread, and the odd device or plugin thread, with room to spare
+const int MagicConstants::EventLogThreadCapacity{ 8 };
+
+// Enough for a log call in every processor on every block, at 64-sample blocks, between formatting passes
+const int MagicConstants::EventLogEventsPerThread{ 4096 };
+
+// Frequent enough that the rings never fill at the rate above, rare enough to cost nothing
+const int MagicConstants::EventLogFormattingMilliseconds{ 20 };
+
+// Long enough that no change is heard as a click, short enough that the change still feels immediate
+const ContinuousDuration<Second> MagicConstants::ParameterSmoothingDuration{ (float)0.02 };
+
+// A few seconds of automation sent at UI frame rate, well ahead of the audio
+const int MagicConstants::ParameterScheduleCapacity{ 64 };
+
 // 200 histogram values at 100Hz = two seconds of history, enough to follow transient crackling/breakup
 // (due to losing foreground execution status, for example)
 const int MagicConstants::AudioQuantumHistogramCapacity{ 200 };
@@ -36,6 +92,19 @@ const int MagicConstants::AudioQuantumHistogramCapacity{ 200 };
 // Volume over the last half second works well enough in practice
 const ContinuousDuration<Second> MagicConstants::RecentVolumeDuration{ (float)0.5 };
 
+// Enough to stack a loop sixteen deep; voice slots are preallocated per track, so keep this modest
+const int MagicConstants::MaximumTrackVoiceCount{ 16 };
+
+// Costs little more than linear (the taps are per block, not per sample) and sounds noticeably cleaner
+const LoopInterpolation MagicConstants::TrackLoopInterpolation{ LoopInterpolation::CubicHermite };
+
+// Tracks keep their recorded tempo unless asked otherwise, as they always have
+const NowSoundTrackTempoMode MagicConstants::InitialTrackTempoMode{ NowSoundTrackTempoMode::TrackTempoFixed };
+
+// Two octaves either way; past that, varispeed is a novelty and time stretching falls apart
+const float MagicConstants::MinimumTrackPlaybackRate{ 0.25f };
+const float MagicConstants::MaximumTrackPlaybackRate{ 4 };
+
 // For now, one-half beat is OK for ending a single-beat loop late.
 const ContinuousDuration<Beat> MagicConstants::SingleTruncationBeats{ (float)0.5 };
 
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "LoopPlayhead.h"
+#include "NowSoundLibTypes.h"
 #include "NowSoundTime.h"
 
 // Constants that are assigned based on manual tuning.
@@ -28,15 +30,90 @@ namespace NowSound
         static const int BeatsPerMeasure;
 
         // How many (one-second, for now) audio buffers do we initially want to allocate?
-        // Not much downside to allocating many; stereo float 48Khz = only 384KB per one-sec buffer
+        // Not much downside to allocating many; mono float 48Khz = only 192KB per one-sec buffer
         static const int InitialAudioBufferCount;
 
-        // How many seconds long is each audio buffer?
+        // How many audio buffers does the allocator's refill thread create at a time?
+        static const int AudioBufferGrowthStep;
+
+        // How many additional voices (playheads) can a single looping track have?
+        static const int MaximumTrackVoiceCount;
+
+        // How do tracks and their voices play loops whose length is a fractional number of samples?
+        static const LoopInterpolation TrackLoopInterpolation;
+
+        // How do new tracks follow changes to the graph's tempo?
+        static const NowSoundTrackTempoMode InitialTrackTempoMode;
+
+        // The slowest and fastest a track will play to follow the graph's tempo, relative to its recorded tempo;
+        // beyond these it just plays as fast or as slow as it can.
+        static const float MinimumTrackPlaybackRate;
+        static const float MaximumTrackPlaybackRate;
+
+        // How many audio buffers are carved out of the audio allocator's pre-faulted, locked memory arena?
+        // Buffers beyond this many come from the heap.
+        static const int AudioBufferArenaCount;
+
+        // Should the audio buffer arena try to use large pages? (Requires SeLockMemoryPrivilege on Windows;
+        // falls back to normal pages if unavailable.)
+        static const bool UseLargeAudioBufferPages;
+
+        // How many audio buffers can the audio allocator ever create?
+        // This sizes the allocator's lock-free free list up front, so it can never need reallocating.
+        static const int MaximumAudioBufferCount;
+
+        // How many free audio buffers does the allocator's refill thread try to keep on hand?
+        // Recording tracks allocate on the audio thread, so this must cover all the buffers that
+        // simultaneously recording tracks could need between refills.
+        static const int AudioBufferLowWaterMark;
+
+        // How many seconds long is each audio buffer, for mono audio?  Buffers hold floats, so a stereo stream
+        // gets half as long from each.
         static const Duration<Second> AudioBufferSizeInSeconds;
 
         // The number of strings to buffer in the per-track debug log.
         static const int DebugLogCapacity;
 
+        // How many background threads run frequency analysis?
+        static const int AnalysisWorkerCount;
+
+        // How long does an analysis worker sleep when it finds no queued audio to analyze?
+        static const int AnalysisWorkerIdleMsec;
+
+        // How many FFTs' worth of audio can each frequency tracker queue for the analysis workers?
+        // If the workers fall further behind than this, the newest audio is dropped from analysis.
+        static const int AnalysisQueueFftCount;
+
+        // By default, successive FFT frames start every (FFT size / FftHopDivisor) samples.
+        static const int FftHopDivisor;
+
+        // How long before each block is due does the software audio device stop sleeping and start spinning?
+        static const int SoftwareDeviceSpinMicroseconds;
+
+        // The frequency of the test tone fed to all inputs by an offline render with no input file.
+        static const float OfflineTestToneHz;
+
+        // The amplitude of that test tone.
+        static const float OfflineTestToneLevel;
+
+        // How many audio callbacks' durations apart must two callbacks start for the gap to count as an xrun?
+        static const float XrunCallbackGapFactor;
+
+        // How many threads can write to the real-time event log?
+        static const int EventLogThreadCapacity;
+
+        // How many events can each thread log between formatting passes?  Must be a power of two.
+        static const int EventLogEventsPerThread;
+
+        // How often are logged events formatted into log messages?
+        static const int EventLogFormattingMilliseconds;
+
+        // How long do volume, pan, and dry/wet changes take to ramp to their new values?
+        static const ContinuousDuration<Second> ParameterSmoothingDuration;
+
+        // How many scheduled changes can each smoothed parameter hold before they are reached?  Must be a power of two.
+        static const int ParameterScheduleCapacity;
+
         // How many audio frames' duration will the per-track histogram follow?
         // The histogram helps detect spikes in the latency observed by the FrameInputNode_QuantumStarted method.
         static const int AudioQuantumHistogramCapacity;
@@ -7,18 +7,23 @@ using namespace std;
 
 #include "Clock.h"
 #include "MagicConstants.h"
+#include "Kernels.h"
 #include "MeasurementAudioProcessor.h"
 
 using namespace NowSound;
 
 MeasurementAudioProcessor::MeasurementAudioProcessor(NowSoundGraph* graph, const wstring& name)
     : BaseAudioProcessor(graph, name),
-    _frequencyDataMutex{},
     // hardcoded to the clock's channel count, e.g. the overall output bus width.
-    _volumeHistogram{ new Histogram((int)(graph->Clock()->TimeToRoundedUpSamples(MagicConstants::RecentVolumeDuration).Value())) },
+    // Summarized per audio quantum, since the UI only polls a few times a second anyway.
+    _volumeHistogram{ new Histogram(
+        (int)(graph->Clock()->TimeToRoundedUpSamples(MagicConstants::RecentVolumeDuration).Value()),
+        graph->Info().SamplesPerQuantum) },
+    _signalInfo{ CreateNowSoundSignalInfo(0, 0, 0) },
+    _volumeScratch(graph->Info().SamplesPerQuantum),
     _frequencyTracker{ graph->FftSize() < 0
         ? ((NowSoundFrequencyTracker*)nullptr)
-        : new NowSoundFrequencyTracker(graph->BinBounds(), graph->FftSize()) },
+        : new NowSoundFrequencyTracker(graph->Analysis()) },
     _recordingFile{},
     _recordingMutex{},
     _recordingThread{},
@@ -28,11 +33,7 @@ MeasurementAudioProcessor::MeasurementAudioProcessor(NowSoundGraph* graph, const
 
 NowSoundSignalInfo MeasurementAudioProcessor::SignalInfo()
 {
-    std::lock_guard<std::mutex> guard(_frequencyDataMutex);
-    float min = _volumeHistogram->Min();
-    float max = _volumeHistogram->Max();
-    float avg = _volumeHistogram->Average();
-    return CreateNowSoundSignalInfo(min, max, avg);
+    return _signalInfo.Read();
 }
 
 void MeasurementAudioProcessor::GetFrequencies(void* floatBuffer, int floatBufferCapacity)
@@ -43,20 +44,27 @@ void MeasurementAudioProcessor::GetFrequencies(void* floatBuffer, int floatBuffe
         return;
     }
 
-    std::lock_guard<std::mutex> guard(_frequencyDataMutex);
     _frequencyTracker->GetLatestHistogram((float*)floatBuffer, floatBufferCapacity);
 }
 
+void MeasurementAudioProcessor::SetFrequencyAnalysisEnabled(bool isEnabled)
+{
+    if (_frequencyTracker == nullptr)
+    {
+        return;
+    }
+
+    _frequencyTracker->SetIsEnabled(isEnabled);
+}
+
 const double Pi = std::atan(1) * 4;
 
-void MeasurementAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
+void MeasurementAudioProcessor::ProcessBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
 {
     // temporary debugging code: see if processBlock is ever being called under Holofunk
     if (CheckLogThrottle())
     {
-        std::wstringstream wstr{};
-        wstr << getName() << L"::processBlock: count " << NextCounter();
-        NowSoundGraph::Instance()->Log(wstr.str());
+        Graph()->Events().Log(Graph()->ProcessBlockFormat(), NodeId().uid, NextCounter());
     }
 
     Check(audioBuffer.getNumChannels() == 2);
@@ -66,23 +74,22 @@ void MeasurementAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, Mi
     const float* outputBufferChannel0 = audioBuffer.getReadPointer(0);
     const float* outputBufferChannel1 = audioBuffer.getReadPointer(1);
 
-    // Pan each mono sample (and track its volume), if we're not muted.
+    // Track the volume, and publish the updated statistics.
+    // we average the stereo channels when computing the histogram values to add
+    int scratchCapacity = (int)_volumeScratch.size();
+    for (int i = 0; i < numSamples; i += scratchCapacity)
     {
-        std::lock_guard<std::mutex> guard(_frequencyDataMutex);
-
-        for (int i = 0; i < numSamples; i++)
-        {
-            // we average the stereo channels when computing the histogram values to add
-            float value0 = outputBufferChannel0[i];
-            float value1 = outputBufferChannel1[i];
-            _volumeHistogram->Add(std::abs(value0) / 2 + std::abs(value1) / 2);
-        }
+        int chunkSize = std::min<int>(scratchCapacity, numSamples - i);
+        Kernels::AbsMean(outputBufferChannel0 + i, outputBufferChannel1 + i, chunkSize, _volumeScratch.data());
+        _volumeHistogram->AddAll(_volumeScratch.data(), chunkSize, /*absoluteValue:*/false);
+    }
+    _signalInfo.WriteBuffer() = CreateNowSoundSignalInfo(_volumeHistogram->Min(), _volumeHistogram->Max(), _volumeHistogram->Average());
+    _signalInfo.Publish();
 
-        // and provide it to frequency histogram as well
-        if (_frequencyTracker != nullptr)
-        {
-            _frequencyTracker->Record(outputBufferChannel0, outputBufferChannel1, numSamples);
-        }
+    // and provide it to frequency histogram as well (which publishes its own results)
+    if (_frequencyTracker != nullptr)
+    {
+        _frequencyTracker->Record(outputBufferChannel0, outputBufferChannel1, numSamples);
     }
 
     // and write to recording thread, if any
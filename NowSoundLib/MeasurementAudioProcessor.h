@@ -9,6 +9,7 @@
 #include "NowSoundGraph.h"
 #include "BaseAudioProcessor.h"
 #include "MeasurableAudio.h"
+#include "TripleBuffer.h"
 
 namespace NowSound
 {
@@ -17,12 +18,16 @@ namespace NowSound
     // Subclasses can use this to measure either before or after subclass processing.
     class MeasurementAudioProcessor : public BaseAudioProcessor, public MeasurableAudio
     {
-        // Mutex to use when returning or updating signal info; to prevent racing between data access and update.
-        std::mutex _frequencyDataMutex;
-
-        // histogram of volume
+        // histogram of volume; touched only by the audio thread
         std::unique_ptr<Histogram> _volumeHistogram;
 
+        // The latest volume statistics, published by the audio thread after every block.
+        TripleBuffer<NowSoundSignalInfo> _signalInfo;
+
+        // Per-sample stereo volumes for the current block, fed to _volumeHistogram; one audio quantum long,
+        // and reused in chunks if a block is ever longer than that.
+        std::vector<float> _volumeScratch;
+
         // The frequency tracker for the audio traveling through this processor.
         // TODOFX: make this actually track the *post-effects* audio... probably via its own tracker at that stage?
         const std::unique_ptr<NowSoundFrequencyTracker> _frequencyTracker;
@@ -46,17 +51,21 @@ namespace NowSound
         MeasurementAudioProcessor(NowSoundGraph* graph, const std::wstring& name);
 
         // Process the given buffer; use the number of output channels as the channel count.
-        // This locks the info mutex.
-        virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+        // Never blocks on readers of the signal info or frequencies.
+        virtual void ProcessBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
 
-        // Copy out the volume signal info for reading.
-        // This locks the info mutex.
+        // Copy out the latest volume signal info for reading.
+        // Wait-free; must only be called from one thread (the UI thread).
         NowSoundSignalInfo SignalInfo();
 
         // Get the frequency histogram, by updating the given WCHAR buffer as though it were a float* buffer.
-        // This locks the info mutex.
+        // Wait-free; must only be called from one thread (the UI thread).
         void GetFrequencies(void* floatBuffer, int floatBufferCapacity);
 
+        // Start or stop frequency analysis of this processor's audio; while stopped, GetFrequencies
+        // keeps returning the last histogram.
+        void SetFrequencyAnalysisEnabled(bool isEnabled);
+
         // Start recording to the given file (WAV format); ignored if already recording.
         void StartRecording(LPWSTR fileName, int32_t fileNameLength);
 
@@ -7,77 +7,163 @@
 
 #include "stdint.h"
 
+#include "Kernels.h"
+#include "MagicConstants.h"
 #include "NowSoundFrequencyTracker.h"
 
-using namespace RosettaFFT;
 using namespace std;
 
 namespace NowSound
 {
-    NowSoundFrequencyTracker::NowSoundFrequencyTracker(
-        const std::vector<FrequencyBinBounds>* bounds,
-        int fftSize)
-        : _fftBuffer{ std::unique_ptr<Complex>(new Complex[fftSize]) },
-        _outputBuffer{ std::unique_ptr<float>(new float[bounds->size()]) },
+    // The smallest power of two that is at least value.
+    static int NextPowerOfTwo(int value)
+    {
+        int result = 1;
+        while (result < value)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+
+    NowSoundFrequencyTracker::NowSoundFrequencyTracker(AnalysisEngine* engine)
+        : _engine{ engine },
+        _queue{ NextPowerOfTwo(engine->FftSize() * MagicConstants::AnalysisQueueFftCount) },
+        _mixBuffer(engine->FftSize()),
+        _frame(engine->FftSize()),
+        _peaks(engine->OutputBinCount()),
+        _output{ std::vector<float>(engine->OutputBinCount(), engine->Options().Decibels ? RosettaFFT::MinimumDecibels : 0) },
         _recordingBufferSize{ 0 },
-        _binBounds(bounds),
-        _fftSize{ fftSize }
+        _samplesToSkip{ 0 },
+        _isEnabled{ true },
+        _needsRestart{ false },
+        _isAnalyzing{}
     {
-        // TODO: BROKEN: std::fill(_outputBuffer.get(), _outputBuffer.get() + bounds->size(), 0);
+        _isAnalyzing.clear();
+        _engine->Register(this);
+    }
+
+    NowSoundFrequencyTracker::~NowSoundFrequencyTracker()
+    {
+        _engine->Unregister(this);
     }
 
     void NowSoundFrequencyTracker::GetLatestHistogram(float* outputBuffer, int capacity)
     {
-        Check(capacity == _binBounds->size());
+        Check(capacity == _engine->OutputBinCount());
 
-        // No thread synchronization here.  Slightly inconsistent data is fine.
-        std::copy(_outputBuffer.get(), _outputBuffer.get() + capacity, outputBuffer);
+        const std::vector<float>& latest = _output.Read();
+        std::copy(latest.begin(), latest.end(), outputBuffer);
+    }
+
+    void NowSoundFrequencyTracker::SetIsEnabled(bool isEnabled)
+    {
+        if (isEnabled && !_isEnabled.load())
+        {
+            _needsRestart = true;
+        }
+        _isEnabled = isEnabled;
     }
 
     void NowSoundFrequencyTracker::Record(const float* buffer0, const float* buffer1, int sampleCount)
     {
-        Check(_recordingBufferSize <= _fftSize);
+        if (!_isEnabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        int mixBufferCapacity = (int)_mixBuffer.size();
+        for (int i = 0; i < sampleCount; i += mixBufferCapacity)
+        {
+            int chunkSize = std::min<int>(mixBufferCapacity, sampleCount - i);
+
+            // average the stereo channels
+            Kernels::Crossfade(buffer0 + i, buffer1 + i, chunkSize, 0.5f, _mixBuffer.data());
+
+            // if the workers have fallen too far behind, whatever doesn't fit is simply not analyzed
+            _queue.Push(_mixBuffer.data(), chunkSize);
+        }
+    }
+
+    bool NowSoundFrequencyTracker::TryAnalyze(AnalysisEngine::Scratch& scratch)
+    {
+        if (!_isEnabled.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
 
-        int inputPosition = 0;
-        while (sampleCount > 0)
+        if (_isAnalyzing.test_and_set(std::memory_order_acquire))
         {
-            int recordingBufferCapacity = _fftSize - _recordingBufferSize;
+            return false;
+        }
 
-            int samplesToRecord = sampleCount > recordingBufferCapacity ? recordingBufferCapacity : sampleCount;
+        if (_needsRestart.exchange(false))
+        {
+            // drop whatever was queued before the tracker was disabled, and any partial frame
+            _queue.Skip(_queue.Capacity());
+            _recordingBufferSize = 0;
+            _samplesToSkip = 0;
+            std::fill(_peaks.begin(), _peaks.end(), 0.0f);
+        }
 
-            Complex* recordingBuffer = _fftBuffer.get();
+        int fftSize = _engine->FftSize();
+        Check(_recordingBufferSize <= fftSize);
 
-            for (int i = 0; i < samplesToRecord; i++)
+        bool analyzedAnything = false;
+        while (true)
+        {
+            if (_samplesToSkip > 0)
             {
-                // Assigning float to complex leaves imaginary value as 0, as desired.
-                // Note that std::copy is inapplicable here as we are writing into a Complex array.
-                // TODO: add back Blackman-Harris windowing here
-                recordingBuffer[_recordingBufferSize + i] = buffer0[inputPosition + i] / 2 + buffer1[inputPosition + 1] / 2;
+                int samplesSkipped = _queue.Skip(_samplesToSkip);
+                if (samplesSkipped == 0)
+                {
+                    break;
+                }
+                analyzedAnything = true;
+                _samplesToSkip -= samplesSkipped;
+                continue;
             }
 
-            _recordingBufferSize += samplesToRecord;
-            if (_recordingBufferSize == _fftSize)
+            int recordingBufferCapacity = fftSize - _recordingBufferSize;
+            int samplesToRecord = _queue.Pop(_frame.data() + _recordingBufferSize, recordingBufferCapacity);
+            if (samplesToRecord == 0)
             {
-                // this buffer is full.
-                _recordingBufferSize = 0;
-                TransformBuffer();
+                break;
             }
+            analyzedAnything = true;
 
-            sampleCount -= samplesToRecord;
-            inputPosition += samplesToRecord;
+            _recordingBufferSize += samplesToRecord;
+            if (_recordingBufferSize == fftSize)
+            {
+                // this frame is full.
+                TransformBuffer(scratch);
+            }
         }
+
+        _isAnalyzing.clear(std::memory_order_release);
+        return analyzedAnything;
     }
     
-    void NowSoundFrequencyTracker::TransformBuffer()
+    void NowSoundFrequencyTracker::TransformBuffer(AnalysisEngine::Scratch& scratch)
     {
-        // actually run the FFT in placeB!
-        RosettaFFT::Complex* fftBuffer = _fftBuffer.get();
-        RosettaFFT::CArray fftArray(fftBuffer, _fftSize);
+        // analyze it!
+        _engine->AnalyzeFrame(_frame.data(), scratch, _peaks.data(), _output.WriteBuffer().data());
 
-        // and run it!
-        RosettaFFT::optimized_fft(fftArray);
+        // and publish it!
+        _output.Publish();
 
-        // and rescale it!
-        RosettaFFT::RescaleFFT(*_binBounds, fftArray, _outputBuffer.get(), static_cast<int>(_binBounds->size()));
+        // and move on to the next frame, which either overlaps this one or starts after it
+        int fftSize = _engine->FftSize();
+        int hopSize = _engine->HopSize();
+        if (hopSize < fftSize)
+        {
+            std::copy(_frame.begin() + hopSize, _frame.end(), _frame.begin());
+            _recordingBufferSize = fftSize - hopSize;
+        }
+        else
+        {
+            _recordingBufferSize = 0;
+            _samplesToSkip = hopSize - fftSize;
+        }
     }
 }
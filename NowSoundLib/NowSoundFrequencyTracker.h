@@ -3,54 +3,94 @@
 
 #pragma once
 
-#include <complex>
+#include <atomic>
 #include <vector>
 
 #include "stdafx.h"
 
+#include "AnalysisEngine.h"
 #include "Clock.h"
 #include "Histogram.h"
 #include "NowSoundLibTypes.h"
-#include "rosetta_fft.h"
 #include "NowSoundTime.h"
+#include "SpscRing.h"
+#include "TripleBuffer.h"
 
 namespace NowSound
 {
     // Tracks the frequencies of a stream of input audio, and runs an FFT on that data.
     // Ultimately the tracker allows copying the current histogram of binned values.
+    //
+    // The audio thread only mixes incoming audio to mono and queues it (Record); the FFTs themselves run on
+    // an AnalysisEngine worker thread (TryAnalyze), which owns all the FFT tables and scratch space.
+    //
+    // Each FFT frame is windowed, and frames start every hop; so with a hop shorter than the FFT, frames
+    // overlap, and the spectrum updates more often than once per FFT size.  With a hop longer than the FFT,
+    // the samples between frames are skipped.
+    //
+    // A disabled tracker (e.g. for a track nobody is looking at) costs nothing on any thread; its histogram
+    // keeps its last value until it is enabled again.
     class NowSoundFrequencyTracker
     {
     private:
-        // The FFT buffer.
-        std::unique_ptr<RosettaFFT::Complex> _fftBuffer;
+        // The engine analyzing this tracker.
+        AnalysisEngine* const _engine;
 
-        // The single lock-free output buffer.
-        // This may get written and read concurrently, which is fine; slightly inconsistent data
-        // is better than locking overhead.
-        std::unique_ptr<float> _outputBuffer;
+        // Mono audio queued by the audio thread for the analysis workers.
+        SpscRing<float> _queue;
 
-        // The current size of the recording buffer.
+        // Audio thread scratch space for mixing to mono before queueing.
+        std::vector<float> _mixBuffer;
+
+        // The samples of the frame being filled; touched only by the analysis worker.
+        std::vector<float> _frame;
+
+        // The held peak of each output bin; touched only by the analysis worker.
+        std::vector<float> _peaks;
+
+        // The binned output of the latest FFT, published wait-free from the analysis worker to the reader.
+        TripleBuffer<std::vector<float>> _output;
+
+        // The number of samples in _frame so far.
         int _recordingBufferSize;
 
-        // The per-bin bounds; equal in length to the number of bins.
-        const std::vector<RosettaFFT::FrequencyBinBounds>* _binBounds;
+        // The number of queued samples to drop before the next frame starts (when the hop exceeds the FFT size).
+        int _samplesToSkip;
+
+        // Is this tracker being analyzed at all?
+        std::atomic<bool> _isEnabled;
 
-        // The total FFT size, measured as number of samples in the FFT window.
-        const int _fftSize;
+        // Set when the tracker is enabled, so the next analysis starts afresh rather than mixing in stale audio.
+        std::atomic<bool> _needsRestart;
+
+        // Set while an analysis worker is in TryAnalyze, so only one worker analyzes this at a time.
+        std::atomic_flag _isAnalyzing;
 
     private:
-        // Run the FFT inside a task and update the requisite output buffer.
-        void TransformBuffer();
+        // Analyze the full frame, publish the result, and shift the frame by one hop.
+        void TransformBuffer(AnalysisEngine::Scratch& scratch);
 
     public:
-        NowSoundFrequencyTracker(
-            const std::vector<RosettaFFT::FrequencyBinBounds>* bounds,
-            int fftSize);
+        // Construct a tracker, and register it with the engine.
+        NowSoundFrequencyTracker(AnalysisEngine* engine);
+
+        // Unregister from the engine.
+        ~NowSoundFrequencyTracker();
 
         // Get the latest histogram of output values.
+        // Wait-free; must only be called from one thread.
         void GetLatestHistogram(float* outputBuffer, int capacity);
 
-        // Record the given amount of float data.
+        // Start or stop analyzing this tracker's audio.  Enabled by default.
+        void SetIsEnabled(bool isEnabled);
+
+        // Queue the given amount of float data for analysis, if enabled.
+        // Called from the audio thread; O(sampleCount), never blocks and never allocates.
         void Record(const float* channel0, const float* channel1, int sampleCount);
+
+        // Analyze all queued audio, publishing a new histogram whenever an FFT frame fills.
+        // Called from analysis worker threads, each with its own scratch; returns false if there was nothing
+        // to do, the tracker is disabled, or another worker is already analyzing this tracker.
+        bool TryAnalyze(AnalysisEngine::Scratch& scratch);
     };
 }
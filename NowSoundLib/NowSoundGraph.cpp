@@ -14,6 +14,7 @@
 #include "NowSoundInput.h"
 #include "NowSoundTrack.h"
 #include "Option.h"
+#include "SoftwareAudioDevice.h"
 #include "Tempo.h"
 
 using namespace concurrency;
@@ -45,28 +46,18 @@ namespace NowSound
 
     NowSoundGraph* NowSoundGraph::Instance() { return s_instance.get(); }
 
-    void NowSoundGraph::InitializeInstance(
-        int outputBinCount,
-        float centralFrequency,
-        int octaveDivisions,
-        int centralBinIndex,
-        int fftSize,
-        float preRecordingDuration)
+    void NowSoundGraph::InitializeInstance(const NowSoundGraphOptions& options, LPWSTR loopbackFileNames)
     {
         std::unique_ptr<NowSoundGraph> temp{ new NowSoundGraph() };
         s_instance = std::move(temp);
-        s_instance.get()->Initialize(
-            outputBinCount,
-            centralFrequency,
-            octaveDivisions,
-            centralBinIndex,
-            fftSize,
-            preRecordingDuration);
+        s_instance.get()->Initialize(options, loopbackFileNames);
     }
 
     NowSoundGraph::NowSoundGraph() :
         _audioGraphState{ NowSoundGraphState::GraphUninitialized },
         _audioDeviceManager{},
+        _isOffline{ false },
+        _offlineInfo{},
         _audioAllocator{ nullptr },
         _clock{ nullptr },
         _nextTrackId{ TrackId::TrackIdUndefined },
@@ -76,10 +67,16 @@ namespace NowSound
         _changingState{ false },
         _fftBinBounds{},
         _fftSize{ -1 },
+        _analysisEngine{ nullptr },
         _stateMutex{},
         _outputSignalMutex{},
         _logMessages{},
         _logMutex{},
+        _eventLog{ MagicConstants::EventLogThreadCapacity, MagicConstants::EventLogEventsPerThread },
+        _droppedInputFormat{ _eventLog.RegisterFormat(L"Track {}: dropped {} samples of input; audio buffer pool exhausted ({} failed allocations)") },
+        _processBlockFormat{ _eventLog.RegisterFormat(L"Node {}::processBlock: count {}") },
+        _nodeTimings{},
+        _nodeTimingMutex{},
         _juceGraphChanged{},
         _juceGraphChangedMutex{},
         _audioPluginSearchPaths{},
@@ -87,7 +84,8 @@ namespace NowSound
         _audioPluginFormatManager{},
         _preRecordingDuration{ 0 },
         _audioProcessorGraph{ new AudioProcessorGraph() },
-        _tempo{ nullptr }
+        _tempo{ nullptr },
+        _beatsPerMinute{ 0 }
     {
         _logMessages.reserve(s_logMessageCapacity);
         Check(_logMessages.size() == 0);
@@ -205,6 +203,70 @@ namespace NowSound
         _logMessages.erase(_logMessages.begin(), _logMessages.begin() + messageCountToDrop);
     }
 
+    EventLog& NowSoundGraph::Events()
+    {
+        return _eventLog;
+    }
+
+    int NowSoundGraph::DroppedInputFormat() const
+    {
+        return _droppedInputFormat;
+    }
+
+    int NowSoundGraph::ProcessBlockFormat() const
+    {
+        return _processBlockFormat;
+    }
+
+    NodeTiming* NowSoundGraph::RegisterNodeTiming(const std::wstring& name)
+    {
+        std::lock_guard<std::mutex> guard(_nodeTimingMutex);
+
+        _nodeTimings.push_back(std::unique_ptr<NodeTiming>(new NodeTiming(name)));
+        return _nodeTimings.back().get();
+    }
+
+    void NowSoundGraph::UnregisterNodeTiming(NodeTiming* timing)
+    {
+        std::lock_guard<std::mutex> guard(_nodeTimingMutex);
+
+        auto found = std::find_if(
+            _nodeTimings.begin(),
+            _nodeTimings.end(),
+            [&](const std::unique_ptr<NodeTiming>& nodeTiming) { return nodeTiming.get() == timing; });
+        Check(found != _nodeTimings.end());
+        _nodeTimings.erase(found);
+    }
+
+    int32_t NowSoundGraph::NodeTimingCount()
+    {
+        std::lock_guard<std::mutex> guard(_nodeTimingMutex);
+
+        return (int32_t)_nodeTimings.size();
+    }
+
+    NowSoundNodeTimingInfo NowSoundGraph::NodeTimingInfo(int32_t nodeIndex)
+    {
+        std::lock_guard<std::mutex> guard(_nodeTimingMutex);
+
+        Check(nodeIndex >= 0 && nodeIndex < _nodeTimings.size());
+        return _nodeTimings[nodeIndex]->Info();
+    }
+
+    void NowSoundGraph::NodeTimingName(int32_t nodeIndex, LPWSTR buffer, int32_t bufferCapacity)
+    {
+        std::lock_guard<std::mutex> guard(_nodeTimingMutex);
+
+        Check(nodeIndex >= 0 && nodeIndex < _nodeTimings.size());
+        const std::wstring& name = _nodeTimings[nodeIndex]->Name;
+        wcsncpy_s(buffer, (size_t)bufferCapacity, name.c_str(), _TRUNCATE);
+    }
+
+    NowSoundCallbackTimingInfo NowSoundGraph::CallbackTimingInfo()
+    {
+        return _audioProcessorPlayer.Info();
+    }
+
     AudioProcessorGraph& NowSoundGraph::JuceGraph()
     {
         return *(_audioProcessorGraph.get());
@@ -252,17 +314,24 @@ namespace NowSound
         }
     }
 
-    void NowSoundGraph::Initialize(
-        int outputBinCount,
-        float centralFrequency,
-        int octaveDivisions,
-        int centralBinIndex,
-        int fftSize,
-        float preRecordingDuration)
+    void NowSoundGraph::Initialize(const NowSoundGraphOptions& options, LPWSTR loopbackFileNames)
     {
         Log(L"Initialize(): start");
 
-        _preRecordingDuration = preRecordingDuration;
+        _eventLog.StartFormatting(
+            [this](const std::wstring& message)
+            {
+                std::lock_guard<std::mutex> guard(_logMutex);
+
+                // unlike Log, drop messages rather than fail if the client has not been draining them
+                if (_logMessages.size() < s_logMessageCapacity)
+                {
+                    _logMessages.push_back(message);
+                }
+            },
+            MagicConstants::EventLogFormattingMilliseconds);
+
+        _preRecordingDuration = options.PreRecordingDuration;
 
         PrepareToChangeState(NowSoundGraphState::GraphUninitialized);
 
@@ -276,8 +345,18 @@ namespace NowSound
         // Not yet investigated....
         MessageManager::getInstance();
 
-        // Initialize the ASIO device.
+        _isOffline = options.AudioDevice == NowSoundAudioDevice::AudioDeviceOffline;
+        if (_isOffline)
         {
+            // No device to ask, so the caller tells us everything; offline rendering has no output latency.
+            Check(options.SoftwareSampleRateHz > 0);
+            Check(options.SoftwareSamplesPerQuantum > 0);
+            _offlineInfo = CreateNowSoundGraphInfo(options.SoftwareSampleRateHz, 2, 32, 0, options.SoftwareSamplesPerQuantum);
+        }
+        else
+        {
+            // Initialize the ASIO device.
+            //
             // Valid values for this on Surface Book are L"DirectSound" and L"Windows Audio".
             // Both seem to permit 96 sample buffering (!) but DirectSound seems to come up with
             // 16 bit audio sometimes... let's see if Windows Audio (AKA (AFAICT) WASAPI) causes
@@ -291,6 +370,31 @@ namespace NowSound
             // forgot how to really play.
             String desiredDeviceType = L"ASIO";
 
+            // ...unless there is no audio hardware to use, in which case a software device paces the graph instead.
+            if (options.AudioDevice != NowSoundAudioDevice::AudioDeviceAsio)
+            {
+                Check(options.SoftwareSampleRateHz > 0);
+                Check(options.SoftwareSamplesPerQuantum > 0);
+
+                StringArray loopbackFiles{};
+                if (options.AudioDevice == NowSoundAudioDevice::AudioDeviceLoopback)
+                {
+                    loopbackFiles.addTokens(String{ loopbackFileNames }, "|", "");
+                    loopbackFiles.removeEmptyStrings();
+                    Check(loopbackFiles.size() > 0);
+                }
+
+                SoftwareAudioIODeviceType* softwareDeviceType = new SoftwareAudioIODeviceType(
+                    options.SoftwareSampleRateHz,
+                    options.SoftwareSamplesPerQuantum,
+                    2,
+                    loopbackFiles);
+                desiredDeviceType = softwareDeviceType->getTypeName();
+
+                // the device manager owns the type from here on
+                _audioDeviceManager.addAudioDeviceType(softwareDeviceType);
+            }
+
             const OwnedArray<AudioIODeviceType>& deviceTypes = _audioDeviceManager.getAvailableDeviceTypes();
 
             // Set the audio device type.  Note that this actually winds up initializing one, which we don't want
@@ -310,10 +414,13 @@ namespace NowSound
         // Set up the ASIO device, clock, and audio allocator.
         NowSoundGraphInfo info;
         {
-            // we expect ASIO
-            Check(_audioDeviceManager.getCurrentAudioDeviceType() == L"ASIO");
+            if (options.AudioDevice == NowSoundAudioDevice::AudioDeviceAsio)
+            {
+                // we expect ASIO
+                Check(_audioDeviceManager.getCurrentAudioDeviceType() == L"ASIO");
 
-            setBufferSize();
+                setBufferSize();
+            }
 
             info = Info();
 
@@ -324,39 +431,94 @@ namespace NowSound
             Check(info.BitsPerSample == 32);
 
             _clock.reset(new NowSound::Clock(info.SampleRateHz,  info.ChannelCount));
+            _audioProcessorPlayer.SetClock(_clock.get());
 
             _tempo.reset(new NowSound::Tempo(
                 MagicConstants::InitialBeatsPerMinute,
                 MagicConstants::BeatsPerMeasure,
                 info.SampleRateHz));
-
-            _audioAllocator = std::unique_ptr<BufferAllocator<float>>(new BufferAllocator<float>(
-                (int)(_clock->BytesPerSecond() * MagicConstants::AudioBufferSizeInSeconds.Value()),
-                MagicConstants::InitialAudioBufferCount));
+            _beatsPerMinute.store(_tempo->BeatsPerMinute(), std::memory_order_release);
+
+            // Buffer length is a count of floats (not bytes!), and streams store SliceSize() floats per frame, so a
+            // buffer holds length / channelCount frames of a multichannel stream; if the length is not a multiple of
+            // the channel count, the remainder of each buffer goes unused (see BufferedSliceStream::EnsureFreeSlice).
+            // The first AudioBufferArenaCount buffers come from one locked, pre-faulted arena, so recording
+            // into them never page-faults on the audio thread.
+            int maximumBufferCount = options.MaximumAudioBufferCount > 0 ? options.MaximumAudioBufferCount : MagicConstants::MaximumAudioBufferCount;
+            BufferAllocatorPolicy audioBufferPolicy(
+                options.AudioBufferLengthInFloats > 0
+                    ? options.AudioBufferLengthInFloats
+                    : (int)(info.SampleRateHz * MagicConstants::AudioBufferSizeInSeconds.Value()),
+                options.InitialAudioBufferCount > 0 ? options.InitialAudioBufferCount : MagicConstants::InitialAudioBufferCount,
+                maximumBufferCount,
+                MagicConstants::AudioBufferLowWaterMark,
+                options.AudioBufferGrowthStep > 0 ? options.AudioBufferGrowthStep : MagicConstants::AudioBufferGrowthStep,
+                std::min<int>(MagicConstants::AudioBufferArenaCount, maximumBufferCount),
+                MagicConstants::UseLargeAudioBufferPages,
+                /*lockArenaPages:*/ true);
+
+            _audioAllocator = std::unique_ptr<BufferAllocator<float>>(new BufferAllocator<float>(audioBufferPolicy));
         }
 
         {
-            _fftBinBounds.resize(outputBinCount);
-            Check(_fftBinBounds.capacity() == outputBinCount);
-            Check(_fftBinBounds.size() == outputBinCount);
+            _fftBinBounds.resize(options.OutputBinCount);
+            Check(_fftBinBounds.capacity() == options.OutputBinCount);
+            Check(_fftBinBounds.size() == options.OutputBinCount);
 
-            _fftSize = fftSize;
+            _fftSize = options.FftSize;
 
             // Initialize the bounds of the bins into which we collate FFT data.
             RosettaFFT::MakeBinBounds(
                 _fftBinBounds,
-                centralFrequency,
-                octaveDivisions,
-                outputBinCount,
-                centralBinIndex,
+                options.CentralFrequency,
+                options.OctaveDivisions,
+                options.OutputBinCount,
+                options.CentralBinIndex,
                 _clock->SampleRateHz(),
-                fftSize);
+                options.FftSize);
+
+            Check(options.FftHopSize >= 0);
+            Check(options.FftFramesPerSecond >= 0);
+            int hopSize;
+            if (options.FftFramesPerSecond > 0)
+            {
+                hopSize = std::max<int>(1, (int)std::round(_clock->SampleRateHz() / options.FftFramesPerSecond));
+            }
+            else
+            {
+                hopSize = options.FftHopSize > 0 ? options.FftHopSize : options.FftSize / MagicConstants::FftHopDivisor;
+            }
+
+            Check(options.FftPeakHoldSeconds >= 0);
+            float peakDecay = 0;
+            if (options.FftPeakHoldSeconds > 0)
+            {
+                // decay by a factor of 10 (20 dB) every FftPeakHoldSeconds
+                double hopSeconds = (double)hopSize / _clock->SampleRateHz();
+                peakDecay = (float)std::pow(0.1, hopSeconds / options.FftPeakHoldSeconds);
+            }
+
+            _analysisEngine = std::unique_ptr<AnalysisEngine>(new AnalysisEngine(
+                _fftBinBounds,
+                options.FftSize,
+                hopSize,
+                RosettaFFT::RescaleOptions(options.FftOutputDecibels != 0, peakDecay),
+                MagicConstants::AnalysisWorkerCount));
         }
 
         // Set up the audio processor graph and its related components.
         {
-            _audioProcessorPlayer.setProcessor(_audioProcessorGraph.get());
-            _audioDeviceManager.addAudioCallback(&_audioProcessorPlayer);
+            // call the JUCE method when there is a device, because it returns a higher precision than NowSoundInfo.SampleRate
+            // TODO: consider making NowSoundInfo.SampleRate into a double
+            double sampleRate = _isOffline
+                ? (double)info.SampleRateHz
+                : _audioDeviceManager.getCurrentAudioDevice()->getCurrentSampleRate();
+
+            if (!_isOffline)
+            {
+                _audioProcessorPlayer.setProcessor(_audioProcessorGraph.get());
+                _audioDeviceManager.addAudioCallback(&_audioProcessorPlayer);
+            }
 
             AudioProcessorGraph::AudioGraphIOProcessor* inputAudioProcessor =
                 new AudioProcessorGraph::AudioGraphIOProcessor(AudioProcessorGraph::AudioGraphIOProcessor::IODeviceType::audioInputNode);
@@ -372,17 +534,13 @@ namespace NowSound
             _audioProcessorGraph.get()->setPlayConfigDetails(
                 info.ChannelCount,
                 info.ChannelCount,
-                // call the JUCE method because it returns a higher precision than NowSoundInfo.SampleRate
-                // TODO: consider making NowSoundInfo.SampleRate into a double
-                _audioDeviceManager.getCurrentAudioDevice()->getCurrentSampleRate(),
+                sampleRate,
                 info.SamplesPerQuantum);
 
             // TBD: is double better?  Single (e.g. float32) definitely best for starters though
             _audioProcessorGraph.get()->setProcessingPrecision(AudioProcessor::singlePrecision);
 
-            _audioProcessorGraph.get()->prepareToPlay(
-                _audioDeviceManager.getCurrentAudioDevice()->getCurrentSampleRate(),
-                info.SamplesPerQuantum);
+            _audioProcessorGraph.get()->prepareToPlay(sampleRate, info.SamplesPerQuantum);
 
             _audioInputNodePtr = _audioProcessorGraph.get()->addNode(inputAudioProcessor);
             _audioOutputNodePtr = _audioProcessorGraph.get()->addNode(outputAudioProcessor);
@@ -398,14 +556,22 @@ namespace NowSound
             }
         }
 
-        // and start everything!
-        _audioDeviceManager.getCurrentAudioDevice()->start(&_audioProcessorPlayer);
+        // and start everything!  (An offline graph waits for RenderOffline instead.)
+        if (!_isOffline)
+        {
+            _audioDeviceManager.getCurrentAudioDevice()->start(&_audioProcessorPlayer);
+        }
 
         ChangeState(NowSoundGraphState::GraphRunning);
     }
 
     NowSoundGraphInfo NowSoundGraph::Info()
     {
+        if (_isOffline)
+        {
+            return _offlineInfo;
+        }
+
         // TODO: verify not on audio graph thread
         AudioIODevice* device = _audioDeviceManager.getCurrentAudioDevice();
 
@@ -459,10 +625,10 @@ namespace NowSound
     }
 #endif
 
-    const std::vector<RosettaFFT::FrequencyBinBounds>* NowSoundGraph::BinBounds() const { return &_fftBinBounds; }
-
     int NowSoundGraph::FftSize() const { return _fftSize; }
 
+    AnalysisEngine* NowSoundGraph::Analysis() const { return _analysisEngine.get(); }
+
     ContinuousDuration<Second> NowSoundGraph::PreRecordingDuration() const { return _preRecordingDuration; }
 
     void NowSoundGraph::CreateNowSoundInputForChannel(int channel)
@@ -471,7 +637,6 @@ namespace NowSound
         NowSoundInputAudioProcessor* inputProcessor = new NowSoundInputAudioProcessor(
             this,
             id,
-            _audioAllocator.get(),
             channel);
 
         AddInputNodeToJuceGraph(inputProcessor, channel);
@@ -501,11 +666,29 @@ namespace NowSound
         return timeInfo;
     }
 
+    NowSoundAllocatorInfo NowSoundGraph::AllocatorInfo()
+    {
+        Check(_audioGraphState > NowSoundGraphState::GraphInError);
+
+        return CreateNowSoundAllocatorInfo(
+            _audioAllocator->BufferLength,
+            _audioAllocator->LiveBufferCount(),
+            _audioAllocator->FreeListCount(),
+            _audioAllocator->PeakLiveBufferCount(),
+            _audioAllocator->TotalBufferCount(),
+            _audioAllocator->FailedAllocationCount());
+    }
+
     Tempo* NowSoundGraph::Tempo() const
     {
         return _tempo.get();
     }
 
+    float NowSoundGraph::BeatsPerMinute() const
+    {
+        return _beatsPerMinute.load(std::memory_order_acquire);
+    }
+
     Clock* NowSoundGraph::Clock() const
     {
         return _clock.get();
@@ -514,6 +697,7 @@ namespace NowSound
     void NowSoundGraph::SetTempo(float beatsPerMinute, int beatsPerMeasure)
     {
         _tempo.reset(new NowSound::Tempo(beatsPerMinute, beatsPerMeasure, _clock->SampleRateHz()));
+        _beatsPerMinute.store(_tempo->BeatsPerMinute(), std::memory_order_release);
 
         {
             std::wstringstream wstr{};
@@ -553,21 +737,23 @@ namespace NowSound
         Input(id)->Pan(pan);
     }
 
-    TrackId NowSoundGraph::CreateRecordingTrackAsync(AudioInputId audioInputId)
+    TrackId NowSoundGraph::CreateRecordingTrackAsync(AudioInputId audioInputId, int channelCount)
     {
         // TODO: verify not on audio graph thread
         Check(_audioGraphState == NowSoundGraphState::GraphRunning);
+        Check(channelCount >= 1 && channelCount <= Info().ChannelCount);
+        Check((int)audioInputId - 1 + channelCount <= (int)_audioInputs.size());
 
         // by construction this will be greater than TrackId::Undefined
         TrackId id = (TrackId)((int)_nextTrackId + 1);
         _nextTrackId = id;
 
-        NowSoundTrackAudioProcessor* newTrack = Input(audioInputId)->CreateRecordingTrack(id);
+        NowSoundTrackAudioProcessor* newTrack = Input(audioInputId)->CreateRecordingTrack(id, channelCount);
 
         _tracks.insert(std::pair<TrackId, NowSoundTrackAudioProcessor*>{id, newTrack});
 
         // convert from audio input numbering (1-based) to channel id (0-based)
-        AddRecordingNodeToJuceGraph(newTrack, audioInputId);
+        AddRecordingNodeToJuceGraph(newTrack, audioInputId, channelCount);
 
         return id;
     }
@@ -749,13 +935,24 @@ namespace NowSound
         }
     }
 
-    void NowSoundGraph::AddRecordingNodeToJuceGraph(SpatialAudioProcessor* newProcessor, AudioInputId audioInputId)
+    void NowSoundGraph::AddRecordingNodeToJuceGraph(SpatialAudioProcessor* newProcessor, AudioInputId audioInputId, int channelCount)
     {
         AudioProcessorGraph::NodeID newNodeId = AddNodeToJuceGraph(newProcessor, NodeType::Recording);
 
         // Input connections (one per output channel); consume the *pre-effect* input
-        Check(JuceGraph().addConnection({ { Input(audioInputId)->NodeId(), 0 }, { newNodeId, 0 } }));
-        Check(JuceGraph().addConnection({ { Input(audioInputId)->NodeId(), 1 }, { newNodeId, 1 } }));
+        if (channelCount == 1)
+        {
+            Check(JuceGraph().addConnection({ { Input(audioInputId)->NodeId(), 0 }, { newNodeId, 0 } }));
+            Check(JuceGraph().addConnection({ { Input(audioInputId)->NodeId(), 1 }, { newNodeId, 1 } }));
+        }
+        else
+        {
+            // each recorded input into its own channel
+            for (int i = 0; i < channelCount; i++)
+            {
+                Check(JuceGraph().addConnection({ { Input((AudioInputId)(audioInputId + i))->NodeId(), 0 }, { newNodeId, i } }));
+            }
+        }
 
         {
             std::wstringstream wstr{};
@@ -933,6 +1130,101 @@ namespace NowSound
         outputMixProcessor->StopRecording();
     }
 
+    float NowSoundGraph::RenderOffline(LPWSTR inputFileName, LPWSTR outputFileName, float durationSeconds)
+    {
+        Check(_isOffline);
+        Check(State() == NowSoundGraphState::GraphRunning);
+        Check(durationSeconds > 0);
+
+        NowSoundGraphInfo info = Info();
+
+        // The input, if any; read in blocks as the render goes.
+        std::unique_ptr<AudioFormatReader> reader{};
+        String inputName{ inputFileName };
+        if (inputName.isNotEmpty())
+        {
+            AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+            reader.reset(formatManager.createReaderFor(File{ inputName }));
+            if (reader.get() == nullptr)
+            {
+                Log(L"RenderOffline(): could not read input file");
+                return 0;
+            }
+        }
+
+        // The output; written directly from this thread, since there is no audio thread to keep clear of disk I/O.
+        File outputFile{ String{ outputFileName } };
+        outputFile.deleteFile();
+        std::unique_ptr<AudioFormatWriter> writer{};
+        if (auto fileStream = std::unique_ptr<FileOutputStream>(outputFile.createOutputStream()))
+        {
+            WavAudioFormat wavFormat;
+            writer.reset(wavFormat.createWriterFor(fileStream.get(), info.SampleRateHz, info.ChannelCount, 32, {}, 0));
+            if (writer.get() != nullptr)
+            {
+                fileStream.release(); // (the writer now owns the stream)
+            }
+        }
+        if (writer.get() == nullptr)
+        {
+            Log(L"RenderOffline(): could not write output file");
+            return 0;
+        }
+
+        int64_t sampleCount = _clock->TimeToRoundedUpSamples(durationSeconds).Value();
+        AudioBuffer<float> audioBuffer(info.ChannelCount, info.SamplesPerQuantum);
+        MidiBuffer midiBuffer{};
+        double tonePhase = 0;
+        double tonePhaseIncrement = MathConstants<double>::twoPi * MagicConstants::OfflineTestToneHz / info.SampleRateHz;
+
+        auto renderStart = steady_clock::now();
+
+        for (int64_t samplesRendered = 0; samplesRendered < sampleCount;)
+        {
+            int blockSize = (int)std::min<int64_t>(info.SamplesPerQuantum, sampleCount - samplesRendered);
+            audioBuffer.setSize(info.ChannelCount, blockSize, /*keepExistingContent*/ false, /*clearExtraSpace*/ false, /*avoidReallocating*/ true);
+
+            // Fill the device input channels, just as a device callback would.
+            if (reader.get() != nullptr)
+            {
+                // past the end of the file, this reads silence
+                reader->read(&audioBuffer, 0, blockSize, samplesRendered, true, true);
+            }
+            else
+            {
+                float* channel0 = audioBuffer.getWritePointer(0);
+                for (int i = 0; i < blockSize; i++)
+                {
+                    channel0[i] = MagicConstants::OfflineTestToneLevel * (float)std::sin(tonePhase);
+                    tonePhase += tonePhaseIncrement;
+                }
+                tonePhase = std::fmod(tonePhase, MathConstants<double>::twoPi);
+                for (int channel = 1; channel < info.ChannelCount; channel++)
+                {
+                    audioBuffer.copyFrom(channel, 0, audioBuffer, 0, 0, blockSize);
+                }
+            }
+
+            // Process the graph in place, under the same lock the AudioProcessorPlayer would hold.
+            {
+                const ScopedLock callbackLock(_audioProcessorGraph->getCallbackLock());
+                _clock->BeginAudioBlock();
+                _audioProcessorGraph->processBlock(audioBuffer, midiBuffer);
+            }
+            midiBuffer.clear();
+
+            writer->writeFromAudioSampleBuffer(audioBuffer, 0, blockSize);
+            samplesRendered += blockSize;
+        }
+
+        // flush the file before timing, so the speed reflects the finished bounce
+        writer.reset();
+
+        double renderSeconds = std::chrono::duration<double>(steady_clock::now() - renderStart).count();
+        return (float)(durationSeconds / std::max(renderSeconds, 1e-9));
+    }
+
     void NowSoundGraph::ShutdownInstance()
     {
         // SHUT. DOWN. EVERYTHING
@@ -953,7 +1245,13 @@ namespace NowSound
         // break stream teardown)
         _audioProcessorGraph.get()->clear();
 
+        // all the frequency trackers are gone with the graph, so the analysis engine can stop
+        _analysisEngine.reset();
+
         // and in fact, drop it now, so by the time we get to destructor, it has completed its shutdown
         _audioProcessorGraph.release();
+
+        // nothing is processing audio any more, so the last events are in
+        _eventLog.StopFormatting();
     }
 }
@@ -5,14 +5,18 @@
 
 #include "stdafx.h"
 
+#include <atomic>
 #include <future>
 #include <vector>
 
 #include "stdint.h"
 
+#include "AnalysisEngine.h"
+#include "AudioTiming.h"
 #include "BufferAllocator.h"
 #include "Check.h"
 #include "Clock.h"
+#include "EventLog.h"
 #include "Histogram.h"
 #include "NowSoundLibTypes.h"
 #include "rosetta_fft.h"
@@ -63,14 +67,18 @@ namespace NowSound
     public: // API methods called by the NowSoundGraphAPI P/Invoke bridge methods
 
         // Initialize the audio graph subsystem.
+        // The audio buffer pool options may each be 0 to use the MagicConstants default; a buffer length of 0
+        // means AudioBufferSizeInSeconds times the device's sample rate in floats (so half that long for stereo).
+        // FFT frames start every FftHopSize samples (0 = FftSize / FftHopDivisor), unless FftFramesPerSecond is
+        // nonzero, in which case the hop is chosen to produce that many frames per second (e.g. the UI frame rate).
+        // The frequency bins are in decibels if FftOutputDecibels, and hold their peaks (decaying by 20 dB every
+        // FftPeakHoldSeconds) if FftPeakHoldSeconds is nonzero.
+        // The graph runs on the given kind of audio device.  The software devices (null, loopback and offline) run
+        // stereo at SoftwareSampleRateHz in blocks of SoftwareSamplesPerQuantum; the loopback device reads its inputs
+        // from the '|'-separated loopbackFileNames; and an offline graph opens no device at all, and only processes
+        // audio when RenderOffline is called.
         // Graph must be Uninitialized.  On completion, graph becomes Initialized.
-        void Initialize(
-            int outputBinCount,
-            float centralFrequency,
-            int octaveDivisions,
-            int centralBinIndex,
-            int fftSize,
-            float preRecordingDuration);
+        void Initialize(const NowSoundGraphOptions& options, LPWSTR loopbackFileNames);
 
         // Get the current state of the audio graph; intended to be efficiently pollable by the client.
         // This is one of the only two methods that may be called in any state whatoever.
@@ -102,6 +110,10 @@ namespace NowSound
         // Graph must be Created or Running.
         NowSoundTimeInfo TimeInfo();
 
+        // Statistics about the audio buffer allocator.
+        // Graph must be at least Initialized.
+        NowSoundAllocatorInfo AllocatorInfo();
+
         // Set the tempo of the graph (really the tempo of currently recorded inputs).
         void SetTempo(float beatsPerMinute, int beatsPerMeasure);
 
@@ -114,12 +126,27 @@ namespace NowSound
         // Drop all messages up to (and including) the given log message index.
         void DropLogMessages(int32_t messageCountToDrop);
 
+        // The number of nodes whose processing times are recorded: every NowSound processor ever created in this
+        // graph, in creation order (so a node's index never changes, and removed nodes keep their final timings).
+        int32_t NodeTimingCount();
+
+        // Statistics about the processing time of the node with the given index.
+        NowSoundNodeTimingInfo NodeTimingInfo(int32_t nodeIndex);
+
+        // The name of the node with the given index.
+        void NodeTimingName(int32_t nodeIndex, LPWSTR buffer, int32_t bufferCapacity);
+
+        // Statistics about the time spent in audio device callbacks, against the time available.
+        // (RenderOffline bypasses the device, so its blocks are counted only in the node timings.)
+        NowSoundCallbackTimingInfo CallbackTimingInfo();
+
         // Log the current connections in the graph
         void LogConnections();
 
-        // Create a new track and begin recording.
+        // Create a new track and begin recording, with one channel from each of channelCount consecutive inputs
+        // starting at inputIndex.
         // Graph may be in any state other than InError. On completion, graph becomes Uninitialized.
-        TrackId CreateRecordingTrackAsync(AudioInputId inputIndex);
+        TrackId CreateRecordingTrackAsync(AudioInputId inputIndex, int channelCount);
 
         // Create a copy of a track that has finished recording and started looping; the copy will be at the
         // exact same loop position.
@@ -138,6 +165,14 @@ namespace NowSound
         // Stop recording and close the file; if not recording, this is ignored.
         void StopRecording();
 
+        // Run the whole graph for durationSeconds of audio as fast as possible, feeding its inputs from the
+        // given audio file (or from a test tone if inputFileName is empty), and writing the output mix to
+        // outputFileName (WAV format).  Track recording, looping, plugins and analysis all behave as they would
+        // live, and the clock advances by the rendered duration.
+        // Returns how many times faster than real time the render ran, or 0 if either file could not be opened.
+        // Graph must be Running, and must have been initialized with AudioDeviceOffline.
+        float RenderOffline(LPWSTR inputFileName, LPWSTR outputFileName, float durationSeconds);
+
         // Get the pan value of this input (0 = left; 0.5 = center; 1 = right)
         float InputPan(AudioInputId id);
 
@@ -210,6 +245,10 @@ namespace NowSound
         // The current Tempo.
         std::unique_ptr<NowSound::Tempo> _tempo;
 
+        // The current tempo's beats per minute; unlike _tempo, this may be read from the audio thread while the
+        // tempo is being set.
+        std::atomic<float> _beatsPerMinute;
+
         // Log messages.
         // Note that this vector is always allocated to a fixed capacity so we don't get vector resizes while appending.
         std::vector<std::wstring> _logMessages;
@@ -217,12 +256,35 @@ namespace NowSound
         // The mutex used when updating log state variables.
         std::mutex _logMutex;
 
+        // The log for the audio thread (and any other thread that must not block), formatted into _logMessages
+        // by a background thread.
+        EventLog _eventLog;
+
+        // Format for logging input a track dropped because the audio buffer pool was exhausted.
+        const int _droppedInputFormat;
+
+        // Format for a processor's processBlock debugging message; shared by all processors, since formats are never
+        // freed and processors come and go.
+        const int _processBlockFormat;
+
+        // The processing times of every live NowSound processor, in creation order.
+        std::vector<std::unique_ptr<NodeTiming>> _nodeTimings;
+
+        // The mutex guarding the _nodeTimings vector (but not the timings themselves, which are lock-free).
+        std::mutex _nodeTimingMutex;
+
         // The AudioDeviceManager held by this Graph.
         // This is conceptually a singleton (just as the NowSoundGraph is), but we scope it within this type.
         juce::AudioDeviceManager _audioDeviceManager;
 
-        // Callback object which couples the device manager to the audio processor graph.
-        juce::AudioProcessorPlayer _audioProcessorPlayer;
+        // True if this graph has no audio device, and is driven only by RenderOffline.
+        bool _isOffline;
+
+        // The info of an offline graph, which has no device to query.
+        NowSoundGraphInfo _offlineInfo;
+
+        // Callback object which couples the device manager to the audio processor graph, and times each callback.
+        TimedAudioProcessorPlayer _audioProcessorPlayer;
 
         // The audio processor graph. Held via unique ptr so it can be dropped explicitly.
         std::unique_ptr<juce::AudioProcessorGraph> _audioProcessorGraph;
@@ -265,6 +327,9 @@ namespace NowSound
         // The FFT size.
         int _fftSize;
 
+        // The frequency analysis shared by all frequency trackers.
+        std::unique_ptr<AnalysisEngine> _analysisEngine;
+
         // The amount of time to "pre-record" as latency compensation.
         ContinuousDuration<Second> _preRecordingDuration;
 
@@ -313,6 +378,9 @@ namespace NowSound
         // The current graph-wide Tempo (for inputs)
         Tempo* Tempo() const;
 
+        // The current graph-wide tempo in beats per minute; safe to call from the audio thread.
+        float BeatsPerMinute() const;
+
         // The graph-wide Clock.
         Clock* Clock() const;
 
@@ -331,18 +399,30 @@ namespace NowSound
         static NowSoundGraph* Instance();
 
         // Create the singleton graph instance and initialize it.
-        static void InitializeInstance(
-            int outputBinCount,
-            float centralFrequency,
-            int octaveDivisions,
-            int centralBinIndex,
-            int fftSize,
-            float preRecordingDuration);
+        static void InitializeInstance(const NowSoundGraphOptions& options, LPWSTR loopbackFileNames);
 
         // Record this log message.
         // These messages can be queried via the external NowSoundGraphAPI, for scenarios when native debugging is
         // inaccessible (such as VS2019 debugging Unity with the Mono runtime).
         void Log(const std::wstring& str);
+
+        // The log for code that must not block or allocate, such as ProcessBlock methods; its events end up
+        // alongside those from Log.
+        EventLog& Events();
+
+        // Format ID for logging input dropped for lack of audio buffers: track ID, samples dropped, and the
+        // allocator's failed allocation count.
+        int DroppedInputFormat() const;
+
+        // Format ID for a processor's processBlock debugging message: its JUCE node ID and its log counter.
+        int ProcessBlockFormat() const;
+
+        // Allocate the record of a new node's processing times; the graph owns it until the node unregisters it.
+        NodeTiming* RegisterNodeTiming(const std::wstring& name);
+
+        // Drop the record of a deleted node's processing times; the node must not be processing any more.
+        // Node timing indices past this one shift down by one.
+        void UnregisterNodeTiming(NodeTiming* timing);
         
         // Audio allocator has static lifetime currently, but we give borrowed pointers rather than just statically
         // referencing it everywhere, because all this mutable static state continues to be concerning.
@@ -351,12 +431,12 @@ namespace NowSound
         // Create a NowSoundInputAudioProcessor for the specified channel.
         void CreateNowSoundInputForChannel(int channel);
 
-        // Access the vector of frequency bins, when generating frequency histograms.
-        const std::vector<RosettaFFT::FrequencyBinBounds>* BinBounds() const;
-
         // Access to the FFT size.
         int FftSize() const;
 
+        // The frequency analysis shared by all frequency trackers; null if there is no FFT.
+        AnalysisEngine* Analysis() const;
+
         // The amount of time to "pre-record" by, as latency compensation
         ContinuousDuration<Second> PreRecordingDuration() const;
 
@@ -374,9 +454,10 @@ namespace NowSound
         // This sets up one input connection and two output connections.
         void AddInputNodeToJuceGraph(SpatialAudioProcessor* newSpatialNode, int inputChannel);
 
-        // Add the connections of a SpatialAudioProcessor node consuming (not spatializing) a two-channel input.
+        // Add the connections of a SpatialAudioProcessor node consuming (not spatializing) a two-channel input,
+        // or, if channelCount is 2, channel 0 of each of two consecutive inputs.
         // This sets up two input connections and two output connections.
-        void AddRecordingNodeToJuceGraph(SpatialAudioProcessor* newSpatialNode, AudioInputId audioInputId);
+        void AddRecordingNodeToJuceGraph(SpatialAudioProcessor* newSpatialNode, AudioInputId audioInputId, int channelCount);
 
         // Construct a stereo AudioProcessor for the given plugin and program.
         // The returned reference is unowned and raw; this needs to be added to the JUCE AudioProcessorGraph immediately.
@@ -24,18 +24,18 @@ namespace NowSound
     NowSoundInputAudioProcessor::NowSoundInputAudioProcessor(
         NowSoundGraph* nowSoundGraph,
         AudioInputId inputId,
-        BufferAllocator<float>* audioAllocator,
         int channel)
-        : SpatialAudioProcessor(nowSoundGraph, MakeName(L"Input ", (int)inputId), /*isMuted*/false, /*initialVolume*/1.0, /*initialPan*/0.5),
+        : SpatialAudioProcessor(nowSoundGraph, MakeName(L"Input ", (int)inputId), /*channelCount*/1, /*isMuted*/false, /*initialVolume*/1.0, /*initialPan*/0.5),
         _audioInputId{ inputId },
         _channel{ channel },
         _incomingAudioStream {
             /*channelCount*/1,
-            audioAllocator,
-            /*maxBufferedLength*/(int)(nowSoundGraph->Clock()->SampleRateHz() * nowSoundGraph->PreRecordingDuration().Value()) * 2
+            /*minimumCapacity*/(int)(nowSoundGraph->Clock()->SampleRateHz() * nowSoundGraph->PreRecordingDuration().Value()) * 2
         },
-        _rawInputHistogram{ new Histogram((int)nowSoundGraph->Clock()->TimeToRoundedUpSamples(MagicConstants::RecentVolumeDuration).Value()) },
-        _mutex{}
+        _rawInputHistogram{ new Histogram(
+            (int)nowSoundGraph->Clock()->TimeToRoundedUpSamples(MagicConstants::RecentVolumeDuration).Value(),
+            nowSoundGraph->Info().SamplesPerQuantum) },
+        _signalInfo{ CreateNowSoundSignalInfo(0, 0, 0) }
     {
     }
 
@@ -47,13 +47,20 @@ namespace NowSound
         return ret;
     }
 
-    NowSoundTrackAudioProcessor* NowSoundInputAudioProcessor::CreateRecordingTrack(TrackId id)
+    NowSoundTrackAudioProcessor* NowSoundInputAudioProcessor::CreateRecordingTrack(TrackId id, int channelCount)
     {
+        // prerecord from every input the track records
+        std::vector<const DenseSliceStream<AudioSample, float>*> sourceStreams;
+        for (int i = 0; i < channelCount; i++)
+        {
+            sourceStreams.push_back(&Graph()->Input((AudioInputId)(_audioInputId + i))->_incomingAudioStream);
+        }
+
         NowSoundTrackAudioProcessor* track = new NowSoundTrackAudioProcessor(
             Graph(),
             id,
             _audioInputId,
-            _incomingAudioStream,
+            sourceStreams,
             Volume(),
             Pan(),
             this->Graph()->Tempo()->BeatsPerMinute(),
@@ -64,20 +71,14 @@ namespace NowSound
 
     NowSoundSignalInfo NowSoundInputAudioProcessor::RawSignalInfo()
     {
-        std::lock_guard<std::mutex> guard(_mutex);
-        float min = _rawInputHistogram->Min();
-        float max = _rawInputHistogram->Max();
-        float avg = _rawInputHistogram->Average();
-        return CreateNowSoundSignalInfo(min, max, avg);
+        return _signalInfo.Read();
     }
 
-    void NowSoundInputAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
+    void NowSoundInputAudioProcessor::ProcessBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
     {
         // temporary debugging code: see if processBlock is ever being called under Holofunk
         if (CheckLogThrottle()) {
-            std::wstringstream wstr{};
-            wstr << getName() << L"::processBlock: count " << NextCounter();
-            NowSoundGraph::Instance()->Log(wstr.str());
+            Graph()->Events().Log(Graph()->ProcessBlockFormat(), NodeId().uid, NextCounter());
         }
 
         // HACK!!!  If this is the zeroth input, then update the audio graph time.
@@ -94,14 +95,13 @@ namespace NowSound
         const float* buffer = audioBuffer.getReadPointer(0);
 
         // update raw input data because need ALL THE SIGNAL DATA
-        for (int i = 0; i < audioBuffer.getNumSamples(); i++)
-        {
-            _rawInputHistogram->Add(std::abs(buffer[i]));
-        }
+        _rawInputHistogram->AddAll(buffer, audioBuffer.getNumSamples(), /*absoluteValue:*/true);
+        _signalInfo.WriteBuffer() = CreateNowSoundSignalInfo(_rawInputHistogram->Min(), _rawInputHistogram->Max(), _rawInputHistogram->Average());
+        _signalInfo.Publish();
 
         _incomingAudioStream.Append(audioBuffer.getNumSamples(), buffer);
 
         // now process the input audio spatially so we hear it panned in the output
-        SpatialAudioProcessor::processBlock(audioBuffer, midiBuffer);
+        SpatialAudioProcessor::ProcessBlock(audioBuffer, midiBuffer);
     }
 }
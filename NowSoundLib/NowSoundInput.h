@@ -14,8 +14,10 @@
 #include "Histogram.h"
 #include "NowSoundLibTypes.h"
 #include "Option.h"
+#include "RingSliceStream.h"
 #include "SliceStream.h"
 #include "SpatialAudioProcessor.h"
+#include "TripleBuffer.h"
 
 #include "JuceHeader.h"
 
@@ -37,35 +39,37 @@ namespace NowSound
         // (Not really clear why latency compensation should be needed for NowSoundApp which shouldn't really
         // have any problematic latency... but this was needed for gesture latency compensation with Kinect,
         // so let's at least experiment with it.)
-        BufferedSliceStream<AudioSample, float> _incomingAudioStream;
+        // This is a fixed ring, so the audio thread never allocates or trims while appending to it.
+        RingSliceStream<AudioSample, float> _incomingAudioStream;
 
-        // Volume histogram for recording the raw input volume.
+        // Volume histogram for recording the raw input volume; touched only by the audio thread.
         std::unique_ptr<Histogram> _rawInputHistogram;
 
-        // Mutex to use when returning or updating signal info; to prevent racing between data access and update.
-        std::mutex _mutex;
+        // The latest raw input volume statistics, published by the audio thread after every block.
+        TripleBuffer<NowSoundSignalInfo> _signalInfo;
 
     public:
         // Construct a NowSoundInput.
         NowSoundInputAudioProcessor(
             NowSoundGraph* audioGraph,
             AudioInputId audioInputId,
-            BufferAllocator<float>* audioAllocator,
             int channel);
 
         // Process input audio by recording it into the (bounded) incomingAudioStream.
-        virtual void processBlock(juce::AudioBuffer<float>& audioBuffer, juce::MidiBuffer& midiBuffer);
+        virtual void ProcessBlock(juce::AudioBuffer<float>& audioBuffer, juce::MidiBuffer& midiBuffer) override;
         
         // Get information about this input.
         NowSoundSpatialParameters SpatialParameters();
 
         // Get the raw signal info for the mono source of this input.
+        // Wait-free; must only be called from one thread (the UI thread).
         NowSoundSignalInfo RawSignalInfo();
 
-        // Create a recording track monitoring this input.
+        // Create a recording track monitoring this input, and (if channelCount is more than 1) the inputs after it,
+        // one per channel.
         // Note that this is not concurrency-safe with respect to other calls to this method.
         // (It is of course concurrency-safe with respect to ongoing audio activity.)
         // Returns a reference to the newly created Node which holds the new TrackAudioProcessor instance.
-        NowSoundTrackAudioProcessor* CreateRecordingTrack(TrackId id);
+        NowSoundTrackAudioProcessor* CreateRecordingTrack(TrackId id, int channelCount);
     };
 }
@@ -46,22 +46,10 @@ namespace NowSound
         }
     }
 
-    void NowSoundGraph_InitializeInstance(
-        int outputBinCount,
-        float centralFrequency,
-        int octaveDivisions,
-        int centralBinIndex,
-        int fftSize,
-        float preRecordingDuration)
+    void NowSoundGraph_InitializeInstance(NowSoundGraphOptions options, LPWSTR loopbackFileNames)
     {
         Check(NowSoundGraph_State() == NowSoundGraphState::GraphUninitialized);
-        NowSoundGraph::InitializeInstance(
-            outputBinCount,
-            centralFrequency,
-            octaveDivisions,
-            centralBinIndex,
-            fftSize,
-            preRecordingDuration);
+        NowSoundGraph::InitializeInstance(options, loopbackFileNames);
     }
 
     NowSoundGraphInfo NowSoundGraph_Info()
@@ -159,6 +147,12 @@ namespace NowSound
         NowSoundGraph::Instance()->InputPan(audioInputId, pan);
     }
 
+    bool NowSoundGraph_ScheduleInputPan(AudioInputId audioInputId, int64_t timeInSamples, float pan)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->Input(audioInputId)->SchedulePan(timeInSamples, pan);
+    }
+
 #ifdef INPUT_DEVICE_SELECTION // JUCETODO
     void NowSoundGraph_InputDeviceId(int deviceIndex, LPWSTR wcharBuffer, int bufferCapacity)
     {
@@ -188,6 +182,42 @@ namespace NowSound
         }
     }
 
+    NowSoundAllocatorInfo NowSoundGraph_AllocatorInfo()
+    {
+        if (NowSoundGraph::Instance() != nullptr)
+        {
+            return NowSoundGraph::Instance()->AllocatorInfo();
+        }
+        else
+        {
+            return NowSoundAllocatorInfo{};
+        }
+    }
+
+    int32_t NowSoundGraph_NodeTimingCount()
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->NodeTimingCount();
+    }
+
+    NowSoundNodeTimingInfo NowSoundGraph_NodeTimingInfo(int32_t nodeIndex)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->NodeTimingInfo(nodeIndex);
+    }
+
+    void NowSoundGraph_NodeTimingName(int32_t nodeIndex, LPWSTR wcharBuffer, int32_t bufferCapacity)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        NowSoundGraph::Instance()->NodeTimingName(nodeIndex, wcharBuffer, bufferCapacity);
+    }
+
+    NowSoundCallbackTimingInfo NowSoundGraph_CallbackTimingInfo()
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->CallbackTimingInfo();
+    }
+
     void NowSoundGraph_SetTempo(float beatsPerMinute, int beatsPerMeasure)
     {
         Check(NowSoundGraph::Instance() != nullptr);
@@ -200,6 +230,12 @@ namespace NowSound
         NowSoundGraph::Instance()->Input(audioInputId)->GetFrequencies(floatBuffer, floatBufferCapacity);
     }
 
+    void NowSoundGraph_SetInputFrequencyAnalysisEnabled(AudioInputId audioInputId, bool isEnabled)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        NowSoundGraph::Instance()->Input(audioInputId)->SetFrequencyAnalysisEnabled(isEnabled);
+    }
+
     NowSoundSpatialParameters NowSoundGraph_SpatialParameters(AudioInputId audioInputId)
     {
         return NowSoundGraph::Instance()->Input(audioInputId)->SpatialParameters();
@@ -208,7 +244,13 @@ namespace NowSound
     TrackId NowSoundGraph_CreateRecordingTrackAsync(AudioInputId audioInputId)
     {
         Check(NowSoundGraph::Instance() != nullptr);
-        return NowSoundGraph::Instance()->CreateRecordingTrackAsync(audioInputId);
+        return NowSoundGraph::Instance()->CreateRecordingTrackAsync(audioInputId, 1);
+    }
+
+    TrackId NowSoundGraph_CreateMultichannelRecordingTrackAsync(AudioInputId audioInputId, int32_t channelCount)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->CreateRecordingTrackAsync(audioInputId, channelCount);
     }
 
     TrackId NowSoundGraph_CopyLoopingTrack(TrackId trackId)
@@ -241,6 +283,12 @@ namespace NowSound
         NowSoundGraph::Instance()->StopRecording();
     }
 
+    float NowSoundGraph_RenderOffline(LPWSTR inputFileName, LPWSTR outputFileName, float durationSeconds)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->RenderOffline(inputFileName, outputFileName, durationSeconds);
+    }
+
     // Plugin searching requires setting paths to search.
     // TODO: make this use the idiom for passing in strings rather than StringBuilders.
     void NowSoundGraph_AddPluginSearchPath(LPWSTR wcharBuffer, int32_t bufferCapacity)
@@ -311,6 +359,12 @@ namespace NowSound
         NowSoundGraph::Instance()->Input(audioInputId)->SetPluginInstanceDryWet(pluginInstanceIndex, dryWet_0_100);
     }
 
+    bool NowSoundGraph_ScheduleInputPluginInstanceDryWet(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex, int64_t timeInSamples, int32_t dryWet_0_100)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->Input(audioInputId)->SchedulePluginInstanceDryWet(pluginInstanceIndex, timeInSamples, dryWet_0_100);
+    }
+
     void NowSoundGraph_DeleteInputPluginInstance(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex)
     {
         Check(NowSoundGraph::Instance() != nullptr);
@@ -340,7 +394,8 @@ namespace NowSound
             (float)6,
             (float)7,
             (float)8,
-            9);
+            9,
+            10);
     }
 
     NowSoundTrackState NowSoundTrack_State(TrackId trackId)
@@ -397,6 +452,36 @@ namespace NowSound
         NowSoundGraph::Instance()->Track(trackId)->Rewind();
     }
 
+    void NowSoundTrack_SetTempoMode(TrackId trackId, NowSoundTrackTempoMode tempoMode)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        NowSoundGraph::Instance()->Track(trackId)->SetTempoMode(tempoMode);
+    }
+
+    TrackVoiceId NowSoundTrack_AddVoice(TrackId trackId, float offsetBeats, bool isPlaybackBackwards, float volume, float pan)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->Track(trackId)->AddVoice(ContinuousDuration<Beat>(offsetBeats), isPlaybackBackwards, volume, pan);
+    }
+
+    void NowSoundTrack_SetVoiceVolume(TrackId trackId, TrackVoiceId voiceId, float volume)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        NowSoundGraph::Instance()->Track(trackId)->SetVoiceVolume(voiceId, volume);
+    }
+
+    void NowSoundTrack_SetVoicePan(TrackId trackId, TrackVoiceId voiceId, float pan)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        NowSoundGraph::Instance()->Track(trackId)->SetVoicePan(voiceId, pan);
+    }
+
+    void NowSoundTrack_DeleteVoice(TrackId trackId, TrackVoiceId voiceId)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        NowSoundGraph::Instance()->Track(trackId)->DeleteVoice(voiceId);
+    }
+
     void NowSoundTrack_GetFrequencies(TrackId trackId, void* floatBuffer, int32_t floatBufferCapacity)
     {
         Check(NowSoundGraph::Instance() != nullptr);
@@ -410,6 +495,19 @@ namespace NowSound
         }
     }
 
+    void NowSoundTrack_SetFrequencyAnalysisEnabled(TrackId trackId, bool isEnabled)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        if (NowSoundGraph::Instance()->TrackIsDefined(trackId))
+        {
+            NowSoundGraph::Instance()->Track(trackId)->SetFrequencyAnalysisEnabled(isEnabled);
+        }
+        else
+        {
+            NowSoundGraph::Instance()->Log(L"Track ID *WAS NOT DEFINED* in NowSoundTrack_SetFrequencyAnalysisEnabled");
+        }
+    }
+
     bool NowSoundTrack_IsMuted(TrackId trackId)
     {
         Check(NowSoundGraph::Instance() != nullptr);
@@ -446,6 +544,18 @@ namespace NowSound
         NowSoundGraph::Instance()->Track(trackId)->Volume(volume);
     }
 
+    bool NowSoundTrack_SchedulePan(TrackId trackId, int64_t timeInSamples, float pan)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->Track(trackId)->SchedulePan(timeInSamples, pan);
+    }
+
+    bool NowSoundTrack_ScheduleVolume(TrackId trackId, int64_t timeInSamples, float volume)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->Track(trackId)->ScheduleVolume(timeInSamples, volume);
+    }
+
     PluginInstanceIndex NowSoundTrack_AddPluginInstance(TrackId trackId, PluginId pluginId, ProgramId programId, int32_t dryWet_0_100)
     {
         Check(NowSoundGraph::Instance() != nullptr);
@@ -470,6 +580,12 @@ namespace NowSound
         NowSoundGraph::Instance()->Track(trackId)->SetPluginInstanceDryWet(PluginInstanceIndex, dryWet_0_100);
     }
 
+    bool NowSoundTrack_SchedulePluginInstanceDryWet(TrackId trackId, PluginInstanceIndex PluginInstanceIndex, int64_t timeInSamples, int32_t dryWet_0_100)
+    {
+        Check(NowSoundGraph::Instance() != nullptr);
+        return NowSoundGraph::Instance()->Track(trackId)->SchedulePluginInstanceDryWet(PluginInstanceIndex, timeInSamples, dryWet_0_100);
+    }
+
     void NowSoundTrack_DeletePluginInstance(TrackId trackId, PluginInstanceIndex PluginInstanceIndex)
     {
         Check(NowSoundGraph::Instance() != nullptr);
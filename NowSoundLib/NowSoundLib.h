@@ -57,20 +57,10 @@ namespace NowSound
         __declspec(dllexport) void NowSoundGraph_LogConnections();
 
         // Initialize the audio graph subsystem such that device information can be queried.
+        // The loopback device reads its inputs from the '|'-separated loopbackFileNames (ignored for other devices);
+        // they are passed separately to keep the options struct blittable.
         // Graph must be Uninitialized.  On completion, graph becomes Initialized.
-        __declspec(dllexport) void NowSoundGraph_InitializeInstance(
-            // How many output bins in the (logarithmic) frequency histogram?
-            int outputBinCount,
-            // What central frequency to use for the histogram?
-            float centralFrequency,
-            // How many divisions to make in each octave?
-            int octaveDivisions,
-            // Which bin index should be centered on centralFrequency?
-            int centralBinIndex,
-            // How many samples as input to and output from the FFT?
-            int fftSize,
-            // How many seconds to pre-record, as latency compensation?
-            float preRecordingDuration);
+        __declspec(dllexport) void NowSoundGraph_InitializeInstance(NowSoundGraphOptions options, LPWSTR loopbackFileNames);
 
         // Get the info for the created graph.
         // Graph must be at least Created.
@@ -91,6 +81,10 @@ namespace NowSound
         // Get the current info for the post-effects signal from the given input.
         __declspec(dllexport) void NowSoundGraph_SetInputPan(AudioInputId audioInputId, float volume);
 
+        // Start moving the input's pan to the given value at exactly the given audio time (as in NowSoundTimeInfo).
+        // Changes must be scheduled in time order; returns false if too many are already waiting.
+        __declspec(dllexport) bool NowSoundGraph_ScheduleInputPan(AudioInputId audioInputId, int64_t timeInSamples, float pan);
+
         // Get the ID of the given device.
         // Graph must be at least Initialized.
         // JUCETODO: __declspec(dllexport) void NowSoundGraph_InputDeviceId(int deviceIndex, LPWSTR wcharBuffer, int bufferCapacity);
@@ -108,6 +102,28 @@ namespace NowSound
         // Graph must be at least Created; time will not be running until the graph is Running.
         __declspec(dllexport) NowSoundTimeInfo NowSoundGraph_TimeInfo();
 
+        // Get statistics about the audio buffer allocator (live, free and peak buffer counts).
+        // Graph must be at least Initialized.
+        __declspec(dllexport) NowSoundAllocatorInfo NowSoundGraph_AllocatorInfo();
+
+        // Get the number of nodes whose processing times are recorded (every live NowSound processor in the graph,
+        // in creation order; deleting a node shifts the indices of the nodes created after it down by one).
+        // Graph must be at least Initialized.
+        __declspec(dllexport) int32_t NowSoundGraph_NodeTimingCount();
+
+        // Get the processing time statistics of the given node (from 0 to NowSoundGraph_NodeTimingCount()-1).
+        // Graph must be at least Initialized.
+        __declspec(dllexport) NowSoundNodeTimingInfo NowSoundGraph_NodeTimingInfo(int32_t nodeIndex);
+
+        // Get the name of the given node.
+        // Graph must be at least Initialized.
+        __declspec(dllexport) void NowSoundGraph_NodeTimingName(int32_t nodeIndex, LPWSTR wcharBuffer, int32_t bufferCapacity);
+
+        // Get statistics about the time spent in each audio device callback, against the time available, along
+        // with the number of callbacks that overran and the number of blocks lost.
+        // Graph must be at least Initialized.
+        __declspec(dllexport) NowSoundCallbackTimingInfo NowSoundGraph_CallbackTimingInfo();
+
         // Set the tempo. Affects any newly recorded tracks; current tracks keep their tempo. Buyer beware!
         __declspec(dllexport) void NowSoundGraph_SetTempo(float beatsPerMinute, int beatsPerMeasure);
 
@@ -117,9 +133,17 @@ namespace NowSound
         // "pass in StringBuilder", known to work well).
         __declspec(dllexport) void NowSoundGraph_GetInputFrequencies(AudioInputId audioInputId, void* floatBuffer, int32_t floatBufferCapacity);
 
+        // Start or stop frequency analysis of this input (enabled by default); while stopped, the input costs no
+        // analysis time, and NowSoundGraph_GetInputFrequencies keeps returning the last histogram.
+        __declspec(dllexport) void NowSoundGraph_SetInputFrequencyAnalysisEnabled(AudioInputId audioInputId, bool isEnabled);
+
         // Create a new track and begin recording.
         __declspec(dllexport) TrackId NowSoundGraph_CreateRecordingTrackAsync(AudioInputId audioInputId);
 
+        // Create a new multichannel (currently at most stereo) track and begin recording, with one channel from
+        // each of channelCount consecutive inputs starting at audioInputId.
+        __declspec(dllexport) TrackId NowSoundGraph_CreateMultichannelRecordingTrackAsync(AudioInputId audioInputId, int32_t channelCount);
+
         // Copy a currently looping track to a new track.
         __declspec(dllexport) TrackId NowSoundGraph_CopyLoopingTrack(TrackId copiedTrackId);
 
@@ -136,6 +160,12 @@ namespace NowSound
         // Stop recording and close the file; if not recording, this is ignored.
         __declspec(dllexport) void NowSoundGraph_StopRecording();
 
+        // Run the graph for durationSeconds of audio as fast as possible, feeding all inputs from inputFileName (or a
+        // test tone if it is empty) and writing the output mix to outputFileName (WAV format).
+        // Returns how many times faster than real time the render ran, or 0 if either file could not be opened.
+        // Graph must be Running, and must have been initialized with AudioDeviceOffline.
+        __declspec(dllexport) float NowSoundGraph_RenderOffline(LPWSTR inputFileName, LPWSTR outputFileName, float durationSeconds);
+
         // Plugin searching requires setting paths to search.
         // TODO: make this use the idiom for passing in strings rather than StringBuilders.
         __declspec(dllexport) void NowSoundGraph_AddPluginSearchPath(LPWSTR wcharBuffer, int32_t bufferCapacity);
@@ -168,6 +198,8 @@ namespace NowSound
         __declspec(dllexport) NowSoundPluginInstanceInfo NowSoundGraph_GetInputPluginInstanceInfo(AudioInputId audioInputId, PluginInstanceIndex index);
         // Set the dry/wet balance on the given plugin.
         __declspec(dllexport) void NowSoundGraph_SetInputPluginInstanceDryWet(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex, int32_t dryWet_0_100);
+        // Schedule the dry/wet balance on the given plugin to change at exactly the given audio time.
+        __declspec(dllexport) bool NowSoundGraph_ScheduleInputPluginInstanceDryWet(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex, int64_t timeInSamples, int32_t dryWet_0_100);
         // Delete the given plugin instance; note that this will effectively renumber all subsequent instances.
         __declspec(dllexport) void NowSoundGraph_DeleteInputPluginInstance(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex);
 
@@ -207,12 +239,31 @@ namespace NowSound
         // Contractually requires State == NowSoundTrack_State.Looping.
         __declspec(dllexport) void NowSoundTrack_Rewind(TrackId trackId);
 
+        // Set how this track follows the graph's tempo, once that differs from the tempo it was recorded at
+        // (NowSoundGraph_SetTempo).  Tracks start out TrackTempoFixed.
+        __declspec(dllexport) void NowSoundTrack_SetTempoMode(TrackId trackId, NowSoundTrackTempoMode tempoMode);
+
+        // Add a voice to this track: another playhead over the same recorded audio, starting offsetBeats
+        // ahead of the track's current position, with its own direction, volume and pan.  Voices are mixed
+        // in the track itself, so they are much cheaper than copying the track.
+        // Contractually requires State == NowSoundTrack_State.Looping.
+        // Returns TrackVoiceIdUndefined, adding nothing, if the track already has as many voices as it can hold;
+        // a deleted voice counts until the audio thread finishes its current block.
+        __declspec(dllexport) TrackVoiceId NowSoundTrack_AddVoice(TrackId trackId, float offsetBeats, bool isPlaybackBackwards, float volume, float pan);
+        __declspec(dllexport) void NowSoundTrack_SetVoiceVolume(TrackId trackId, TrackVoiceId voiceId, float volume);
+        __declspec(dllexport) void NowSoundTrack_SetVoicePan(TrackId trackId, TrackVoiceId voiceId, float pan);
+        __declspec(dllexport) void NowSoundTrack_DeleteVoice(TrackId trackId, TrackVoiceId voiceId);
+
         // Get the current track frequency histogram (post-effects); LPWSTR must actually reference a float buffer of the
         // same length as the outputBinCount argument passed to InitializeFFT, but must be typed as LPWSTR
         // and must have a capacity represented in two-byte wide characters (to match the P/Invoke style of
         // "pass in StringBuilder", known to work well).
         __declspec(dllexport) void NowSoundTrack_GetFrequencies(TrackId trackId, void* floatBuffer, int32_t floatBufferCapacity);
 
+        // Start or stop frequency analysis of this track (enabled by default); while stopped, the track costs no
+        // analysis time, and NowSoundTrack_GetFrequencies keeps returning the last histogram.
+        __declspec(dllexport) void NowSoundTrack_SetFrequencyAnalysisEnabled(TrackId trackId, bool isEnabled);
+
         // True if this is muted.
         // 
         // Note that something can be in FinishRecording state but still be muted, if the user is fast!
@@ -225,6 +276,12 @@ namespace NowSound
         __declspec(dllexport) float NowSoundTrack_Volume(TrackId trackId);
         __declspec(dllexport) void NowSoundTrack_SetVolume(TrackId trackId, float volume);
 
+        // Start moving the track's pan (or volume) to the given value at exactly the given audio time (as in
+        // NowSoundTimeInfo), so automation can be sent ahead in batches.
+        // Changes must be scheduled in time order; returns false if too many are already waiting.
+        __declspec(dllexport) bool NowSoundTrack_SchedulePan(TrackId trackId, int64_t timeInSamples, float pan);
+        __declspec(dllexport) bool NowSoundTrack_ScheduleVolume(TrackId trackId, int64_t timeInSamples, float volume);
+
         // Add an instance of the given plugin on the given track.
         __declspec(dllexport) PluginInstanceIndex NowSoundTrack_AddPluginInstance(TrackId trackId, PluginId pluginId, ProgramId programId, int32_t dryWet_0_100);
         // Get the number of plugin instances on this track.
@@ -233,6 +290,8 @@ namespace NowSound
         __declspec(dllexport) NowSoundPluginInstanceInfo NowSoundTrack_GetPluginInstanceInfo(TrackId trackId, PluginInstanceIndex index);
         // Set the dry/wet balance on the given plugin. TODO: implement this!
         __declspec(dllexport) void NowSoundTrack_SetPluginInstanceDryWet(TrackId trackId, PluginInstanceIndex PluginInstanceIndex, int32_t dryWet_0_100);
+        // Schedule the dry/wet balance on the given plugin to change at exactly the given audio time.
+        __declspec(dllexport) bool NowSoundTrack_SchedulePluginInstanceDryWet(TrackId trackId, PluginInstanceIndex PluginInstanceIndex, int64_t timeInSamples, int32_t dryWet_0_100);
         // Delete the given plugin instance; note that this will effectively renumber all subsequent instances.
         __declspec(dllexport) void NowSoundTrack_DeletePluginInstance(TrackId trackId, PluginInstanceIndex PluginInstanceIndex);
     };
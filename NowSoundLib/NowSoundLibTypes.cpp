@@ -40,6 +40,24 @@ namespace NowSound
         return info;
     }
 
+    NowSoundAllocatorInfo CreateNowSoundAllocatorInfo(
+        int32_t bufferLength,
+        int32_t liveBufferCount,
+        int32_t freeBufferCount,
+        int32_t peakLiveBufferCount,
+        int32_t totalBufferCount,
+        int32_t failedAllocationCount)
+    {
+        NowSoundAllocatorInfo info;
+        info.BufferLength = bufferLength;
+        info.LiveBufferCount = liveBufferCount;
+        info.FreeBufferCount = freeBufferCount;
+        info.PeakLiveBufferCount = peakLiveBufferCount;
+        info.TotalBufferCount = totalBufferCount;
+        info.FailedAllocationCount = failedAllocationCount;
+        return info;
+    }
+
     NowSoundSpatialParameters CreateNowSoundInputInfo(
         float volume,
         float pan)
@@ -72,7 +90,8 @@ namespace NowSound
         float pan,
         float volume,
         float beatsPerMinute,
-        int64_t beatsPerMeasure)
+        int64_t beatsPerMeasure,
+        int64_t droppedSampleCount)
     {
         NowSoundTrackInfo info;
         info.IsTrackLooping = isTrackLooping ? 1 : 0;
@@ -86,6 +105,7 @@ namespace NowSound
         info.BeatsPerMinute = beatsPerMinute;
         // definitely not exceeding 2^31 lol
         info.BeatsPerMeasure = static_cast<int>(beatsPerMeasure);
+        info.DroppedSampleCount = droppedSampleCount;
         return info;
     }
 
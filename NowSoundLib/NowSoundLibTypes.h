@@ -71,6 +71,61 @@ namespace NowSound
             float BeatInMeasure;
         } NowSoundTimeInfo;
 
+        // Statistics about the graph's audio buffer allocator.
+        typedef struct NowSoundAllocatorInfo
+        {
+            // The number of floats in each buffer.
+            int32_t BufferLength;
+            // The number of buffers currently in use (by tracks, inputs, etc.).
+            int32_t LiveBufferCount;
+            // The number of buffers currently on the free list.
+            int32_t FreeBufferCount;
+            // The largest number of buffers ever in use at once.
+            int32_t PeakLiveBufferCount;
+            // The total number of buffers ever created, live or free.
+            int32_t TotalBufferCount;
+            // The number of times a buffer was needed but none could be had (so audio was dropped).
+            int32_t FailedAllocationCount;
+        } NowSoundAllocatorInfo;
+
+        // Statistics about the time one node of the graph has spent processing audio.
+        typedef struct NowSoundNodeTimingInfo
+        {
+            // The number of blocks the node has processed.
+            int64_t CallCount;
+            // The average time per block.
+            float AverageMicroseconds;
+            // The median time per block (rounded up to the histogram's resolution).
+            float MedianMicroseconds;
+            // The 99th percentile time per block (rounded up to the histogram's resolution).
+            float Percentile99Microseconds;
+            // The longest time any block took.
+            float MaximumMicroseconds;
+        } NowSoundNodeTimingInfo;
+
+        // Statistics about the time the whole graph has spent in audio device callbacks.
+        typedef struct NowSoundCallbackTimingInfo
+        {
+            // The number of callbacks.
+            int64_t CallCount;
+            // The average time per callback.
+            float AverageMicroseconds;
+            // The median time per callback (rounded up to the histogram's resolution).
+            float MedianMicroseconds;
+            // The 99th percentile time per callback (rounded up to the histogram's resolution).
+            float Percentile99Microseconds;
+            // The longest time any callback took.
+            float MaximumMicroseconds;
+            // The time available to each callback: the duration of the audio it processes.
+            float BudgetMicroseconds;
+            // The number of callbacks that took longer than their budget.
+            int64_t OverBudgetCount;
+            // The number of times the gap between callbacks showed that audio was lost.
+            int64_t XrunCount;
+            // The number of xruns reported by the device itself (-1 if the device does not report them).
+            int64_t DeviceXrunCount;
+        } NowSoundCallbackTimingInfo;
+
         // Information about a created input; currently only mono inputs are supported.
         // (Stereo inputs can be represented as a pair of mono inputs.)
         typedef struct NowSoundSpatialParameters
@@ -119,6 +174,9 @@ namespace NowSound
             float BeatsPerMinute;
             // The number of beats per measure (e.g. time signature).
             int64_t BeatsPerMeasure;
+            // The number of samples of input this track failed to record because the audio buffer pool was
+            // exhausted; if nonzero, the loop is shifted against the beat by that much.
+            int64_t DroppedSampleCount;
         } NowSoundTrackInfo;
 
         // The states of a NowSound graph.
@@ -139,6 +197,64 @@ namespace NowSound
             // NOTYET: Stopped,
         };
 
+        // The kinds of audio device a graph can run on.
+        // Note that since this is extern "C", this is not an enum class, so these identifiers begin with AudioDevice.
+        enum NowSoundAudioDevice
+        {
+            // The default ASIO hardware device.
+            AudioDeviceAsio,
+
+            // A software device calling back in real time, with silent inputs.
+            AudioDeviceNull,
+
+            // A software device calling back in real time, with inputs read from audio files.
+            AudioDeviceLoopback,
+
+            // No device at all; the graph processes audio only when RenderOffline is called.
+            AudioDeviceOffline,
+        };
+
+        // How to set up a graph, passed to NowSoundGraph_InitializeInstance.
+        // Every field after PreRecordingDuration may be 0 to get the default (and AudioDevice's default, 0, is ASIO).
+        typedef struct NowSoundGraphOptions
+        {
+            // How many output bins in the (logarithmic) frequency histogram?
+            int32_t OutputBinCount;
+            // What central frequency to use for the histogram?
+            float CentralFrequency;
+            // How many divisions to make in each octave?
+            int32_t OctaveDivisions;
+            // Which bin index should be centered on CentralFrequency?
+            int32_t CentralBinIndex;
+            // How many samples as input to and output from the FFT?
+            int32_t FftSize;
+            // How many seconds to pre-record, as latency compensation?
+            float PreRecordingDuration;
+            // How many floats in each audio buffer? (0 = the device's sample rate, i.e. one second of mono audio or
+            // half a second of stereo)
+            int32_t AudioBufferLengthInFloats;
+            // How many audio buffers to preallocate? (0 = default)
+            int32_t InitialAudioBufferCount;
+            // How many audio buffers may ever be allocated? (0 = default)
+            int32_t MaximumAudioBufferCount;
+            // How many audio buffers to allocate at once when the free list runs low? (0 = default)
+            int32_t AudioBufferGrowthStep;
+            // How many samples from the start of one FFT frame to the start of the next? (0 = half the FFT size)
+            int32_t FftHopSize;
+            // How many FFT frames per second, e.g. to match the UI frame rate? (0 = as set by FftHopSize)
+            float FftFramesPerSecond;
+            // Nonzero if the frequency bins should be in decibels rather than linear magnitudes.
+            int32_t FftOutputDecibels;
+            // How many seconds should held frequency bin peaks take to decay by 20 dB? (0 = no peak hold)
+            float FftPeakHoldSeconds;
+            // Which kind of audio device should the graph run on?
+            NowSoundAudioDevice AudioDevice;
+            // At what sample rate should a software (null, loopback or offline) device run? (ignored for ASIO)
+            int32_t SoftwareSampleRateHz;
+            // How many samples per block should a software device process? (ignored for ASIO)
+            int32_t SoftwareSamplesPerQuantum;
+        } NowSoundGraphOptions;
+
         // The state of a particular IHolofunkAudioTrack.
         // Note that since this is extern "C", this is not an enum class, so these identifiers have to begin with Track
         // to disambiguate them from the GraphState identifiers.
@@ -158,6 +274,20 @@ namespace NowSound
             TrackLooping,
         };
 
+        // How a looping track follows the graph's tempo, once that differs from the tempo it was recorded at.
+        // Note that since this is extern "C", this is not an enum class, so these identifiers begin with TrackTempo.
+        enum NowSoundTrackTempoMode
+        {
+            // Keep playing at the recorded tempo, ignoring the graph's.
+            TrackTempoFixed,
+
+            // Play faster or slower to match the graph's tempo, changing pitch too (like a turntable); cheap.
+            TrackTempoVarispeed,
+
+            // Stretch the loop to match the graph's tempo, keeping its pitch.  Mono tracks only; stereo tracks varispeed.
+            TrackTempoTimeStretch,
+        };
+
         // The indices for audio inputs created by the app.
         // Prevents confusing an audio input with some other int value.
         //
@@ -210,6 +340,13 @@ namespace NowSound
             PluginInstanceIndexUndefined = 0
         };
 
+        // The ID of an additional voice (playhead) on a looping track; one-based, and stable until the voice
+        // is deleted.  Note that 0 is the default, undefined, invalid value, to catch interop errors more easily.
+        enum TrackVoiceId
+        {
+            TrackVoiceIdUndefined = 0
+        };
+
         // The state of an instantiated plugin; eventually will include parameter settings.
         typedef struct NowSoundPluginInstanceInfo
         {
@@ -235,6 +372,14 @@ namespace NowSound
             int beatsPerMeasure,
             float beatInMeasure);
 
+        NowSoundAllocatorInfo CreateNowSoundAllocatorInfo(
+            int32_t bufferLength,
+            int32_t liveBufferCount,
+            int32_t freeBufferCount,
+            int32_t peakLiveBufferCount,
+            int32_t totalBufferCount,
+            int32_t failedAllocationCount);
+
         NowSoundSpatialParameters CreateNowSoundInputInfo(
             float volume,
             float pan);
@@ -254,7 +399,8 @@ namespace NowSound
             float pan,
             float volume,
             float beatsPerMinute,
-            int64_t beatsPerMeasure);
+            int64_t beatsPerMeasure,
+            int64_t droppedSampleCount);
 
         NowSoundPluginInstanceInfo CreateNowSoundPluginInstanceInfo(
             PluginId pluginId,
@@ -33,25 +33,30 @@ namespace NowSound
         NowSoundGraph* graph,
         TrackId trackId,
         AudioInputId inputId,
-        const BufferedSliceStream<AudioSample, float>& sourceStream,
+        const std::vector<const DenseSliceStream<AudioSample, float>*>& sourceStreams,
         float initialVolume,
         float initialPan,
         float beatsPerMinute,
         int beatsPerMeasure)
-        : SpatialAudioProcessor(graph, MakeName(L"Track ", (int)trackId), /*isMuted:*/false, initialVolume, initialPan),
+        : SpatialAudioProcessor(graph, MakeName(L"Track ", (int)trackId), (int)sourceStreams.size(), /*isMuted:*/false, initialVolume, initialPan),
         _trackId{ trackId },
         _audioInputId{ inputId },
         _state{ NowSoundTrackState::TrackRecording },
         // latency compensation effectively means the track started before it was constructed ;-)
         _audioStream(new BufferedSliceStream<AudioSample, float>(
-            1,
+            (int)sourceStreams.size(),
             NowSoundGraph::Instance()->AudioAllocator(),
             /*maxBufferedDuration:*/ 0)),
         // one beat is the shortest any track ever is (TODO: allow optionally relaxing quantization)
         _beatDuration{ 1 },
         _priorBeatDuration{ 1 },
         _localLoopTime{ 0 },
-        _tempo{ new Tempo(beatsPerMinute, beatsPerMeasure, graph->Clock()->SampleRateHz()) }
+        _tempo{ new Tempo(beatsPerMinute, beatsPerMeasure, graph->Clock()->SampleRateHz()) },
+        _voices{ MagicConstants::MaximumTrackVoiceCount },
+        _voiceScratch{},
+        _playhead{ MagicConstants::TrackLoopInterpolation, (int)sourceStreams.size() },
+        _tempoMode{ MagicConstants::InitialTrackTempoMode },
+        _stretcher{ CanTimeStretch() ? new TimeStretcher() : nullptr }
     {
         // Tracks should only be created from the UI thread (or at least not from the audio thread).
         // TODO: thread contracts.
@@ -64,11 +69,39 @@ namespace NowSound
         {
             // Prepend preRecordingDuration seconds of previously buffered input audio, to prepopulate this track.
             Duration<AudioSample> preRecordingSampleDuration = graph->Clock()->TimeToRoundedUpSamples(preRecordingDuration);
-            Interval<AudioSample> lastIntervalOfSourceStream(
-                Time<AudioSample>(0) + sourceStream.DiscreteDuration() - preRecordingSampleDuration,
-                preRecordingSampleDuration,
-                Direction::Forwards);
-            sourceStream.AppendTo(lastIntervalOfSourceStream, _audioStream.get());
+            if (sourceStreams.size() == 1)
+            {
+                const DenseSliceStream<AudioSample, float>& sourceStream = *sourceStreams[0];
+                Interval<AudioSample> lastIntervalOfSourceStream(
+                    Time<AudioSample>(0) + sourceStream.DiscreteDuration() - preRecordingSampleDuration,
+                    preRecordingSampleDuration,
+                    Direction::Forwards);
+                sourceStream.AppendTo(lastIntervalOfSourceStream, _audioStream.get());
+            }
+            else
+            {
+                // The inputs are appended to one after another, so one may be a block ahead of the others; take
+                // the latest audio all of them have, and interleave it.
+                Duration<AudioSample> commonDuration = sourceStreams[0]->DiscreteDuration();
+                for (const DenseSliceStream<AudioSample, float>* sourceStream : sourceStreams)
+                {
+                    commonDuration = std::min(commonDuration, sourceStream->DiscreteDuration());
+                }
+                Duration<AudioSample> copiedDuration = std::min(commonDuration, preRecordingSampleDuration);
+
+                std::vector<std::vector<float>> channelSamples(sourceStreams.size(), std::vector<float>((size_t)copiedDuration.Value()));
+                std::vector<const float*> channels;
+                for (size_t i = 0; i < sourceStreams.size(); i++)
+                {
+                    Interval<AudioSample> lastIntervalOfSourceStream(
+                        Time<AudioSample>(0) + sourceStreams[i]->DiscreteDuration() - copiedDuration,
+                        copiedDuration,
+                        Direction::Forwards);
+                    sourceStreams[i]->CopyTo(lastIntervalOfSourceStream, channelSamples[i].data());
+                    channels.push_back(channelSamples[i].data());
+                }
+                _audioStream->AppendChannels(copiedDuration, channels.data());
+            }
         }
 
         {
@@ -79,7 +112,7 @@ namespace NowSound
     }
 
     NowSoundTrackAudioProcessor::NowSoundTrackAudioProcessor(TrackId trackId, NowSoundTrackAudioProcessor* other)
-        : SpatialAudioProcessor(other->Graph(), MakeName(L"Track ", (int)trackId), other->IsMuted(), other->Volume(), other->Pan()),
+        : SpatialAudioProcessor(other->Graph(), MakeName(L"Track ", (int)trackId), other->ChannelCount(), other->IsMuted(), other->Volume(), other->Pan()),
         _trackId{ trackId },
         _audioInputId{ other->_audioInputId },
         _state{ NowSoundTrackState::TrackLooping },
@@ -91,7 +124,12 @@ namespace NowSound
         _localLoopTime{ other->_localLoopTime },
         _justStoppedRecording{ false },
         _direction{ other->_direction },
-        _tempo{ new Tempo(other->_tempo->BeatsPerMinute(), other->_tempo->BeatsPerMeasure(), other->Graph()->Clock()->SampleRateHz()) }
+        _tempo{ new Tempo(other->_tempo->BeatsPerMinute(), other->_tempo->BeatsPerMeasure(), other->Graph()->Clock()->SampleRateHz()) },
+        _voices{ MagicConstants::MaximumTrackVoiceCount },
+        _voiceScratch{},
+        _playhead{ MagicConstants::TrackLoopInterpolation, other->ChannelCount() },
+        _tempoMode{ other->TempoMode() },
+        _stretcher{ other->CanTimeStretch() ? new TimeStretcher() : nullptr }
     {
         // we're a copied loop; spam like crazy
         std::wstringstream wstr{};
@@ -183,7 +221,8 @@ namespace NowSound
             Pan(),
             Volume(),
             BeatsPerMinute(),
-            BeatsPerMeasure());
+            BeatsPerMeasure(),
+            _audioStream->DroppedDuration().Value());
     }
 
     void NowSoundTrackAudioProcessor::FinishRecording()
@@ -212,21 +251,184 @@ namespace NowSound
         _localLoopTime = 0;
     }
 
+    NowSoundTrackTempoMode NowSoundTrackAudioProcessor::TempoMode() const
+    {
+        return _tempoMode.load(std::memory_order_acquire);
+    }
+
+    void NowSoundTrackAudioProcessor::SetTempoMode(NowSoundTrackTempoMode tempoMode)
+    {
+        Check(tempoMode >= NowSoundTrackTempoMode::TrackTempoFixed && tempoMode <= NowSoundTrackTempoMode::TrackTempoTimeStretch);
+
+        // Every stretcher a mono track needs already exists, so there is nothing to allocate (and nothing for the
+        // audio thread to race with); it picks up the new mode on its next block.
+        _tempoMode.store(tempoMode, std::memory_order_release);
+    }
+
+    float NowSoundTrackAudioProcessor::PlaybackRate(NowSoundTrackTempoMode tempoMode) const
+    {
+        if (tempoMode == NowSoundTrackTempoMode::TrackTempoFixed)
+        {
+            return 1;
+        }
+
+        // exactly 1 when the tempos match, so an unchanged tempo costs nothing
+        float rate = Graph()->BeatsPerMinute() / _tempo->BeatsPerMinute();
+        return std::min(std::max(rate, MagicConstants::MinimumTrackPlaybackRate), MagicConstants::MaximumTrackPlaybackRate);
+    }
+
+    void NowSoundTrackAudioProcessor::RenderLoop(
+        LoopPlayhead& playhead,
+        TimeStretcher* stretcher,
+        ContinuousTime<AudioSample>& position,
+        Direction direction,
+        NowSoundTrackTempoMode tempoMode,
+        float rate,
+        int count,
+        float* const* destinations)
+    {
+        // stretchers are only ever allocated for mono tracks
+        if (tempoMode == NowSoundTrackTempoMode::TrackTempoTimeStretch && rate != 1 && stretcher != nullptr)
+        {
+            stretcher->Render(*_audioStream, position, direction, rate, count, destinations[0]);
+        }
+        else
+        {
+            // at rate 1 this is the plain playhead; otherwise, varispeed
+            playhead.Render(*_audioStream, position, direction, count, destinations, rate);
+        }
+    }
+
+    bool NowSoundTrackAudioProcessor::AppendInput(Duration<AudioSample> duration, const juce::AudioSampleBuffer& audioBuffer)
+    {
+        Duration<AudioSample> droppedBefore = _audioStream->DroppedDuration();
+
+        // Getting data for channel 0 (and on) is always correct because the JUCE per-channel connections handle
+        // which input channel goes to which track channel.
+        if (ChannelCount() == 1)
+        {
+            _audioStream->Append(duration, audioBuffer.getReadPointer(0));
+        }
+        else
+        {
+            _audioStream->AppendChannels(duration, audioBuffer.getArrayOfReadPointers());
+        }
+
+        Duration<AudioSample> dropped = _audioStream->DroppedDuration() - droppedBefore;
+        if (dropped > 0)
+        {
+            Graph()->Events().Log(
+                Graph()->DroppedInputFormat(),
+                (int)_trackId,
+                dropped.Value(),
+                Graph()->AudioAllocator()->FailedAllocationCount());
+            return false;
+        }
+        return true;
+    }
+
+    TrackVoiceId NowSoundTrackAudioProcessor::AddVoice(ContinuousDuration<Beat> offsetBeats, bool isPlaybackBackwards, float volume, float pan)
+    {
+        Check(_state == NowSoundTrackState::TrackLooping);
+        Check(volume >= 0);
+        Check(pan >= 0 && pan <= 1);
+
+        // the audio thread only reads the scratch buffer while some voice is active, so sizing it now is safe
+        if (_voiceScratch.empty())
+        {
+            _voiceScratch.resize(Graph()->Info().SamplesPerQuantum * ChannelCount());
+        }
+
+        int index = _voices.FindFree();
+        if (index == -1)
+        {
+            // out of voices; the caller gets to decide what to do about it
+            return TrackVoiceId::TrackVoiceIdUndefined;
+        }
+
+        // start offsetBeats ahead of where the track is right now, modulo the loop length
+        TrackVoice& voice = _voices[index];
+        float loopDuration = ExactDuration().Value();
+        float startTime = std::fmod(_localLoopTime.Value() + _tempo->BeatsToSamples(offsetBeats).Value(), loopDuration);
+        if (startTime < 0)
+        {
+            startTime += loopDuration;
+        }
+
+        voice.LocalLoopTime = ContinuousTime<AudioSample>(startTime);
+        voice.PlaybackDirection = isPlaybackBackwards ? Direction::Backwards : Direction::Forwards;
+        if (voice.Volume == nullptr)
+        {
+            voice.Volume.reset(new SmoothedParameter<float>(volume, ParameterRampSamples(), SmoothingCurve::Exponential, MagicConstants::ParameterScheduleCapacity));
+            voice.Pan.reset(new SmoothedParameter<float>(pan, ParameterRampSamples(), SmoothingCurve::Linear, MagicConstants::ParameterScheduleCapacity));
+        }
+        else
+        {
+            // a reused voice ramps (briefly) from where its previous use left off
+            voice.Volume->SetTarget(volume);
+            voice.Pan->SetTarget(pan);
+        }
+        if (voice.Playhead == nullptr)
+        {
+            voice.Playhead.reset(new LoopPlayhead(MagicConstants::TrackLoopInterpolation, ChannelCount()));
+        }
+        if (CanTimeStretch() && voice.Stretcher == nullptr)
+        {
+            voice.Stretcher.reset(new TimeStretcher());
+        }
+        _voices.Activate(index);
+
+        return (TrackVoiceId)(index + 1);
+    }
+
+    NowSoundTrackAudioProcessor::TrackVoice& NowSoundTrackAudioProcessor::Voice(TrackVoiceId voiceId)
+    {
+        Check(voiceId > TrackVoiceId::TrackVoiceIdUndefined);
+        Check((int)voiceId <= MagicConstants::MaximumTrackVoiceCount);
+
+        Check(_voices.IsActive((int)voiceId - 1));
+        return _voices[(int)voiceId - 1];
+    }
+
+    void NowSoundTrackAudioProcessor::SetVoiceVolume(TrackVoiceId voiceId, float volume)
+    {
+        Check(volume >= 0);
+
+        // ramp to it, as with the track's own volume
+        Voice(voiceId).Volume->SetTarget(volume);
+    }
+
+    void NowSoundTrackAudioProcessor::SetVoicePan(TrackVoiceId voiceId, float pan)
+    {
+        Check(pan >= 0 && pan <= 1);
+
+        Voice(voiceId).Pan->SetTarget(pan);
+    }
+
+    void NowSoundTrackAudioProcessor::DeleteVoice(TrackVoiceId voiceId)
+    {
+        Check(voiceId > TrackVoiceId::TrackVoiceIdUndefined);
+        _voices.Deactivate((int)voiceId - 1);
+    }
+
+    bool NowSoundTrackAudioProcessor::HasActiveVoices() const
+    {
+        return _voices.AnyActive();
+    }
+
     const int maxCounter = 1000;
 
-    void NowSoundTrackAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
+    void NowSoundTrackAudioProcessor::ProcessBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
     {
         // temporary debugging code: see if processBlock is ever being called under Holofunk
         /*
         if (CheckLogThrottle()) {
-            std::wstringstream wstr{};
-            wstr << getName() << L"::processBlock: count " << NextCounter() << L", state " << _state;
-            NowSoundGraph::Instance()->Log(wstr.str());
+            Graph()->Events().Log(Graph()->ProcessBlockFormat(), NodeId().uid, NextCounter());
         }
         */
         
-        // This should always take two channels.  Only channel 0 is used on input.  Both channels are used
-        // on output (only stereo supported for now).
+        // This should always take two channels.  Only channel 0 is used on input, unless this is a stereo
+        // track.  Both channels are used on output (only stereo supported for now).
         Check(audioBuffer.getNumChannels() == 2);
 
         // Depending on the current state of this track, we either record, or we finish recording
@@ -262,7 +464,7 @@ namespace NowSound
 
     void NowSoundTrackAudioProcessor::HandleTrackRecording(NowSound::Duration<NowSound::AudioSample>& bufferDuration, juce::AudioSampleBuffer& audioBuffer)
     {
-        // We are recording; save the input audio in our stream, and that's it (we never call processBlock here,
+        // We are recording; save the input audio in our stream, and that's it (we never call ProcessBlock here,
         // because the input audio is already getting mixed through to the output).
 
         // How many complete beats after we record this data?
@@ -293,9 +495,7 @@ namespace NowSound
         }
 
         // and actually record the full amount of available data.
-        // Getting data for channel 0 is always correct because the JUCE per-channel connections handle which
-        // input channel goes to which track.
-        _audioStream.get()->Append(bufferDuration, audioBuffer.getReadPointer(0));
+        AppendInput(bufferDuration, audioBuffer);
 
         // and quiet all output channels
         for (int i = 0; i < this->getTotalNumOutputChannels(); i++)
@@ -306,7 +506,7 @@ namespace NowSound
 
     void NowSoundTrackAudioProcessor::HandleTrackFinishRecording(NowSound::Duration<NowSound::AudioSample>& bufferDuration, juce::AudioSampleBuffer& audioBuffer)
     {
-        // Finish up and close the audio stream with the last precise samples; again, don't call processBlock.
+        // Finish up and close the audio stream with the last precise samples; again, don't call ProcessBlock.
         ContinuousDuration<AudioSample> lastPriorDuration = _tempo->BeatsToSamples(_priorBeatDuration.AsContinuous());
         if (_audioStream->DiscreteDuration() > lastPriorDuration.RoundedUp()) {
             // Check whether we are within a certain beat duration (the "truncation beats" duration)
@@ -352,11 +552,41 @@ namespace NowSound
         Duration<AudioSample> originalDiscreteDuration = _audioStream.get()->DiscreteDuration();
         Check(originalDiscreteDuration <= roundedUpDuration);
 
+        bool appendedAll;
         if (originalDiscreteDuration + bufferDuration >= roundedUpDuration)
         {
             // reduce duration so we only capture the exact right number of samples
             Duration<AudioSample> captureDuration = roundedUpDuration - originalDiscreteDuration;
 
+            appendedAll = AppendInput(captureDuration, audioBuffer);
+        }
+        else
+        {
+            // capture the full duration
+            appendedAll = AppendInput(bufferDuration, audioBuffer);
+        }
+
+        if (!appendedAll)
+        {
+            // The buffer allocator ran dry, so the rest of the loop may never be captured.  Rather than waiting
+            // for memory indefinitely, loop the whole beats we already have, if there is at least one.
+            Duration<AudioSample> capturedDuration = _audioStream->DiscreteDuration();
+            Duration<Beat> capturedBeats = (Duration<Beat>)((int)_tempo->TimeToBeats(Time<AudioSample>(capturedDuration.Value()).AsContinuous()).Value());
+            if (capturedBeats > 0)
+            {
+                _beatDuration = capturedBeats;
+                roundedUpDuration = ExactDuration().RoundedUp();
+                if (roundedUpDuration < capturedDuration)
+                {
+                    _audioStream->Truncate(roundedUpDuration);
+                }
+            }
+        }
+
+        // Unless we have captured every last sample (which only fails to happen if there is less than a beat of
+        // audio and no memory for more), keep finishing on the next block.
+        if (_audioStream.get()->DiscreteDuration() == roundedUpDuration)
+        {
             // we are done recording altogether
             _state = NowSoundTrackState::TrackLooping;
 
@@ -370,20 +600,11 @@ namespace NowSound
             // TODONEXT: actually remove input connections by polling! (NYI atm)
             _justStoppedRecording = true;
 
-            // Getting data for channel 0 is always correct, because the JUCE per-channel connections handle
-            // the input-channel-to-track routing.
-            _audioStream.get()->Append(captureDuration, audioBuffer.getReadPointer(0));
-
             // now that we have done our final append, shut the stream at the current duration.
             // This requires that the stream has captured exactly roundedUpDuration samples in total,
             // or an assertion will fire.
             _audioStream.get()->Shut(ExactDuration(), /* fade: */true);
         }
-        else
-        {
-            // capture the full duration
-            _audioStream.get()->Append(bufferDuration, audioBuffer.getReadPointer(0));
-        }
 
         // Quiet the output audio.
         // We will start looping on the next block.
@@ -396,116 +617,119 @@ namespace NowSound
 
     void NowSoundTrackAudioProcessor::HandleTrackLooping(NowSound::Duration<NowSound::AudioSample>& bufferDuration, juce::AudioSampleBuffer& audioBuffer, NowSound::Duration<NowSound::AudioSample>& completedDuration, juce::MidiBuffer& midiBuffer)
     {
-        // The fractional part of the track's continuous duration.
-        // Used when computing whether to pick up a rounded-up sample when wrapping around.
-        ContinuousDuration<AudioSample> streamDuration = _audioStream.get()->ExactDuration();
-        float streamFractionalDuration = streamDuration.Value() - std::floor(streamDuration.Value());
+        // Render the track's own playhead into channel 0 only (or, if stereo, channels 0 and 1);
+        // SpatialAudioProcessor::ProcessBlock pans it from there into both channels.
+        float* channel0 = audioBuffer.getWritePointer(0) + completedDuration.Value();
+        float* channel1 = audioBuffer.getWritePointer(1) + completedDuration.Value();
+        float* channels[] = { channel0, channel1 };
+        Duration<AudioSample> loopDuration = bufferDuration;
+        NowSoundTrackTempoMode tempoMode = TempoMode();
+        float rate = PlaybackRate(tempoMode);
+        RenderLoop(_playhead, _stretcher.get(), _localLoopTime, _direction, tempoMode, rate, (int)loopDuration.Value(), channels);
+
+        completedDuration = completedDuration + loopDuration;
+        bufferDuration = 0;
 
-        // Copy our audio stream data into audioBuffer, slice by slice.
-        while (bufferDuration > 0)
+        // Now process the whole block to the output.
+        // Note that this is the right thing to do even if we are looping over only a partial block;
+        // the portion of the block when we were still recording will be zeroed out properly.
+        SpatialAudioProcessor::ProcessBlock(audioBuffer, midiBuffer);
+
+        if (!HasActiveVoices())
         {
-            float fractionalLocalLoopTime = _localLoopTime.Value() - std::floor(_localLoopTime.Value());
+            // still a pass over the voices, so acknowledge any deleted ones
+            _voices.Acknowledge();
+            return;
+        }
 
-            // Are we playing forwards or backwards?
-            Slice<AudioSample, float> slice(
-                _audioStream.get()->GetSliceIntersecting(
-                    Interval<AudioSample>(_localLoopTime.RoundedDown(), bufferDuration, _direction)));
+        // Mix in all the voices, reading the same shared stream with each voice's own playhead.
+        // Voices follow the track's mute state and are scaled by the track's volume, as of the end of the
+        // block (so a ramping track volume moves the voices in block-sized steps); each voice's own volume
+        // and pan ramp smoothly.
+        int scratchCapacity = (int)_voiceScratch.size() / ChannelCount();
+        float* scratch[] = { _voiceScratch.data(), _voiceScratch.data() + (ChannelCount() - 1) * scratchCapacity };
+        Time<AudioSample> loopStart = Graph()->Clock()->BlockStart() + (completedDuration - loopDuration);
+        for (int i = 0; i < _voices.Capacity(); i++)
+        {
+            if (!_voices.IsActive(i))
+            {
+                continue;
+            }
 
-            if (_direction == Direction::Forwards)
+            TrackVoice& voice = _voices[i];
+            int rendered = 0;
+            while (rendered < loopDuration.Value())
             {
-                // Is this the last data in the stream?
-                // If so, then its final offset will be equal to the stream's DiscreteDuration.
-                Time<AudioSample> sliceEndTime = _localLoopTime.RoundedDown() + slice.SliceDuration();
-                bool reachedStreamEnd = sliceEndTime.Value() == _audioStream.get()->DiscreteDuration().Value();
-
-                // If this is the last slice, then we are about to wrap around.
-                // When doing this, we need to decide whether to pick up an extra rounded sample.
-                // Since the DiscreteDuration is equal to the rounded-up ContinuousDuration,
-                // we by default *will* get a rounded-up extra sample.
-                // So now is when we decide to possibly *not* do that.
-                if (reachedStreamEnd)
-                {
-                    // If the fractional part of _localLoopTime plus streamFractionalDuration is
-                    // less than 1, it means we are NOT rounding up, and we want to drop the
-                    // rounded-up sample from the last slice.
-                    float fractionalSum = fractionalLocalLoopTime + streamFractionalDuration;
-                    if (fractionalSum < 1)
-                    {
-                        // drop the extra sample from the slice
-                        slice = slice.SubsliceOfDuration(slice.SliceDuration() - Duration<AudioSample>(1));
-                    }
-
-                    // because we wrapped around and just accounted for any rounding up,
-                    // we keep the fractional part only but go back to the zeroth sample
-                    _localLoopTime = fractionalSum - std::floor(fractionalSum);
-                }
-                else
-                {
-                    // we can just use the slice as is.
-                    // increase the local loop time by this whole slice
-                    _localLoopTime = _localLoopTime + slice.SliceDuration().AsContinuous();
-                }
+                int chunk = std::min<int>(scratchCapacity, (int)loopDuration.Value() - rendered);
+                RenderLoop(
+                    *voice.Playhead,
+                    voice.Stretcher.get(),
+                    voice.LocalLoopTime,
+                    voice.PlaybackDirection,
+                    tempoMode,
+                    rate,
+                    chunk,
+                    scratch);
+                MixVoice(voice, scratch, chunk, loopStart + Duration<AudioSample>(rendered), channel0 + rendered, channel1 + rendered);
+                rendered += chunk;
+            }
+        }
 
-                // B4PR: REMOVE: try to catch bug before next loop iteration
-                assert(_localLoopTime.Value() != _audioStream.get()->DiscreteDuration().Value());
+        // done with every voice deleted before this block; AddVoice may now reuse their slots
+        _voices.Acknowledge();
 
-                // copy the same audio to both output channels; it will get panned by SpatialAudioProcessor::processBlock
-                slice.CopyTo(audioBuffer.getWritePointer(0) + completedDuration.Value());
-                slice.CopyTo(audioBuffer.getWritePointer(1) + completedDuration.Value());
-            }
-            else
+        ClampOutput(channel0, (int)loopDuration.Value());
+        ClampOutput(channel1, (int)loopDuration.Value());
+    }
+
+    void NowSoundTrackAudioProcessor::MixVoice(TrackVoice& voice, float* const* source, int count, Time<AudioSample> start, float* left, float* right)
+    {
+        // per-sample parameter values and gains, for chunks where the voice's volume or pan is ramping
+        float volumes[ParameterChunkSamples];
+        float pans[ParameterChunkSamples];
+        float leftGains[ParameterChunkSamples];
+        float rightGains[ParameterChunkSamples];
+
+        const float* sourceLeft = source[0];
+        const float* sourceRight = source[ChannelCount() - 1];
+        float trackGain = CurrentGain();
+        for (int offset = 0; offset < count; offset += ParameterChunkSamples)
+        {
+            int chunk = std::min(ParameterChunkSamples, count - offset);
+            Time<AudioSample> chunkStart = start + Duration<AudioSample>(offset);
+            bool volumeVaries = voice.Volume->Advance(chunkStart, chunk, volumes);
+            bool panVaries = voice.Pan->Advance(chunkStart, chunk, pans);
+
+            if (!volumeVaries && !panVaries)
             {
-                // here we go backwards!
-
-                // Is this the first slice in the stream?
-                // If so, then its final offset will be equal to the stream's DiscreteDuration.
-                bool isFirstSlice = slice.Offset() == 0;
-
-                // If this is the first slice, then we are about to wrap around.
-                // When doing this, we need to decide whether to pick up an extra rounded sample.
-                // Since the DiscreteDuration is equal to the rounded-up ContinuousDuration,
-                // we by default *will* get a rounded-up extra sample.
-                // So now is when we decide to possibly *not* do that.
-                if (isFirstSlice)
+                // the usual case: the voice's gains are constant
+                float volume = voice.Volume->Current() * trackGain;
+                if (ChannelCount() == 1)
                 {
-                    // The default local loop time is the whole stream, plus the fractional accumulation.
-                    _localLoopTime =
-                        _audioStream.get()->DiscreteDuration().Value() - 1
-                        + (fractionalLocalLoopTime - streamFractionalDuration);
-
-                    // If the fractional part of localLoopTime is more than streamFractionalDuration,
-                    // then we did not in fact round up this time, and we should drop one sample.
-                    if (fractionalLocalLoopTime >= streamFractionalDuration)
-                    {
-                        // The new local loop time keeps the fractional result, but drops the
-                        // last sample.
-                        _localLoopTime = ContinuousTime<AudioSample>(_localLoopTime.Value() - 1);
-                    }
+                    AccumulatePanned(sourceLeft + offset, chunk, voice.Pan->Current(), volume, left + offset, right + offset);
                 }
                 else
                 {
-                    // we can just use the slice as is.
-                    // decrease the local loop time by this whole slice
-                    _localLoopTime = ContinuousTime<AudioSample>(_localLoopTime.Value() - slice.SliceDuration().AsContinuous().Value());
+                    AccumulateBalanced(sourceLeft + offset, sourceRight + offset, chunk, voice.Pan->Current(), volume, left + offset, right + offset);
                 }
+                continue;
+            }
 
-                // copy the same audio BACKWARDS to both output channels;
-                // it will get panned by SpatialAudioProcessor::processBlock
-                for (int sourceIndex = 0; sourceIndex < slice.SliceDuration().Value(); sourceIndex++)
+            // as in SpatialAudioProcessor::ProcessBlock, only a moving pan needs per-sample trig
+            float leftCoefficient;
+            float rightCoefficient;
+            PanCoefficients(ChannelCount(), voice.Pan->Current(), &leftCoefficient, &rightCoefficient);
+            for (int i = 0; i < chunk; i++)
+            {
+                if (panVaries)
                 {
-                    int destIndex = slice.SliceDuration().Value() - sourceIndex - 1 + completedDuration.Value();
-                    audioBuffer.getWritePointer(0)[destIndex] = slice.Get(sourceIndex, 0);
-                    audioBuffer.getWritePointer(1)[destIndex] = slice.Get(sourceIndex, 0);
+                    PanCoefficients(ChannelCount(), pans[i], &leftCoefficient, &rightCoefficient);
                 }
+                float volume = (volumeVaries ? volumes[i] : voice.Volume->Current()) * trackGain;
+                leftGains[i] = leftCoefficient * volume;
+                rightGains[i] = rightCoefficient * volume;
             }
-
-            bufferDuration = bufferDuration - slice.SliceDuration();
-            completedDuration = completedDuration + slice.SliceDuration();
+            AccumulatePerSample(sourceLeft + offset, sourceRight + offset, chunk, leftGains, rightGains, left + offset, right + offset);
         }
-
-        // Now process the whole block to the output.
-        // Note that this is the right thing to do even if we are looping over only a partial block;
-        // the portion of the block when we were still recording will be zeroed out properly.
-        SpatialAudioProcessor::processBlock(audioBuffer, midiBuffer);
     }
 }
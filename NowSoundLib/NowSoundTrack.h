@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "stdafx.h"
 
@@ -14,10 +16,15 @@
 #include "Clock.h"
 #include "Histogram.h"
 #include "Interval.h"
+#include "LoopPlayhead.h"
+#include "MagicConstants.h"
 #include "NowSoundFrequencyTracker.h"
 #include "NowSoundLibTypes.h"
 #include "NowSoundTime.h"
+#include "SlotTable.h"
+#include "SmoothedParameter.h"
 #include "Tempo.h"
+#include "TimeStretcher.h"
 
 // set to 1 to reuse a static AudioFrame; 0 will allocate a new AudioFrame in each audio quantum event handler
 #define STATIC_AUDIO_FRAME 1
@@ -25,12 +32,43 @@
 namespace NowSound
 {
     // Represents a single looping track of recorded audio.
-    // Currently a Track is backed by a mono BufferedSliceStream, but emits stereo output based on current Pan value.
-    // This allows Tracks to be panned around even after being recorded. In other words, the stereo balance is not
-    // baked into two channels.
+    // A Track is backed by a BufferedSliceStream of one channel per input it records, interleaved, and emits stereo
+    // output based on current Pan value.  A mono track is panned, which allows it to be panned around even after
+    // being recorded (in other words, the stereo balance is not baked into two channels); a stereo track keeps the
+    // image it was recorded with, and its Pan sets the balance between its channels.
     class NowSoundTrackAudioProcessor : public SpatialAudioProcessor
     {
     private:
+        // An additional playhead over this track's stream, with its own position, direction, volume and pan.
+        // Voices are mixed into the track's output in the track's own ProcessBlock, so stacking many voices of
+        // one loop costs no extra graph nodes, measurement, or FFT.
+        // Whether each voice is playing lives in the track's SlotTable; a voice is activated last when adding it, so
+        // the audio thread never sees a half-initialized voice, and a deleted voice's slot is only reused once the
+        // audio thread has acknowledged the deletion, so it is never rewritten while the audio thread renders it.
+        struct TrackVoice
+        {
+            // This voice's position in the loop; only the audio thread touches this once the voice is active.
+            ContinuousTime<AudioSample> LocalLoopTime{ 0 };
+
+            // Plays this voice's position through the track's stream; allocated (on the message thread), for the
+            // track's channel count, when the voice is first added.
+            std::unique_ptr<LoopPlayhead> Playhead;
+
+            // Plays this voice's position when the (mono) track is time stretching; allocated (on the message
+            // thread) when a mono track's voice is first added, whatever the tempo mode, and never replaced.
+            std::unique_ptr<TimeStretcher> Stretcher;
+
+            // Playback direction of this voice.
+            Direction PlaybackDirection{ Direction::Forwards };
+
+            // Volume of this voice, relative to the track's volume; ramps to each new value, like the track's own.
+            // Allocated (on the message thread) when the voice is first added.
+            std::unique_ptr<SmoothedParameter<float>> Volume;
+
+            // Pan of this voice; 0 = left, 0.5 = center, 1 = right.  Ramps and is allocated as Volume is.
+            std::unique_ptr<SmoothedParameter<float>> Pan;
+        };
+
         // Identifier of this Track.
         const TrackId _trackId;
 
@@ -52,7 +90,7 @@ namespace NowSound
         // the shorter loop.
         Duration<Beat> _priorBeatDuration;
 
-        // The stream containing this Track's mono data.
+        // The stream containing this Track's data, with ChannelCount() values (one per channel) in each slice.
         // This may be shared with copied Tracks.
         // The number of samples in this track will exactly equal Math.Ceiling(ExactDuration())
         // -- e.g. in the common case where _beatDuration equals a non-integer number of samples, this stream
@@ -79,14 +117,69 @@ namespace NowSound
         // Playback direction.
         Direction _direction;
 
+        // Voice slots; MagicConstants::MaximumTrackVoiceCount of them, allocated up front so the audio thread
+        // never sees this table change.  A TrackVoiceId is one more than the slot index.
+        SlotTable<TrackVoice> _voices;
+
+        // Scratch buffer for rendering voices, holding a block of each channel in turn; allocated (on the message
+        // thread) when the first voice is added.
+        std::vector<float> _voiceScratch;
+
+        // Plays _localLoopTime through _audioStream.
+        LoopPlayhead _playhead;
+
+        // How this track follows the graph's tempo.  Set by the message thread; any stretchers the mode needs
+        // already exist.
+        std::atomic<NowSoundTrackTempoMode> _tempoMode;
+
+        // Plays _localLoopTime through _audioStream while time stretching; allocated in the constructor for every
+        // mono track, and never replaced, since the audio thread reads it every block.  Only mono tracks time
+        // stretch (multichannel tracks have none); in that mode, multichannel tracks play at the same rate with
+        // varispeed instead.
+        const std::unique_ptr<TimeStretcher> _stretcher;
+
+        // The rate to play the loop at to follow the graph's tempo, in this mode: 1 if fixed, otherwise the
+        // graph's tempo over this track's, within MagicConstants' limits.
+        float PlaybackRate(NowSoundTrackTempoMode tempoMode) const;
+
+        // Can this track time stretch?  Only if mono.
+        bool CanTimeStretch() const { return ChannelCount() == 1; }
+
+        // Render count samples of the loop from position through the given playhead or stretcher, as the tempo
+        // mode and rate require; destinations holds one destination per channel.
+        void RenderLoop(
+            LoopPlayhead& playhead,
+            TimeStretcher* stretcher,
+            ContinuousTime<AudioSample>& position,
+            Direction direction,
+            NowSoundTrackTempoMode tempoMode,
+            float rate,
+            int count,
+            float* const* destinations);
+
+        // Append duration samples of each channel we record, from the corresponding channel of audioBuffer.
+        // Returns false, and logs, if the audio buffer pool ran dry and some of the input was dropped.
+        bool AppendInput(Duration<AudioSample> duration, const juce::AudioSampleBuffer& audioBuffer);
+
+        // Is any voice active?
+        bool HasActiveVoices() const;
+
+        // Add count samples of this voice, rendered into source (one pointer per channel), into left and right,
+        // ramping the voice's volume and pan from start onwards.  Audio thread only.
+        void MixVoice(TrackVoice& voice, float* const* source, int count, Time<AudioSample> start, float* left, float* right);
+
+        // Get the voice with the given ID, which must be active.
+        TrackVoice& Voice(TrackVoiceId voiceId);
+
     public: // Non-exported methods for internal use
 
-        // New constructor
+        // New constructor; records one channel from each source stream's input, starting with inputId, and
+        // prerecords from the source streams.
         NowSoundTrackAudioProcessor(
             NowSoundGraph* graph,
             TrackId trackId,
             AudioInputId inputId,
-            const BufferedSliceStream<AudioSample, float>& sourceStream,
+            const std::vector<const DenseSliceStream<AudioSample, float>*>& sourceStreams,
             float initialVolume,
             float initialPan,
             float beatsPerMinute,
@@ -96,7 +189,7 @@ namespace NowSound
         NowSoundTrackAudioProcessor(TrackId trackId, NowSoundTrackAudioProcessor* other);
 
         // JUCE processing method; this is called on the audio thread and may not make graph changes.
-        virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+        virtual void ProcessBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
 
         void HandleTrackLooping(NowSound::Duration<NowSound::AudioSample>& bufferDuration, juce::AudioSampleBuffer& audioBuffer, NowSound::Duration<NowSound::AudioSample>& completedDuration, juce::MidiBuffer& midiBuffer);
 
@@ -153,6 +246,27 @@ namespace NowSound
         // Can only be called once the track has finished recording and started looping.
         void Rewind();
 
+        // How this track follows the graph's tempo.
+        NowSoundTrackTempoMode TempoMode() const;
+
+        // Set how this track follows the graph's tempo.
+        void SetTempoMode(NowSoundTrackTempoMode tempoMode);
+
+        // Add a voice playing this track's audio, starting offsetBeats ahead of the track's current position.
+        // Can only be called once the track has finished recording and started looping.
+        // Returns TrackVoiceIdUndefined, adding nothing, if all MagicConstants::MaximumTrackVoiceCount voices are in use
+        // (a deleted voice stays in use until the audio thread has finished the block it may be rendering it in).
+        TrackVoiceId AddVoice(ContinuousDuration<Beat> offsetBeats, bool isPlaybackBackwards, float volume, float pan);
+
+        // Set the volume of a voice, relative to the track's volume.
+        void SetVoiceVolume(TrackVoiceId voiceId, float volume);
+
+        // Set the pan of a voice; 0 = left, 0.5 = center, 1 = right.
+        void SetVoicePan(TrackVoiceId voiceId, float pan);
+
+        // Stop and delete a voice; its ID may be reused by a later AddVoice, once the audio thread is done with it.
+        void DeleteVoice(TrackVoiceId voiceId);
+
         // The full time info for this track (to allow just one call per track for all this info).
         // Note that this is not const because it may recalculate histograms etc. when called.
         NowSoundTrackInfo Info();
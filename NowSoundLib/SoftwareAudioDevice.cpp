@@ -0,0 +1,320 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Check.h"
+#include "MagicConstants.h"
+#include "SoftwareAudioDevice.h"
+
+using namespace juce;
+using namespace NowSound;
+
+SoftwareAudioIODevice::SoftwareAudioIODevice(
+    const String& deviceName,
+    const String& typeName,
+    double sampleRate,
+    int bufferSize,
+    int channelCount,
+    const StringArray& loopbackFiles)
+    : AudioIODevice(deviceName, typeName),
+    _sampleRate{ sampleRate },
+    _bufferSize{ bufferSize },
+    _channelCount{ channelCount },
+    _loopbackAudio{},
+    _loopbackPosition{ 0 },
+    _inputBuffer{ channelCount, bufferSize },
+    _outputBuffer{ channelCount, bufferSize },
+    _callback{ nullptr },
+    _callbackMutex{},
+    _isOpen{ false },
+    _stopping{ false },
+    _thread{},
+    _lastError{}
+{
+    Check(sampleRate > 0);
+    Check(bufferSize > 0);
+    Check(channelCount > 0);
+
+    _inputBuffer.clear();
+
+    if (loopbackFiles.isEmpty())
+    {
+        return;
+    }
+
+    // Load all the files now, so the callback thread never waits on the disk.
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::vector<std::unique_ptr<AudioFormatReader>> readers;
+    int loopbackLength = 0;
+    for (const String& fileName : loopbackFiles)
+    {
+        std::unique_ptr<AudioFormatReader> reader{ formatManager.createReaderFor(File{ fileName }) };
+        if (reader.get() == nullptr)
+        {
+            _lastError = "Could not read loopback file " + fileName;
+            return;
+        }
+        loopbackLength = std::max<int>(loopbackLength, (int)std::min<int64>(reader->lengthInSamples, INT32_MAX));
+        readers.push_back(std::move(reader));
+    }
+
+    _loopbackAudio.setSize(channelCount, std::max(loopbackLength, 1));
+    _loopbackAudio.clear();
+
+    // each file's channels fill the next available input channels
+    int channel = 0;
+    for (std::unique_ptr<AudioFormatReader>& reader : readers)
+    {
+        int fileChannelCount = (int)reader->numChannels;
+        int fileLength = (int)std::min<int64>(reader->lengthInSamples, INT32_MAX);
+        AudioBuffer<float> fileAudio(fileChannelCount, std::max(fileLength, 1));
+        reader->read(&fileAudio, 0, fileLength, 0, true, fileChannelCount > 1);
+
+        for (int fileChannel = 0; fileChannel < fileChannelCount && channel < channelCount; fileChannel++, channel++)
+        {
+            _loopbackAudio.copyFrom(channel, 0, fileAudio, fileChannel, 0, fileLength);
+        }
+    }
+}
+
+SoftwareAudioIODevice::~SoftwareAudioIODevice()
+{
+    close();
+}
+
+StringArray SoftwareAudioIODevice::getOutputChannelNames()
+{
+    StringArray names;
+    for (int i = 0; i < _channelCount; i++)
+    {
+        names.add("Output " + String(i + 1));
+    }
+    return names;
+}
+
+StringArray SoftwareAudioIODevice::getInputChannelNames()
+{
+    StringArray names;
+    for (int i = 0; i < _channelCount; i++)
+    {
+        names.add("Input " + String(i + 1));
+    }
+    return names;
+}
+
+// Only the configured rate and size are offered, so the device manager's defaults always pick them.
+Array<double> SoftwareAudioIODevice::getAvailableSampleRates() { return { _sampleRate }; }
+
+Array<int> SoftwareAudioIODevice::getAvailableBufferSizes() { return { _bufferSize }; }
+
+int SoftwareAudioIODevice::getDefaultBufferSize() { return _bufferSize; }
+
+String SoftwareAudioIODevice::open(
+    const BigInteger& inputChannels,
+    const BigInteger& outputChannels,
+    double sampleRate,
+    int bufferSizeSamples)
+{
+    if (_lastError.isNotEmpty())
+    {
+        return _lastError;
+    }
+
+    if ((sampleRate != 0 && sampleRate != _sampleRate)
+        || (bufferSizeSamples != 0 && bufferSizeSamples != _bufferSize))
+    {
+        _lastError = "Software device supports only its configured sample rate and buffer size";
+        return _lastError;
+    }
+
+    _isOpen = true;
+    return {};
+}
+
+void SoftwareAudioIODevice::close()
+{
+    stop();
+    _isOpen = false;
+}
+
+bool SoftwareAudioIODevice::isOpen() { return _isOpen; }
+
+void SoftwareAudioIODevice::start(AudioIODeviceCallback* callback)
+{
+    Check(_isOpen);
+
+    if (callback == nullptr)
+    {
+        return;
+    }
+
+    callback->audioDeviceAboutToStart(this);
+
+    {
+        std::lock_guard<std::mutex> guard(_callbackMutex);
+        _callback = callback;
+    }
+
+    if (!_thread.joinable())
+    {
+        _stopping = false;
+        _thread = std::thread([this]() { Run(); });
+    }
+}
+
+void SoftwareAudioIODevice::stop()
+{
+    if (_thread.joinable())
+    {
+        _stopping = true;
+        _thread.join();
+    }
+
+    AudioIODeviceCallback* lastCallback;
+    {
+        std::lock_guard<std::mutex> guard(_callbackMutex);
+        lastCallback = _callback;
+        _callback = nullptr;
+    }
+
+    if (lastCallback != nullptr)
+    {
+        lastCallback->audioDeviceStopped();
+    }
+}
+
+bool SoftwareAudioIODevice::isPlaying()
+{
+    std::lock_guard<std::mutex> guard(_callbackMutex);
+    return _callback != nullptr;
+}
+
+String SoftwareAudioIODevice::getLastError() { return _lastError; }
+
+int SoftwareAudioIODevice::getCurrentBufferSizeSamples() { return _bufferSize; }
+
+double SoftwareAudioIODevice::getCurrentSampleRate() { return _sampleRate; }
+
+int SoftwareAudioIODevice::getCurrentBitDepth() { return 32; }
+
+BigInteger SoftwareAudioIODevice::getActiveOutputChannels() const
+{
+    BigInteger channels;
+    channels.setRange(0, _channelCount, true);
+    return channels;
+}
+
+BigInteger SoftwareAudioIODevice::getActiveInputChannels() const
+{
+    BigInteger channels;
+    channels.setRange(0, _channelCount, true);
+    return channels;
+}
+
+// One block is always in flight on the output side, as with a double-buffered hardware device.
+int SoftwareAudioIODevice::getOutputLatencyInSamples() { return _bufferSize; }
+
+int SoftwareAudioIODevice::getInputLatencyInSamples() { return 0; }
+
+void SoftwareAudioIODevice::Run()
+{
+    using namespace std::chrono;
+
+    const steady_clock::duration blockDuration =
+        duration_cast<steady_clock::duration>(duration<double>(_bufferSize / _sampleRate));
+    const steady_clock::duration spinDuration = microseconds(MagicConstants::SoftwareDeviceSpinMicroseconds);
+
+    int loopbackLength = _loopbackAudio.getNumSamples();
+    steady_clock::time_point nextBlock = steady_clock::now();
+    while (!_stopping)
+    {
+        // feed the inputs, wrapping around at the end of the loopback audio
+        for (int written = 0; loopbackLength > 0 && written < _bufferSize;)
+        {
+            int count = std::min(_bufferSize - written, loopbackLength - _loopbackPosition);
+            for (int channel = 0; channel < _channelCount; channel++)
+            {
+                _inputBuffer.copyFrom(channel, written, _loopbackAudio, channel, _loopbackPosition, count);
+            }
+            written += count;
+            _loopbackPosition = (_loopbackPosition + count) % loopbackLength;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(_callbackMutex);
+            if (_callback != nullptr)
+            {
+                _callback->audioDeviceIOCallback(
+                    _inputBuffer.getArrayOfReadPointers(),
+                    _channelCount,
+                    _outputBuffer.getArrayOfWritePointers(),
+                    _channelCount,
+                    _bufferSize);
+            }
+        }
+
+        nextBlock += blockDuration;
+        steady_clock::time_point now = steady_clock::now();
+        if (now >= nextBlock)
+        {
+            // The callback overran its budget; like a hardware device, drop the lost time rather than
+            // delivering a burst of late blocks.
+            nextBlock = now;
+            continue;
+        }
+
+        // Sleep for most of the wait, then spin out the rest, since OS sleeps are only good to a millisecond or so.
+        std::this_thread::sleep_until(nextBlock - spinDuration);
+        while (steady_clock::now() < nextBlock)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+const String SoftwareAudioIODeviceType::NullTypeName{ "NowSound Null" };
+
+const String SoftwareAudioIODeviceType::LoopbackTypeName{ "NowSound Loopback" };
+
+SoftwareAudioIODeviceType::SoftwareAudioIODeviceType(
+    double sampleRate,
+    int bufferSize,
+    int channelCount,
+    const StringArray& loopbackFiles)
+    : AudioIODeviceType(loopbackFiles.isEmpty() ? NullTypeName : LoopbackTypeName),
+    _sampleRate{ sampleRate },
+    _bufferSize{ bufferSize },
+    _channelCount{ channelCount },
+    _loopbackFiles{ loopbackFiles }
+{
+}
+
+void SoftwareAudioIODeviceType::scanForDevices() {}
+
+StringArray SoftwareAudioIODeviceType::getDeviceNames(bool) const { return StringArray(getTypeName()); }
+
+int SoftwareAudioIODeviceType::getDefaultDeviceIndex(bool) const { return 0; }
+
+int SoftwareAudioIODeviceType::getIndexOfDevice(AudioIODevice* device, bool) const
+{
+    return device != nullptr && device->getTypeName() == getTypeName() ? 0 : -1;
+}
+
+bool SoftwareAudioIODeviceType::hasSeparateInputsAndOutputs() const { return false; }
+
+AudioIODevice* SoftwareAudioIODeviceType::createDevice(const String& outputDeviceName, const String& inputDeviceName)
+{
+    if ((outputDeviceName.isNotEmpty() && outputDeviceName != getTypeName())
+        || (inputDeviceName.isNotEmpty() && inputDeviceName != getTypeName()))
+    {
+        return nullptr;
+    }
+
+    return new SoftwareAudioIODevice(getTypeName(), getTypeName(), _sampleRate, _bufferSize, _channelCount, _loopbackFiles);
+}
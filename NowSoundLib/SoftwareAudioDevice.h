@@ -0,0 +1,119 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "JuceHeader.h"
+
+namespace NowSound
+{
+    // An audio device with no hardware behind it: a thread that calls back at exactly the pace a real device
+    // with the given sample rate and block size would, so the whole engine can run (and be benchmarked) on
+    // machines with no sound card.
+    //
+    // A null device has silent inputs and discards its outputs.  A loopback device instead feeds its inputs from
+    // a list of audio files, loaded into memory up front so the callback thread never touches the disk; the files'
+    // channels fill the device's input channels in order, and the input loops back to the start when the longest
+    // file ends.  (Files are used at their own sample rates; no resampling is done.)
+    class SoftwareAudioIODevice : public juce::AudioIODevice
+    {
+    private:
+        const double _sampleRate;
+
+        const int _bufferSize;
+
+        const int _channelCount;
+
+        // The audio fed to the inputs; empty for a null device.
+        juce::AudioBuffer<float> _loopbackAudio;
+
+        // The next sample of _loopbackAudio to feed; touched only by the callback thread.
+        int _loopbackPosition;
+
+        // One block of input and output audio; touched only by the callback thread.
+        juce::AudioBuffer<float> _inputBuffer;
+        juce::AudioBuffer<float> _outputBuffer;
+
+        // The callback, while started; guarded by _callbackMutex, so stop() can wait out a callback in progress.
+        juce::AudioIODeviceCallback* _callback;
+        std::mutex _callbackMutex;
+
+        bool _isOpen;
+
+        std::atomic<bool> _stopping;
+
+        std::thread _thread;
+
+        juce::String _lastError;
+
+        // Callback thread body: deliver one block per block duration, until stopped.
+        void Run();
+
+    public:
+        // Construct a device; if loopbackFiles is empty, this is a null device.
+        SoftwareAudioIODevice(
+            const juce::String& deviceName,
+            const juce::String& typeName,
+            double sampleRate,
+            int bufferSize,
+            int channelCount,
+            const juce::StringArray& loopbackFiles);
+
+        ~SoftwareAudioIODevice();
+
+        virtual juce::StringArray getOutputChannelNames() override;
+        virtual juce::StringArray getInputChannelNames() override;
+        virtual juce::Array<double> getAvailableSampleRates() override;
+        virtual juce::Array<int> getAvailableBufferSizes() override;
+        virtual int getDefaultBufferSize() override;
+        virtual juce::String open(
+            const juce::BigInteger& inputChannels,
+            const juce::BigInteger& outputChannels,
+            double sampleRate,
+            int bufferSizeSamples) override;
+        virtual void close() override;
+        virtual bool isOpen() override;
+        virtual void start(juce::AudioIODeviceCallback* callback) override;
+        virtual void stop() override;
+        virtual bool isPlaying() override;
+        virtual juce::String getLastError() override;
+        virtual int getCurrentBufferSizeSamples() override;
+        virtual double getCurrentSampleRate() override;
+        virtual int getCurrentBitDepth() override;
+        virtual juce::BigInteger getActiveOutputChannels() const override;
+        virtual juce::BigInteger getActiveInputChannels() const override;
+        virtual int getOutputLatencyInSamples() override;
+        virtual int getInputLatencyInSamples() override;
+    };
+
+    // The device type offering a single SoftwareAudioIODevice, for registering with an AudioDeviceManager.
+    class SoftwareAudioIODeviceType : public juce::AudioIODeviceType
+    {
+    private:
+        const double _sampleRate;
+        const int _bufferSize;
+        const int _channelCount;
+        const juce::StringArray _loopbackFiles;
+
+    public:
+        // The type names of the null and loopback devices.
+        static const juce::String NullTypeName;
+        static const juce::String LoopbackTypeName;
+
+        // A null device type if loopbackFiles is empty, otherwise a loopback device type.
+        SoftwareAudioIODeviceType(double sampleRate, int bufferSize, int channelCount, const juce::StringArray& loopbackFiles);
+
+        virtual void scanForDevices() override;
+        virtual juce::StringArray getDeviceNames(bool wantInputNames) const override;
+        virtual int getDefaultDeviceIndex(bool forInput) const override;
+        virtual int getIndexOfDevice(juce::AudioIODevice* device, bool asInput) const override;
+        virtual bool hasSeparateInputsAndOutputs() const override;
+        virtual juce::AudioIODevice* createDevice(const juce::String& outputDeviceName, const juce::String& inputDeviceName) override;
+    };
+}
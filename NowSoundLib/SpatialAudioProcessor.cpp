@@ -8,39 +8,59 @@
 #include "SpatialAudioProcessor.h"
 #include "DryWetAudio.h"
 #include "DryWetMixAudioProcessor.h"
+#include "Kernels.h"
 
 using namespace NowSound;
 using namespace std;
 
-SpatialAudioProcessor::SpatialAudioProcessor(NowSoundGraph* graph, const wstring& name, bool isMuted, float initialVolume, float initialPan) 
+SpatialAudioProcessor::SpatialAudioProcessor(NowSoundGraph* graph, const wstring& name, int channelCount, bool isMuted, float initialVolume, float initialPan) 
     : BaseAudioProcessor(graph, name),
-    _isMuted{ false },
-    _volume{ initialVolume },
-    _pan{ initialPan },
+    _channelCount{ channelCount },
+    _pan{ initialPan, ParameterRampSamples(), SmoothingCurve::Linear, MagicConstants::ParameterScheduleCapacity },
+    _volume{ initialVolume, ParameterRampSamples(), SmoothingCurve::Exponential, MagicConstants::ParameterScheduleCapacity },
+    _muteGain{ isMuted ? 0.0f : 1.0f, ParameterRampSamples(), SmoothingCurve::Linear, MagicConstants::ParameterScheduleCapacity },
     _outputProcessor{ new MeasurementAudioProcessor(graph, MakeName(name, L" Output")) },
     _pluginInstances{},
     _pluginNodeIds{},
     _dryWetNodeIds{}
-{}
+{
+    // the graph is stereo only, so a source can have no more channels than that
+    Check(channelCount == 1 || channelCount == 2);
+}
 
-bool SpatialAudioProcessor::IsMuted() const { return _isMuted; }
-void SpatialAudioProcessor::IsMuted(bool isMuted) { _isMuted = isMuted; }
+bool SpatialAudioProcessor::IsMuted() const { return _muteGain.Target() == 0; }
+void SpatialAudioProcessor::IsMuted(bool isMuted) { _muteGain.SetTarget(isMuted ? 0.0f : 1.0f); }
 
-float SpatialAudioProcessor::Pan() const { return _pan; }
+float SpatialAudioProcessor::Pan() const { return _pan.Target(); }
 void SpatialAudioProcessor::Pan(float pan)
 {
     Check(pan >= 0);
     Check(pan <= 1);
 
-    _pan = pan;
+    _pan.SetTarget(pan);
+}
+
+bool SpatialAudioProcessor::SchedulePan(Time<AudioSample> time, float pan)
+{
+    Check(pan >= 0);
+    Check(pan <= 1);
+
+    return _pan.Schedule(time, pan);
 }
 
-float SpatialAudioProcessor::Volume() const { return _volume; }
+float SpatialAudioProcessor::Volume() const { return _volume.Target(); }
 void SpatialAudioProcessor::Volume(float volume)
 {
     Check(volume >= 0);
 
-    _volume = volume;
+    _volume.SetTarget(volume);
+}
+
+bool SpatialAudioProcessor::ScheduleVolume(Time<AudioSample> time, float volume)
+{
+    Check(volume >= 0);
+
+    return _volume.Schedule(time, volume);
 }
 
 const double Pi = std::atan(1) * 4;
@@ -58,7 +78,7 @@ float clamp(float value, float absLimit)
     }
 }
 
-void SpatialAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
+void SpatialAudioProcessor::ProcessBlock(AudioBuffer<float>& audioBuffer, MidiBuffer& midiBuffer)
 {
     Check(audioBuffer.getNumChannels() == 2);
     Check(getTotalNumOutputChannels() == 2);
@@ -66,26 +86,131 @@ void SpatialAudioProcessor::processBlock(AudioBuffer<float>& audioBuffer, MidiBu
 
     int numSamples = audioBuffer.getNumSamples();
 
-    // all input data comes in channel 0
+    // mono input data comes in channel 0; stereo in channels 0 and 1
     float* outputBufferChannel0 = audioBuffer.getWritePointer(0);
     float* outputBufferChannel1 = audioBuffer.getWritePointer(1);
 
-    // Use cosine panner for volume preservation.
-    double angularPosition = _pan * Pi / 2;
-    double leftCoefficient = std::cos(angularPosition);
-    double rightCoefficient = std::sin(angularPosition);
+    // per-sample parameter values and gains, for chunks where any parameter is ramping
+    float pans[ParameterChunkSamples];
+    float volumes[ParameterChunkSamples];
+    float muteGains[ParameterChunkSamples];
+    float leftGains[ParameterChunkSamples];
+    float rightGains[ParameterChunkSamples];
 
-    // Pan each mono sample, if we're not muted.
-    for (int i = 0; i < numSamples; i++)
+    Time<AudioSample> blockStart = Graph()->Clock()->BlockStart();
+    for (int offset = 0; offset < numSamples; offset += ParameterChunkSamples)
     {
-        float value = _isMuted ? 0 : outputBufferChannel0[i];
-        outputBufferChannel0[i] = clamp((float)(leftCoefficient * _volume * value), 0.99f);
-        outputBufferChannel1[i] = clamp((float)(rightCoefficient * _volume * value), 0.99f);
+        int count = std::min(ParameterChunkSamples, numSamples - offset);
+        Time<AudioSample> chunkStart = blockStart + Duration<AudioSample>(offset);
+        bool panVaries = _pan.Advance(chunkStart, count, pans);
+        bool volumeVaries = _volume.Advance(chunkStart, count, volumes);
+        bool muteGainVaries = _muteGain.Advance(chunkStart, count, muteGains);
+
+        float* left = outputBufferChannel0 + offset;
+        float* right = outputBufferChannel1 + offset;
+
+        if (!panVaries && !volumeVaries && !muteGainVaries)
+        {
+            // The usual case: nothing is changing, so pan each sample with constant gains.
+            float leftCoefficient;
+            float rightCoefficient;
+            PanCoefficients(_channelCount, _pan.Current(), &leftCoefficient, &rightCoefficient);
+            float volume = CurrentGain();
+            if (_channelCount == 1)
+            {
+                Kernels::GainPanClamp(left, count, leftCoefficient * volume, rightCoefficient * volume, 0.99f, left, right);
+            }
+            else
+            {
+                // each channel of a stereo source is just scaled in place
+                Kernels::GainPanClamp(left, count, leftCoefficient * volume, leftCoefficient * volume, 0.99f, left, left);
+                Kernels::GainPanClamp(right, count, rightCoefficient * volume, rightCoefficient * volume, 0.99f, right, right);
+            }
+            continue;
+        }
+
+        // Something is ramping, so work out each sample's gains; only a moving pan needs per-sample trig.
+        float leftCoefficient;
+        float rightCoefficient;
+        PanCoefficients(_channelCount, _pan.Current(), &leftCoefficient, &rightCoefficient);
+        for (int i = 0; i < count; i++)
+        {
+            if (panVaries)
+            {
+                PanCoefficients(_channelCount, pans[i], &leftCoefficient, &rightCoefficient);
+            }
+            float volume = (volumeVaries ? volumes[i] : _volume.Current()) * (muteGainVaries ? muteGains[i] : _muteGain.Current());
+            leftGains[i] = leftCoefficient * volume;
+            rightGains[i] = rightCoefficient * volume;
+        }
+        if (_channelCount == 1)
+        {
+            Kernels::GainPanClampPerSample(left, count, leftGains, rightGains, 0.99f, left, right);
+        }
+        else
+        {
+            Kernels::GainPanClampPerSample(left, count, leftGains, leftGains, 0.99f, left, left);
+            Kernels::GainPanClampPerSample(right, count, rightGains, rightGains, 0.99f, right, right);
+        }
     }
 
     // And that's it! audioBuffer is good to go, ship it.
 }
 
+void SpatialAudioProcessor::PanCoefficients(int channelCount, float pan, float* leftCoefficient, float* rightCoefficient)
+{
+    if (channelCount == 1)
+    {
+        double angularPosition = pan * Pi / 2;
+        *leftCoefficient = (float)std::cos(angularPosition);
+        *rightCoefficient = (float)std::sin(angularPosition);
+    }
+    else
+    {
+        *leftCoefficient = std::min(1.0f, 2 * (1 - pan));
+        *rightCoefficient = std::min(1.0f, 2 * pan);
+    }
+}
+
+void SpatialAudioProcessor::AccumulatePanned(const float* mono, int numSamples, float pan, float volume, float* left, float* right)
+{
+    // same cosine panner as ProcessBlock
+    float leftCoefficient;
+    float rightCoefficient;
+    PanCoefficients(1, pan, &leftCoefficient, &rightCoefficient);
+
+    Kernels::GainPanAccumulate(mono, numSamples, leftCoefficient * volume, rightCoefficient * volume, left, right);
+}
+
+void SpatialAudioProcessor::AccumulateBalanced(const float* sourceLeft, const float* sourceRight, int numSamples, float pan, float volume, float* left, float* right)
+{
+    // same balance as ProcessBlock
+    float leftCoefficient;
+    float rightCoefficient;
+    PanCoefficients(2, pan, &leftCoefficient, &rightCoefficient);
+
+    // each source channel goes only to its own side
+    Kernels::GainPanAccumulate(sourceLeft, numSamples, leftCoefficient * volume, 0, left, right);
+    Kernels::GainPanAccumulate(sourceRight, numSamples, 0, rightCoefficient * volume, left, right);
+}
+
+void SpatialAudioProcessor::AccumulatePerSample(const float* sourceLeft, const float* sourceRight, int numSamples, const float* leftGains, const float* rightGains, float* left, float* right)
+{
+    for (int i = 0; i < numSamples; i++)
+    {
+        left[i] += sourceLeft[i] * leftGains[i];
+        right[i] += sourceRight[i] * rightGains[i];
+    }
+}
+
+void SpatialAudioProcessor::ClampOutput(float* channel, int numSamples)
+{
+    for (int i = 0; i < numSamples; i++)
+    {
+        channel[i] = clamp(channel[i], 0.99f);
+    }
+}
+
 void SpatialAudioProcessor::SetNodeIds(juce::AudioProcessorGraph::NodeID inputNodeId, juce::AudioProcessorGraph::NodeID outputNodeId)
 {
     SetNodeId(inputNodeId);
@@ -242,6 +367,18 @@ void SpatialAudioProcessor::SetPluginInstanceDryWet(PluginInstanceIndex index, i
     _pluginInstances[index - 1].DryWet_0_100 = dryWet_0_100;
 }
 
+bool SpatialAudioProcessor::SchedulePluginInstanceDryWet(PluginInstanceIndex index, Time<AudioSample> time, int32_t dryWet_0_100)
+{
+    Check((int)index >= 1);
+    Check((int)index <= _pluginInstances.size());
+    Check(dryWet_0_100 >= 0);
+    Check(dryWet_0_100 <= 100);
+
+    auto dryWetNode = Graph()->JuceGraph().getNodeForId(_dryWetNodeIds[index - 1]);
+    auto dryWetAudio = dynamic_cast<DryWetAudio*>(dryWetNode->getProcessor());
+    return dryWetAudio->ScheduleDryWetLevel(time, dryWet_0_100);
+}
+
 void SpatialAudioProcessor::DeletePluginInstance(PluginInstanceIndex pluginInstanceIndex)
 {
     Check(pluginInstanceIndex >= 1);
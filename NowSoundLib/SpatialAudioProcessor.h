@@ -10,23 +10,27 @@
 #include "NowSoundGraph.h"
 #include "MeasurementAudioProcessor.h"
 #include "MeasurableAudio.h"
+#include "SmoothedParameter.h"
 
 namespace NowSound
 {
-    // Expects one input channel and N output channels; applies appropriate spatialization (at the moment,
-    // stereo panning only), applies a possible internal chain of PluginProgramInstances (instantiated as
+    // Expects one (mono) or two (stereo) channels of source audio and N output channels; applies appropriate
+    // spatialization (at the moment, stereo panning only, or balance for stereo sources), applies a possible internal chain of PluginProgramInstances (instantiated as
     // VSTAudioProcessor nodes), and provides an output MeasurementAudioProcessor for measuring the final audio.
     class SpatialAudioProcessor : public BaseAudioProcessor, public MeasurableAudio
     {
+        // The number of channels of source audio: 1 (mono, in channel 0) or 2 (stereo, in channels 0 and 1).
+        const int _channelCount;
+
         // current pan value; 0 = left, 0.5 = center, 1 = right
-        float _pan;
+        SmoothedParameter<float> _pan;
 
         // current volume; 0 to 1
-        float _volume;
+        SmoothedParameter<float> _volume;
 
-        // is this currently muted?
-        // if so, output audio is zeroed
-        bool _isMuted;
+        // 0 if this is muted (in which case output audio is zeroed), 1 if not; smoothed like the others,
+        // so muting does not click
+        SmoothedParameter<float> _muteGain;
 
         // instantiated plugin instances
         std::vector<NowSoundPluginInstanceInfo> _pluginInstances;
@@ -42,12 +46,16 @@ namespace NowSound
         MeasurementAudioProcessor* _outputProcessor;
 
     public:
-        SpatialAudioProcessor(NowSoundGraph* graph, const std::wstring& name, bool isMuted, float initialVolume, float initialPan);
+        SpatialAudioProcessor(NowSoundGraph* graph, const std::wstring& name, int channelCount, bool isMuted, float initialVolume, float initialPan);
+
+        // The number of channels of source audio.
+        int ChannelCount() const { return _channelCount; }
 
-        // Expect channel 0 to have mono audio data; update all channels with FX-applied output.
+        // Expect channel 0 to have mono audio data (or channels 0 and 1 to have stereo audio data, if ChannelCount()
+        // is 2); update all channels with FX-applied output.
         // Will clamp output values in the range (-1.0, 1.0); volumes above 1.0 are not recommended unless the whole loop is quiet
         // enough not to clip.
-        virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+        virtual void ProcessBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
 
         // Assign both input and output node IDs at once.
         // This allows the processor to do its own internal JUCE graph connections and setup as well.
@@ -62,6 +70,9 @@ namespace NowSound
 
         // Get the output frequency histogram, writing it into this (presumed) vector of floats.
         virtual void GetFrequencies(void* floatBuffer, int floatBufferCapacity) { _outputProcessor->GetFrequencies(floatBuffer, floatBufferCapacity); }
+
+        // Start or stop frequency analysis of the output (post-effects).
+        void SetFrequencyAnalysisEnabled(bool isEnabled) { _outputProcessor->SetFrequencyAnalysisEnabled(isEnabled); }
         
         // True if this is muted.
         // 
@@ -71,13 +82,20 @@ namespace NowSound
         void IsMuted(bool isMuted);
 
         // Get and set the pan value for this track. Values range from 0 (left) to 1 (right).
+        // Changes ramp in over MagicConstants::ParameterSmoothingDuration.
         float Pan() const;
         void Pan(float pan);
 
         // Get and set the volume of this track. 0 = mute; 1 = original input level. Use with caution; clipping can occur.
+        // Changes ramp in over MagicConstants::ParameterSmoothingDuration.
         float Volume() const;
         void Volume(float volume);
 
+        // Start ramping the pan (or volume) to the given value at exactly the given audio time.
+        // Changes must be scheduled in time order, from one thread; returns false if too many are already waiting.
+        bool SchedulePan(Time<AudioSample> time, float pan);
+        bool ScheduleVolume(Time<AudioSample> time, float volume);
+
         // Delete this processor, by dropping all its nodes.
         void Delete();
 
@@ -88,6 +106,10 @@ namespace NowSound
         // Set the dry/wet ratio for the given plugin.
         void SetPluginInstanceDryWet(PluginInstanceIndex pluginInstanceIndex, int dryWet_0_100);
 
+        // Schedule the dry/wet ratio for the given plugin to change at exactly the given audio time.
+        // The instance's info keeps reporting the last ratio set, not scheduled.
+        bool SchedulePluginInstanceDryWet(PluginInstanceIndex pluginInstanceIndex, Time<AudioSample> time, int dryWet_0_100);
+
         // Delete a plugin instance. Will cause all subsequent instances to be renumbered.
         // (e.g. plugin instance IDs are really just indexes into the current sequence, not
         // persistent values.)
@@ -100,6 +122,28 @@ namespace NowSound
         NowSoundPluginInstanceInfo GetPluginInstanceInfo(PluginInstanceIndex pluginInstanceIndex);
 
     protected: 
+        // The gain (volume, and muting) as of the last sample processed.  Audio thread only.
+        float CurrentGain() const { return _volume.Current() * _muteGain.Current(); }
+
+        // The left and right gains for a source of this many channels at this pan: a cosine pan for mono, which
+        // keeps the power constant, and a balance for stereo, which leaves both channels untouched at center.
+        static void PanCoefficients(int channelCount, float pan, float* leftCoefficient, float* rightCoefficient);
+
+        // Cosine-pan the mono data, scaled by volume, and add it into the left and right channels.
+        // Does not clamp; mix everything first, then call ClampOutput.
+        static void AccumulatePanned(const float* mono, int numSamples, float pan, float volume, float* left, float* right);
+
+        // Balance the stereo data, scaled by volume, and add it into the left and right channels.
+        // Does not clamp; mix everything first, then call ClampOutput.
+        static void AccumulateBalanced(const float* sourceLeft, const float* sourceRight, int numSamples, float pan, float volume, float* left, float* right);
+
+        // Scale each sample of sourceLeft and sourceRight by its own gain, and add it into the left and right
+        // channels; for mono data, pass the same source twice.  For ramping gains; does not clamp.
+        static void AccumulatePerSample(const float* sourceLeft, const float* sourceRight, int numSamples, const float* leftGains, const float* rightGains, float* left, float* right);
+
+        // Clamp each value in the channel to the same (-0.99, 0.99) range that ProcessBlock does.
+        static void ClampOutput(float* channel, int numSamples);
+
         static std::wstring MakeName(const wchar_t* label, int id)
         {
             std::wstringstream wstr;
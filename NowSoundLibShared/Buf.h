@@ -9,46 +9,83 @@
 namespace NowSound
 {
     // Buffer of data; owns the data contained within it.
+    // If the data was carved out of a MemoryArena, the arena owns the storage; the OwningBuf still owns the
+    // exclusive right to use it, but will not delete it.
     template<typename T>
     class OwningBuf
     {
         int _id;
         std::unique_ptr<T> _data;
         int _length;
+        // False if _data belongs to an arena and must not be deleted.
+        bool _ownsStorage;
+#ifdef _DEBUG
+        // Allocation generation of this buffer, stamped by BufferAllocator; lets Free() detect stale double-frees
+        // in constant time.
+        int _generation = 0;
+#endif
 
     public:
-        OwningBuf() = delete;
+        // Create an empty OwningBuf (ID 0, no data); BufferAllocator returns one of these when it has no buffer to give.
+        OwningBuf() : _id(0), _data(), _length(0), _ownsStorage(true) { }
 
         // Create a new OwningBuf with a newly allocated T[length] backing store.
         OwningBuf(int id, int length)
-            : _id(id), _data(std::unique_ptr<T>(new T[length])), _length(length)
+            : _id(id), _data(std::unique_ptr<T>(new T[length])), _length(length), _ownsStorage(true)
         {
             Check(length > 0);
         }
 
         // Create an OwningBuf which takes ownership of rawBuffer (which had better have the given length).
-        OwningBuf(int id, int length, T* rawBuffer)
-            : _id(id), _data(std::unique_ptr<T>(rawBuffer)), _length(length)
+        // If ownsStorage is false, rawBuffer belongs to an arena and will not be deleted.
+        OwningBuf(int id, int length, T* rawBuffer, bool ownsStorage = true)
+            : _id(id), _data(std::unique_ptr<T>(rawBuffer)), _length(length), _ownsStorage(ownsStorage)
         {
             Check(length > 0);
         }
 
         // Move constructor.
         OwningBuf(OwningBuf&& other)
-            : _id(other._id), _data(std::move(other._data)), _length(other._length)
+            : _id(other._id), _data(std::move(other._data)), _length(other._length), _ownsStorage(other._ownsStorage)
         {
+#ifdef _DEBUG
+            _generation = other._generation;
+#endif
             Check((_data == nullptr) == (_length == 0));
 
             Check(other._data == nullptr);
             other._length = 0;
         }
 
+        ~OwningBuf()
+        {
+            if (!_ownsStorage)
+            {
+                _data.release();
+            }
+        }
+
         // ID of this owning buffer; primarily for debugging.
         int Id() const { return _id; }
         // Borrowed pointer to the actual data.
         T* Data() const { return _data.get(); }
         // Count of T values in the actual data, NOT count of individual slices.
         int Length() const { return _length; }
+        // Is this an empty buffer, with no data at all?
+        bool IsEmpty() const { return _data == nullptr; }
+
+#ifdef _DEBUG
+        // Allocation generation; only tracked in debug builds.
+        int Generation() const { return _generation; }
+        void SetGeneration(int generation) { _generation = generation; }
+#endif
+
+        // Give up ownership of the data, leaving this buffer empty; used by BufferAllocator to recycle storage.
+        T* Release()
+        {
+            _length = 0;
+            return _data.release();
+        }
 
         bool operator==(const OwningBuf<T>& other) const
         {
@@ -57,9 +94,17 @@ namespace NowSound
 
         OwningBuf<T>& operator=(OwningBuf<T>&& other)
         {
+            if (!_ownsStorage)
+            {
+                _data.release();
+            }
             _id = other._id;
             _data = std::move(other._data);
             _length = other._length;
+            _ownsStorage = other._ownsStorage;
+#ifdef _DEBUG
+            _generation = other._generation;
+#endif
 
             Check((_data == nullptr) == (_length == 0));
             Check(other._data == nullptr);
@@ -3,84 +3,441 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
 #include "stdafx.h"
 
 #include "Buf.h"
+#include "MemoryArena.h"
 
 namespace NowSound
 {
+    // How a BufferAllocator sizes and grows its pool.
+    struct BufferAllocatorPolicy
+    {
+        // The number of values in each buffer (e.g. floats, for a float allocator); a stream of SliceSize() values
+        // per frame uses only a whole number of frames of each buffer.
+        int BufferLength;
+
+        // The number of buffers to pre-allocate.
+        int InitialBufferCount;
+
+        // The maximum number of buffers the allocator will ever create; sizes the free list node table.
+        int MaximumBufferCount;
+
+        // The number of free buffers the refill thread tries to maintain; 0 = no refill thread.
+        int LowWaterMark;
+
+        // The number of buffers the refill thread creates at a time when the free list is below LowWaterMark.
+        int GrowthStep;
+
+        // The number of buffers carved out of a single pre-faulted MemoryArena; 0 = no arena, all buffers on the heap.
+        // Buffers beyond this count are heap-allocated.
+        int ArenaBufferCount;
+
+        // Should the arena try to use large (huge) pages?
+        bool UseLargePages;
+
+        // Should the arena try to lock its pages into physical memory?
+        bool LockArenaPages;
+
+        BufferAllocatorPolicy(
+            int bufferLength,
+            int initialBufferCount,
+            int maximumBufferCount,
+            int lowWaterMark,
+            int growthStep,
+            int arenaBufferCount = 0,
+            bool useLargePages = false,
+            bool lockArenaPages = false)
+            : BufferLength{ bufferLength },
+            InitialBufferCount{ initialBufferCount },
+            MaximumBufferCount{ maximumBufferCount },
+            LowWaterMark{ lowWaterMark },
+            GrowthStep{ growthStep },
+            ArenaBufferCount{ arenaBufferCount },
+            UseLargePages{ useLargePages },
+            LockArenaPages{ lockArenaPages }
+        {
+        }
+    };
+
     // Allocate T[] of a predetermined size, and support returning such T[] to a free list.
+    //
+    // The free list is a lock-free stack threaded through a pre-sized table of nodes, one node per buffer ID;
+    // the head of the stack carries a tag which is bumped on every push and pop, to avoid ABA problems.
+    // Allocate() and Free() therefore never lock and never touch the heap as long as the free list is nonempty,
+    // so they are safe to call from the audio thread.
+    //
+    // If lowWaterMark is nonzero, a background refill thread keeps at least that many buffers on the free list,
+    // so that growth happens off the audio thread.  If the refill thread falls behind, Allocate() will still
+    // hand out unused arena buffers, but never heap-allocates; with no refill thread, Allocate() grows the pool
+    // itself.  Either way, once no buffer can be had, Allocate() returns an empty buffer (and counts the failure)
+    // rather than failing; callers must check for this.
+    //
+    // If the policy has a nonzero ArenaBufferCount, the first that many buffers are carved out of one contiguous,
+    // pre-faulted (and optionally locked, large-page) MemoryArena rather than being separate heap allocations.
+    //
+    // In debug builds, each node tracks the generation of its buffer's current allocation (odd = live, even = free),
+    // and each OwningBuf carries the generation it was allocated with, so Free() catches double-frees in O(1).
     template<typename T>
     class BufferAllocator
     {
+    public:
+        // Default maximum number of buffers; the node table costs only a pointer and an index per buffer.
+        static constexpr int DefaultMaximumNumberOfBuffers = 4096;
+
+        // How often the refill thread checks the low-water mark.
+        static constexpr int RefillIntervalMsec = 10;
+
     private:
-        int _latestBufferId = 1; // 0 = empty buf
+        // Sentinel node index for the end of the free list.
+        static constexpr int32_t EndOfList = -1;
+
+        // Node in the free list; node i holds the buffer with ID i + 1 whenever that buffer is free.
+        struct FreeListNode
+        {
+            // The buffer's storage, valid only while the buffer is on the free list.
+            T* Data;
+
+            // Index of the next free node, or EndOfList.
+            std::atomic<int32_t> Next;
+
+#ifdef _DEBUG
+            // Allocation generation; odd while the buffer is live, even while it is free.
+            std::atomic<int> Generation;
+#endif
+        };
+
+        // Pack a node index and a tag into a single atomically updatable head value.
+        static uint64_t PackHead(int32_t index, uint32_t tag) { return ((uint64_t)tag << 32) | (uint32_t)index; }
+        static int32_t HeadIndex(uint64_t head) { return (int32_t)(uint32_t)head; }
+        static uint32_t HeadTag(uint64_t head) { return (uint32_t)(head >> 32); }
+
+        // The ID of the most recently created buffer; 0 = empty buf, so IDs start at 1.
+        std::atomic<int> _latestBufferId;
 
     public:
         // The number of T in a buffer from this allocator.
         const int BufferLength;
 
+        // The maximum number of buffers this allocator will ever create.
+        const int MaximumNumberOfBuffers;
+
+        // The number of free buffers the refill thread tries to maintain; 0 = no refill thread.
+        const int LowWaterMark;
+
+        // The number of buffers the refill thread creates at a time.
+        const int GrowthStep;
+
+        // The number of buffers (IDs 1 through ArenaBufferCount) that live in _arena.
+        const int ArenaBufferCount;
+
     private:
-        // Free list; we recycle from here if possible.
-        // This allocator owns all these buffers.
-        std::vector<OwningBuf<T>> _freeList;
+        // Backing store for the first ArenaBufferCount buffers; null if ArenaBufferCount is 0.
+        std::unique_ptr<MemoryArena> _arena;
+
+        // Free list nodes, indexed by buffer ID - 1; sized once at construction and never reallocated.
+        // This allocator owns the data of all nodes which are on the free list.
+        std::unique_ptr<FreeListNode[]> _nodes;
+
+        // Head of the free list: tag in the high 32 bits, node index in the low 32 bits.
+        std::atomic<uint64_t> _freeListHead;
+
+        // Number of buffers currently on the free list.
+        std::atomic<int> _freeListCount;
 
         // Total number of buffers we have ever allocated.
-        int _totalBufferCount;
+        std::atomic<int> _totalBufferCount;
+
+        // Number of buffers currently allocated and not yet freed.
+        std::atomic<int> _liveBufferCount;
+
+        // High-water mark of _liveBufferCount.
+        std::atomic<int> _peakLiveBufferCount;
+
+        // Number of Allocate() calls which found no buffer to hand out, and returned an empty one.
+        std::atomic<int> _failedAllocationCount;
+
+        // Set to stop the refill thread.
+        std::atomic<bool> _stopRefilling;
+
+        // Background thread keeping the free list above LowWaterMark; not started if LowWaterMark is 0.
+        std::thread _refillThread;
+
+        // Push the buffer with the given ID and data onto the free list.
+        void Push(int id, T* data)
+        {
+            int32_t index = id - 1;
+            _nodes[index].Data = data;
+
+            // count before pushing, so the count never goes negative when a concurrent Pop() wins the race
+            _freeListCount++;
+
+            uint64_t head = _freeListHead.load(std::memory_order_relaxed);
+            uint64_t newHead;
+            do
+            {
+                _nodes[index].Next.store(HeadIndex(head), std::memory_order_relaxed);
+                newHead = PackHead(index, HeadTag(head) + 1);
+            } while (!_freeListHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Pop a node off the free list, returning its index, or EndOfList if the free list is empty.
+        int32_t Pop()
+        {
+            uint64_t head = _freeListHead.load(std::memory_order_acquire);
+            uint64_t newHead;
+            do
+            {
+                if (HeadIndex(head) == EndOfList)
+                {
+                    return EndOfList;
+                }
+                // If another thread pops this node first, the tag will have changed and the exchange will fail.
+                int32_t next = _nodes[HeadIndex(head)].Next.load(std::memory_order_relaxed);
+                newHead = PackHead(next, HeadTag(head) + 1);
+            } while (!_freeListHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire));
+
+            _freeListCount--;
+            return HeadIndex(head);
+        }
+
+        // Is the buffer with this ID carved out of the arena?
+        bool IsArenaBuffer(int id) const { return id <= ArenaBufferCount; }
+
+        // Reserve the next unused buffer ID, as long as it is no greater than limit; returns 0 if there is none.
+        // _latestBufferId only advances by compare-and-swap, so racing threads can never push it past the limit.
+        int ReserveBufferId(int limit)
+        {
+            int latest = _latestBufferId.load();
+            do
+            {
+                if (latest >= limit)
+                {
+                    return 0;
+                }
+            } while (!_latestBufferId.compare_exchange_weak(latest, latest + 1));
+
+            return latest + 1;
+        }
+
+        // Create a brand new buffer (from the arena if there is room, else on the heap), returning its ID;
+        // returns 0, creating nothing, if that would take the buffer count past limit.
+        int CreateBuffer(T** data, int limit)
+        {
+            int id = ReserveBufferId(limit);
+            if (id == 0)
+            {
+                return 0;
+            }
+
+            if (IsArenaBuffer(id))
+            {
+                *data = (T*)_arena->Base() + ((size_t)(id - 1) * BufferLength);
+            }
+            else
+            {
+                *data = new T[BufferLength];
+            }
+            _totalBufferCount++;
+            return id;
+        }
+
+        // Refill thread body; tops up the free list whenever it falls below LowWaterMark.
+        void RefillLoop()
+        {
+            while (!_stopRefilling)
+            {
+                bool exhausted = false;
+                while (_freeListCount < LowWaterMark && !exhausted && !_stopRefilling)
+                {
+                    for (int i = 0; i < GrowthStep; i++)
+                    {
+                        T* data;
+                        int id = CreateBuffer(&data, MaximumNumberOfBuffers);
+                        if (id == 0)
+                        {
+                            exhausted = true;
+                            break;
+                        }
+                        Push(id, data);
+                    }
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(RefillIntervalMsec));
+            }
+        }
 
     public:
-        // bufferLength is the number of values in each buffer; initialNumberOfBuffers is the number of buffers to pre-allocate
-        BufferAllocator(int bufferLength, int initialNumberOfBuffers)
-            : BufferLength(bufferLength)
+        // Construct an allocator with the given pool policy; starts a refill thread if policy.LowWaterMark is nonzero.
+        BufferAllocator(const BufferAllocatorPolicy& policy)
+            : _latestBufferId{ 0 },
+            BufferLength{ policy.BufferLength },
+            MaximumNumberOfBuffers{ policy.MaximumBufferCount },
+            LowWaterMark{ policy.LowWaterMark },
+            GrowthStep{ policy.GrowthStep },
+            ArenaBufferCount{ policy.ArenaBufferCount },
+            _arena{ policy.ArenaBufferCount > 0
+                ? new MemoryArena((size_t)policy.ArenaBufferCount * policy.BufferLength * sizeof(T), policy.UseLargePages, policy.LockArenaPages)
+                : nullptr },
+            _nodes{ new FreeListNode[policy.MaximumBufferCount] },
+            _freeListHead{ PackHead(EndOfList, 0) },
+            _freeListCount{ 0 },
+            _totalBufferCount{ 0 },
+            _liveBufferCount{ 0 },
+            _peakLiveBufferCount{ 0 },
+            _failedAllocationCount{ 0 },
+            _stopRefilling{ false }
         {
-            Check(bufferLength > 0);
-            Check(initialNumberOfBuffers > 0);
+            Check(BufferLength > 0);
+            Check(policy.InitialBufferCount > 0);
+            Check(policy.InitialBufferCount <= MaximumNumberOfBuffers);
+            Check(LowWaterMark >= 0);
+            Check(LowWaterMark <= MaximumNumberOfBuffers);
+            Check(GrowthStep > 0);
+            Check(ArenaBufferCount >= 0);
+            Check(ArenaBufferCount <= MaximumNumberOfBuffers);
+
+            for (int i = 0; i < MaximumNumberOfBuffers; i++)
+            {
+                _nodes[i].Data = nullptr;
+                _nodes[i].Next.store(EndOfList, std::memory_order_relaxed);
+#ifdef _DEBUG
+                _nodes[i].Generation.store(0, std::memory_order_relaxed);
+#endif
+            }
 
             // Prepopulate the free list as a way of preallocating.
-            for (int i = 0; i < initialNumberOfBuffers; i++)
+            for (int i = 0; i < policy.InitialBufferCount; i++)
+            {
+                T* data;
+                int id = CreateBuffer(&data, MaximumNumberOfBuffers);
+                Check(id != 0);
+                Push(id, data);
+            }
+
+            if (LowWaterMark > 0)
             {
-                OwningBuf<T> buf(_latestBufferId++, bufferLength);
-                _freeList.push_back(std::move(buf));
+                _refillThread = std::thread([this]() { RefillLoop(); });
             }
-            _totalBufferCount = initialNumberOfBuffers;
+        }
+
+        // bufferLength is the number of values in each buffer; initialNumberOfBuffers is the number of buffers to pre-allocate;
+        // maximumNumberOfBuffers sizes the free list node table; lowWaterMark (if nonzero) starts a refill thread.
+        BufferAllocator(int bufferLength, int initialNumberOfBuffers, int maximumNumberOfBuffers = DefaultMaximumNumberOfBuffers, int lowWaterMark = 0)
+            : BufferAllocator(BufferAllocatorPolicy(bufferLength, initialNumberOfBuffers, maximumNumberOfBuffers, lowWaterMark, 1))
+        {
         }
 
         // no copying this
         BufferAllocator(const BufferAllocator&) = delete;
 
+        // Stops the refill thread and deletes all buffers on the free list.
+        // All buffers allocated from this allocator must have been freed or destroyed first.
+        virtual ~BufferAllocator()
+        {
+            _stopRefilling = true;
+            if (_refillThread.joinable())
+            {
+                _refillThread.join();
+            }
+
+            for (int32_t index = Pop(); index != EndOfList; index = Pop())
+            {
+                if (!IsArenaBuffer(index + 1))
+                {
+                    delete[] _nodes[index].Data;
+                }
+                _nodes[index].Data = nullptr;
+            }
+        }
+
         // Number of bytes reserved by this allocator; will increase if free list runs out, and includes free space.
-        long TotalReservedSpace() { return _totalBufferCount * BufferLength * sizeof(T); }
+        long TotalReservedSpace() const { return _totalBufferCount * BufferLength * sizeof(T); }
 
         // Number of bytes held in buffers on the free list.
-        long TotalFreeListSpace() { return _freeList.Count * BufferLength * sizeof(T); }
+        long TotalFreeListSpace() const { return _freeListCount * BufferLength * sizeof(T); }
+
+        // Number of buffers currently on the free list.
+        int FreeListCount() const { return _freeListCount; }
+
+        // Number of buffers currently allocated and not yet freed.
+        int LiveBufferCount() const { return _liveBufferCount; }
+
+        // Largest number of buffers that have ever been live at once.
+        int PeakLiveBufferCount() const { return _peakLiveBufferCount; }
+
+        // Total number of buffers ever created, live or free.
+        int TotalBufferCount() const { return _totalBufferCount; }
+
+        // Number of Allocate() calls which returned an empty buffer because no buffer could be had.
+        int FailedAllocationCount() const { return _failedAllocationCount; }
+
+        // The arena backing the first ArenaBufferCount buffers, or null if there is none.
+        const MemoryArena* Arena() const { return _arena.get(); }
 
         // Allocate a new Buf<T>; this is an owning Buf<T>.
-        // TODO: needs thread safety or contractual thread affinity
+        // Returns an empty buffer (see OwningBuf<T>::IsEmpty()) if the free list is empty and no buffer can be
+        // created on this thread.
+        // Lock-free; may be called from any thread, including the audio thread.
         OwningBuf<T> Allocate()
         {
-            if (_freeList.size() == 0)
+            int id;
+            T* data;
+            int32_t index = Pop();
+            if (index == EndOfList)
             {
-                _totalBufferCount++;
-                OwningBuf<T> result(_latestBufferId++, BufferLength);
-                return result;
+                // The refill thread (if any) fell behind.  If there is a refill thread, this may well be the audio
+                // thread, so only take what the arena has left; otherwise grow the pool on this thread.
+                id = CreateBuffer(&data, LowWaterMark > 0 ? ArenaBufferCount : MaximumNumberOfBuffers);
+                if (id == 0)
+                {
+                    _failedAllocationCount++;
+                    return OwningBuf<T>();
+                }
             }
             else
             {
-                OwningBuf<T> ret(std::move(_freeList[_freeList.size() - 1]));
-                _freeList.erase(_freeList.end() - 1);
-                return ret;
+                id = index + 1;
+                data = _nodes[index].Data;
+                _nodes[index].Data = nullptr;
+            }
+
+            int live = ++_liveBufferCount;
+            int peak = _peakLiveBufferCount;
+            while (live > peak && !_peakLiveBufferCount.compare_exchange_weak(peak, live))
+            {
             }
+
+            OwningBuf<T> result(id, BufferLength, data, /*ownsStorage:*/ !IsArenaBuffer(id));
+#ifdef _DEBUG
+            result.SetGeneration(++_nodes[id - 1].Generation);
+#endif
+            return result;
         }
 
         // Free the given buffer back to the pool.
+        // Lock-free; may be called from any thread, including the audio thread.
         virtual void Free(OwningBuf<T>&& buffer)
         {
-            // must not already be on free list or we have a bug
-            for (const OwningBuf<T>& t : _freeList)
-            {
-                Check(!(buffer == t)); // TODO: Buf<T>::operator!=
-            }
-            _freeList.push_back(std::move(buffer));
+            // must have come from this allocator
+            Check(buffer.Id() > 0 && buffer.Id() <= _latestBufferId);
+            Check(buffer.Length() == BufferLength);
+#ifdef _DEBUG
+            // must be the current allocation of this buffer, not already freed, or we have a bug
+            int generation = buffer.Generation();
+            Check((generation & 1) == 1);
+            Check(_nodes[buffer.Id() - 1].Generation.compare_exchange_strong(generation, generation + 1));
+#endif
+
+            _liveBufferCount--;
+            int id = buffer.Id();
+            Push(id, buffer.Release());
         }
     };
 }
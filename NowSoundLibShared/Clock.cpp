@@ -14,7 +14,8 @@ using namespace winrt::Windows::Foundation;
 NowSound::Clock::Clock(int sampleRateHz, int channelCount)
     : _sampleRateHz(sampleRateHz),
     _channelCount(channelCount),
-    _now(0)
+    _now(0),
+    _blockStart(0)
 {
 }
 
@@ -29,6 +29,9 @@ namespace NowSound
         // The number of samples since the beginning of Holofunk; incremented by the audio quantum.
         Time<AudioSample> _now;
 
+        // The value of _now when the current audio block started; set by the audio thread before processing.
+        Time<AudioSample> _blockStart;
+
     public:
         // Number of 100ns units in one second; useful for constructing Windows::Foundation::TimeSpans.
         static const long TicksPerSecond;
@@ -36,6 +39,9 @@ namespace NowSound
         // Advance this clock from an AudioGraph thread.
         void AdvanceFromAudioGraph(Duration<AudioSample> duration);
 
+        // Note that the audio graph is starting a block, at the current time.
+        void BeginAudioBlock() { _blockStart = _now; }
+
         int SampleRateHz() const { return _sampleRateHz; }
 
         int ChannelCount() const { return _channelCount; }
@@ -44,6 +50,10 @@ namespace NowSound
 
         Time<AudioSample> Now() { return _now; }
 
+        // The time of the first sample of the block being processed (Now() may already have advanced past it,
+        // depending on where in the graph the caller is).  Audio thread only.
+        Time<AudioSample> BlockStart() const { return _blockStart; }
+
         // TODO: is this correct for rounding up? Right now it doesn't, so does this drop fractional samples?
         Duration<AudioSample> TimeToRoundedUpSamples(ContinuousDuration<Second> seconds) { return static_cast<int64_t>(std::ceil(SampleRateHz() * seconds.Value())); }
 
@@ -0,0 +1,186 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "Check.h"
+#include "EventLog.h"
+
+using namespace NowSound;
+
+// Source of EventLog serial numbers.
+static std::atomic<uint64_t> s_nextEventLogSerial{ 1 };
+
+// The ring the current thread last logged to, and the log it belongs to.  A plain pointer and integer, so
+// reading and writing these never allocates, even on a thread's first use.
+static thread_local uint64_t t_eventLogSerial{ 0 };
+static thread_local SpscRing<LogEvent>* t_eventLogRing{ nullptr };
+
+EventLog::EventLog(int threadCapacity, int eventsPerThread)
+    : _formats{},
+    _formatMutex{},
+    _rings{},
+    _claimedRingCount{ 0 },
+    _serial{ s_nextEventLogSerial++ },
+    _droppedCount{ 0 },
+    _reportedDroppedCount{ 0 },
+    _drainBuffer{},
+    _formattingThread{},
+    _stopFormatting{ false }
+{
+    Check(threadCapacity > 0);
+
+    for (int i = 0; i < threadCapacity; i++)
+    {
+        _rings.push_back(std::unique_ptr<SpscRing<LogEvent>>(new SpscRing<LogEvent>(eventsPerThread)));
+    }
+    _drainBuffer.reserve((size_t)threadCapacity * eventsPerThread);
+}
+
+EventLog::~EventLog()
+{
+    StopFormatting();
+}
+
+int EventLog::RegisterFormat(const std::wstring& format)
+{
+    std::lock_guard<std::mutex> guard(_formatMutex);
+
+    _formats.push_back(format);
+    return (int)_formats.size() - 1;
+}
+
+SpscRing<LogEvent>* EventLog::ThreadRing()
+{
+    if (t_eventLogSerial == _serial)
+    {
+        return t_eventLogRing;
+    }
+
+    // This thread has not logged here before; claim the next ring (lock-free, since the rings already exist).
+    int ringIndex = _claimedRingCount.load(std::memory_order_relaxed);
+    do
+    {
+        if (ringIndex == (int)_rings.size())
+        {
+            return nullptr;
+        }
+    } while (!_claimedRingCount.compare_exchange_weak(ringIndex, ringIndex + 1, std::memory_order_acq_rel));
+
+    t_eventLogSerial = _serial;
+    t_eventLogRing = _rings[ringIndex].get();
+    return t_eventLogRing;
+}
+
+void EventLog::Append(const LogEvent& event)
+{
+    SpscRing<LogEvent>* ring = ThreadRing();
+    if (ring == nullptr || ring->Push(&event, 1) == 0)
+    {
+        _droppedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::wstring EventLog::Format(const LogEvent& event) const
+{
+    Check(event.FormatId >= 0 && event.FormatId < (int)_formats.size());
+    const std::wstring& format = _formats[event.FormatId];
+
+    std::wstringstream wstr{};
+    int argument = 0;
+    size_t position = 0;
+    while (true)
+    {
+        size_t placeholder = format.find(L"{}", position);
+        if (placeholder == std::wstring::npos || argument == event.ArgumentCount)
+        {
+            wstr << format.substr(position);
+            break;
+        }
+
+        wstr << format.substr(position, placeholder - position);
+        if (event.RealArgumentMask & (1 << argument))
+        {
+            wstr << event.Arguments[argument].Real;
+        }
+        else
+        {
+            wstr << event.Arguments[argument].Integer;
+        }
+        argument++;
+        position = placeholder + 2;
+    }
+    return wstr.str();
+}
+
+int EventLog::Drain(const std::function<void(const std::wstring&)>& sink)
+{
+    // Pop whatever each ring holds now; anything logged after this drain starts waits for the next one.
+    _drainBuffer.clear();
+    int claimedRingCount = _claimedRingCount.load(std::memory_order_acquire);
+    for (int i = 0; i < claimedRingCount; i++)
+    {
+        SpscRing<LogEvent>& ring = *_rings[i];
+        size_t start = _drainBuffer.size();
+        _drainBuffer.resize(start + ring.Capacity());
+        int popped = ring.Pop(_drainBuffer.data() + start, ring.Capacity());
+        _drainBuffer.resize(start + popped);
+    }
+
+    // each ring is in order already, but the threads' events interleave
+    std::stable_sort(_drainBuffer.begin(), _drainBuffer.end(), [](const LogEvent& a, const LogEvent& b)
+    {
+        return a.Timestamp < b.Timestamp;
+    });
+
+    {
+        std::lock_guard<std::mutex> guard(_formatMutex);
+        for (const LogEvent& event : _drainBuffer)
+        {
+            sink(Format(event));
+        }
+    }
+
+    uint64_t droppedCount = DroppedCount();
+    if (droppedCount != _reportedDroppedCount)
+    {
+        std::wstringstream wstr{};
+        wstr << L"EventLog: dropped " << (droppedCount - _reportedDroppedCount) << L" events";
+        sink(wstr.str());
+        _reportedDroppedCount = droppedCount;
+    }
+
+    return (int)_drainBuffer.size();
+}
+
+void EventLog::StartFormatting(std::function<void(const std::wstring&)> sink, int intervalMilliseconds)
+{
+    Check(!_formattingThread.joinable());
+    Check(intervalMilliseconds > 0);
+
+    _stopFormatting = false;
+    _formattingThread = std::thread([this, sink, intervalMilliseconds]()
+    {
+        while (!_stopFormatting)
+        {
+            Drain(sink);
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMilliseconds));
+        }
+
+        // pick up anything logged while we slept
+        Drain(sink);
+    });
+}
+
+void EventLog::StopFormatting()
+{
+    if (_formattingThread.joinable())
+    {
+        _stopFormatting = true;
+        _formattingThread.join();
+    }
+}
@@ -0,0 +1,153 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "stdafx.h"
+
+#include "stdint.h"
+
+#include "SpscRing.h"
+#include "TimingHistogram.h"
+
+namespace NowSound
+{
+    // One logged event: which format to use, and the values to fill it in with.
+    struct LogEvent
+    {
+        // The most arguments one event can carry.
+        static constexpr int MaximumArgumentCount = 4;
+
+        // When the event was logged, in CycleTimer ticks.
+        uint64_t Timestamp;
+
+        // The ID returned by EventLog::RegisterFormat.
+        int32_t FormatId;
+
+        // How many of Arguments are in use.
+        int32_t ArgumentCount;
+
+        // Bit i is set if argument i is Real rather than Integer.
+        int32_t RealArgumentMask;
+
+        union
+        {
+            int64_t Integer;
+            double Real;
+        } Arguments[MaximumArgumentCount];
+    };
+
+    // A log which any thread, including the audio thread, may write to without locking or allocating.
+    //
+    // Messages are logged as fixed-size binary LogEvents: a format registered in advance (from a thread that
+    // may allocate), plus up to four numeric arguments.  Each logging thread gets its own SpscRing of events,
+    // claimed from a preallocated pool the first time the thread logs; a formatting thread (or a direct call to
+    // Drain) turns the events into text, in timestamp order, and hands them on.  Events are dropped, and counted,
+    // if a ring is full or every ring is claimed; rings stay claimed by their threads for the life of the log.
+    class EventLog
+    {
+    private:
+        // The registered formats, indexed by format ID; each "{}" in a format is replaced by the next argument.
+        std::vector<std::wstring> _formats;
+
+        // Guards _formats, which is only touched by non-real-time threads.
+        std::mutex _formatMutex;
+
+        // One ring per logging thread.
+        std::vector<std::unique_ptr<SpscRing<LogEvent>>> _rings;
+
+        // How many of _rings have been claimed by threads.
+        std::atomic<int> _claimedRingCount;
+
+        // Distinguishes this log from any earlier one at the same address, for threads' cached ring lookups.
+        const uint64_t _serial;
+
+        // Events which did not fit.
+        std::atomic<uint64_t> _droppedCount;
+
+        // The dropped count as of the last drain; touched only by the draining thread.
+        uint64_t _reportedDroppedCount;
+
+        // The events popped by the current drain, for sorting; touched only by the draining thread.
+        std::vector<LogEvent> _drainBuffer;
+
+        // The thread formatting events, if started.
+        std::thread _formattingThread;
+
+        std::atomic<bool> _stopFormatting;
+
+        // Find or claim the calling thread's ring; null if every ring is claimed by other threads.
+        SpscRing<LogEvent>* ThreadRing();
+
+        // Append the event to the calling thread's ring.
+        void Append(const LogEvent& event);
+
+        // Format one event as text.
+        std::wstring Format(const LogEvent& event) const;
+
+        template<typename T>
+        static void AddArgument(LogEvent& event, T value)
+        {
+            if constexpr (std::is_floating_point<T>::value)
+            {
+                event.Arguments[event.ArgumentCount].Real = (double)value;
+                event.RealArgumentMask |= 1 << event.ArgumentCount;
+            }
+            else
+            {
+                event.Arguments[event.ArgumentCount].Integer = (int64_t)value;
+            }
+            event.ArgumentCount++;
+        }
+
+    public:
+        // Construct a log for up to threadCapacity logging threads, each holding up to eventsPerThread events
+        // (a power of two) between drains.
+        EventLog(int threadCapacity, int eventsPerThread);
+
+        // Stops the formatting thread, if any.
+        ~EventLog();
+
+        // Register a format, returning its ID for passing to Log.  May allocate; not for the audio thread.
+        // Formats are never freed, so register each distinct format once, not once per object logging it.
+        int RegisterFormat(const std::wstring& format);
+
+        // Log an event with the given format and numeric arguments.  Never blocks and never allocates.
+        template<typename... Args>
+        void Log(int formatId, Args... arguments)
+        {
+            static_assert(sizeof...(Args) <= LogEvent::MaximumArgumentCount, "too many arguments for one log event");
+
+            LogEvent event;
+            event.Timestamp = CycleTimer::Now();
+            event.FormatId = formatId;
+            event.ArgumentCount = 0;
+            event.RealArgumentMask = 0;
+            (AddArgument(event, arguments), ...);
+            Append(event);
+        }
+
+        // The number of events dropped so far because a ring was full or no ring was free.
+        uint64_t DroppedCount() const { return _droppedCount.load(std::memory_order_relaxed); }
+
+        // Format every event logged so far, in timestamp order, and pass each message to the sink; also reports
+        // any newly dropped events.  Returns the number of events formatted.
+        // Must only be called from one thread at a time, and not while the formatting thread runs.
+        int Drain(const std::function<void(const std::wstring&)>& sink);
+
+        // Start a thread which drains into the sink every intervalMilliseconds.
+        void StartFormatting(std::function<void(const std::wstring&)> sink, int intervalMilliseconds);
+
+        // Stop the formatting thread, after a final drain; does nothing if it is not running.
+        void StopFormatting();
+    };
+}
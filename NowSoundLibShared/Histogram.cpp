@@ -5,107 +5,210 @@
 
 #include "Check.h"
 #include "Histogram.h"
+#include "Kernels.h"
 
 using namespace NowSound;
 
-Histogram::Histogram(int capacity)
+// The number of values AddAll takes the absolute value of at once.
+const int AbsoluteValueChunkSize = 64;
+
+// The number of whole blocks of decimation values in capacity values; at least one.
+static int SlotCapacity(int capacity, int decimation)
+{
+    return std::max<int>(1, capacity / decimation);
+}
+
+Histogram::Wedge::Wedge(int capacity)
     : _capacity{ capacity },
-    _size{ 0 },
-    _index{ 0 },
-    _min{ 0 },
-    _max{ 0 },
-    _total{ 0 },
-    _minMaxKnown{ false },
-    _values{ new float[capacity] }
+    _entries{ new int[capacity] },
+    _head{ 0 },
+    _count{ 0 }
+{}
+
+void Histogram::Wedge::PopFront()
 {
-    Check(capacity > 0);
+    Check(_count > 0);
+    _head = Wrap(_head + 1);
+    _count--;
 }
 
-void Histogram::Add(float value)
+void Histogram::Wedge::PopBack()
 {
-    AddImpl(value);
+    Check(_count > 0);
+    _count--;
 }
 
-void Histogram::AddAll(const float* data, int count, bool absoluteValue)
+void Histogram::Wedge::PushBack(int slot)
 {
-    for (int i = 0; i < count; i++)
-    {
-        AddImpl(absoluteValue ? (float)std::abs(data[i]) : data[i]);
-    }
+    Check(_count < _capacity);
+    _entries[Wrap(_head + _count)] = slot;
+    _count++;
+}
+
+Histogram::Histogram(int capacity, int decimation)
+    : _decimation{ decimation },
+    _slotCapacity{ SlotCapacity(capacity, decimation) },
+    _slotMins{ new float[SlotCapacity(capacity, decimation)] },
+    _slotMaxes{ new float[SlotCapacity(capacity, decimation)] },
+    _slotSums{ new float[SlotCapacity(capacity, decimation)] },
+    _slotsInWindow{ 0 },
+    _nextSlot{ 0 },
+    _total{ 0 },
+    _blockMin{ 0 },
+    _blockMax{ 0 },
+    _blockSum{ 0 },
+    _blockCount{ 0 },
+    _minWedge{ SlotCapacity(capacity, decimation) },
+    _maxWedge{ SlotCapacity(capacity, decimation) }
+{
+    Check(capacity > 0);
+    Check(decimation > 0);
 }
 
-void Histogram::AddImpl(float value)
+void Histogram::AddSlot(float min, float max, float sum)
 {
-    if (_size == 0)
+    int slot = _nextSlot;
+
+    if (_slotsInWindow == _slotCapacity)
     {
-        _values.get()[0] = value;
-        _size = _index = 1;
-        _min = _max = _total = value;
-        _minMaxKnown = true;
+        // The block in this slot is leaving the window.  It is the oldest block, so if it is in a wedge
+        // at all, it is at the front.
+        _total -= _slotSums[slot];
+        if (!_minWedge.IsEmpty() && _minWedge.Front() == slot)
+        {
+            _minWedge.PopFront();
+        }
+        if (!_maxWedge.IsEmpty() && _maxWedge.Front() == slot)
+        {
+            _maxWedge.PopFront();
+        }
     }
     else
     {
-        bool atCapacity = _size == _capacity;
+        _slotsInWindow++;
+    }
 
-        if (atCapacity)
-        {
-            _index = _index % _size;
+    _slotMins[slot] = min;
+    _slotMaxes[slot] = max;
+    _slotSums[slot] = sum;
+    _total += sum;
 
-            float oldValue = _values.get()[_index];
-            _total -= oldValue;
+    // Older blocks that are no smaller (or no larger) than this one can never be the minimum (or maximum)
+    // again, since this block will outlast them in the window.
+    while (!_minWedge.IsEmpty() && _slotMins[_minWedge.Back()] >= min)
+    {
+        _minWedge.PopBack();
+    }
+    _minWedge.PushBack(slot);
 
-            _minMaxKnown = _minMaxKnown && (oldValue > _min && oldValue < _max);
-        }
-        else
-        {
-            _size++;
-        }
+    while (!_maxWedge.IsEmpty() && _slotMaxes[_maxWedge.Back()] <= max)
+    {
+        _maxWedge.PopBack();
+    }
+    _maxWedge.PushBack(slot);
 
-        _values.get()[_index] = value;
-        _total += value;
-        // Update _min or _max if applicable.  Note that this doesn't change _minMaxKnown.
-        if (value < _min)
-        {
-            _min = value;
-        }
-        else if (value > _max)
-        {
-            _max = value;
-        }
+    _nextSlot = _nextSlot + 1 == _slotCapacity ? 0 : _nextSlot + 1;
+}
 
-        _index++;
+void Histogram::AddToBlock(float min, float max, float sum, int count)
+{
+    if (_blockCount == 0)
+    {
+        _blockMin = min;
+        _blockMax = max;
+        _blockSum = sum;
     }
+    else
+    {
+        _blockMin = std::min<float>(_blockMin, min);
+        _blockMax = std::max<float>(_blockMax, max);
+        _blockSum += sum;
+    }
+    _blockCount += count;
 
-    _average = _total / _size;
+    Check(_blockCount <= _decimation);
+    if (_blockCount == _decimation)
+    {
+        AddSlot(_blockMin, _blockMax, _blockSum);
+        _blockCount = 0;
+    }
+}
+
+void Histogram::Add(float value)
+{
+    if (_decimation == 1)
+    {
+        AddSlot(value, value, value);
+    }
+    else
+    {
+        AddToBlock(value, value, value, 1);
+    }
 }
 
-void Histogram::EnsureMinMaxKnown()
+void Histogram::AddAll(const float* data, int count, bool absoluteValue)
 {
-    if (!_minMaxKnown && _size > 0)
+    if (_decimation == 1)
     {
-        _min = _max = _values.get()[0];
-        for (int i = 1; i < _size; i++)
+        for (int i = 0; i < count; i++)
         {
-            _min = std::min<float>(_min, _values.get()[i]);
-            _max = std::max<float>(_max, _values.get()[i]);
+            float value = absoluteValue ? std::abs(data[i]) : data[i];
+            AddSlot(value, value, value);
         }
-        _minMaxKnown = true;
+        return;
+    }
+
+    // Summarize the data a run at a time, where no run crosses a block boundary.
+    float absoluteValues[AbsoluteValueChunkSize];
+    while (count > 0)
+    {
+        int runLength = std::min<int>(count, _decimation - _blockCount);
+        const float* run = data;
+        if (absoluteValue)
+        {
+            runLength = std::min<int>(runLength, AbsoluteValueChunkSize);
+            Kernels::Abs(data, runLength, absoluteValues);
+            run = absoluteValues;
+        }
+
+        float min, max;
+        Kernels::MinMax(run, runLength, &min, &max);
+        AddToBlock(min, max, Kernels::Sum(run, runLength), runLength);
+
+        data += runLength;
+        count -= runLength;
     }
 }
 
 float Histogram::Min()
 {
-    EnsureMinMaxKnown();
-    return _min;
+    if (_minWedge.IsEmpty())
+    {
+        return _blockCount > 0 ? _blockMin : 0;
+    }
+
+    float min = _slotMins[_minWedge.Front()];
+    return _blockCount > 0 ? std::min<float>(min, _blockMin) : min;
 }
 
 float Histogram::Max()
 {
-    EnsureMinMaxKnown();
-    return _max;
+    if (_maxWedge.IsEmpty())
+    {
+        return _blockCount > 0 ? _blockMax : 0;
+    }
+
+    float max = _slotMaxes[_maxWedge.Front()];
+    return _blockCount > 0 ? std::max<float>(max, _blockMax) : max;
 }
 
 float Histogram::Average()
 {
-    return _average;
+    int64_t valueCount = (int64_t)_slotsInWindow * _decimation + _blockCount;
+    if (valueCount == 0)
+    {
+        return 0;
+    }
+
+    return (_total + (_blockCount > 0 ? _blockSum : 0)) / valueCount;
 }
@@ -5,49 +5,89 @@
 
 #include "stdint.h"
 
-#include <deque>
-
-// Simple histogram structure for tracking statistics over a bounded set of float values.
-// Average() is always available with O(1) performance.  Max() and Min() are calculated lazily on demand.
+#include <memory>
+
+// Simple histogram structure for tracking statistics over a sliding window of float values.
+// Average(), Min() and Max() are all O(1); adding a value is amortized O(1).
+// Min and max are tracked with monotonic wedges (deques of candidate extremes, oldest first), so values
+// leaving the window never force a rescan of the window.
+//
+// With a decimation greater than one, the histogram summarizes each consecutive block of that many values
+// (e.g. one audio quantum) by its min, max and sum, and keeps only those block summaries; this divides both
+// memory and per-value update cost by the decimation.  The window then moves a block at a time, and the
+// statistics include the values of the current incomplete block.
 // THIS TYPE IS NOT THREAD SAFE, BY DESIGN. Owners are responsible for synchronization.
 namespace NowSound
 {
     class Histogram
     {
     private:
-        // The number of elements.
-        int _capacity;
-        
-        // The number of values inserted. Once this reaches capacity, it remains constant.
-        int _size;
+        // The number of values per block summary.
+        const int _decimation;
+
+        // The number of block summaries in the window.
+        const int _slotCapacity;
 
-        // The index at which to insert the next element.
-        int _index;
+        // The per-block minimum, maximum and sum of each block in the window, in a ring.
+        // (With a decimation of one, these are all the same value.)
+        std::unique_ptr<float[]> _slotMins;
+        std::unique_ptr<float[]> _slotMaxes;
+        std::unique_ptr<float[]> _slotSums;
 
-        // The possibly stale values of _min and _max (if !_minMaxKnown).
-        float _min;
-        float _max;
+        // The number of complete blocks in the window.
+        int _slotsInWindow;
 
-        // The always accurate total of all values.
+        // The slot the next block goes in; once the window is full, this is also the oldest block.
+        int _nextSlot;
+
+        // The always accurate total of all complete blocks in the window.
         float _total;
 
-        // The always accurate average of all values.
-        float _average;
+        // The statistics of the current, incomplete block.
+        float _blockMin;
+        float _blockMax;
+        float _blockSum;
+        int _blockCount;
+
+        // A fixed-capacity deque of slots, oldest block first.
+        // (It can never hold more than _slotCapacity entries, since it holds only blocks in the window.)
+        class Wedge
+        {
+        private:
+            const int _capacity;
+            std::unique_ptr<int[]> _entries;
+            int _head;
+            int _count;
+
+            int Wrap(int index) const { return index >= _capacity ? index - _capacity : index; }
+
+        public:
+            Wedge(int capacity);
+
+            bool IsEmpty() const { return _count == 0; }
+            int Front() const { return _entries[_head]; }
+            int Back() const { return _entries[Wrap(_head + _count - 1)]; }
+            void PopFront();
+            void PopBack();
+            void PushBack(int slot);
+        };
 
-        // If _max and _min are known to be accurate with respect to _valuesInInsertionOrder, then this is true.
-        bool _minMaxKnown;
+        // Blocks whose minimums are strictly increasing; the first is the minimum of the window.
+        Wedge _minWedge;
 
-        // This deque simply tracks the values in the order they entered the histogram.
-        std::unique_ptr<float> _values;
+        // Blocks whose maximums are strictly decreasing; the first is the maximum of the window.
+        Wedge _maxWedge;
 
-        // Recalculate min/max if necessary.
-        void EnsureMinMaxKnown();
+        // Add a complete block summary, evicting the oldest if the window is full.
+        void AddSlot(float min, float max, float sum);
 
-        // Add implementation (no locking).
-        void AddImpl(float value);
+        // Add statistics of count more values to the current block, completing it if it is now full.
+        void AddToBlock(float min, float max, float sum, int count);
 
     public:
-        Histogram(int capacity);
+        // Track the last capacity values, in blocks of decimation values (capacity is rounded down to a whole
+        // number of blocks, but is always at least one block).
+        Histogram(int capacity, int decimation = 1);
 
         // Check the minimum value.
         float Min();
@@ -0,0 +1,1739 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+#include "Check.h"
+#include "Kernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NOWSOUND_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(_M_ARM64) || defined(_M_ARM) || defined(__ARM_NEON)
+#define NOWSOUND_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC allows any intrinsic in any function; GCC and clang need the instruction set enabled per function,
+// since the rest of the library must still run on CPUs without it.
+#if defined(NOWSOUND_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NOWSOUND_TARGET_SSE2 __attribute__((target("sse2")))
+#define NOWSOUND_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NOWSOUND_TARGET_SSE2
+#define NOWSOUND_TARGET_AVX2
+#endif
+
+using namespace NowSound;
+using namespace NowSound::Kernels;
+
+namespace
+{
+    // One complete set of kernel implementations.
+    struct KernelTable
+    {
+        KernelSet Set;
+        void (*GainPanClamp)(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right);
+        void (*GainPanClampPerSample)(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right);
+        void (*GainPanAccumulate)(const float* mono, int count, float leftGain, float rightGain, float* left, float* right);
+        void (*Reverse)(const float* input, int count, float* output);
+        void (*FourTapFilter)(const float* input, int count, const float* taps, float* output);
+        void (*ResampleCubic)(const float* input, float start, float step, int count, float* output);
+        void (*MultiplyAccumulate)(const float* a, const float* b, int count, float* output);
+        void (*Interleave)(const float* const* channels, int offset, int channelCount, int count, float* output);
+        void (*Deinterleave)(const float* input, int channelCount, int count, float* const* channels, int offset);
+        void (*Crossfade)(const float* dry, const float* wet, int count, float mix, float* output);
+        void (*CrossfadePerSample)(const float* dry, const float* wet, int count, const float* mixes, float* output);
+        void (*LinearRamp)(float start, float step, int count, float* output);
+        void (*ExponentialRamp)(float start, float target, float ratio, int count, float* output);
+        void (*AbsMean)(const float* a, const float* b, int count, float* output);
+        void (*Abs)(const float* input, int count, float* output);
+        float (*Sum)(const float* input, int count);
+        void (*MinMax)(const float* input, int count, float* min, float* max);
+        void (*FftPass)(float* data, int complexCount, int halfSize, const float* twiddles);
+        void (*ComplexMagnitude)(const float* input, int count, float* output);
+        float (*Dot)(const float* a, const float* b, int count);
+    };
+
+    // The cubic Hermite (Catmull-Rom) interpolation of input at position, from input[index - 1] through
+    // input[index + 2], where index is the whole part of position.  Every kernel set's ResampleCubic uses this for
+    // its tail, so all agree on the formula.
+    inline float CubicSample(const float* input, float position)
+    {
+        int index = (int)position;
+        float fraction = position - (float)index;
+        const float* x = input + index - 1;
+        float a = -0.5f * x[0] + 1.5f * x[1] - 1.5f * x[2] + 0.5f * x[3];
+        float b = x[0] - 2.5f * x[1] + 2 * x[2] - 0.5f * x[3];
+        float c = -0.5f * x[0] + 0.5f * x[2];
+        return ((a * fraction + b) * fraction + c) * fraction + x[1];
+    }
+
+    // The scalar kernels; the vector kernels also use these for their leftover tail samples.
+    namespace Scalar
+    {
+        void GainPanClamp(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                float value = mono[i];
+                float leftValue = leftGain * value;
+                float rightValue = rightGain * value;
+                left[i] = leftValue < -limit ? -limit : (leftValue > limit ? limit : leftValue);
+                right[i] = rightValue < -limit ? -limit : (rightValue > limit ? limit : rightValue);
+            }
+        }
+
+        void GainPanClampPerSample(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                float value = mono[i];
+                float leftValue = leftGains[i] * value;
+                float rightValue = rightGains[i] * value;
+                left[i] = leftValue < -limit ? -limit : (leftValue > limit ? limit : leftValue);
+                right[i] = rightValue < -limit ? -limit : (rightValue > limit ? limit : rightValue);
+            }
+        }
+
+        void GainPanAccumulate(const float* mono, int count, float leftGain, float rightGain, float* left, float* right)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                left[i] += leftGain * mono[i];
+                right[i] += rightGain * mono[i];
+            }
+        }
+
+        void Reverse(const float* input, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[count - 1 - i] = input[i];
+            }
+        }
+
+        void FourTapFilter(const float* input, int count, const float* taps, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = taps[0] * input[i] + taps[1] * input[i + 1] + taps[2] * input[i + 2] + taps[3] * input[i + 3];
+            }
+        }
+
+        void ResampleCubic(const float* input, float start, float step, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = CubicSample(input, start + (float)i * step);
+            }
+        }
+
+        void MultiplyAccumulate(const float* a, const float* b, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] += a[i] * b[i];
+            }
+        }
+
+        void Interleave(const float* const* channels, int offset, int channelCount, int count, float* output)
+        {
+            if (channelCount == 1)
+            {
+                std::memcpy(output, channels[0] + offset, (size_t)count * sizeof(float));
+                return;
+            }
+
+            for (int c = 0; c < channelCount; c++)
+            {
+                const float* channel = channels[c] + offset;
+                for (int i = 0; i < count; i++)
+                {
+                    output[i * channelCount + c] = channel[i];
+                }
+            }
+        }
+
+        void Deinterleave(const float* input, int channelCount, int count, float* const* channels, int offset)
+        {
+            if (channelCount == 1)
+            {
+                std::memcpy(channels[0] + offset, input, (size_t)count * sizeof(float));
+                return;
+            }
+
+            for (int c = 0; c < channelCount; c++)
+            {
+                float* channel = channels[c] + offset;
+                for (int i = 0; i < count; i++)
+                {
+                    channel[i] = input[i * channelCount + c];
+                }
+            }
+        }
+
+        void Crossfade(const float* dry, const float* wet, int count, float mix, float* output)
+        {
+            float dryGain = 1 - mix;
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = dry[i] * dryGain + wet[i] * mix;
+            }
+        }
+
+        void CrossfadePerSample(const float* dry, const float* wet, int count, const float* mixes, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = dry[i] * (1 - mixes[i]) + wet[i] * mixes[i];
+            }
+        }
+
+        void LinearRamp(float start, float step, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = start + step * i;
+            }
+        }
+
+        void ExponentialRamp(float start, float target, float ratio, int count, float* output)
+        {
+            float distance = start - target;
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = target + distance;
+                distance *= ratio;
+            }
+        }
+
+        void AbsMean(const float* a, const float* b, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = std::abs(a[i]) / 2 + std::abs(b[i]) / 2;
+            }
+        }
+
+        void Abs(const float* input, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                output[i] = std::abs(input[i]);
+            }
+        }
+
+        float Sum(const float* input, int count)
+        {
+            float total = 0;
+            for (int i = 0; i < count; i++)
+            {
+                total += input[i];
+            }
+            return total;
+        }
+
+        void MinMax(const float* input, int count, float* min, float* max)
+        {
+            Check(count > 0);
+            float currentMin = input[0];
+            float currentMax = input[0];
+            for (int i = 1; i < count; i++)
+            {
+                currentMin = input[i] < currentMin ? input[i] : currentMin;
+                currentMax = input[i] > currentMax ? input[i] : currentMax;
+            }
+            *min = currentMin;
+            *max = currentMax;
+        }
+
+        void FftPass(float* data, int complexCount, int halfSize, const float* twiddles)
+        {
+            for (int group = 0; group < complexCount; group += 2 * halfSize)
+            {
+                float* a = data + 2 * group;
+                float* b = a + 2 * halfSize;
+                for (int j = 0; j < halfSize; j++)
+                {
+                    float twiddleReal = twiddles[2 * j];
+                    float twiddleImaginary = twiddles[2 * j + 1];
+                    float bReal = b[2 * j];
+                    float bImaginary = b[2 * j + 1];
+                    float tReal = bReal * twiddleReal - bImaginary * twiddleImaginary;
+                    float tImaginary = bReal * twiddleImaginary + bImaginary * twiddleReal;
+                    b[2 * j] = a[2 * j] - tReal;
+                    b[2 * j + 1] = a[2 * j + 1] - tImaginary;
+                    a[2 * j] += tReal;
+                    a[2 * j + 1] += tImaginary;
+                }
+            }
+        }
+
+        void ComplexMagnitude(const float* input, int count, float* output)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                float real = input[2 * i];
+                float imaginary = input[2 * i + 1];
+                output[i] = std::sqrt(real * real + imaginary * imaginary);
+            }
+        }
+
+        float Dot(const float* a, const float* b, int count)
+        {
+            float total = 0;
+            for (int i = 0; i < count; i++)
+            {
+                total += a[i] * b[i];
+            }
+            return total;
+        }
+    }
+
+    const KernelTable ScalarTable{
+        KernelSet::Scalar,
+        Scalar::GainPanClamp,
+        Scalar::GainPanClampPerSample,
+        Scalar::GainPanAccumulate,
+        Scalar::Reverse,
+        Scalar::FourTapFilter,
+        Scalar::ResampleCubic,
+        Scalar::MultiplyAccumulate,
+        Scalar::Interleave,
+        Scalar::Deinterleave,
+        Scalar::Crossfade,
+        Scalar::CrossfadePerSample,
+        Scalar::LinearRamp,
+        Scalar::ExponentialRamp,
+        Scalar::AbsMean,
+        Scalar::Abs,
+        Scalar::Sum,
+        Scalar::MinMax,
+        Scalar::FftPass,
+        Scalar::ComplexMagnitude,
+        Scalar::Dot
+    };
+
+#ifdef NOWSOUND_KERNELS_X86
+    namespace Sse2
+    {
+        NOWSOUND_TARGET_SSE2 void GainPanClamp(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right)
+        {
+            __m128 leftGains = _mm_set1_ps(leftGain);
+            __m128 rightGains = _mm_set1_ps(rightGain);
+            __m128 highs = _mm_set1_ps(limit);
+            __m128 lows = _mm_set1_ps(-limit);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 values = _mm_loadu_ps(mono + i);
+                _mm_storeu_ps(left + i, _mm_max_ps(lows, _mm_min_ps(highs, _mm_mul_ps(leftGains, values))));
+                _mm_storeu_ps(right + i, _mm_max_ps(lows, _mm_min_ps(highs, _mm_mul_ps(rightGains, values))));
+            }
+            Scalar::GainPanClamp(mono + i, count - i, leftGain, rightGain, limit, left + i, right + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void GainPanAccumulate(const float* mono, int count, float leftGain, float rightGain, float* left, float* right)
+        {
+            __m128 leftGains = _mm_set1_ps(leftGain);
+            __m128 rightGains = _mm_set1_ps(rightGain);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 values = _mm_loadu_ps(mono + i);
+                _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(leftGains, values)));
+                _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(rightGains, values)));
+            }
+            Scalar::GainPanAccumulate(mono + i, count - i, leftGain, rightGain, left + i, right + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void Reverse(const float* input, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 values = _mm_loadu_ps(input + i);
+                _mm_storeu_ps(output + count - 4 - i, _mm_shuffle_ps(values, values, _MM_SHUFFLE(0, 1, 2, 3)));
+            }
+            // the leftover input goes at the front of the output
+            Scalar::Reverse(input + i, count - i, output);
+        }
+
+        NOWSOUND_TARGET_SSE2 void FourTapFilter(const float* input, int count, const float* taps, float* output)
+        {
+            __m128 tap0 = _mm_set1_ps(taps[0]);
+            __m128 tap1 = _mm_set1_ps(taps[1]);
+            __m128 tap2 = _mm_set1_ps(taps[2]);
+            __m128 tap3 = _mm_set1_ps(taps[3]);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 sum = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(tap0, _mm_loadu_ps(input + i)), _mm_mul_ps(tap1, _mm_loadu_ps(input + i + 1))),
+                    _mm_add_ps(_mm_mul_ps(tap2, _mm_loadu_ps(input + i + 2)), _mm_mul_ps(tap3, _mm_loadu_ps(input + i + 3))));
+                _mm_storeu_ps(output + i, sum);
+            }
+            Scalar::FourTapFilter(input + i, count - i, taps, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void ResampleCubic(const float* input, float start, float step, int count, float* output)
+        {
+            __m128 starts = _mm_set1_ps(start);
+            __m128 steps = _mm_set1_ps(step);
+            __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 positions = _mm_add_ps(starts, _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(i), lanes)), steps));
+                __m128i indices = _mm_cvttps_epi32(positions);
+                __m128 fractions = _mm_sub_ps(positions, _mm_cvtepi32_ps(indices));
+
+                // load each lane's four samples, then transpose so each vector holds one tap for every lane
+                alignas(16) int32_t index[4];
+                _mm_store_si128((__m128i*)index, indices);
+                __m128 x0 = _mm_loadu_ps(input + index[0] - 1);
+                __m128 x1 = _mm_loadu_ps(input + index[1] - 1);
+                __m128 x2 = _mm_loadu_ps(input + index[2] - 1);
+                __m128 x3 = _mm_loadu_ps(input + index[3] - 1);
+                _MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+
+                __m128 a = _mm_add_ps(
+                    _mm_sub_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.5f), x0), _mm_mul_ps(_mm_set1_ps(1.5f), x1)), _mm_mul_ps(_mm_set1_ps(1.5f), x2)),
+                    _mm_mul_ps(_mm_set1_ps(0.5f), x3));
+                __m128 b = _mm_sub_ps(
+                    _mm_add_ps(_mm_sub_ps(x0, _mm_mul_ps(_mm_set1_ps(2.5f), x1)), _mm_mul_ps(_mm_set1_ps(2), x2)),
+                    _mm_mul_ps(_mm_set1_ps(0.5f), x3));
+                __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.5f), x0), _mm_mul_ps(_mm_set1_ps(0.5f), x2));
+                __m128 result = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(a, fractions), b), fractions), c), fractions), x1);
+                _mm_storeu_ps(output + i, result);
+            }
+            for (; i < count; i++)
+            {
+                output[i] = CubicSample(input, start + (float)i * step);
+            }
+        }
+
+        NOWSOUND_TARGET_SSE2 void MultiplyAccumulate(const float* a, const float* b, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))));
+            }
+            Scalar::MultiplyAccumulate(a + i, b + i, count - i, output + i);
+        }
+
+        // Only stereo is vectorized; any other channel count goes to the scalar kernel.
+        NOWSOUND_TARGET_SSE2 void Interleave(const float* const* channels, int offset, int channelCount, int count, float* output)
+        {
+            if (channelCount != 2)
+            {
+                Scalar::Interleave(channels, offset, channelCount, count, output);
+                return;
+            }
+
+            const float* left = channels[0] + offset;
+            const float* right = channels[1] + offset;
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 l = _mm_loadu_ps(left + i);
+                __m128 r = _mm_loadu_ps(right + i);
+                _mm_storeu_ps(output + 2 * i, _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(output + 2 * i + 4, _mm_unpackhi_ps(l, r));
+            }
+            Scalar::Interleave(channels, offset + i, 2, count - i, output + 2 * i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void Deinterleave(const float* input, int channelCount, int count, float* const* channels, int offset)
+        {
+            if (channelCount != 2)
+            {
+                Scalar::Deinterleave(input, channelCount, count, channels, offset);
+                return;
+            }
+
+            float* left = channels[0] + offset;
+            float* right = channels[1] + offset;
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 a = _mm_loadu_ps(input + 2 * i);
+                __m128 b = _mm_loadu_ps(input + 2 * i + 4);
+                _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            Scalar::Deinterleave(input + 2 * i, 2, count - i, channels, offset + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void Crossfade(const float* dry, const float* wet, int count, float mix, float* output)
+        {
+            __m128 dryGains = _mm_set1_ps(1 - mix);
+            __m128 wetGains = _mm_set1_ps(mix);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 dryValues = _mm_mul_ps(_mm_loadu_ps(dry + i), dryGains);
+                __m128 wetValues = _mm_mul_ps(_mm_loadu_ps(wet + i), wetGains);
+                _mm_storeu_ps(output + i, _mm_add_ps(dryValues, wetValues));
+            }
+            Scalar::Crossfade(dry + i, wet + i, count - i, mix, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void GainPanClampPerSample(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right)
+        {
+            __m128 highs = _mm_set1_ps(limit);
+            __m128 lows = _mm_set1_ps(-limit);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 values = _mm_loadu_ps(mono + i);
+                __m128 leftValues = _mm_mul_ps(_mm_loadu_ps(leftGains + i), values);
+                __m128 rightValues = _mm_mul_ps(_mm_loadu_ps(rightGains + i), values);
+                _mm_storeu_ps(left + i, _mm_max_ps(lows, _mm_min_ps(highs, leftValues)));
+                _mm_storeu_ps(right + i, _mm_max_ps(lows, _mm_min_ps(highs, rightValues)));
+            }
+            Scalar::GainPanClampPerSample(mono + i, count - i, leftGains + i, rightGains + i, limit, left + i, right + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void CrossfadePerSample(const float* dry, const float* wet, int count, const float* mixes, float* output)
+        {
+            __m128 ones = _mm_set1_ps(1);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 wetGains = _mm_loadu_ps(mixes + i);
+                __m128 dryValues = _mm_mul_ps(_mm_loadu_ps(dry + i), _mm_sub_ps(ones, wetGains));
+                __m128 wetValues = _mm_mul_ps(_mm_loadu_ps(wet + i), wetGains);
+                _mm_storeu_ps(output + i, _mm_add_ps(dryValues, wetValues));
+            }
+            Scalar::CrossfadePerSample(dry + i, wet + i, count - i, mixes + i, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void LinearRamp(float start, float step, int count, float* output)
+        {
+            // compute each value from its index, rather than accumulating, so rounding errors do not build up
+            __m128 indices = _mm_set_ps(3, 2, 1, 0);
+            __m128 fours = _mm_set1_ps(4);
+            __m128 starts = _mm_set1_ps(start);
+            __m128 steps = _mm_set1_ps(step);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(output + i, _mm_add_ps(starts, _mm_mul_ps(steps, indices)));
+                indices = _mm_add_ps(indices, fours);
+            }
+            Scalar::LinearRamp(start + step * i, step, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void ExponentialRamp(float start, float target, float ratio, int count, float* output)
+        {
+            // each lane holds the distance to target for one of four consecutive samples
+            float ratio2 = ratio * ratio;
+            float distance = start - target;
+            __m128 distances = _mm_set_ps(distance * ratio2 * ratio, distance * ratio2, distance * ratio, distance);
+            __m128 ratio4s = _mm_set1_ps(ratio2 * ratio2);
+            __m128 targets = _mm_set1_ps(target);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(output + i, _mm_add_ps(targets, distances));
+                distances = _mm_mul_ps(distances, ratio4s);
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, distances);
+            Scalar::ExponentialRamp(target + lanes[0], target, ratio, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void AbsMean(const float* a, const float* b, int count, float* output)
+        {
+            // clearing the sign bit is abs()
+            __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            __m128 halves = _mm_set1_ps(0.5f);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 aValues = _mm_and_ps(_mm_loadu_ps(a + i), absMask);
+                __m128 bValues = _mm_and_ps(_mm_loadu_ps(b + i), absMask);
+                _mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(aValues, halves), _mm_mul_ps(bValues, halves)));
+            }
+            Scalar::AbsMean(a + i, b + i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void Abs(const float* input, int count, float* output)
+        {
+            __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(output + i, _mm_and_ps(_mm_loadu_ps(input + i), absMask));
+            }
+            Scalar::Abs(input + i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 float Sum(const float* input, int count)
+        {
+            __m128 totals = _mm_setzero_ps();
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                totals = _mm_add_ps(totals, _mm_loadu_ps(input + i));
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, totals);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + Scalar::Sum(input + i, count - i);
+        }
+
+        NOWSOUND_TARGET_SSE2 void MinMax(const float* input, int count, float* min, float* max)
+        {
+            Check(count > 0);
+            if (count < 4)
+            {
+                Scalar::MinMax(input, count, min, max);
+                return;
+            }
+
+            __m128 mins = _mm_loadu_ps(input);
+            __m128 maxes = mins;
+            int i = 4;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 values = _mm_loadu_ps(input + i);
+                mins = _mm_min_ps(mins, values);
+                maxes = _mm_max_ps(maxes, values);
+            }
+            float minLanes[4];
+            float maxLanes[4];
+            _mm_storeu_ps(minLanes, mins);
+            _mm_storeu_ps(maxLanes, maxes);
+            float ignored;
+            Scalar::MinMax(minLanes, 4, min, &ignored);
+            Scalar::MinMax(maxLanes, 4, &ignored, max);
+            if (i < count)
+            {
+                float tailMin, tailMax;
+                Scalar::MinMax(input + i, count - i, &tailMin, &tailMax);
+                *min = tailMin < *min ? tailMin : *min;
+                *max = tailMax > *max ? tailMax : *max;
+            }
+        }
+
+        // Two complex values per vector; SSE2 has no addsub, so the sign flip is an xor.
+        NOWSOUND_TARGET_SSE2 void FftPass(float* data, int complexCount, int halfSize, const float* twiddles)
+        {
+            if (halfSize < 2)
+            {
+                Scalar::FftPass(data, complexCount, halfSize, twiddles);
+                return;
+            }
+
+            __m128 negateReals = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+            for (int group = 0; group < complexCount; group += 2 * halfSize)
+            {
+                float* a = data + 2 * group;
+                float* b = a + 2 * halfSize;
+                for (int j = 0; j < 2 * halfSize; j += 4)
+                {
+                    __m128 twiddle = _mm_loadu_ps(twiddles + j);
+                    __m128 twiddleReals = _mm_shuffle_ps(twiddle, twiddle, _MM_SHUFFLE(2, 2, 0, 0));
+                    __m128 twiddleImaginaries = _mm_shuffle_ps(twiddle, twiddle, _MM_SHUFFLE(3, 3, 1, 1));
+                    __m128 bValues = _mm_loadu_ps(b + j);
+                    __m128 bSwapped = _mm_shuffle_ps(bValues, bValues, _MM_SHUFFLE(2, 3, 0, 1));
+                    __m128 t = _mm_add_ps(
+                        _mm_mul_ps(bValues, twiddleReals),
+                        _mm_xor_ps(_mm_mul_ps(bSwapped, twiddleImaginaries), negateReals));
+                    __m128 aValues = _mm_loadu_ps(a + j);
+                    _mm_storeu_ps(b + j, _mm_sub_ps(aValues, t));
+                    _mm_storeu_ps(a + j, _mm_add_ps(aValues, t));
+                }
+            }
+        }
+
+        NOWSOUND_TARGET_SSE2 void ComplexMagnitude(const float* input, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 first = _mm_loadu_ps(input + 2 * i);
+                __m128 second = _mm_loadu_ps(input + 2 * i + 4);
+                first = _mm_mul_ps(first, first);
+                second = _mm_mul_ps(second, second);
+                // separate the squared reals from the squared imaginaries
+                __m128 reals = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 imaginaries = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(output + i, _mm_sqrt_ps(_mm_add_ps(reals, imaginaries)));
+            }
+            Scalar::ComplexMagnitude(input + 2 * i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_SSE2 float Dot(const float* a, const float* b, int count)
+        {
+            __m128 totals = _mm_setzero_ps();
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                totals = _mm_add_ps(totals, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, totals);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + Scalar::Dot(a + i, b + i, count - i);
+        }
+    }
+
+    const KernelTable Sse2Table{
+        KernelSet::Sse2,
+        Sse2::GainPanClamp,
+        Sse2::GainPanClampPerSample,
+        Sse2::GainPanAccumulate,
+        Sse2::Reverse,
+        Sse2::FourTapFilter,
+        Sse2::ResampleCubic,
+        Sse2::MultiplyAccumulate,
+        Sse2::Interleave,
+        Sse2::Deinterleave,
+        Sse2::Crossfade,
+        Sse2::CrossfadePerSample,
+        Sse2::LinearRamp,
+        Sse2::ExponentialRamp,
+        Sse2::AbsMean,
+        Sse2::Abs,
+        Sse2::Sum,
+        Sse2::MinMax,
+        Sse2::FftPass,
+        Sse2::ComplexMagnitude,
+        Sse2::Dot
+    };
+
+    // Each AVX2 kernel clears the upper halves of the YMM registers before handing its tail to the SSE2 kernel;
+    // otherwise every SSE instruction afterwards pays an AVX-SSE transition penalty.
+    namespace Avx2
+    {
+        NOWSOUND_TARGET_AVX2 void GainPanClamp(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right)
+        {
+            __m256 leftGains = _mm256_set1_ps(leftGain);
+            __m256 rightGains = _mm256_set1_ps(rightGain);
+            __m256 highs = _mm256_set1_ps(limit);
+            __m256 lows = _mm256_set1_ps(-limit);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 values = _mm256_loadu_ps(mono + i);
+                _mm256_storeu_ps(left + i, _mm256_max_ps(lows, _mm256_min_ps(highs, _mm256_mul_ps(leftGains, values))));
+                _mm256_storeu_ps(right + i, _mm256_max_ps(lows, _mm256_min_ps(highs, _mm256_mul_ps(rightGains, values))));
+            }
+            _mm256_zeroupper();
+            Sse2::GainPanClamp(mono + i, count - i, leftGain, rightGain, limit, left + i, right + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void GainPanAccumulate(const float* mono, int count, float leftGain, float rightGain, float* left, float* right)
+        {
+            __m256 leftGains = _mm256_set1_ps(leftGain);
+            __m256 rightGains = _mm256_set1_ps(rightGain);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 values = _mm256_loadu_ps(mono + i);
+                _mm256_storeu_ps(left + i, _mm256_add_ps(_mm256_loadu_ps(left + i), _mm256_mul_ps(leftGains, values)));
+                _mm256_storeu_ps(right + i, _mm256_add_ps(_mm256_loadu_ps(right + i), _mm256_mul_ps(rightGains, values)));
+            }
+            _mm256_zeroupper();
+            Sse2::GainPanAccumulate(mono + i, count - i, leftGain, rightGain, left + i, right + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void Reverse(const float* input, int count, float* output)
+        {
+            __m256i reversed = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(output + count - 8 - i, _mm256_permutevar8x32_ps(_mm256_loadu_ps(input + i), reversed));
+            }
+            _mm256_zeroupper();
+            Sse2::Reverse(input + i, count - i, output);
+        }
+
+        NOWSOUND_TARGET_AVX2 void FourTapFilter(const float* input, int count, const float* taps, float* output)
+        {
+            __m256 tap0 = _mm256_set1_ps(taps[0]);
+            __m256 tap1 = _mm256_set1_ps(taps[1]);
+            __m256 tap2 = _mm256_set1_ps(taps[2]);
+            __m256 tap3 = _mm256_set1_ps(taps[3]);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 sum = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(tap0, _mm256_loadu_ps(input + i)), _mm256_mul_ps(tap1, _mm256_loadu_ps(input + i + 1))),
+                    _mm256_add_ps(_mm256_mul_ps(tap2, _mm256_loadu_ps(input + i + 2)), _mm256_mul_ps(tap3, _mm256_loadu_ps(input + i + 3))));
+                _mm256_storeu_ps(output + i, sum);
+            }
+            _mm256_zeroupper();
+            Sse2::FourTapFilter(input + i, count - i, taps, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void ResampleCubic(const float* input, float start, float step, int count, float* output)
+        {
+            __m256 starts = _mm256_set1_ps(start);
+            __m256 steps = _mm256_set1_ps(step);
+            __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            __m256i ones = _mm256_set1_epi32(1);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 positions = _mm256_add_ps(starts, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(i), lanes)), steps));
+                __m256i indices = _mm256_cvttps_epi32(positions);
+                __m256 fractions = _mm256_sub_ps(positions, _mm256_cvtepi32_ps(indices));
+
+                __m256 x0 = _mm256_i32gather_ps(input, _mm256_sub_epi32(indices, ones), 4);
+                __m256 x1 = _mm256_i32gather_ps(input, indices, 4);
+                __m256 x2 = _mm256_i32gather_ps(input, _mm256_add_epi32(indices, ones), 4);
+                __m256 x3 = _mm256_i32gather_ps(input, _mm256_add_epi32(indices, _mm256_set1_epi32(2)), 4);
+
+                __m256 a = _mm256_add_ps(
+                    _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-0.5f), x0), _mm256_mul_ps(_mm256_set1_ps(1.5f), x1)), _mm256_mul_ps(_mm256_set1_ps(1.5f), x2)),
+                    _mm256_mul_ps(_mm256_set1_ps(0.5f), x3));
+                __m256 b = _mm256_sub_ps(
+                    _mm256_add_ps(_mm256_sub_ps(x0, _mm256_mul_ps(_mm256_set1_ps(2.5f), x1)), _mm256_mul_ps(_mm256_set1_ps(2), x2)),
+                    _mm256_mul_ps(_mm256_set1_ps(0.5f), x3));
+                __m256 c = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-0.5f), x0), _mm256_mul_ps(_mm256_set1_ps(0.5f), x2));
+                __m256 result = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(a, fractions), b), fractions), c), fractions), x1);
+                _mm256_storeu_ps(output + i, result);
+            }
+            _mm256_zeroupper();
+            for (; i < count; i++)
+            {
+                output[i] = CubicSample(input, start + (float)i * step);
+            }
+        }
+
+        NOWSOUND_TARGET_AVX2 void MultiplyAccumulate(const float* a, const float* b, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_loadu_ps(output + i), _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))));
+            }
+            _mm256_zeroupper();
+            Sse2::MultiplyAccumulate(a + i, b + i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void Interleave(const float* const* channels, int offset, int channelCount, int count, float* output)
+        {
+            if (channelCount != 2)
+            {
+                Scalar::Interleave(channels, offset, channelCount, count, output);
+                return;
+            }
+
+            const float* left = channels[0] + offset;
+            const float* right = channels[1] + offset;
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 l = _mm256_loadu_ps(left + i);
+                __m256 r = _mm256_loadu_ps(right + i);
+                // unpacking works within each 128-bit lane, so the halves come out as (0 1, 4 5) and (2 3, 6 7)
+                __m256 low = _mm256_unpacklo_ps(l, r);
+                __m256 high = _mm256_unpackhi_ps(l, r);
+                _mm256_storeu_ps(output + 2 * i, _mm256_permute2f128_ps(low, high, 0x20));
+                _mm256_storeu_ps(output + 2 * i + 8, _mm256_permute2f128_ps(low, high, 0x31));
+            }
+            _mm256_zeroupper();
+            Sse2::Interleave(channels, offset + i, 2, count - i, output + 2 * i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void Deinterleave(const float* input, int channelCount, int count, float* const* channels, int offset)
+        {
+            if (channelCount != 2)
+            {
+                Scalar::Deinterleave(input, channelCount, count, channels, offset);
+                return;
+            }
+
+            float* left = channels[0] + offset;
+            float* right = channels[1] + offset;
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 a = _mm256_loadu_ps(input + 2 * i);
+                __m256 b = _mm256_loadu_ps(input + 2 * i + 8);
+                // regroup the lanes as frames (0 1, 4 5) and (2 3, 6 7), so one shuffle per channel puts them in order
+                __m256 low = _mm256_permute2f128_ps(a, b, 0x20);
+                __m256 high = _mm256_permute2f128_ps(a, b, 0x31);
+                _mm256_storeu_ps(left + i, _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm256_storeu_ps(right + i, _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            _mm256_zeroupper();
+            Sse2::Deinterleave(input + 2 * i, 2, count - i, channels, offset + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void Crossfade(const float* dry, const float* wet, int count, float mix, float* output)
+        {
+            __m256 dryGains = _mm256_set1_ps(1 - mix);
+            __m256 wetGains = _mm256_set1_ps(mix);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 dryValues = _mm256_mul_ps(_mm256_loadu_ps(dry + i), dryGains);
+                __m256 wetValues = _mm256_mul_ps(_mm256_loadu_ps(wet + i), wetGains);
+                _mm256_storeu_ps(output + i, _mm256_add_ps(dryValues, wetValues));
+            }
+            _mm256_zeroupper();
+            Sse2::Crossfade(dry + i, wet + i, count - i, mix, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void GainPanClampPerSample(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right)
+        {
+            __m256 highs = _mm256_set1_ps(limit);
+            __m256 lows = _mm256_set1_ps(-limit);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 values = _mm256_loadu_ps(mono + i);
+                __m256 leftValues = _mm256_mul_ps(_mm256_loadu_ps(leftGains + i), values);
+                __m256 rightValues = _mm256_mul_ps(_mm256_loadu_ps(rightGains + i), values);
+                _mm256_storeu_ps(left + i, _mm256_max_ps(lows, _mm256_min_ps(highs, leftValues)));
+                _mm256_storeu_ps(right + i, _mm256_max_ps(lows, _mm256_min_ps(highs, rightValues)));
+            }
+            _mm256_zeroupper();
+            Sse2::GainPanClampPerSample(mono + i, count - i, leftGains + i, rightGains + i, limit, left + i, right + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void CrossfadePerSample(const float* dry, const float* wet, int count, const float* mixes, float* output)
+        {
+            __m256 ones = _mm256_set1_ps(1);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 wetGains = _mm256_loadu_ps(mixes + i);
+                __m256 dryValues = _mm256_mul_ps(_mm256_loadu_ps(dry + i), _mm256_sub_ps(ones, wetGains));
+                __m256 wetValues = _mm256_mul_ps(_mm256_loadu_ps(wet + i), wetGains);
+                _mm256_storeu_ps(output + i, _mm256_add_ps(dryValues, wetValues));
+            }
+            _mm256_zeroupper();
+            Sse2::CrossfadePerSample(dry + i, wet + i, count - i, mixes + i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void LinearRamp(float start, float step, int count, float* output)
+        {
+            __m256 indices = _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0);
+            __m256 eights = _mm256_set1_ps(8);
+            __m256 starts = _mm256_set1_ps(start);
+            __m256 steps = _mm256_set1_ps(step);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(output + i, _mm256_add_ps(starts, _mm256_mul_ps(steps, indices)));
+                indices = _mm256_add_ps(indices, eights);
+            }
+            _mm256_zeroupper();
+            Sse2::LinearRamp(start + step * i, step, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void ExponentialRamp(float start, float target, float ratio, int count, float* output)
+        {
+            // each lane holds the distance to target for one of eight consecutive samples
+            float powers[8];
+            powers[0] = 1;
+            for (int lane = 1; lane < 8; lane++)
+            {
+                powers[lane] = powers[lane - 1] * ratio;
+            }
+            __m256 distances = _mm256_mul_ps(_mm256_loadu_ps(powers), _mm256_set1_ps(start - target));
+            __m256 ratio8s = _mm256_set1_ps(powers[7] * ratio);
+            __m256 targets = _mm256_set1_ps(target);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(output + i, _mm256_add_ps(targets, distances));
+                distances = _mm256_mul_ps(distances, ratio8s);
+            }
+            float lanes[8];
+            _mm256_storeu_ps(lanes, distances);
+            _mm256_zeroupper();
+            Sse2::ExponentialRamp(target + lanes[0], target, ratio, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void AbsMean(const float* a, const float* b, int count, float* output)
+        {
+            __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            __m256 halves = _mm256_set1_ps(0.5f);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 aValues = _mm256_and_ps(_mm256_loadu_ps(a + i), absMask);
+                __m256 bValues = _mm256_and_ps(_mm256_loadu_ps(b + i), absMask);
+                _mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_mul_ps(aValues, halves), _mm256_mul_ps(bValues, halves)));
+            }
+            _mm256_zeroupper();
+            Sse2::AbsMean(a + i, b + i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void Abs(const float* input, int count, float* output)
+        {
+            __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(output + i, _mm256_and_ps(_mm256_loadu_ps(input + i), absMask));
+            }
+            _mm256_zeroupper();
+            Sse2::Abs(input + i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 float Sum(const float* input, int count)
+        {
+            __m256 totals = _mm256_setzero_ps();
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                totals = _mm256_add_ps(totals, _mm256_loadu_ps(input + i));
+            }
+            float lanes[8];
+            _mm256_storeu_ps(lanes, totals);
+            _mm256_zeroupper();
+            return Scalar::Sum(lanes, 8) + Sse2::Sum(input + i, count - i);
+        }
+
+        NOWSOUND_TARGET_AVX2 void MinMax(const float* input, int count, float* min, float* max)
+        {
+            Check(count > 0);
+            if (count < 8)
+            {
+                Sse2::MinMax(input, count, min, max);
+                return;
+            }
+
+            __m256 mins = _mm256_loadu_ps(input);
+            __m256 maxes = mins;
+            int i = 8;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 values = _mm256_loadu_ps(input + i);
+                mins = _mm256_min_ps(mins, values);
+                maxes = _mm256_max_ps(maxes, values);
+            }
+            float minLanes[8];
+            float maxLanes[8];
+            _mm256_storeu_ps(minLanes, mins);
+            _mm256_storeu_ps(maxLanes, maxes);
+            _mm256_zeroupper();
+            float ignored;
+            Scalar::MinMax(minLanes, 8, min, &ignored);
+            Scalar::MinMax(maxLanes, 8, &ignored, max);
+            if (i < count)
+            {
+                float tailMin, tailMax;
+                Sse2::MinMax(input + i, count - i, &tailMin, &tailMax);
+                *min = tailMin < *min ? tailMin : *min;
+                *max = tailMax > *max ? tailMax : *max;
+            }
+        }
+
+        // Four complex values per vector.
+        NOWSOUND_TARGET_AVX2 void FftPass(float* data, int complexCount, int halfSize, const float* twiddles)
+        {
+            if (halfSize < 4)
+            {
+                Sse2::FftPass(data, complexCount, halfSize, twiddles);
+                return;
+            }
+
+            for (int group = 0; group < complexCount; group += 2 * halfSize)
+            {
+                float* a = data + 2 * group;
+                float* b = a + 2 * halfSize;
+                for (int j = 0; j < 2 * halfSize; j += 8)
+                {
+                    __m256 twiddle = _mm256_loadu_ps(twiddles + j);
+                    __m256 twiddleReals = _mm256_permute_ps(twiddle, _MM_SHUFFLE(2, 2, 0, 0));
+                    __m256 twiddleImaginaries = _mm256_permute_ps(twiddle, _MM_SHUFFLE(3, 3, 1, 1));
+                    __m256 bValues = _mm256_loadu_ps(b + j);
+                    __m256 bSwapped = _mm256_permute_ps(bValues, _MM_SHUFFLE(2, 3, 0, 1));
+                    __m256 t = _mm256_addsub_ps(
+                        _mm256_mul_ps(bValues, twiddleReals),
+                        _mm256_mul_ps(bSwapped, twiddleImaginaries));
+                    __m256 aValues = _mm256_loadu_ps(a + j);
+                    _mm256_storeu_ps(b + j, _mm256_sub_ps(aValues, t));
+                    _mm256_storeu_ps(a + j, _mm256_add_ps(aValues, t));
+                }
+            }
+            _mm256_zeroupper();
+        }
+
+        NOWSOUND_TARGET_AVX2 void ComplexMagnitude(const float* input, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 first = _mm256_loadu_ps(input + 2 * i);
+                __m256 second = _mm256_loadu_ps(input + 2 * i + 8);
+                first = _mm256_mul_ps(first, first);
+                second = _mm256_mul_ps(second, second);
+                // the shuffles work within 128-bit lanes, leaving values 0 1 4 5 2 3 6 7; the permute restores order
+                __m256 reals = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+                __m256 imaginaries = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+                __m256 magnitudes = _mm256_sqrt_ps(_mm256_add_ps(reals, imaginaries));
+                magnitudes = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(magnitudes), _MM_SHUFFLE(3, 1, 2, 0)));
+                _mm256_storeu_ps(output + i, magnitudes);
+            }
+            _mm256_zeroupper();
+            Sse2::ComplexMagnitude(input + 2 * i, count - i, output + i);
+        }
+
+        NOWSOUND_TARGET_AVX2 float Dot(const float* a, const float* b, int count)
+        {
+            __m256 totals = _mm256_setzero_ps();
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                totals = _mm256_add_ps(totals, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            }
+            float lanes[8];
+            _mm256_storeu_ps(lanes, totals);
+            _mm256_zeroupper();
+            return Scalar::Sum(lanes, 8) + Sse2::Dot(a + i, b + i, count - i);
+        }
+    }
+
+    const KernelTable Avx2Table{
+        KernelSet::Avx2,
+        Avx2::GainPanClamp,
+        Avx2::GainPanClampPerSample,
+        Avx2::GainPanAccumulate,
+        Avx2::Reverse,
+        Avx2::FourTapFilter,
+        Avx2::ResampleCubic,
+        Avx2::MultiplyAccumulate,
+        Avx2::Interleave,
+        Avx2::Deinterleave,
+        Avx2::Crossfade,
+        Avx2::CrossfadePerSample,
+        Avx2::LinearRamp,
+        Avx2::ExponentialRamp,
+        Avx2::AbsMean,
+        Avx2::Abs,
+        Avx2::Sum,
+        Avx2::MinMax,
+        Avx2::FftPass,
+        Avx2::ComplexMagnitude,
+        Avx2::Dot
+    };
+
+    bool CpuSupportsSse2()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        // part of the x64 baseline
+        return true;
+#elif defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+        return (registers[3] & (1 << 26)) != 0;
+#else
+        return __builtin_cpu_supports("sse2");
+#endif
+    }
+
+    bool CpuSupportsAvx2()
+    {
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 0);
+        if (registers[0] < 7)
+        {
+            return false;
+        }
+
+        // the OS must also save the YMM registers on context switch
+        __cpuid(registers, 1);
+        bool osSavesYmm = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (!osSavesYmm)
+        {
+            return false;
+        }
+
+        __cpuidex(registers, 7, 0);
+        return (registers[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif // NOWSOUND_KERNELS_X86
+
+#ifdef NOWSOUND_KERNELS_NEON
+    namespace Neon
+    {
+        void GainPanClamp(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right)
+        {
+            float32x4_t leftGains = vdupq_n_f32(leftGain);
+            float32x4_t rightGains = vdupq_n_f32(rightGain);
+            float32x4_t highs = vdupq_n_f32(limit);
+            float32x4_t lows = vdupq_n_f32(-limit);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t values = vld1q_f32(mono + i);
+                vst1q_f32(left + i, vmaxq_f32(lows, vminq_f32(highs, vmulq_f32(leftGains, values))));
+                vst1q_f32(right + i, vmaxq_f32(lows, vminq_f32(highs, vmulq_f32(rightGains, values))));
+            }
+            Scalar::GainPanClamp(mono + i, count - i, leftGain, rightGain, limit, left + i, right + i);
+        }
+
+        void GainPanAccumulate(const float* mono, int count, float leftGain, float rightGain, float* left, float* right)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t values = vld1q_f32(mono + i);
+                vst1q_f32(left + i, vmlaq_n_f32(vld1q_f32(left + i), values, leftGain));
+                vst1q_f32(right + i, vmlaq_n_f32(vld1q_f32(right + i), values, rightGain));
+            }
+            Scalar::GainPanAccumulate(mono + i, count - i, leftGain, rightGain, left + i, right + i);
+        }
+
+        void Reverse(const float* input, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t pairsSwapped = vrev64q_f32(vld1q_f32(input + i));
+                vst1q_f32(output + count - 4 - i, vcombine_f32(vget_high_f32(pairsSwapped), vget_low_f32(pairsSwapped)));
+            }
+            Scalar::Reverse(input + i, count - i, output);
+        }
+
+        void FourTapFilter(const float* input, int count, const float* taps, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t sum = vmulq_n_f32(vld1q_f32(input + i), taps[0]);
+                sum = vmlaq_n_f32(sum, vld1q_f32(input + i + 1), taps[1]);
+                sum = vmlaq_n_f32(sum, vld1q_f32(input + i + 2), taps[2]);
+                sum = vmlaq_n_f32(sum, vld1q_f32(input + i + 3), taps[3]);
+                vst1q_f32(output + i, sum);
+            }
+            Scalar::FourTapFilter(input + i, count - i, taps, output + i);
+        }
+
+        void ResampleCubic(const float* input, float start, float step, int count, float* output)
+        {
+            float32x4_t starts = vdupq_n_f32(start);
+            float32x4_t steps = vdupq_n_f32(step);
+            const int32_t laneValues[4] = { 0, 1, 2, 3 };
+            int32x4_t lanes = vld1q_s32(laneValues);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t positions = vmlaq_f32(starts, vcvtq_f32_s32(vaddq_s32(vdupq_n_s32(i), lanes)), steps);
+                int32x4_t indices = vcvtq_s32_f32(positions);
+                float32x4_t fractions = vsubq_f32(positions, vcvtq_f32_s32(indices));
+
+                // load each lane's four samples, then transpose so each vector holds one tap for every lane
+                int32_t index[4];
+                vst1q_s32(index, indices);
+                float32x4x2_t rows01 = vtrnq_f32(vld1q_f32(input + index[0] - 1), vld1q_f32(input + index[1] - 1));
+                float32x4x2_t rows23 = vtrnq_f32(vld1q_f32(input + index[2] - 1), vld1q_f32(input + index[3] - 1));
+                float32x4_t x0 = vcombine_f32(vget_low_f32(rows01.val[0]), vget_low_f32(rows23.val[0]));
+                float32x4_t x1 = vcombine_f32(vget_low_f32(rows01.val[1]), vget_low_f32(rows23.val[1]));
+                float32x4_t x2 = vcombine_f32(vget_high_f32(rows01.val[0]), vget_high_f32(rows23.val[0]));
+                float32x4_t x3 = vcombine_f32(vget_high_f32(rows01.val[1]), vget_high_f32(rows23.val[1]));
+
+                float32x4_t a = vmlaq_n_f32(vmlsq_n_f32(vmlaq_n_f32(vmulq_n_f32(x0, -0.5f), x1, 1.5f), x2, 1.5f), x3, 0.5f);
+                float32x4_t b = vmlsq_n_f32(vmlaq_n_f32(vmlsq_n_f32(x0, x1, 2.5f), x2, 2), x3, 0.5f);
+                float32x4_t c = vmlaq_n_f32(vmulq_n_f32(x0, -0.5f), x2, 0.5f);
+                float32x4_t result = vmlaq_f32(x1, vmlaq_f32(c, vmlaq_f32(b, a, fractions), fractions), fractions);
+                vst1q_f32(output + i, result);
+            }
+            for (; i < count; i++)
+            {
+                output[i] = CubicSample(input, start + (float)i * step);
+            }
+        }
+
+        void MultiplyAccumulate(const float* a, const float* b, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                vst1q_f32(output + i, vmlaq_f32(vld1q_f32(output + i), vld1q_f32(a + i), vld1q_f32(b + i)));
+            }
+            Scalar::MultiplyAccumulate(a + i, b + i, count - i, output + i);
+        }
+
+        void Interleave(const float* const* channels, int offset, int channelCount, int count, float* output)
+        {
+            if (channelCount != 2)
+            {
+                Scalar::Interleave(channels, offset, channelCount, count, output);
+                return;
+            }
+
+            const float* left = channels[0] + offset;
+            const float* right = channels[1] + offset;
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4x2_t frames;
+                frames.val[0] = vld1q_f32(left + i);
+                frames.val[1] = vld1q_f32(right + i);
+                vst2q_f32(output + 2 * i, frames);
+            }
+            Scalar::Interleave(channels, offset + i, 2, count - i, output + 2 * i);
+        }
+
+        void Deinterleave(const float* input, int channelCount, int count, float* const* channels, int offset)
+        {
+            if (channelCount != 2)
+            {
+                Scalar::Deinterleave(input, channelCount, count, channels, offset);
+                return;
+            }
+
+            float* left = channels[0] + offset;
+            float* right = channels[1] + offset;
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4x2_t frames = vld2q_f32(input + 2 * i);
+                vst1q_f32(left + i, frames.val[0]);
+                vst1q_f32(right + i, frames.val[1]);
+            }
+            Scalar::Deinterleave(input + 2 * i, 2, count - i, channels, offset + i);
+        }
+
+        void Crossfade(const float* dry, const float* wet, int count, float mix, float* output)
+        {
+            float32x4_t dryGains = vdupq_n_f32(1 - mix);
+            float32x4_t wetGains = vdupq_n_f32(mix);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t dryValues = vmulq_f32(vld1q_f32(dry + i), dryGains);
+                float32x4_t wetValues = vmulq_f32(vld1q_f32(wet + i), wetGains);
+                vst1q_f32(output + i, vaddq_f32(dryValues, wetValues));
+            }
+            Scalar::Crossfade(dry + i, wet + i, count - i, mix, output + i);
+        }
+
+        void GainPanClampPerSample(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right)
+        {
+            float32x4_t highs = vdupq_n_f32(limit);
+            float32x4_t lows = vdupq_n_f32(-limit);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t values = vld1q_f32(mono + i);
+                vst1q_f32(left + i, vmaxq_f32(lows, vminq_f32(highs, vmulq_f32(vld1q_f32(leftGains + i), values))));
+                vst1q_f32(right + i, vmaxq_f32(lows, vminq_f32(highs, vmulq_f32(vld1q_f32(rightGains + i), values))));
+            }
+            Scalar::GainPanClampPerSample(mono + i, count - i, leftGains + i, rightGains + i, limit, left + i, right + i);
+        }
+
+        void CrossfadePerSample(const float* dry, const float* wet, int count, const float* mixes, float* output)
+        {
+            float32x4_t ones = vdupq_n_f32(1);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t wetGains = vld1q_f32(mixes + i);
+                float32x4_t dryValues = vmulq_f32(vld1q_f32(dry + i), vsubq_f32(ones, wetGains));
+                vst1q_f32(output + i, vmlaq_f32(dryValues, vld1q_f32(wet + i), wetGains));
+            }
+            Scalar::CrossfadePerSample(dry + i, wet + i, count - i, mixes + i, output + i);
+        }
+
+        void LinearRamp(float start, float step, int count, float* output)
+        {
+            const float firstIndices[4] = { 0, 1, 2, 3 };
+            float32x4_t indices = vld1q_f32(firstIndices);
+            float32x4_t fours = vdupq_n_f32(4);
+            float32x4_t starts = vdupq_n_f32(start);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                vst1q_f32(output + i, vmlaq_n_f32(starts, indices, step));
+                indices = vaddq_f32(indices, fours);
+            }
+            Scalar::LinearRamp(start + step * i, step, count - i, output + i);
+        }
+
+        void ExponentialRamp(float start, float target, float ratio, int count, float* output)
+        {
+            float ratio2 = ratio * ratio;
+            float distance = start - target;
+            const float firstDistances[4] = { distance, distance * ratio, distance * ratio2, distance * ratio2 * ratio };
+            float32x4_t distances = vld1q_f32(firstDistances);
+            float32x4_t targets = vdupq_n_f32(target);
+            float ratio4 = ratio2 * ratio2;
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                vst1q_f32(output + i, vaddq_f32(targets, distances));
+                distances = vmulq_n_f32(distances, ratio4);
+            }
+            float lanes[4];
+            vst1q_f32(lanes, distances);
+            Scalar::ExponentialRamp(target + lanes[0], target, ratio, count - i, output + i);
+        }
+
+        void AbsMean(const float* a, const float* b, int count, float* output)
+        {
+            float32x4_t halves = vdupq_n_f32(0.5f);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t aValues = vabsq_f32(vld1q_f32(a + i));
+                float32x4_t bValues = vabsq_f32(vld1q_f32(b + i));
+                vst1q_f32(output + i, vaddq_f32(vmulq_f32(aValues, halves), vmulq_f32(bValues, halves)));
+            }
+            Scalar::AbsMean(a + i, b + i, count - i, output + i);
+        }
+
+        void Abs(const float* input, int count, float* output)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                vst1q_f32(output + i, vabsq_f32(vld1q_f32(input + i)));
+            }
+            Scalar::Abs(input + i, count - i, output + i);
+        }
+
+        float Sum(const float* input, int count)
+        {
+            float32x4_t totals = vdupq_n_f32(0);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                totals = vaddq_f32(totals, vld1q_f32(input + i));
+            }
+            float lanes[4];
+            vst1q_f32(lanes, totals);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + Scalar::Sum(input + i, count - i);
+        }
+
+        void MinMax(const float* input, int count, float* min, float* max)
+        {
+            Check(count > 0);
+            if (count < 4)
+            {
+                Scalar::MinMax(input, count, min, max);
+                return;
+            }
+
+            float32x4_t mins = vld1q_f32(input);
+            float32x4_t maxes = mins;
+            int i = 4;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t values = vld1q_f32(input + i);
+                mins = vminq_f32(mins, values);
+                maxes = vmaxq_f32(maxes, values);
+            }
+            float minLanes[4];
+            float maxLanes[4];
+            vst1q_f32(minLanes, mins);
+            vst1q_f32(maxLanes, maxes);
+            float ignored;
+            Scalar::MinMax(minLanes, 4, min, &ignored);
+            Scalar::MinMax(maxLanes, 4, &ignored, max);
+            if (i < count)
+            {
+                float tailMin, tailMax;
+                Scalar::MinMax(input + i, count - i, &tailMin, &tailMax);
+                *min = tailMin < *min ? tailMin : *min;
+                *max = tailMax > *max ? tailMax : *max;
+            }
+        }
+
+        // Four complex values per vector, deinterleaved into real and imaginary vectors on load.
+        void FftPass(float* data, int complexCount, int halfSize, const float* twiddles)
+        {
+            if (halfSize < 4)
+            {
+                Scalar::FftPass(data, complexCount, halfSize, twiddles);
+                return;
+            }
+
+            for (int group = 0; group < complexCount; group += 2 * halfSize)
+            {
+                float* a = data + 2 * group;
+                float* b = a + 2 * halfSize;
+                for (int j = 0; j < 2 * halfSize; j += 8)
+                {
+                    float32x4x2_t twiddle = vld2q_f32(twiddles + j);
+                    float32x4x2_t bValues = vld2q_f32(b + j);
+                    float32x4_t tReal = vmlsq_f32(vmulq_f32(bValues.val[0], twiddle.val[0]), bValues.val[1], twiddle.val[1]);
+                    float32x4_t tImaginary = vmlaq_f32(vmulq_f32(bValues.val[0], twiddle.val[1]), bValues.val[1], twiddle.val[0]);
+                    float32x4x2_t aValues = vld2q_f32(a + j);
+                    float32x4x2_t difference = { { vsubq_f32(aValues.val[0], tReal), vsubq_f32(aValues.val[1], tImaginary) } };
+                    float32x4x2_t sum = { { vaddq_f32(aValues.val[0], tReal), vaddq_f32(aValues.val[1], tImaginary) } };
+                    vst2q_f32(b + j, difference);
+                    vst2q_f32(a + j, sum);
+                }
+            }
+        }
+
+        void ComplexMagnitude(const float* input, int count, float* output)
+        {
+            int i = 0;
+#if defined(_M_ARM64) || defined(__aarch64__)
+            // (32-bit NEON has no vector square root)
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4x2_t values = vld2q_f32(input + 2 * i);
+                float32x4_t squares = vmlaq_f32(vmulq_f32(values.val[0], values.val[0]), values.val[1], values.val[1]);
+                vst1q_f32(output + i, vsqrtq_f32(squares));
+            }
+#endif
+            Scalar::ComplexMagnitude(input + 2 * i, count - i, output + i);
+        }
+
+        float Dot(const float* a, const float* b, int count)
+        {
+            float32x4_t totals = vdupq_n_f32(0);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                totals = vmlaq_f32(totals, vld1q_f32(a + i), vld1q_f32(b + i));
+            }
+            float lanes[4];
+            vst1q_f32(lanes, totals);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + Scalar::Dot(a + i, b + i, count - i);
+        }
+    }
+
+    const KernelTable NeonTable{
+        KernelSet::Neon,
+        Neon::GainPanClamp,
+        Neon::GainPanClampPerSample,
+        Neon::GainPanAccumulate,
+        Neon::Reverse,
+        Neon::FourTapFilter,
+        Neon::ResampleCubic,
+        Neon::MultiplyAccumulate,
+        Neon::Interleave,
+        Neon::Deinterleave,
+        Neon::Crossfade,
+        Neon::CrossfadePerSample,
+        Neon::LinearRamp,
+        Neon::ExponentialRamp,
+        Neon::AbsMean,
+        Neon::Abs,
+        Neon::Sum,
+        Neon::MinMax,
+        Neon::FftPass,
+        Neon::ComplexMagnitude,
+        Neon::Dot
+    };
+#endif // NOWSOUND_KERNELS_NEON
+
+    // The table for the given kernel set, or nullptr if it is not compiled in or not supported by this CPU.
+    const KernelTable* TableFor(KernelSet kernelSet)
+    {
+        switch (kernelSet)
+        {
+        case KernelSet::Scalar:
+            return &ScalarTable;
+#ifdef NOWSOUND_KERNELS_X86
+        case KernelSet::Sse2:
+            return CpuSupportsSse2() ? &Sse2Table : nullptr;
+        case KernelSet::Avx2:
+            // the AVX2 kernels fall back to SSE2 for their tails
+            return CpuSupportsSse2() && CpuSupportsAvx2() ? &Avx2Table : nullptr;
+#endif
+#ifdef NOWSOUND_KERNELS_NEON
+        case KernelSet::Neon:
+            return &NeonTable;
+#endif
+        default:
+            return nullptr;
+        }
+    }
+
+    const KernelTable* BestTable()
+    {
+        for (KernelSet kernelSet : { KernelSet::Avx2, KernelSet::Sse2, KernelSet::Neon })
+        {
+            const KernelTable* table = TableFor(kernelSet);
+            if (table != nullptr)
+            {
+                return table;
+            }
+        }
+        return &ScalarTable;
+    }
+
+    // Chosen once at startup, before any audio processing.
+    const KernelTable* s_activeTable = BestTable();
+}
+
+bool Kernels::IsSupported(KernelSet kernelSet)
+{
+    return TableFor(kernelSet) != nullptr;
+}
+
+KernelSet Kernels::ActiveKernelSet()
+{
+    return s_activeTable->Set;
+}
+
+void Kernels::UseKernelSet(KernelSet kernelSet)
+{
+    const KernelTable* table = TableFor(kernelSet);
+    Check(table != nullptr);
+    s_activeTable = table;
+}
+
+void Kernels::GainPanClamp(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right)
+{
+    Check(count >= 0);
+    Check(limit > 0);
+    s_activeTable->GainPanClamp(mono, count, leftGain, rightGain, limit, left, right);
+}
+
+void Kernels::GainPanClampPerSample(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right)
+{
+    Check(count >= 0);
+    Check(limit > 0);
+    s_activeTable->GainPanClampPerSample(mono, count, leftGains, rightGains, limit, left, right);
+}
+
+void Kernels::GainPanAccumulate(const float* mono, int count, float leftGain, float rightGain, float* left, float* right)
+{
+    Check(count >= 0);
+    s_activeTable->GainPanAccumulate(mono, count, leftGain, rightGain, left, right);
+}
+
+void Kernels::Reverse(const float* input, int count, float* output)
+{
+    Check(count >= 0);
+    Check(input + count <= output || output + count <= input);
+    s_activeTable->Reverse(input, count, output);
+}
+
+void Kernels::FourTapFilter(const float* input, int count, const float* taps, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->FourTapFilter(input, count, taps, output);
+}
+
+void Kernels::ResampleCubic(const float* input, float start, float step, int count, float* output)
+{
+    Check(count >= 0);
+    Check(start >= 1 && step > 0);
+    s_activeTable->ResampleCubic(input, start, step, count, output);
+}
+
+void Kernels::MultiplyAccumulate(const float* a, const float* b, int count, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->MultiplyAccumulate(a, b, count, output);
+}
+
+void Kernels::Interleave(const float* const* channels, int offset, int channelCount, int count, float* output)
+{
+    Check(count >= 0);
+    Check(channelCount >= 1 && offset >= 0);
+    s_activeTable->Interleave(channels, offset, channelCount, count, output);
+}
+
+void Kernels::Deinterleave(const float* input, int channelCount, int count, float* const* channels, int offset)
+{
+    Check(count >= 0);
+    Check(channelCount >= 1 && offset >= 0);
+    s_activeTable->Deinterleave(input, channelCount, count, channels, offset);
+}
+
+void Kernels::Crossfade(const float* dry, const float* wet, int count, float mix, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->Crossfade(dry, wet, count, mix, output);
+}
+
+void Kernels::CrossfadePerSample(const float* dry, const float* wet, int count, const float* mixes, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->CrossfadePerSample(dry, wet, count, mixes, output);
+}
+
+void Kernels::LinearRamp(float start, float step, int count, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->LinearRamp(start, step, count, output);
+}
+
+void Kernels::ExponentialRamp(float start, float target, float ratio, int count, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->ExponentialRamp(start, target, ratio, count, output);
+}
+
+void Kernels::AbsMean(const float* a, const float* b, int count, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->AbsMean(a, b, count, output);
+}
+
+void Kernels::Abs(const float* input, int count, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->Abs(input, count, output);
+}
+
+float Kernels::Sum(const float* input, int count)
+{
+    Check(count >= 0);
+    return s_activeTable->Sum(input, count);
+}
+
+void Kernels::MinMax(const float* input, int count, float* min, float* max)
+{
+    Check(count > 0);
+    s_activeTable->MinMax(input, count, min, max);
+}
+
+void Kernels::FftPass(float* data, int complexCount, int halfSize, const float* twiddles)
+{
+    Check(halfSize > 0 && (halfSize & (halfSize - 1)) == 0);
+    Check(complexCount % (2 * halfSize) == 0);
+    s_activeTable->FftPass(data, complexCount, halfSize, twiddles);
+}
+
+void Kernels::ComplexMagnitude(const float* input, int count, float* output)
+{
+    Check(count >= 0);
+    s_activeTable->ComplexMagnitude(input, count, output);
+}
+
+float Kernels::Dot(const float* a, const float* b, int count)
+{
+    Check(count >= 0);
+    return s_activeTable->Dot(a, b, count);
+}
+
+void Kernels::Prefetch(const void* address, int64_t byteCount)
+{
+    // the usual cache line size on both x86 and ARM
+    const int64_t cacheLineBytes = 64;
+
+    const char* start = static_cast<const char*>(address);
+    for (int64_t offset = 0; offset < byteCount; offset += cacheLineBytes)
+    {
+#if defined(NOWSOUND_KERNELS_X86)
+        _mm_prefetch(start + offset, _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(start + offset);
+#else
+        (void)start;
+#endif
+    }
+}
@@ -0,0 +1,118 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include "stdafx.h"
+
+#include "stdint.h"
+
+namespace NowSound
+{
+    // Vectorized implementations of the per-sample loops on the audio thread.
+    //
+    // Each kernel has a scalar implementation plus SSE2 and AVX2 (x86/x64) or NEON (ARM) implementations.
+    // The best kernel set the CPU supports is selected once, at startup; the free functions below dispatch
+    // through it.  All kernels accept arbitrary (unaligned) pointers and any count >= 0.
+    namespace Kernels
+    {
+        enum class KernelSet
+        {
+            // Plain C++ loops; always supported.
+            Scalar,
+            // 4-wide SSE2.
+            Sse2,
+            // 8-wide AVX2.
+            Avx2,
+            // 4-wide NEON.
+            Neon
+        };
+
+        // Is this kernel set compiled in, and supported by this CPU?
+        bool IsSupported(KernelSet kernelSet);
+
+        // The kernel set the functions below currently dispatch to.
+        KernelSet ActiveKernelSet();
+
+        // Switch kernel sets (which must be supported); for testing and benchmarking only, as this is not
+        // synchronized with the audio thread.
+        void UseKernelSet(KernelSet kernelSet);
+
+        // left[i] = clamp(leftGain * mono[i]), right[i] = clamp(rightGain * mono[i]), where clamp limits
+        // values to [-limit, limit].  mono may be the same as left or right, or both (to scale and clamp it in place).
+        void GainPanClamp(const float* mono, int count, float leftGain, float rightGain, float limit, float* left, float* right);
+
+        // As GainPanClamp, but with a gain per sample: left[i] = clamp(leftGains[i] * mono[i]), and likewise
+        // right[i].  mono may be the same as left or right, or both.
+        void GainPanClampPerSample(const float* mono, int count, const float* leftGains, const float* rightGains, float limit, float* left, float* right);
+
+        // left[i] += leftGain * mono[i], right[i] += rightGain * mono[i]: mix a panned mono signal into both
+        // channels in one pass.  Does not clamp.
+        void GainPanAccumulate(const float* mono, int count, float leftGain, float rightGain, float* left, float* right);
+
+        // output[count - 1 - i] = input[i]; for playing audio backwards.  input and output must not overlap.
+        void Reverse(const float* input, int count, float* output);
+
+        // output[i] = taps[0] * input[i] + taps[1] * input[i + 1] + taps[2] * input[i + 2] + taps[3] * input[i + 3],
+        // reading count + 3 inputs; for interpolating a signal at a fixed fractional offset.  output must not
+        // overlap input.
+        void FourTapFilter(const float* input, int count, const float* taps, float* output);
+
+        // output[i] = input interpolated (cubic Hermite) at position start + i * step, reading input[p - 1] through
+        // input[p + 2] for each whole position p; for playing audio at another rate.  start must be at least 1.
+        void ResampleCubic(const float* input, float start, float step, int count, float* output);
+
+        // output[i] += a[i] * b[i]; for windowed overlap-add.
+        void MultiplyAccumulate(const float* a, const float* b, int count, float* output);
+
+        // output[i * channelCount + c] = channels[c][offset + i]: interleave count frames of channelCount separate
+        // channels into one array.  The output must not overlap any channel.
+        void Interleave(const float* const* channels, int offset, int channelCount, int count, float* output);
+
+        // channels[c][offset + i] = input[i * channelCount + c]: split count interleaved frames into channelCount
+        // separate channels.  No channel may overlap the input.
+        void Deinterleave(const float* input, int channelCount, int count, float* const* channels, int offset);
+
+        // output[i] = dry[i] * (1 - mix) + wet[i] * mix.  output may be the same as dry or wet.
+        void Crossfade(const float* dry, const float* wet, int count, float mix, float* output);
+
+        // As Crossfade, but with a mix per sample: output[i] = dry[i] * (1 - mixes[i]) + wet[i] * mixes[i].
+        // output may be the same as dry or wet.
+        void CrossfadePerSample(const float* dry, const float* wet, int count, const float* mixes, float* output);
+
+        // output[i] = start + step * i.
+        void LinearRamp(float start, float step, int count, float* output);
+
+        // output[i] = target + (start - target) * ratio^i: an exponential approach to target.
+        void ExponentialRamp(float start, float target, float ratio, int count, float* output);
+
+        // output[i] = (|a[i]| + |b[i]|) / 2.  output may be the same as a or b.
+        void AbsMean(const float* a, const float* b, int count, float* output);
+
+        // output[i] = |input[i]|.  output may be the same as input.
+        void Abs(const float* input, int count, float* output);
+
+        // Sum of all values.
+        float Sum(const float* input, int count);
+
+        // Minimum and maximum of all values; count must be > 0.
+        void MinMax(const float* input, int count, float* min, float* max);
+
+        // One radix-2 decimation-in-time FFT pass, in place, over complexCount interleaved (real, imaginary)
+        // values: within each group of 2 * halfSize values, for each j < halfSize,
+        //     t = data[j + halfSize] * twiddles[j];  data[j + halfSize] = data[j] - t;  data[j] += t.
+        // halfSize must be a power of two, complexCount a multiple of 2 * halfSize, and twiddles must hold
+        // halfSize interleaved complex values.
+        void FftPass(float* data, int complexCount, int halfSize, const float* twiddles);
+
+        // output[i] = |complex value i|, for count interleaved (real, imaginary) values in input.
+        void ComplexMagnitude(const float* input, int count, float* output);
+
+        // Sum of a[i] * b[i].
+        float Dot(const float* a, const float* b, int count);
+
+        // Hint that the byteCount bytes at address will be read soon, so the cache can start fetching them.
+        // Not a kernel (it is the same for every kernel set), and never faults, whatever the address.
+        void Prefetch(const void* address, int64_t byteCount);
+    }
+}
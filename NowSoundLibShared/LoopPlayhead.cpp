@@ -0,0 +1,322 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Check.h"
+#include "Kernels.h"
+#include "LoopPlayhead.h"
+
+using namespace NowSound;
+
+LoopPlayhead::LoopPlayhead(LoopInterpolation interpolation, int channelCount)
+    : _interpolation{ interpolation },
+    _channelCount{ channelCount },
+    _cursor{},
+    _window((WindowSamples + 3) * channelCount),
+    _channelWindows(channelCount == 1 ? 0 : (WindowSamples + 3) * channelCount),
+    _interpolated(WindowSamples * channelCount)
+{
+    Check(channelCount >= 1 && channelCount <= MaximumChannels);
+}
+
+void LoopPlayhead::SplitPointers(float* buffer, int stride, float** channels) const
+{
+    for (int c = 0; c < _channelCount; c++)
+    {
+        channels[c] = buffer + c * stride;
+    }
+}
+
+void LoopPlayhead::SplitWindow(int count, float** channels)
+{
+    if (_channelCount == 1)
+    {
+        channels[0] = _window.data();
+        return;
+    }
+
+    SplitPointers(_channelWindows.data(), WindowSamples + 3, channels);
+    Kernels::Deinterleave(_window.data(), _channelCount, count, channels, 0);
+}
+
+void LoopPlayhead::ReverseInterpolated(int count, float* const* destinations, int offset)
+{
+    for (int c = 0; c < _channelCount; c++)
+    {
+        Kernels::Reverse(_interpolated.data() + c * WindowSamples, count, destinations[c] + offset);
+    }
+}
+
+void LoopPlayhead::CopyLoopSamples(int64_t discreteDuration, int64_t first, int count, float* destination)
+{
+    int64_t index = first % discreteDuration;
+    if (index < 0)
+    {
+        index += discreteDuration;
+    }
+
+    while (count > 0)
+    {
+        _cursor.MoveTo(index);
+
+        // segments never extend past the end of the loop
+        int64_t run = std::min<int64_t>(count, _cursor.SegmentEnd().Value() - index);
+        std::memcpy(destination, _cursor.DataAt(index), (size_t)(run * _channelCount) * sizeof(float));
+
+        destination += run * _channelCount;
+        count -= (int)run;
+        index += run;
+        if (index == discreteDuration)
+        {
+            index = 0;
+        }
+    }
+}
+
+void LoopPlayhead::Interpolate(int64_t discreteDuration, int64_t first, float fraction, int count, float* const* destinations, int offset)
+{
+    Check(count <= WindowSamples);
+
+    // the taps apply to the samples at first - 1, first, first + 1 and first + 2
+    float taps[4];
+    if (_interpolation == LoopInterpolation::Linear)
+    {
+        taps[0] = 0;
+        taps[1] = 1 - fraction;
+        taps[2] = fraction;
+        taps[3] = 0;
+    }
+    else
+    {
+        Check(_interpolation == LoopInterpolation::CubicHermite);
+        float fraction2 = fraction * fraction;
+        float fraction3 = fraction2 * fraction;
+        taps[0] = -0.5f * fraction3 + fraction2 - 0.5f * fraction;
+        taps[1] = 1.5f * fraction3 - 2.5f * fraction2 + 1;
+        taps[2] = -1.5f * fraction3 + 2 * fraction2 + 0.5f * fraction;
+        taps[3] = 0.5f * fraction3 - 0.5f * fraction2;
+    }
+
+    CopyLoopSamples(discreteDuration, first - 1, count + 3, _window.data());
+    float* channels[MaximumChannels];
+    SplitWindow(count + 3, channels);
+    for (int c = 0; c < _channelCount; c++)
+    {
+        Kernels::FourTapFilter(channels[c], count, taps, destinations[c] + offset);
+    }
+}
+
+void LoopPlayhead::Resample(int64_t discreteDuration, int64_t first, float fraction, float rate, int count, float* const* destinations, int offset)
+{
+    Check(count > 0 && (count - 1) * rate < WindowSamples - 1);
+
+    // the window starts a sample before first, so the first position within it is 1 + fraction
+    int copyCount = std::min(WindowSamples + 3, (int)(fraction + (count - 1) * rate) + 4);
+    CopyLoopSamples(discreteDuration, first - 1, copyCount, _window.data());
+    float* channels[MaximumChannels];
+    SplitWindow(copyCount, channels);
+    for (int c = 0; c < _channelCount; c++)
+    {
+        Kernels::ResampleCubic(channels[c], 1 + fraction, rate, count, destinations[c] + offset);
+    }
+}
+
+void LoopPlayhead::Attach(const BufferedSliceStream<AudioSample, float>& stream)
+{
+    if (_cursor.Stream() != &stream)
+    {
+        _cursor = SliceStreamCursor<AudioSample, float>(stream);
+    }
+}
+
+void LoopPlayhead::CopyLoop(const BufferedSliceStream<AudioSample, float>& stream, int64_t first, int count, float* destination)
+{
+    Check(stream.IsShut());
+    Check(stream.SliceSize() == _channelCount);
+    Check(count >= 0);
+
+    Attach(stream);
+    CopyLoopSamples(stream.DiscreteDuration().Value(), first, count, destination);
+}
+
+void LoopPlayhead::Render(
+    const BufferedSliceStream<AudioSample, float>& stream,
+    ContinuousTime<AudioSample>& position,
+    Direction direction,
+    int count,
+    float* destination,
+    float rate)
+{
+    Check(_channelCount == 1);
+    Render(stream, position, direction, count, &destination, rate);
+}
+
+void LoopPlayhead::Render(
+    const BufferedSliceStream<AudioSample, float>& stream,
+    ContinuousTime<AudioSample>& position,
+    Direction direction,
+    int count,
+    float* const* destinations,
+    float rate)
+{
+    Check(stream.IsShut());
+    Check(stream.SliceSize() == _channelCount);
+    Check(count >= 0);
+    Check(rate > 0 && rate <= MaximumRate);
+
+    // Work in double, so the fractional part survives long loops; position itself is only a float.
+    double exactDuration = stream.ExactDuration().Value();
+    Check(exactDuration >= 1);
+    int64_t discreteDuration = stream.DiscreteDuration().Value();
+
+    Attach(stream);
+
+    double time = std::fmod((double)position.Value(), exactDuration);
+    if (time < 0)
+    {
+        time += exactDuration;
+    }
+
+    int completed = 0;
+    if (rate != 1)
+    {
+        // Resample, a window at a time; each window's positions must span less than WindowSamples - 1 samples.
+        int maximumRun = std::max(1, (int)((WindowSamples - 1) / rate));
+        while (completed < count)
+        {
+            int64_t remaining = std::min<int64_t>(count - completed, maximumRun);
+            if (direction == Direction::Forwards)
+            {
+                // play up to the end of the loop (the first time >= exactDuration) or of the block
+                int64_t first = (int64_t)time;
+                int64_t run = std::min(remaining, (int64_t)std::ceil((exactDuration - time) / rate));
+                Resample(discreteDuration, first, (float)(time - first), rate, (int)run, destinations, completed);
+
+                time += run * (double)rate;
+                if (time >= exactDuration)
+                {
+                    time -= exactDuration;
+                }
+                completed += (int)run;
+            }
+            else
+            {
+                // play down to time 0, wrapping to the end of the loop once there is no time rate before time;
+                // resample forwards from the earliest time, then reverse
+                while (time < rate)
+                {
+                    time += exactDuration;
+                }
+
+                int64_t run = std::min(remaining, (int64_t)(time / rate));
+                double start = time - run * (double)rate;
+                int64_t first = (int64_t)start;
+                float* interpolated[MaximumChannels];
+                SplitPointers(_interpolated.data(), WindowSamples, interpolated);
+                Resample(discreteDuration, first, (float)(start - first), rate, (int)run, interpolated, 0);
+                ReverseInterpolated((int)run, destinations, completed);
+
+                time = start;
+                completed += (int)run;
+            }
+        }
+
+        // a backwards wrap may leave time past the end of the loop, if the block ended soon after it
+        if (time >= exactDuration)
+        {
+            time = std::fmod(time, exactDuration);
+        }
+    }
+
+    while (completed < count)
+    {
+        int64_t remaining = count - completed;
+        if (direction == Direction::Forwards)
+        {
+            // Play from time up to the end of the loop (the first time >= exactDuration), or of the block,
+            // whichever comes first; and, if copying, not past the end of the segment.
+            int64_t first = (int64_t)time;
+            float fraction = (float)(time - first);
+            int64_t run = std::min(remaining, (int64_t)std::ceil(exactDuration - time));
+
+            if (_interpolation == LoopInterpolation::Nearest || fraction == 0)
+            {
+                _cursor.MoveTo(first);
+                run = std::min(run, _cursor.SegmentEnd().Value() - first);
+                Kernels::Deinterleave(_cursor.DataAt(first), _channelCount, (int)run, destinations, completed);
+            }
+            else
+            {
+                run = std::min<int64_t>(run, WindowSamples);
+                Interpolate(discreteDuration, first, fraction, (int)run, destinations, completed);
+            }
+
+            time += run;
+            if (time >= exactDuration)
+            {
+                time -= exactDuration;
+            }
+            completed += (int)run;
+        }
+        else
+        {
+            // The mirror image: play from a sample before time down to time 0, wrapping to the end of the
+            // loop (keeping the fractional part) once there is no whole sample left before time.
+            if (time < 1)
+            {
+                time += exactDuration;
+            }
+
+            int64_t end = (int64_t)time;
+            float fraction = (float)(time - end);
+            int64_t run = std::min(remaining, end);
+
+            if (_interpolation == LoopInterpolation::Nearest || fraction == 0)
+            {
+                _cursor.MoveTo(end - 1);
+                run = std::min(run, end - _cursor.SegmentStart().Value());
+                if (_channelCount == 1)
+                {
+                    Kernels::Reverse(_cursor.DataAt(end - run), (int)run, destinations[0] + completed);
+                }
+                else
+                {
+                    // split the channels first, then reverse each
+                    run = std::min<int64_t>(run, WindowSamples);
+                    float* split[MaximumChannels];
+                    SplitPointers(_interpolated.data(), WindowSamples, split);
+                    Kernels::Deinterleave(_cursor.DataAt(end - run), _channelCount, (int)run, split, 0);
+                    ReverseInterpolated((int)run, destinations, completed);
+                }
+            }
+            else
+            {
+                // interpolate forwards from the earliest time, then reverse
+                run = std::min<int64_t>(run, WindowSamples);
+                float* interpolated[MaximumChannels];
+                SplitPointers(_interpolated.data(), WindowSamples, interpolated);
+                Interpolate(discreteDuration, end - run, fraction, (int)run, interpolated, 0);
+                ReverseInterpolated((int)run, destinations, completed);
+            }
+
+            time -= run;
+            completed += (int)run;
+        }
+    }
+
+    position = ContinuousTime<AudioSample>((float)time);
+
+    // get the next block on its way into the cache
+    if (count > 0)
+    {
+        int64_t next = direction == Direction::Forwards
+            ? (int64_t)time
+            : (int64_t)(time < 1 ? time + exactDuration : time);
+        _cursor.Prefetch(next, (int64_t)std::ceil(count * rate), direction);
+    }
+}
@@ -0,0 +1,148 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include "stdafx.h"
+
+#include <vector>
+
+#include "stdint.h"
+
+#include "Interval.h"
+#include "NowSoundTime.h"
+#include "Slice.h"
+#include "SliceStream.h"
+
+namespace NowSound
+{
+    // How a LoopPlayhead reads the loop between samples.
+    enum class LoopInterpolation
+    {
+        // Play the sample at or before each time.  Cheapest, and bit-exact, but a loop of fractional length
+        // then plays one sample more on some passes than on others, which is heard as a tiny periodic jump.
+        Nearest,
+
+        // Interpolate linearly between the two samples around each time.
+        Linear,
+
+        // Interpolate with a (Catmull-Rom) cubic Hermite spline through the four samples around each time;
+        // much less high-frequency loss than linear, for four multiply-adds per sample.
+        CubicHermite
+    };
+
+    // Plays a shut stream as a loop, forwards or backwards, a block at a time.  The stream may be mono, or hold
+    // several channels interleaved (one slice per frame, one value per channel); each channel is then rendered
+    // into its own destination.
+    //
+    // The position is continuous, and the loop restarts at exactly its ExactDuration, so a loop keeps in time
+    // with its tempo over any number of passes.  Each output sample is the loop's value at a time one sample
+    // after the last; with Nearest interpolation, that is the sample at or before that time, and otherwise
+    // it is interpolated, so the loop is read at exactly its fractional position.  Interpolation across the
+    // loop point uses the samples from the other end of the loop.
+    //
+    // The playhead keeps a SliceStreamCursor on the stream segment (one contiguous buffer) it is reading, so a
+    // block within one segment costs a single copy -- a memcpy forwards, or a vectorized reversing copy
+    // backwards -- and moving on to the next segment, or wrapping around the loop, costs no lookup.  A block
+    // read at a fractional position is gathered into a small window and filtered with Kernels::FourTapFilter;
+    // the interpolation taps are the same for every sample of the block.  After each block the playhead
+    // prefetches the data the next block of the same size will read.  The playhead does not own its position,
+    // so a track's playheads can be repositioned from outside (rewinding, say).
+    //
+    // The loop may also be played at another rate (varispeed): each output sample is then the loop's value at
+    // a time rate samples after the last, so pitch and tempo change together.  Non-unit rates are always read
+    // with cubic Hermite interpolation, resampled with Kernels::ResampleCubic from the same kind of window.
+    //
+    // Multichannel loops are split into their channels (Kernels::Deinterleave) as they are copied out, or as
+    // their windows are gathered, and every channel is then filtered or reversed on its own.
+    class LoopPlayhead
+    {
+    public:
+        // The most samples interpolated at once; longer blocks are interpolated in pieces this long.
+        static constexpr int WindowSamples = 256;
+
+        // The fastest rate the loop may be played at.
+        static constexpr int MaximumRate = 8;
+
+        // The most channels a loop may have.
+        static constexpr int MaximumChannels = 8;
+
+    private:
+        const LoopInterpolation _interpolation;
+
+        const int _channelCount;
+
+        // Where in the stream we are reading.
+        SliceStreamCursor<AudioSample, float> _cursor;
+
+        // The frames being interpolated, with one before and two after, as read from the stream.
+        std::vector<float> _window;
+
+        // The same frames split into channels, one after the other, WindowSamples + 3 apart; unused if mono.
+        std::vector<float> _channelWindows;
+
+        // Interpolated (or split) samples of each channel, WindowSamples apart, before reversing them when
+        // playing backwards.
+        std::vector<float> _interpolated;
+
+        // Point channels[c] at channel c of buffer, which holds stride samples of each channel in turn.
+        void SplitPointers(float* buffer, int stride, float** channels) const;
+
+        // Point channels[c] at channel c of the first count frames of _window, splitting them if need be.
+        void SplitWindow(int count, float** channels);
+
+        // Copy count frames of the loop, starting at frame first (which may be before 0 or past the end),
+        // into destination; frames outside the loop come from its other end.
+        void CopyLoopSamples(int64_t discreteDuration, int64_t first, int count, float* destination);
+
+        // Interpolate count frames of the loop, at times first + fraction, first + fraction + 1, ..., into
+        // each channel's destination, starting at offset.
+        void Interpolate(int64_t discreteDuration, int64_t first, float fraction, int count, float* const* destinations, int offset);
+
+        // Resample count frames of the loop, at times first + fraction, first + fraction + rate, ..., into
+        // each channel's destination, starting at offset; (count - 1) * rate must be less than WindowSamples - 1.
+        void Resample(int64_t discreteDuration, int64_t first, float fraction, float rate, int count, float* const* destinations, int offset);
+
+        // Reverse count samples of each channel of _interpolated into its destination, starting at offset.
+        void ReverseInterpolated(int count, float* const* destinations, int offset);
+
+        // Make sure the cursor is reading this stream.
+        void Attach(const BufferedSliceStream<AudioSample, float>& stream);
+
+    public:
+        explicit LoopPlayhead(LoopInterpolation interpolation, int channelCount = 1);
+
+        LoopInterpolation Interpolation() const { return _interpolation; }
+
+        // The number of channels in the loops this plays; each stream's SliceSize() must equal it.
+        int ChannelCount() const { return _channelCount; }
+
+        // Render count samples of the stream's mono loop into destination, starting from position and moving in the
+        // given direction at the given rate (in loop samples per output sample, up to MaximumRate); position is
+        // updated to where the next block starts.
+        // Going forwards, the first sample played is the one at position; going backwards, the one rate samples
+        // before it.  Position is kept in [0, ExactDuration).
+        // The stream must be shut, and must not be changed while this playhead is used with it.
+        void Render(
+            const BufferedSliceStream<AudioSample, float>& stream,
+            ContinuousTime<AudioSample>& position,
+            Direction direction,
+            int count,
+            float* destination,
+            float rate = 1);
+
+        // As Render, but for a loop of any number of channels; destinations holds one destination per channel.
+        void Render(
+            const BufferedSliceStream<AudioSample, float>& stream,
+            ContinuousTime<AudioSample>& position,
+            Direction direction,
+            int count,
+            float* const* destinations,
+            float rate = 1);
+
+        // Copy count frames of the stream's loop, starting at frame first (which may be before 0 or past the
+        // end), into destination; frames outside the loop come from its other end.  Does not interpolate, or split
+        // the channels.
+        void CopyLoop(const BufferedSliceStream<AudioSample, float>& stream, int64_t first, int count, float* destination);
+    };
+}
@@ -0,0 +1,155 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include "Check.h"
+#include "MemoryArena.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace NowSound;
+
+// Round size up to a multiple of granularity (which must be a power of two).
+static size_t RoundUp(size_t size, size_t granularity)
+{
+    return (size + granularity - 1) & ~(granularity - 1);
+}
+
+#ifdef _WIN32
+
+MemoryArena::MemoryArena(size_t minimumSize, bool useLargePages, bool lockPages)
+    : _base{ nullptr },
+    _size{ 0 },
+    _isLargePage{ false },
+    _isLocked{ false }
+{
+    Check(minimumSize > 0);
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    size_t pageSize = systemInfo.dwPageSize;
+
+    if (useLargePages)
+    {
+        // Requires SeLockMemoryPrivilege; large pages are never paged out, so they are implicitly locked.
+        size_t largePageSize = GetLargePageMinimum();
+        if (largePageSize > 0)
+        {
+            _size = RoundUp(minimumSize, largePageSize);
+            _base = (uint8_t*)VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (_base != nullptr)
+            {
+                pageSize = largePageSize;
+                _isLargePage = true;
+                _isLocked = true;
+            }
+        }
+    }
+
+    if (_base == nullptr)
+    {
+        _size = RoundUp(minimumSize, pageSize);
+        _base = (uint8_t*)VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        Check(_base != nullptr);
+    }
+
+    // Pre-fault every page so no first touch happens on the audio thread.
+    for (size_t offset = 0; offset < _size; offset += pageSize)
+    {
+        ((volatile uint8_t*)_base)[offset] = 0;
+    }
+
+    if (lockPages && !_isLocked)
+    {
+        // VirtualLock can only lock up to the process's minimum working set, so grow that first.
+        HANDLE process = GetCurrentProcess();
+        SIZE_T minimumWorkingSet, maximumWorkingSet;
+        if (GetProcessWorkingSetSize(process, &minimumWorkingSet, &maximumWorkingSet))
+        {
+            SetProcessWorkingSetSize(process, minimumWorkingSet + _size, maximumWorkingSet + _size);
+        }
+        _isLocked = VirtualLock(_base, _size) != 0;
+    }
+}
+
+MemoryArena::~MemoryArena()
+{
+    if (_isLocked && !_isLargePage)
+    {
+        VirtualUnlock(_base, _size);
+    }
+    VirtualFree(_base, 0, MEM_RELEASE);
+}
+
+#else
+
+// Size of a transparent or explicit huge page on x64 and arm64 Linux.
+static const size_t HugePageSize = 2 * 1024 * 1024;
+
+MemoryArena::MemoryArena(size_t minimumSize, bool useLargePages, bool lockPages)
+    : _base{ nullptr },
+    _size{ 0 },
+    _isLargePage{ false },
+    _isLocked{ false }
+{
+    Check(minimumSize > 0);
+
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+
+#ifdef MAP_HUGETLB
+    if (useLargePages)
+    {
+        // Explicit huge pages; fails unless the administrator has reserved some via vm.nr_hugepages.
+        _size = RoundUp(minimumSize, HugePageSize);
+        void* base = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED)
+        {
+            _base = (uint8_t*)base;
+            pageSize = HugePageSize;
+            _isLargePage = true;
+        }
+    }
+#endif
+
+    if (_base == nullptr)
+    {
+        _size = RoundUp(minimumSize, useLargePages ? HugePageSize : pageSize);
+        void* base = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        Check(base != MAP_FAILED);
+        _base = (uint8_t*)base;
+
+#ifdef MADV_HUGEPAGE
+        if (useLargePages)
+        {
+            // Ask for transparent huge pages instead; advisory only.
+            madvise(_base, _size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    // Pre-fault every page so no first touch happens on the audio thread.
+    for (size_t offset = 0; offset < _size; offset += pageSize)
+    {
+        ((volatile uint8_t*)_base)[offset] = 0;
+    }
+
+    if (lockPages)
+    {
+        _isLocked = mlock(_base, _size) == 0;
+    }
+}
+
+MemoryArena::~MemoryArena()
+{
+    if (_isLocked)
+    {
+        munlock(_base, _size);
+    }
+    munmap(_base, _size);
+}
+
+#endif
@@ -0,0 +1,57 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "stdafx.h"
+
+namespace NowSound
+{
+    // One large, page-aligned region of virtual memory, reserved and committed up front.
+    //
+    // The region is pre-faulted at construction (every page is touched), and optionally locked into physical
+    // memory and backed by large pages, so that code carving buffers out of it (e.g. BufferAllocator on the audio
+    // thread) never takes a first-touch page fault.  Locking and large pages are best-effort: if the OS refuses
+    // (e.g. missing SeLockMemoryPrivilege or RLIMIT_MEMLOCK too low), the arena silently falls back to ordinary
+    // pages, and IsLocked() / IsLargePage() report what actually happened.
+    class MemoryArena
+    {
+    private:
+        // Base of the region.
+        uint8_t* _base;
+
+        // Size of the region in bytes; a multiple of the page size actually used.
+        size_t _size;
+
+        // Did we get large pages?
+        bool _isLargePage;
+
+        // Are the pages locked into physical memory?
+        bool _isLocked;
+
+    public:
+        // Reserve, commit and pre-fault at least minimumSize bytes.
+        MemoryArena(size_t minimumSize, bool useLargePages, bool lockPages);
+
+        // no copying this
+        MemoryArena(const MemoryArena&) = delete;
+
+        // Unlocks and releases the region.
+        ~MemoryArena();
+
+        // Base of the region.
+        uint8_t* Base() const { return _base; }
+
+        // Size of the region in bytes.
+        size_t Size() const { return _size; }
+
+        // Is the region backed by large (huge) pages?
+        bool IsLargePage() const { return _isLargePage; }
+
+        // Is the region locked into physical memory?
+        bool IsLocked() const { return _isLocked; }
+    };
+}
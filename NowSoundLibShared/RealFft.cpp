@@ -0,0 +1,115 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <cmath>
+
+#include "Check.h"
+#include "Kernels.h"
+#include "RealFft.h"
+
+using namespace NowSound;
+
+RealFft::RealFft(int size)
+    : _size{ size },
+    _bitReverse(size / 2),
+    _passTwiddles(size),
+    _untangleTwiddles(size / 4 + 1)
+{
+    Check(size >= 8);
+    Check((size & (size - 1)) == 0);
+
+    const double pi = std::atan(1) * 4;
+    int complexSize = size / 2;
+
+    int bitCount = 0;
+    while ((1 << bitCount) < complexSize)
+    {
+        bitCount++;
+    }
+    for (int i = 0; i < complexSize; i++)
+    {
+        int reversed = 0;
+        for (int bit = 0; bit < bitCount; bit++)
+        {
+            reversed |= ((i >> bit) & 1) << (bitCount - 1 - bit);
+        }
+        _bitReverse[i] = reversed;
+    }
+
+    // computed in double precision so the float tables are exact to the last bit or so
+    for (int halfSize = 1; halfSize < complexSize; halfSize *= 2)
+    {
+        float* twiddles = _passTwiddles.data() + 2 * (halfSize - 1);
+        for (int j = 0; j < halfSize; j++)
+        {
+            double angle = -pi * j / halfSize;
+            twiddles[2 * j] = (float)std::cos(angle);
+            twiddles[2 * j + 1] = (float)std::sin(angle);
+        }
+    }
+
+    for (int k = 0; k <= size / 4; k++)
+    {
+        double angle = -2 * pi * k / size;
+        _untangleTwiddles[k] = std::complex<float>((float)std::cos(angle), (float)std::sin(angle));
+    }
+}
+
+void RealFft::Transform(const float* input, std::complex<float>* output) const
+{
+    int complexSize = _size / 2;
+
+    // Pack even samples into the real parts and odd samples into the imaginary parts, in bit-reversed order.
+    // (std::complex<float> is guaranteed to be laid out as two floats.)
+    float* data = reinterpret_cast<float*>(output);
+    for (int i = 0; i < complexSize; i++)
+    {
+        int reversed = _bitReverse[i];
+        data[2 * reversed] = input[2 * i];
+        data[2 * reversed + 1] = input[2 * i + 1];
+    }
+
+    // The first two passes have twiddles of 1 and -i only, so run them together as one radix-4 pass.
+    for (int i = 0; i < complexSize; i += 4)
+    {
+        std::complex<float> sum01 = output[i] + output[i + 1];
+        std::complex<float> difference01 = output[i] - output[i + 1];
+        std::complex<float> sum23 = output[i + 2] + output[i + 3];
+        std::complex<float> difference23 = output[i + 2] - output[i + 3];
+        // multiplying by -i
+        std::complex<float> rotated23(difference23.imag(), -difference23.real());
+        output[i] = sum01 + sum23;
+        output[i + 1] = difference01 + rotated23;
+        output[i + 2] = sum01 - sum23;
+        output[i + 3] = difference01 - rotated23;
+    }
+
+    for (int halfSize = 4; halfSize < complexSize; halfSize *= 2)
+    {
+        Kernels::FftPass(data, complexSize, halfSize, _passTwiddles.data() + 2 * (halfSize - 1));
+    }
+
+    // Untangle: with Z the transform of the packed values, the even samples' transform is
+    // E[k] = (Z[k] + conj(Z[N/2 - k])) / 2, the odd samples' is O[k] = -i (Z[k] - conj(Z[N/2 - k])) / 2,
+    // and X[k] = E[k] + W^k O[k].  X[N/2 - k] comes from the same two values, so each pair is done at once.
+    std::complex<float> first = output[0];
+    output[0] = std::complex<float>(first.real() + first.imag(), 0);
+    output[complexSize] = std::complex<float>(first.real() - first.imag(), 0);
+    for (int k = 1; k <= complexSize / 2; k++)
+    {
+        std::complex<float> low = output[k];
+        std::complex<float> highConjugate = std::conj(output[complexSize - k]);
+        std::complex<float> even = (low + highConjugate) * 0.5f;
+        std::complex<float> difference = (low - highConjugate) * 0.5f;
+        std::complex<float> odd(difference.imag(), -difference.real());
+        // (multiplied out by hand, as some compilers' complex multiply checks for infinities and NaNs)
+        std::complex<float> twiddle = _untangleTwiddles[k];
+        std::complex<float> twiddledOdd(
+            twiddle.real() * odd.real() - twiddle.imag() * odd.imag(),
+            twiddle.real() * odd.imag() + twiddle.imag() * odd.real());
+        output[k] = even + twiddledOdd;
+        output[complexSize - k] = std::conj(even - twiddledOdd);
+    }
+}
@@ -0,0 +1,57 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "stdafx.h"
+
+namespace NowSound
+{
+    // A single-precision FFT of real input, with all tables precomputed for one FFT size.
+    //
+    // The size-N real transform runs as a size-N/2 complex transform of the even and odd samples packed
+    // together, followed by one pass that untangles the two; so it does half the work of a complex FFT on
+    // the same data.  The bit reversal is folded into packing the input, the first two passes run as one
+    // twiddle-free radix-4 pass, and the remaining radix-2 passes run in the vector kernels
+    // (Kernels::FftPass) with precomputed twiddles.
+    //
+    // A RealFft is immutable once constructed, so one instance may be shared by any number of threads.
+    class RealFft
+    {
+    private:
+        // The number of real input samples.
+        const int _size;
+
+        // For each of the _size / 2 packed complex values, its bit-reversed index.
+        std::vector<int> _bitReverse;
+
+        // The twiddles for each radix-2 pass, as interleaved complex values; the pass with half-size h starts
+        // at complex index h - 1, and holds exp(-2 pi i j / 2h) for j < h.
+        std::vector<float> _passTwiddles;
+
+        // exp(-2 pi i k / _size) for k <= _size / 4, used to untangle the even and odd transforms.
+        std::vector<std::complex<float>> _untangleTwiddles;
+
+    public:
+        // size must be a power of two, at least 8.
+        RealFft(int size);
+
+        // no copying this
+        RealFft(const RealFft&) = delete;
+        RealFft& operator=(const RealFft&) = delete;
+
+        // The number of real input samples.
+        int Size() const { return _size; }
+
+        // The number of output bins: one per frequency from 0 to the Nyquist frequency, inclusive.
+        int BinCount() const { return _size / 2 + 1; }
+
+        // Transform Size() real samples from input into BinCount() complex bins in output.
+        // Unnormalized, with the usual exp(-2 pi i k n / N) sign convention; the bins above the Nyquist
+        // frequency are the complex conjugates of these, so are not computed.
+        void Transform(const float* input, std::complex<float>* output) const;
+    };
+}
@@ -0,0 +1,162 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include "Buf.h"
+#include "Check.h"
+#include "SliceStream.h"
+
+namespace NowSound
+{
+    // A fixed-capacity stream that keeps only the most recent data appended to it, in one contiguous
+    // power-of-two ring.
+    //
+    // This is meant for always-on history such as an input's pre-recording buffer: appending never allocates
+    // and never trims, it just overwrites the oldest data.  Once the ring has filled, DiscreteDuration() stays
+    // at Capacity(), and stream time 0 is always the oldest retained slice.
+    //
+    // Since the data may wrap around the end of the ring, GetSliceIntersecting may return a slice shorter than
+    // the requested interval even when more data is available; callers loop, as with any DenseSliceStream.
+    template<typename TTime, typename TValue>
+    class RingSliceStream : public DenseSliceStream<TTime, TValue>
+    {
+    private:
+        // The ring storage, allocated once at construction; Capacity() * SliceSize() values.
+        OwningBuf<TValue> _ring;
+
+        // Borrowed reference to _ring, for building slices.
+        Buf<TValue> _ringBuf;
+
+        // Capacity of the ring in slices; always a power of two.
+        Duration<TTime> _capacity;
+
+        // Total number of slices ever appended; the ring index of the next append is this modulo capacity.
+        int64_t _totalAppended;
+
+        static int64_t RoundUpToPowerOfTwo(int64_t value)
+        {
+            int64_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        // The ring index (in slices) of the given stream time.
+        int64_t RingIndex(Time<TTime> time) const
+        {
+            int64_t absoluteTime = _totalAppended - this->DiscreteDuration().Value() + time.Value();
+            return absoluteTime & (_capacity.Value() - 1);
+        }
+
+    public:
+        // Construct a ring holding at least minimumCapacity slices.
+        RingSliceStream(int sliceSize, Duration<TTime> minimumCapacity)
+            : DenseSliceStream<TTime, TValue>(sliceSize, 0, false, 0),
+            _ring{ -1, (int)(RoundUpToPowerOfTwo(minimumCapacity.Value()) * sliceSize) },
+            _ringBuf{ _ring },
+            _capacity{ RoundUpToPowerOfTwo(minimumCapacity.Value()) },
+            _totalAppended{ 0 }
+        {
+            Check(minimumCapacity > 0);
+        }
+
+        // no copying this
+        RingSliceStream(const RingSliceStream&) = delete;
+
+        // The most this stream will ever hold.
+        Duration<TTime> Capacity() const { return _capacity; }
+
+        // Append the given duration's worth of slices from the given pointer, overwriting the oldest data
+        // if the ring is full.  At most two copies, one on each side of the wrap point.
+        virtual void Append(Duration<TTime> duration, const TValue* p)
+        {
+            Check(!this->IsShut());
+
+            int64_t count = duration.Value();
+            int sliceSize = this->SliceSize();
+
+            // if appending more than fits, only the last _capacity slices will survive
+            if (count > _capacity.Value())
+            {
+                p += (count - _capacity.Value()) * sliceSize;
+                _totalAppended += count - _capacity.Value();
+                count = _capacity.Value();
+            }
+
+            int64_t writeIndex = _totalAppended & (_capacity.Value() - 1);
+            int64_t firstCount = std::min<int64_t>(count, _capacity.Value() - writeIndex);
+            std::memcpy(_ring.Data() + writeIndex * sliceSize, p, (size_t)(firstCount * sliceSize * sizeof(TValue)));
+            if (firstCount < count)
+            {
+                std::memcpy(_ring.Data(), p + firstCount * sliceSize, (size_t)((count - firstCount) * sliceSize * sizeof(TValue)));
+            }
+
+            _totalAppended += count;
+            this->SetDuration(std::min<int64_t>(this->DiscreteDuration().Value() + duration.Value(), _capacity.Value()));
+        }
+
+        // Append contiguous data.
+        virtual void Append(const Slice<TTime, TValue>& source)
+        {
+            Check(source.SliceSize() == this->SliceSize());
+
+            Slice<TTime, TValue> copy(source);
+            Append(copy.SliceDuration(), copy.OffsetPointer());
+        }
+
+        // Get the longest contiguous slice at the start of the interval (or, for a backwards interval, at its end),
+        // no longer than the interval; stops at the wrap point of the ring.
+        virtual Slice<TTime, TValue> GetSliceIntersecting(Interval<TTime> interval) const
+        {
+            if (interval.IsEmpty() || this->DiscreteDuration() == 0)
+            {
+                return Slice<TTime, TValue>::Empty();
+            }
+
+            if (interval.IntervalDirection() == Direction::Forwards)
+            {
+                Check(interval.IntervalTime() >= 0);
+                Check(interval.IntervalTime().Value() < this->DiscreteDuration().Value());
+
+                int64_t startIndex = RingIndex(interval.IntervalTime());
+                int64_t available = std::min<int64_t>(
+                    this->DiscreteDuration().Value() - interval.IntervalTime().Value(),
+                    _capacity.Value() - startIndex);
+                int64_t length = std::min<int64_t>(available, interval.IntervalDuration().Value());
+                return Slice<TTime, TValue>(_ringBuf, startIndex, length, this->SliceSize());
+            }
+            else
+            {
+                // the interval covers [time - duration, time); find the contiguous run ending at time
+                Time<TTime> endTime = interval.IntervalTime();
+                Check(endTime > 0);
+                Check(endTime.Value() <= this->DiscreteDuration().Value());
+
+                int64_t lastIndex = RingIndex(endTime - Duration<TTime>(1));
+                int64_t available = std::min<int64_t>(endTime.Value(), lastIndex + 1);
+                int64_t length = std::min<int64_t>(available, interval.IntervalDuration().Value());
+                return Slice<TTime, TValue>(_ringBuf, lastIndex + 1 - length, length, this->SliceSize());
+            }
+        }
+
+        // Copy the given interval's worth of data to the destination pointer.
+        virtual void CopyTo(const Interval<TTime>& sourceIntervalArgument, TValue* p) const
+        {
+            Interval<TTime> sourceInterval = sourceIntervalArgument;
+            while (!sourceInterval.IsEmpty())
+            {
+                Slice<TTime, TValue> source(GetSliceIntersecting(sourceInterval));
+                source.CopyTo(p);
+                p += source.SliceDuration().Value() * this->SliceSize();
+                sourceInterval = sourceInterval.Suffix(source.SliceDuration());
+            }
+        }
+    };
+}
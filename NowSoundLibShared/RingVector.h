@@ -0,0 +1,135 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "stdafx.h"
+
+#include "Check.h"
+
+namespace NowSound
+{
+    // A double-ended queue stored in one power-of-two ring, indexed from the front.
+    // PushBack, PopFront, PopBack and indexing are all O(1); PushBack only allocates when the ring is full,
+    // at which point the capacity doubles.  So a ring whose size is bounded stops allocating once warmed up,
+    // unlike std::deque (which allocates a block per handful of elements on some implementations).
+    // T need not be default-constructible.  Moving a RingVector leaves the source empty (and still usable).
+    template<typename T>
+    class RingVector
+    {
+    private:
+        // The ring storage; empty slots are nullopt. Size is always a power of two.
+        std::vector<std::optional<T>> _items;
+
+        // Index in _items of the logical first element.
+        size_t _head;
+
+        // Number of elements.
+        size_t _count;
+
+        size_t Mask() const { return _items.size() - 1; }
+
+        // Double the capacity (or, if moved from, start over with one slot), moving the elements to the start of
+        // the new ring.
+        void Grow()
+        {
+            std::vector<std::optional<T>> newItems(_items.empty() ? 1 : _items.size() * 2);
+            for (size_t i = 0; i < _count; i++)
+            {
+                newItems[i] = std::move(_items[(_head + i) & Mask()]);
+            }
+            _items = std::move(newItems);
+            _head = 0;
+        }
+
+    public:
+        // initialCapacity must be a power of two.
+        RingVector(size_t initialCapacity = 8) : _items(initialCapacity), _head{ 0 }, _count{ 0 }
+        {
+            Check(initialCapacity > 0);
+            Check((initialCapacity & (initialCapacity - 1)) == 0);
+        }
+
+        RingVector(RingVector&& other)
+            : _items{ std::move(other._items) }, _head{ other._head }, _count{ other._count }
+        {
+            other._items.clear();
+            other._head = 0;
+            other._count = 0;
+        }
+
+        RingVector& operator=(RingVector&& other)
+        {
+            if (this != &other)
+            {
+                _items = std::move(other._items);
+                _head = other._head;
+                _count = other._count;
+                other._items.clear();
+                other._head = 0;
+                other._count = 0;
+            }
+            return *this;
+        }
+
+        RingVector(const RingVector& other) = default;
+        RingVector& operator=(const RingVector& other) = default;
+
+        size_t Size() const { return _count; }
+
+        bool IsEmpty() const { return _count == 0; }
+
+        // The element at logical index i (0 = front).
+        T& operator[](size_t i)
+        {
+            Check(i < _count);
+            return *_items[(_head + i) & Mask()];
+        }
+
+        const T& operator[](size_t i) const
+        {
+            Check(i < _count);
+            return *_items[(_head + i) & Mask()];
+        }
+
+        T& Front() { return (*this)[0]; }
+        const T& Front() const { return (*this)[0]; }
+
+        T& Back() { return (*this)[_count - 1]; }
+        const T& Back() const { return (*this)[_count - 1]; }
+
+        void PushBack(T&& item)
+        {
+            if (_count == _items.size())
+            {
+                Grow();
+            }
+            _items[(_head + _count) & Mask()].emplace(std::move(item));
+            _count++;
+        }
+
+        void PushBack(const T& item)
+        {
+            T copy(item);
+            PushBack(std::move(copy));
+        }
+
+        void PopFront()
+        {
+            Check(_count > 0);
+            _items[_head].reset();
+            _head = (_head + 1) & Mask();
+            _count--;
+        }
+
+        void PopBack()
+        {
+            Check(_count > 0);
+            _items[(_head + _count - 1) & Mask()].reset();
+            _count--;
+        }
+    };
+}
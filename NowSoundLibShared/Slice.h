@@ -125,6 +125,7 @@ namespace NowSound
 
         // Return a pointer to the start of the data addressed by this slice.
         TValue* OffsetPointer() { return Buffer().Data() + (_offset.Value() * _sliceSize); }
+        const TValue* OffsetPointer() const { return _buffer.Data() + (_offset.Value() * _sliceSize); }
 
         // Get the prefix of this Slice starting at offset 0 and extending for the requested duration.
         Slice<TTime, TValue> SubsliceOfDuration(Duration<TTime> duration) const
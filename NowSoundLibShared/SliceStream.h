@@ -6,10 +6,14 @@
 #include "stdafx.h"
 
 #include <algorithm>
+#include <atomic>
+#include <type_traits>
 
 #include "BufferAllocator.h"
 #include "Check.h"
 #include "IStream.h"
+#include "Kernels.h"
+#include "RingVector.h"
 #include "Slice.h"
 #include "NowSoundTime.h"
 
@@ -147,44 +151,81 @@ namespace NowSound
 
         // Copy the given interval of this stream to the destination.
         virtual void CopyTo(const Interval<TTime>& sourceInterval, TValue* destination) const = 0;
+
+        // Append the given interval from this stream to the (end of the) destination stream.
+        virtual void AppendTo(Interval<TTime> sourceInterval, DenseSliceStream<TTime, TValue>* destinationStream) const
+        {
+            while (!sourceInterval.IsEmpty())
+            {
+                Slice<TTime, TValue> source(GetSliceIntersecting(sourceInterval));
+                destinationStream->Append(source);
+                sourceInterval = sourceInterval.Suffix(source.SliceDuration());
+            }
+        }
     };
 
     // A stream that buffers some amount of data in memory.
     // This is an actual concrete implementation type.
+    //
+    // The data is held in a ring of segments, one per buffer. Segment times are absolute (relative to the very
+    // first data ever appended), and never change once appended; stream time 0 is absolute time _trimmedDuration.
+    // So trimming the front of the stream is O(1), and since every buffer but the last is filled completely,
+    // the segment containing a given time can usually be computed directly.
+    template<typename TTime, typename TValue>
+    class SliceStreamCursor;
+
     template<typename TTime, typename TValue>
     class BufferedSliceStream : public DenseSliceStream<TTime, TValue>
     {
+        friend class SliceStreamCursor<TTime, TValue>;
+
     private:
         // Allocator for obtaining buffers; borrowed from application.
         BufferAllocator<TValue>* _allocator;
 
-        // The slices making up the buffered data itself.
-        // The InitialTime of each entry in this list must exactly equal the InitialTime + Duration of the
+        // The slices making up the buffered data itself, one per buffer in _buffers.
+        // The InitialTime of each entry in this ring must exactly equal the InitialTime + Duration of the
         // previous entry; in other words, these are densely arranged in time.
+        // InitialTimes are absolute; subtract _trimmedDuration to get stream time.
         // Note that slices borrow buffer references from their containing stream.
-        std::vector<TimedSlice<TTime, TValue>> _data{};
+        RingVector<TimedSlice<TTime, TValue>> _data{};
+
+        // The total duration trimmed off the front of this stream; the absolute time of stream time 0.
+        Duration<TTime> _trimmedDuration;
 
         // The maximum amount that this stream will buffer while it is open; more appends will cause
         // earlier data to be dropped.  If 0, no buffering limit will be enforced.
         Duration<TTime> _maxBufferedDuration;
 
-        // This is the vector of buffers appended in the stream thus far; the last one is the current append buffer.
-        // This vector owns the buffers within it; ownership is transferred from allocator to stream whenever a
+        // This is the ring of buffers appended in the stream thus far; the last one is the current append buffer.
+        // This ring owns the buffers within it; ownership is transferred from allocator to stream whenever a
         // new append buffer is needed.
-        std::vector<OwningBuf<TValue>> _buffers;
+        RingVector<OwningBuf<TValue>> _buffers;
 
         // This is the remaining not-yet-allocated portion of the current append buffer (the last in _buffers).
         Slice<TTime, TValue> _remainingFreeSlice;
 
-        void EnsureFreeSlice()
+        // The total duration of appended data which was dropped because the allocator had no buffer to give.
+        // Atomic so that other threads may read it while the appending thread adds to it.
+        std::atomic<int64_t> _droppedDuration;
+
+        // Make sure _remainingFreeSlice is nonempty, allocating a new append buffer if need be.
+        // Returns false if the allocator has no buffer to give; the caller must then drop its data.
+        bool EnsureFreeSlice()
         {
             if (_remainingFreeSlice.IsEmpty())
             {
-                // allocate a new buffer and transfer ownership of it to _buffers
-                _buffers.push_back(std::move(_allocator->Allocate()));
+                OwningBuf<TValue> newBuffer{ _allocator->Allocate() };
+                if (newBuffer.IsEmpty())
+                {
+                    return false;
+                }
+
+                // transfer ownership of the new buffer to _buffers
+                _buffers.PushBack(std::move(newBuffer));
 
                 // get a reference to that new buffer
-                OwningBuf<TValue>& appendBuffer{ _buffers.at(_buffers.size() - 1) };
+                OwningBuf<TValue>& appendBuffer{ _buffers.Back() };
 
                 // point _remainingFreeSlice at that new buffer
                 _remainingFreeSlice = Slice<TTime, TValue>(
@@ -193,6 +234,7 @@ namespace NowSound
                     appendBuffer.Length() / this->SliceSize(),
                     this->SliceSize());
             }
+            return true;
         }
 
         // Internally append this slice (which must be allocated from our free buffer); this does the work
@@ -201,24 +243,24 @@ namespace NowSound
         {
             Check(source.Buffer().Data() == _remainingFreeSlice.Buffer().Data()); // dest must be from our free buffer
 
-            if (_data.size() == 0)
+            if (_data.IsEmpty())
             {
                 // this is the first data of all (base case)
-                _data.push_back(TimedSlice<TTime, TValue>(0, source));
+                _data.PushBack(TimedSlice<TTime, TValue>(Time<TTime>(0) + _trimmedDuration + this->DiscreteDuration(), source));
             }
             else
             {
                 // there is already some data. Coalesce this slice with the existing one if possible.
-                TimedSlice<TTime, TValue> last = _data[_data.size() - 1];
+                TimedSlice<TTime, TValue> last = _data.Back();
                 if (last.Value().Precedes(source))
                 {
                     // coalesce the slices
-                    _data[_data.size() - 1] = TimedSlice<TTime, TValue>(last.InitialTime(), last.Value().UnionWith(source));
+                    _data.Back() = TimedSlice<TTime, TValue>(last.InitialTime(), last.Value().UnionWith(source));
                 }
                 else
                 {
                     // add a new slice
-                    _data.push_back(TimedSlice<TTime, TValue>(last.InitialTime() + last.Value().SliceDuration(), source));
+                    _data.PushBack(TimedSlice<TTime, TValue>(last.InitialTime() + last.Value().SliceDuration(), source));
                 }
             }
 
@@ -237,8 +279,10 @@ namespace NowSound
                 false, // isShut
                 Duration<TTime>{}),
             _allocator{ allocator },
+            _trimmedDuration{ 0 },
             _buffers{ },
             _remainingFreeSlice{ },
+            _droppedDuration{ 0 },
             _maxBufferedDuration{ maxBufferedDuration }
         { }
 
@@ -252,45 +296,36 @@ namespace NowSound
                 false, // isShut
                 Duration<TTime>{}),
             _allocator{ allocator },
+            _trimmedDuration{ 0 },
             _buffers{},
             _remainingFreeSlice{},
+            _droppedDuration{ 0 },
             _maxBufferedDuration{ Duration<TTime>{} }
         { }
 
-        BufferedSliceStream(BufferedSliceStream<TTime, TValue>&& other)
-            : DenseSliceStream<TTime, TValue>(
-                other.SliceSize(),
-                other.ExactDuration(),
-                other.IsShut(),
-                other.DiscreteDuration(),
-                std::move(other._intervalMapper)),
-            _allocator{ other._allocator },
-            _buffers{ std::move(other._buffers) },
-            _remainingFreeSlice{ other._remainingFreeSlice },
-            _maxBufferedDuration{ other._maxBufferedDuration }
-        {
-            Check(_allocator != nullptr);
-            Check(ExactDuration() == other.ExactDuration());
-        }
-
+        // no copying or moving this; streams are held by pointer, and slices point into their buffers
+        BufferedSliceStream(BufferedSliceStream<TTime, TValue>&& other) = delete;
         BufferedSliceStream(const BufferedSliceStream<TTime, TValue>& other) = delete;
 
         // On destruction, return all buffers to free list
         // TODO: does this need locking and/or thread checks?
         ~BufferedSliceStream()
         {
-            for (int i = 0; i < _buffers.size(); i++)
+            for (size_t i = 0; i < _buffers.Size(); i++)
             {
                 // transfer ownership of each buffer back to allocator
-                _allocator->Free(std::move(_buffers.at(i)));
+                _allocator->Free(std::move(_buffers[i]));
             }
         }
 
         // For testing
         int BufferCount() const {
-            return _buffers.size();
+            return (int)_buffers.Size();
         }
 
+        // The total duration of appended data dropped so far because no buffer could be allocated to hold it.
+        Duration<TTime> DroppedDuration() const { return Duration<TTime>(_droppedDuration.load(std::memory_order_relaxed)); }
+
         virtual void Shut(ContinuousDuration<AudioSample> finalDuration, bool fade)
         {
             this->DenseSliceStream<TTime, TValue>::Shut(finalDuration);
@@ -307,9 +342,9 @@ namespace NowSound
                 // this avoids clicking that was empirically otherwise present and annoying.
                 // TODO: this should be dynamically done whenever loopie local time changes noncontinuously!
                 const int64_t microFadeDuration{ 20 };
-                TimedSlice<TTime, TValue>& firstSlice{ _data.at(0) };
+                TimedSlice<TTime, TValue>& firstSlice{ _data.Front() };
                 TValue* firstSliceData{ firstSlice.NonConstValue().OffsetPointer() };
-                TimedSlice<TTime, TValue>& lastSlice{ _data.at(_data.size() - 1) };
+                TimedSlice<TTime, TValue>& lastSlice{ _data.Back() };
                 int sliceSize = firstSlice.Value().SliceSize();
                 int64_t firstSliceDuration = firstSlice.Value().SliceDuration().Value();
                 TValue* lastSliceDataEnd{ lastSlice.NonConstValue().OffsetPointer() + (lastSlice.Value().SliceDuration().Value() * sliceSize) };
@@ -336,7 +371,11 @@ namespace NowSound
 
             while (duration > 0)
             {
-                EnsureFreeSlice();
+                if (!EnsureFreeSlice())
+                {
+                    _droppedDuration.fetch_add(duration.Value(), std::memory_order_relaxed);
+                    return;
+                }
 
                 // if source is larger than available free buffer, then we'll iterate
                 Duration<TTime> durationToCopy(duration);
@@ -355,6 +394,41 @@ namespace NowSound
 
                 // and update our loop variables
                 duration = duration - durationToCopy;
+                p += durationToCopy.Value() * this->SliceSize();
+
+                Trim();
+            }
+        }
+
+        // Append the given duration of data from separate channels, one per value of each slice (so SliceSize()
+        // of them), interleaving them straight into our buffers.
+        void AppendChannels(Duration<TTime> duration, const TValue* const* channels)
+        {
+            static_assert(std::is_same<TValue, float>::value, "AppendChannels requires float values");
+            Check(!this->IsShut());
+
+            int offset = 0;
+            while (duration > 0)
+            {
+                if (!EnsureFreeSlice())
+                {
+                    _droppedDuration.fetch_add(duration.Value(), std::memory_order_relaxed);
+                    return;
+                }
+
+                Duration<TTime> durationToCopy(duration);
+                if (durationToCopy > _remainingFreeSlice.SliceDuration())
+                {
+                    durationToCopy = _remainingFreeSlice.SliceDuration();
+                }
+
+                Slice<TTime, TValue> dest(_remainingFreeSlice.SubsliceOfDuration(durationToCopy));
+                Kernels::Interleave(channels, offset, this->SliceSize(), (int)durationToCopy.Value(), dest.OffsetPointer());
+
+                InternalAppend(dest);
+
+                duration = duration - durationToCopy;
+                offset += (int)durationToCopy.Value();
 
                 Trim();
             }
@@ -370,7 +444,11 @@ namespace NowSound
             // Try to keep copying source into _remainingFreeSlice
             while (!source.IsEmpty())
             {
-                EnsureFreeSlice();
+                if (!EnsureFreeSlice())
+                {
+                    _droppedDuration.fetch_add(source.SliceDuration().Value(), std::memory_order_relaxed);
+                    return;
+                }
 
                 // if source is larger than available free buffer, then we'll iterate
                 Slice<TTime, TValue> originalSource = source;
@@ -402,7 +480,11 @@ namespace NowSound
             Check(this->SliceSize() == width * height);
             Check(stride >= width);
 
-            EnsureFreeSlice();
+            if (!EnsureFreeSlice())
+            {
+                _droppedDuration.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
 
             Slice<TTime, TValue> destination = _remainingFreeSlice.SubsliceOfDuration(1);
 
@@ -422,6 +504,7 @@ namespace NowSound
         }
 
         // Trim off any content from the earliest part of the stream beyond _maxBufferedDuration.
+        // O(1) per trimmed buffer; remaining slices keep their absolute times, and _trimmedDuration moves forwards.
         void Trim()
         {
             if (_maxBufferedDuration == 0 || this->DiscreteDuration() <= _maxBufferedDuration)
@@ -433,27 +516,18 @@ namespace NowSound
             {
                 Duration<TTime> toTrim = this->DiscreteDuration() - _maxBufferedDuration;
                 // get the first slice
-                TimedSlice<TTime, TValue> firstSlice = _data[0];
+                TimedSlice<TTime, TValue> firstSlice = _data.Front();
                 Duration<TTime> firstSliceDuration = firstSlice.Value().SliceDuration();
                 if (firstSlice.Value().SliceDuration() <= toTrim)
                 {
-                    // the whole slice goes away
-                    _data.erase(_data.begin());
-#if DEBUG
-                    for (TimedSlice<TTime, TValue> slice : _data) {
-                        Check(slice.Slice.Buffer.Data != firstSlice.Slice.Buffer.Data,
-                            "make sure our later stream data doesn't reference this one we're about to free");
-                    }
-#endif
-                    Check(firstSlice.Value().Buffer().Data() == _buffers[0].Data());
-                    _allocator->Free(std::move(_buffers.at(0)));
-                    _buffers.erase(_buffers.begin());
+                    // the whole slice goes away, along with its buffer (which no later slice references)
+                    _data.PopFront();
+                    Check(firstSlice.Value().Buffer().Data() == _buffers.Front().Data());
+                    _allocator->Free(std::move(_buffers.Front()));
+                    _buffers.PopFront();
                     this->SetDuration(this->DiscreteDuration() - firstSliceDuration);
-                    // and adjust all remaining slices
-                    for (int i = 0; i < _data.size(); i++) {
-                        _data[i].ChangeInitialTimeBy(-firstSliceDuration.Value());
-                    }
-            }
+                    _trimmedDuration = _trimmedDuration + firstSliceDuration;
+                }
                 else
                 {
                     // chop off the first part of the data
@@ -462,15 +536,9 @@ namespace NowSound
                         firstSlice.Value().Offset() + toTrim,
                         firstSlice.Value().SliceDuration() - toTrim,
                         this->SliceSize());
-                    // initial time is 0 because this is the new first slice
-                    TimedSlice<TTime, TValue> newFirstSlice(0, newSlice);
-                    _data[0] = newFirstSlice;
+                    _data.Front() = TimedSlice<TTime, TValue>(firstSlice.InitialTime() + toTrim, newSlice);
                     this->SetDuration(this->DiscreteDuration() - toTrim);
-
-                    // move all later slices back 
-                    for (int i = 1; i < _data.size(); i++) {
-                        _data[i].ChangeInitialTimeBy(-toTrim.Value());
-                    }
+                    _trimmedDuration = _trimmedDuration + toTrim;
                 }
             }
         }
@@ -487,22 +555,20 @@ namespace NowSound
             // This loop ends when ExactDuration exactly equals shorterDuration.
             while (shorterDuration < this->DiscreteDuration()) {
                 // we had better not run out of data
-                Check(_data.size() > 0);
+                Check(_data.Size() > 0);
                 // or buffers
-                Check(_buffers.size() > 0);
+                Check(_buffers.Size() > 0);
 
                 // Is the last slice to be dropped in its entirety?
-                TimedSlice<TTime, TValue>& lastTimedSlice = _data.at(_data.size() - 1);
+                TimedSlice<TTime, TValue>& lastTimedSlice = _data.Back();
                 Slice<TTime, TValue> lastSlice = lastTimedSlice.Value();
                 Duration<TTime> lastSliceDuration{ lastSlice.SliceDuration() };
                 if (shorterDuration <= this->DiscreteDuration() - lastSliceDuration)
                 {
                     // yes, we want to drop that last slice altogether, and the buffer associated with it
-                    _buffers.pop_back();
-                    _data.pop_back();
-                    
-                    // get the prior buffer
-                    OwningBuf<TValue>& priorBuffer{ _buffers.at(_buffers.size() - 1) };
+                    _allocator->Free(std::move(_buffers.Back()));
+                    _buffers.PopBack();
+                    _data.PopBack();
 
                     // update duration
                     this->SetDuration(this->DiscreteDuration() - lastSliceDuration);
@@ -524,8 +590,7 @@ namespace NowSound
                             0,
                             lastSliceNewDuration.Value(),
                             this->SliceSize()));
-                    _data.pop_back();
-                    _data.push_back(newLastSlice);
+                    _data.Back() = newLastSlice;
 
                     this->SetDuration(shorterDuration);
                 }
@@ -533,26 +598,25 @@ namespace NowSound
         }
 
         // Copy the given interval's worth of data to the destination pointer.
-        virtual void CopyTo(const Interval<TTime>& sourceIntervalArgument, TValue* p) const
+        virtual void CopyTo(const Interval<TTime>& sourceInterval, TValue* p) const
         {
-            // so we can update it in the loop
-            Interval<TTime> sourceInterval = sourceIntervalArgument;
-            while (!sourceInterval.IsEmpty())
+            if (sourceInterval.IsEmpty())
             {
-                Slice<TTime, TValue> source(GetSliceIntersecting(sourceInterval));
-                source.CopyTo(p);
-                sourceInterval = sourceInterval.Suffix(source.SliceDuration());
+                return;
             }
-        }
+            Check(sourceInterval.IntervalDirection() == Direction::Forwards);
 
-        // Append the given interval from this stream to the (end of the) destination stream.
-        virtual void AppendTo(Interval<TTime> sourceInterval, DenseSliceStream<TTime, TValue>* destinationStream) const
-        {
-            while (!sourceInterval.IsEmpty())
+            // one segment at a time, stepping from each segment to the next
+            SliceStreamCursor<TTime, TValue> cursor(*this);
+            Time<TTime> time = sourceInterval.IntervalTime();
+            Time<TTime> end = time + sourceInterval.IntervalDuration();
+            while (time < end)
             {
-                Slice<TTime, TValue> source(GetSliceIntersecting(sourceInterval));
-                destinationStream->Append(source);
-                sourceInterval = sourceInterval.Suffix(source.SliceDuration());
+                cursor.MoveTo(time);
+                Duration<TTime> run = std::min(end - time, cursor.SegmentEnd() - time);
+                std::memcpy(p, cursor.DataAt(time), (size_t)(run.Value() * this->SliceSize()) * sizeof(TValue));
+                p += run.Value() * this->SliceSize();
+                time = time + run;
             }
         }
 
@@ -575,7 +639,7 @@ namespace NowSound
                 return Slice<TTime, TValue>::Empty();
             }
 
-            const TimedSlice<TTime, TValue>& foundTimedSlice = GetFirstSliceIntersecting(interval);
+            TimedSlice<TTime, TValue> foundTimedSlice = GetFirstSliceIntersecting(interval);
 
             // TODO: make this handle backwards intervals (right now, will blow up here because intersecting
             // backwards interval with forwards interval, which results in interval with undefined direction)
@@ -598,48 +662,175 @@ namespace NowSound
             }
         }
 
-        // Get the first timed slice that contains data from this interval.
+        // Get the first timed slice that contains data from this interval, with its InitialTime in stream time.
         // Interval may be backwards.
-        const TimedSlice<TTime, TValue>& GetFirstSliceIntersecting(Interval<TTime> interval) const
+        TimedSlice<TTime, TValue> GetFirstSliceIntersecting(Interval<TTime> interval) const
         {
             // We must overlap somewhere; check for non-empty intersection.
             Interval<TTime> thisInterval = this->DiscreteInterval();
             Check(!thisInterval.Intersect(interval).IsEmpty());
 
-            // Get the biggest available slice at or after interval.InitialTime.
-            // First, get the index of the slice with start time that is at or after the interval's start time.
-            TimedSlice<TTime, TValue> target(interval.IntervalTime(), Slice<TTime, TValue>());
-            auto firstSliceEqualOrGreaterThanTarget = std::lower_bound(_data.begin(), _data.end(), target);
+            // We want the slice containing the interval's start time if forwards, or containing the time just
+            // before it if backwards; clamped to the slices we actually have.
+            Time<TTime> absoluteTime = interval.IntervalTime() + _trimmedDuration;
+            if (interval.IntervalDirection() == Direction::Backwards)
+            {
+                absoluteTime = absoluteTime - Duration<TTime>(1);
+            }
+
+            size_t index = FindSliceIndex(absoluteTime);
+            const TimedSlice<TTime, TValue>& found = _data[index];
+            return TimedSlice<TTime, TValue>(found.InitialTime() - _trimmedDuration, found.Value());
+        }
 
-            if (firstSliceEqualOrGreaterThanTarget == _data.end())
+    private:
+        // Does the slice at this index contain this absolute time?
+        bool SliceContains(size_t index, Time<TTime> absoluteTime) const
+        {
+            const TimedSlice<TTime, TValue>& slice = _data[index];
+            return slice.InitialTime() <= absoluteTime && absoluteTime < slice.InitialTime() + slice.Value().SliceDuration();
+        }
+
+        // Get the index of the slice containing this absolute time, or the first or last slice if the time is
+        // before or after all data.
+        size_t FindSliceIndex(Time<TTime> absoluteTime) const
+        {
+            Check(!_data.IsEmpty());
+
+            const TimedSlice<TTime, TValue>& first = _data.Front();
+            if (absoluteTime < first.InitialTime() + first.Value().SliceDuration())
             {
-                // If we reached the end, then the slice we want is the last slice; it's less than the
-                // start time of target, and it overlaps.
-                return *(firstSliceEqualOrGreaterThanTarget - 1);
+                return 0;
             }
-            else if (firstSliceEqualOrGreaterThanTarget->InitialTime() == interval.IntervalTime())
+            size_t lastIndex = _data.Size() - 1;
+            if (_data.Back().InitialTime() <= absoluteTime)
             {
-                // If interval is forwards, this is the exact right slice.
-                // If interval is backwards, we need the prior slice.
-                if (interval.IntervalDirection() == Direction::Forwards)
+                return lastIndex;
+            }
+
+            // Every buffer is filled completely before the next is allocated, so slice i (counting from the very
+            // first slice ever appended) starts at absolute time i * bufferDuration; compute the index directly.
+            int64_t bufferDuration = _allocator->BufferLength / this->SliceSize();
+            int64_t guess = (absoluteTime.Value() / bufferDuration) - (first.InitialTime().Value() / bufferDuration);
+            if (guess >= 0 && guess <= (int64_t)lastIndex && SliceContains((size_t)guess, absoluteTime))
+            {
+                return (size_t)guess;
+            }
+
+            // Not uniform (e.g. after truncation); binary search for the last slice starting at or before absoluteTime.
+            size_t low = 0;
+            size_t high = lastIndex;
+            while (low < high)
+            {
+                size_t mid = (low + high + 1) / 2;
+                if (_data[mid].InitialTime() <= absoluteTime)
                 {
-                    return *firstSliceEqualOrGreaterThanTarget;
+                    low = mid;
                 }
                 else
                 {
-                    return *(firstSliceEqualOrGreaterThanTarget - 1);
+                    high = mid - 1;
                 }
             }
-            else if (firstSliceEqualOrGreaterThanTarget != _data.begin())
+            return low;
+        }
+    };
+
+    // A position in a BufferedSliceStream, for reading it in order: forwards, backwards, or round and round as a
+    // loop.
+    //
+    // The cursor remembers which segment it is in, so moving to a time in the same segment, either neighbouring
+    // segment, or the first or last segment (as when a loop wraps around) is O(1), without the stream's lookup.
+    // It is a plain value, only valid while its stream exists; trimming the stream is harmless (the cursor
+    // just falls back to the lookup), but data which has been trimmed away cannot be read.
+    template<typename TTime, typename TValue>
+    class SliceStreamCursor
+    {
+    private:
+        // The stream read from; null if this cursor was default constructed.
+        const BufferedSliceStream<TTime, TValue>* _stream;
+
+        // The index in _stream->_data of the current segment.
+        size_t _index;
+
+        // Does the segment at this index exist, and contain this absolute time?
+        bool SegmentContains(size_t index, Time<TTime> absoluteTime) const
+        {
+            return index < _stream->_data.Size() && _stream->SliceContains(index, absoluteTime);
+        }
+
+        // The index of the segment containing this absolute time, trying the segments near the current one first.
+        size_t FindSegment(Time<TTime> absoluteTime) const
+        {
+            if (SegmentContains(_index, absoluteTime))
             {
-                // if there is a prior slice, return that
-                return *(firstSliceEqualOrGreaterThanTarget - 1);
+                return _index;
             }
-            else
+            if (SegmentContains(_index + 1, absoluteTime))
+            {
+                return _index + 1;
+            }
+            if (_index > 0 && SegmentContains(_index - 1, absoluteTime))
             {
-                // return this slice, there's none earlier
-                return *firstSliceEqualOrGreaterThanTarget;
+                return _index - 1;
             }
+            if (SegmentContains(0, absoluteTime))
+            {
+                return 0;
+            }
+            return _stream->FindSliceIndex(absoluteTime);
+        }
+
+        const TimedSlice<TTime, TValue>& Segment() const { return _stream->_data[_index]; }
+
+    public:
+        SliceStreamCursor() : _stream{ nullptr }, _index{ 0 } {}
+
+        // A cursor at the start of the stream.
+        SliceStreamCursor(const BufferedSliceStream<TTime, TValue>& stream) : _stream{ &stream }, _index{ 0 } {}
+
+        // The stream this cursor reads.
+        const BufferedSliceStream<TTime, TValue>* Stream() const { return _stream; }
+
+        // Move to the segment containing this stream time, which must be within the stream.
+        void MoveTo(Time<TTime> time)
+        {
+            Check(_stream != nullptr);
+            Check(time >= 0 && time < Time<TTime>(0) + _stream->DiscreteDuration());
+            _index = FindSegment(time + _stream->_trimmedDuration);
+        }
+
+        // The stream time at which the current segment starts.
+        Time<TTime> SegmentStart() const { return Segment().InitialTime() - _stream->_trimmedDuration; }
+
+        // The stream time just after the current segment ends.
+        Time<TTime> SegmentEnd() const { return SegmentStart() + Segment().Value().SliceDuration(); }
+
+        // The data at this stream time, which must be within the current segment.
+        const TValue* DataAt(Time<TTime> time) const
+        {
+            Check(SegmentStart() <= time && time < SegmentEnd());
+            return Segment().Value().OffsetPointer() + (time - SegmentStart()).Value() * _stream->SliceSize();
+        }
+
+        // Prefetch the data which will be read next: duration slices starting at this stream time if going
+        // forwards, or ending just before it if going backwards.  Only the first segment touched is prefetched.
+        // Does not move the cursor.
+        void Prefetch(Time<TTime> time, Duration<TTime> duration, Direction direction) const
+        {
+            Check(_stream != nullptr);
+            Time<TTime> first = direction == Direction::Forwards ? time : time - Duration<TTime>(1);
+            Check(first >= 0 && first < Time<TTime>(0) + _stream->DiscreteDuration());
+
+            const TimedSlice<TTime, TValue>& segment = _stream->_data[FindSegment(first + _stream->_trimmedDuration)];
+            int64_t segmentStart = (segment.InitialTime() - _stream->_trimmedDuration).Value();
+            int64_t segmentEnd = segmentStart + segment.Value().SliceDuration().Value();
+            int64_t start = direction == Direction::Forwards ? time.Value() : std::max(segmentStart, time.Value() - duration.Value());
+            int64_t end = direction == Direction::Forwards ? std::min(segmentEnd, time.Value() + duration.Value()) : time.Value();
+
+            Kernels::Prefetch(
+                segment.Value().OffsetPointer() + (start - segmentStart) * _stream->SliceSize(),
+                (end - start) * _stream->SliceSize() * (int64_t)sizeof(TValue));
         }
     };
 }
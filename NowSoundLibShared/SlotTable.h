@@ -0,0 +1,135 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "stdafx.h"
+
+#include "Check.h"
+
+namespace NowSound
+{
+    // A fixed number of slots, each either active or free, allocated up front so that the slots never move.
+    //
+    // One thread (the owner, e.g. the message thread) finds a free slot, sets it up, and then activates it;
+    // activating publishes the slot's contents, so another thread (the reader, e.g. the audio thread) which sees a
+    // slot as active also sees it fully set up.  Slots are identified by index; FindFree() returns -1 when no slot
+    // is free, so a full table is something the caller can report rather than a failure.
+    //
+    // The reader may still be using a slot for a while after the owner deactivates it, so a deactivated slot is
+    // not free until the reader has acknowledged it: the reader calls Acknowledge() after each pass over the
+    // table, which bumps an epoch, and a slot deactivated while the epoch is E is only reused once the epoch passes
+    // E (any pass which could have seen the slot as active has then finished).
+    template<typename TSlot>
+    class SlotTable
+    {
+    private:
+        // The number of slots.
+        const int _capacity;
+
+        // The slots themselves.
+        std::unique_ptr<TSlot[]> _slots;
+
+        // Is each slot active?
+        std::unique_ptr<std::atomic<bool>[]> _isActive;
+
+        // The epoch at which each slot was last deactivated; touched only by the owner.
+        std::unique_ptr<int64_t[]> _deactivatedEpoch;
+
+        // The number of passes over the table the reader has finished.
+        std::atomic<int64_t> _epoch;
+
+    public:
+        SlotTable(int capacity)
+            : _capacity{ capacity },
+            _slots{ new TSlot[capacity] },
+            _isActive{ new std::atomic<bool>[capacity] },
+            _deactivatedEpoch{ new int64_t[capacity] },
+            _epoch{ 0 }
+        {
+            Check(capacity > 0);
+            for (int i = 0; i < capacity; i++)
+            {
+                _isActive[i].store(false, std::memory_order_relaxed);
+                // never used, so free from the start
+                _deactivatedEpoch[i] = -1;
+            }
+        }
+
+        // no copying this
+        SlotTable(const SlotTable&) = delete;
+        SlotTable& operator=(const SlotTable&) = delete;
+
+        // The number of slots.
+        int Capacity() const { return _capacity; }
+
+        // The slot at this index, active or not.
+        TSlot& operator[](int index)
+        {
+            Check(index >= 0 && index < _capacity);
+            return _slots[index];
+        }
+
+        // Is the slot at this index active?  Any thread.
+        bool IsActive(int index) const
+        {
+            Check(index >= 0 && index < _capacity);
+            return _isActive[index].load(std::memory_order_seq_cst);
+        }
+
+        // Is any slot active?  Any thread.
+        bool AnyActive() const
+        {
+            for (int i = 0; i < _capacity; i++)
+            {
+                if (IsActive(i))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The index of the first free slot (inactive, and acknowledged by the reader since it was deactivated),
+        // or -1 if there is none.  Owner only.
+        int FindFree() const
+        {
+            int64_t epoch = _epoch.load(std::memory_order_seq_cst);
+            for (int i = 0; i < _capacity; i++)
+            {
+                if (!IsActive(i) && epoch > _deactivatedEpoch[i])
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        // Activate the slot at this index, which FindFree() returned, publishing everything written to it so far.
+        // Owner only.
+        void Activate(int index)
+        {
+            Check(!IsActive(index));
+            _isActive[index].store(true, std::memory_order_seq_cst);
+        }
+
+        // Deactivate the slot at this index; FindFree() will return it again once the reader acknowledges.
+        // Owner only.
+        void Deactivate(int index)
+        {
+            Check(IsActive(index));
+            _isActive[index].store(false, std::memory_order_seq_cst);
+            _deactivatedEpoch[index] = _epoch.load(std::memory_order_seq_cst);
+        }
+
+        // Finish a pass over the table; the reader is no longer using any slot it found inactive.  Reader only.
+        void Acknowledge()
+        {
+            _epoch.fetch_add(1, std::memory_order_seq_cst);
+        }
+    };
+}
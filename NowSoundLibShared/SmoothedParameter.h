@@ -0,0 +1,254 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <type_traits>
+
+#include "stdafx.h"
+
+#include "stdint.h"
+
+#include "Check.h"
+#include "Kernels.h"
+#include "NowSoundTime.h"
+#include "SpscRing.h"
+
+namespace NowSound
+{
+    // The shape of the ramp a SmoothedParameter follows on its way to a new target.
+    enum class SmoothingCurve
+    {
+        // Equal steps all the way; good for pan and mix positions.
+        Linear,
+
+        // Fast at first, then easing in; good for gains, whose loudness is perceived logarithmically.
+        // Reaches within 0.1% of the target over the ramp, then snaps to it.
+        Exponential
+    };
+
+    // A parameter set from the UI thread and read by the audio thread, which ramps smoothly to each new value
+    // rather than jumping (which would be heard as zipper noise).
+    //
+    // The target is atomic, so the UI thread may set it at any time.  Changes may also be scheduled in advance
+    // for an exact sample time, so automation can be sent in batches rather than polled; these pass through an
+    // SpscRing, so only one thread may schedule changes for a given parameter.  Once per block, the audio
+    // thread calls Advance, which either reports that the value is constant for the whole block (the common
+    // case, costing almost nothing) or renders the value for every sample of the block.
+    template<typename T>
+    class SmoothedParameter
+    {
+        static_assert(std::is_floating_point<T>::value, "SmoothedParameter requires a floating point type");
+
+    private:
+        // A change scheduled for an exact sample time.
+        struct ScheduledChange
+        {
+            int64_t Time;
+            T Value;
+        };
+
+        const SmoothingCurve _curve;
+
+        // How many samples each ramp takes.
+        const int _rampSamples;
+
+        // The per-sample ratio of the distance to target, for exponential ramps.
+        const T _ratio;
+
+        // The latest value asked for; written by any thread.
+        std::atomic<T> _target;
+
+        // Changes scheduled but not yet reached, in time order.
+        SpscRing<ScheduledChange> _scheduledChanges;
+
+        // Everything below is touched only by the audio thread.
+
+        // The value as of the last sample processed.
+        T _current;
+
+        // The value of _target the last time we looked; a change means a new ramp is needed.
+        T _lastSeenTarget;
+
+        // Where the current ramp is headed.
+        T _rampTarget;
+
+        // The per-sample increment of the current ramp, if linear.
+        T _step;
+
+        // The samples left in the current ramp; 0 if not ramping.
+        int _rampRemaining;
+
+        // The next scheduled change, if it has been popped from the ring but not yet reached.
+        bool _hasPendingChange;
+        ScheduledChange _pendingChange;
+
+        // Start ramping from the current value towards target.
+        void StartRamp(T target)
+        {
+            if (_rampSamples == 0 || target == _current)
+            {
+                _current = target;
+                _rampRemaining = 0;
+                return;
+            }
+
+            _rampTarget = target;
+            _rampRemaining = _rampSamples;
+            _step = (target - _current) / _rampSamples;
+        }
+
+        // Render the next count samples of the current ramp, which must have at least that many remaining.
+        void RenderRamp(int count, T* values)
+        {
+            if constexpr (std::is_same<T, float>::value)
+            {
+                if (_curve == SmoothingCurve::Linear)
+                {
+                    Kernels::LinearRamp(_current + _step, _step, count, values);
+                }
+                else
+                {
+                    Kernels::ExponentialRamp(_rampTarget + (_current - _rampTarget) * _ratio, _rampTarget, _ratio, count, values);
+                }
+            }
+            else
+            {
+                T distance = _current - _rampTarget;
+                for (int i = 0; i < count; i++)
+                {
+                    if (_curve == SmoothingCurve::Linear)
+                    {
+                        values[i] = _current + _step * (i + 1);
+                    }
+                    else
+                    {
+                        distance *= _ratio;
+                        values[i] = _rampTarget + distance;
+                    }
+                }
+            }
+
+            _rampRemaining -= count;
+            if (_rampRemaining == 0)
+            {
+                // land exactly on the target, whatever rounding happened along the way
+                values[count - 1] = _rampTarget;
+            }
+            _current = values[count - 1];
+        }
+
+    public:
+        // Construct a parameter starting at initialValue, ramping over rampSamples samples, with room for
+        // scheduleCapacity (a power of two) scheduled changes not yet reached.
+        SmoothedParameter(T initialValue, int rampSamples, SmoothingCurve curve, int scheduleCapacity)
+            : _curve{ curve },
+            _rampSamples{ rampSamples },
+            _ratio{ rampSamples == 0 ? (T)0 : (T)std::exp(std::log(0.001) / rampSamples) },
+            _target{ initialValue },
+            _scheduledChanges{ scheduleCapacity },
+            _current{ initialValue },
+            _lastSeenTarget{ initialValue },
+            _rampTarget{ initialValue },
+            _step{ 0 },
+            _rampRemaining{ 0 },
+            _hasPendingChange{ false },
+            _pendingChange{}
+        {
+            Check(rampSamples >= 0);
+        }
+
+        // no copying this
+        SmoothedParameter(const SmoothedParameter&) = delete;
+        SmoothedParameter& operator=(const SmoothedParameter&) = delete;
+
+        // The value the parameter is at or ramping towards.  Any thread.
+        T Target() const { return _target.load(std::memory_order_acquire); }
+
+        // Ramp to the value, starting with the next block processed.  Any thread.
+        void SetTarget(T value) { _target.store(value, std::memory_order_release); }
+
+        // Start ramping to the value at exactly the given sample time; if that time has already passed, at the
+        // start of the next block.  Changes must be scheduled in time order, from only one thread.
+        // Returns false if too many changes are already waiting; the change is then dropped.
+        bool Schedule(Time<AudioSample> time, T value)
+        {
+            ScheduledChange change{ time.Value(), value };
+            return _scheduledChanges.Push(&change, 1) == 1;
+        }
+
+        // The value as of the last sample processed.  Audio thread only.
+        T Current() const { return _current; }
+
+        // Advance the parameter over the block of count samples starting at blockStart.
+        // Returns false if the value is Current() for the whole block, leaving values untouched; otherwise
+        // writes each sample's value into values and returns true.  Audio thread only.
+        bool Advance(Time<AudioSample> blockStart, int count, T* values)
+        {
+            T target = _target.load(std::memory_order_acquire);
+            if (target != _lastSeenTarget)
+            {
+                _lastSeenTarget = target;
+                StartRamp(target);
+            }
+
+            bool isVarying = false;
+            int offset = 0;
+            while (offset < count)
+            {
+                if (!_hasPendingChange)
+                {
+                    _hasPendingChange = _scheduledChanges.Pop(&_pendingChange, 1) == 1;
+                }
+
+                int segmentEnd = count;
+                if (_hasPendingChange)
+                {
+                    int64_t changeOffset = _pendingChange.Time - blockStart.Value();
+                    if (changeOffset <= offset)
+                    {
+                        // a change which jumps rather than ramps makes the block vary from here on
+                        if (!isVarying && offset > 0)
+                        {
+                            std::fill(values, values + offset, _current);
+                            isVarying = true;
+                        }
+
+                        // Make the change the new target too, unless the UI thread has set a newer one meanwhile,
+                        // in which case that will win on the next block.
+                        T expected = _lastSeenTarget;
+                        _target.compare_exchange_strong(expected, _pendingChange.Value, std::memory_order_acq_rel);
+                        _lastSeenTarget = _pendingChange.Value;
+
+                        StartRamp(_pendingChange.Value);
+                        _hasPendingChange = false;
+                        continue;
+                    }
+                    segmentEnd = (int)std::min<int64_t>(changeOffset, count);
+                }
+
+                int segmentCount = segmentEnd - offset;
+                int rampCount = std::min(segmentCount, _rampRemaining);
+                if (rampCount > 0)
+                {
+                    if (!isVarying)
+                    {
+                        std::fill(values, values + offset, _current);
+                        isVarying = true;
+                    }
+                    RenderRamp(rampCount, values + offset);
+                }
+                if (isVarying)
+                {
+                    std::fill(values + offset + rampCount, values + segmentEnd, _current);
+                }
+                offset = segmentEnd;
+            }
+
+            return isVarying;
+        }
+    };
+}
@@ -0,0 +1,97 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "stdafx.h"
+
+#include "Check.h"
+
+namespace NowSound
+{
+    // A fixed-capacity, lock-free ring of values passed from exactly one producer thread to exactly one
+    // consumer thread (e.g. from the audio thread to a background worker).
+    // Push and Pop never block and never allocate; if the ring is full, Push keeps only what fits.
+    // T must be trivially copyable.
+    template<typename T>
+    class SpscRing
+    {
+    private:
+        // The ring storage; its length is a power of two.
+        const std::unique_ptr<T[]> _items;
+        const int64_t _capacity;
+
+        // Total values ever pushed; written only by the producer.
+        std::atomic<int64_t> _pushed;
+
+        // Total values ever popped; written only by the consumer.
+        std::atomic<int64_t> _popped;
+
+        int64_t Mask() const { return _capacity - 1; }
+
+    public:
+        // capacity must be a power of two.
+        SpscRing(int capacity)
+            : _items{ new T[capacity] },
+            _capacity{ capacity },
+            _pushed{ 0 },
+            _popped{ 0 }
+        {
+            Check(capacity > 0);
+            Check((capacity & (capacity - 1)) == 0);
+        }
+
+        // no copying this
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        int Capacity() const { return (int)_capacity; }
+
+        // Append up to count values; returns how many fit.  Producer only.
+        int Push(const T* data, int count)
+        {
+            int64_t pushed = _pushed.load(std::memory_order_relaxed);
+            int64_t free = _capacity - (pushed - _popped.load(std::memory_order_acquire));
+            int toPush = (int)std::min<int64_t>(count, free);
+
+            int64_t start = pushed & Mask();
+            int64_t firstCount = std::min<int64_t>(toPush, _capacity - start);
+            std::copy(data, data + firstCount, _items.get() + start);
+            std::copy(data + firstCount, data + toPush, _items.get());
+
+            _pushed.store(pushed + toPush, std::memory_order_release);
+            return toPush;
+        }
+
+        // Remove up to count values into data; returns how many there were.  Consumer only.
+        int Pop(T* data, int count)
+        {
+            int64_t popped = _popped.load(std::memory_order_relaxed);
+            int64_t available = _pushed.load(std::memory_order_acquire) - popped;
+            int toPop = (int)std::min<int64_t>(count, available);
+
+            int64_t start = popped & Mask();
+            int64_t firstCount = std::min<int64_t>(toPop, _capacity - start);
+            std::copy(_items.get() + start, _items.get() + start + firstCount, data);
+            std::copy(_items.get(), _items.get() + (toPop - firstCount), data + firstCount);
+
+            _popped.store(popped + toPop, std::memory_order_release);
+            return toPop;
+        }
+
+        // Remove up to count values without copying them anywhere; returns how many there were.  Consumer only.
+        int Skip(int count)
+        {
+            int64_t popped = _popped.load(std::memory_order_relaxed);
+            int64_t available = _pushed.load(std::memory_order_acquire) - popped;
+            int toSkip = (int)std::min<int64_t>(count, available);
+
+            _popped.store(popped + toSkip, std::memory_order_release);
+            return toSkip;
+        }
+    };
+}
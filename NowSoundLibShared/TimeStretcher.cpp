@@ -0,0 +1,223 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Check.h"
+#include "Kernels.h"
+#include "TimeStretcher.h"
+
+using namespace NowSound;
+
+const float* TimeStretcher::Window()
+{
+    // periodic, so that windows HopSamples apart sum to exactly one
+    static const struct HannWindow
+    {
+        float Values[FrameSamples];
+
+        HannWindow()
+        {
+            for (int i = 0; i < FrameSamples; i++)
+            {
+                Values[i] = (float)(0.5 - 0.5 * std::cos(2 * 3.14159265358979323846 * i / FrameSamples));
+            }
+        }
+    } s_window{};
+
+    return s_window.Values;
+}
+
+TimeStretcher::TimeStretcher()
+    : _reader{ LoopInterpolation::Nearest },
+    _stream{ nullptr },
+    _direction{ Direction::Forwards },
+    _lastPosition{ 0 },
+    _time{ 0 },
+    _previousStart{ 0 },
+    _accumulator{},
+    _frame{},
+    _template{},
+    _candidates{},
+    _reversed{},
+    _hop{},
+    _hopPlayed{ HopSamples },
+    _hopTime{ 0 },
+    _hopRate{ 0 }
+{
+    // compute the shared window now, rather than on the audio thread
+    Window();
+}
+
+void TimeStretcher::ReadSource(int64_t first, int count, float* destination)
+{
+    Check(count <= FrameSamples);
+
+    if (_direction == Direction::Forwards)
+    {
+        _reader.CopyLoop(*_stream, first, count, destination);
+    }
+    else
+    {
+        // source samples first .. first + count - 1 are loop samples -first - 1 down to -first - count
+        _reader.CopyLoop(*_stream, -first - count, count, _reversed);
+        Kernels::Reverse(_reversed, count, destination);
+    }
+}
+
+int64_t TimeStretcher::SourceSample(double time) const
+{
+    int64_t sample = (int64_t)std::llround(time);
+    return _direction == Direction::Forwards ? sample : -sample;
+}
+
+float TimeStretcher::Similarity(int offset) const
+{
+    const float* candidate = _candidates + SeekSamples + offset;
+    float correlation = Kernels::Dot(_template, candidate, HopSamples);
+    float energy = Kernels::Dot(candidate, candidate, HopSamples);
+    return correlation / std::sqrt(energy + 1e-9f);
+}
+
+int TimeStretcher::BestOffset()
+{
+    // start from no offset at all, so that on a tie we stay where we are
+    int bestOffset = 0;
+    float bestSimilarity = Similarity(0);
+    for (int offset = -SeekSamples; offset <= SeekSamples; offset += CoarseSeekStep)
+    {
+        float similarity = Similarity(offset);
+        if (similarity > bestSimilarity)
+        {
+            bestOffset = offset;
+            bestSimilarity = similarity;
+        }
+    }
+
+    int coarseOffset = bestOffset;
+    int refineStart = std::max(-SeekSamples, coarseOffset - CoarseSeekStep + 1);
+    int refineEnd = std::min(SeekSamples, coarseOffset + CoarseSeekStep - 1);
+    for (int offset = refineStart; offset <= refineEnd; offset++)
+    {
+        float similarity = Similarity(offset);
+        if (similarity > bestSimilarity)
+        {
+            bestOffset = offset;
+            bestSimilarity = similarity;
+        }
+    }
+
+    return bestOffset;
+}
+
+void TimeStretcher::Reset(double time)
+{
+    _time = time;
+
+    // Pretend the frame before this one started a hop ago, and put its second half in the accumulator, so the
+    // first hop is as loud as the rest rather than fading in.
+    int64_t start = SourceSample(time);
+    _previousStart = start - HopSamples;
+    std::fill(_accumulator, _accumulator + FrameSamples, 0.0f);
+    ReadSource(start, HopSamples, _frame);
+    Kernels::MultiplyAccumulate(Window() + HopSamples, _frame, HopSamples, _accumulator);
+
+    // no hop made yet
+    _hopPlayed = HopSamples;
+    _hopTime = time;
+    _hopRate = 0;
+}
+
+void TimeStretcher::MakeHop(double exactDuration, float rate)
+{
+    int64_t discreteDuration = _stream->DiscreteDuration().Value();
+    int64_t nominalStart = SourceSample(_time);
+
+    // If the nominal start is exactly where the previous frame continues, as when playing at rate 1, it is the
+    // best possible fit; otherwise find the best fit near the nominal start.
+    int offset = 0;
+    int64_t continuation = _previousStart + HopSamples;
+    if ((nominalStart - continuation) % discreteDuration != 0)
+    {
+        ReadSource(continuation, HopSamples, _template);
+        ReadSource(nominalStart - SeekSamples, HopSamples + 2 * SeekSamples, _candidates);
+        offset = BestOffset();
+    }
+
+    int64_t start = nominalStart + offset;
+    ReadSource(start, FrameSamples, _frame);
+    Kernels::MultiplyAccumulate(Window(), _frame, FrameSamples, _accumulator);
+
+    // the first hop of the accumulator is now complete; move it out, and shift the rest down
+    std::memcpy(_hop, _accumulator, HopSamples * sizeof(float));
+    std::memmove(_accumulator, _accumulator + HopSamples, (FrameSamples - HopSamples) * sizeof(float));
+    std::fill(_accumulator + FrameSamples - HopSamples, _accumulator + FrameSamples, 0.0f);
+
+    // keep source positions within the loop, so they never grow without bound
+    _previousStart = start % discreteDuration;
+    _hopPlayed = 0;
+    _hopTime = _time;
+    _hopRate = rate;
+
+    double advance = (double)HopSamples * rate;
+    _time = std::fmod(_direction == Direction::Forwards ? _time + advance : _time - advance, exactDuration);
+    if (_time < 0)
+    {
+        _time += exactDuration;
+    }
+}
+
+void TimeStretcher::Render(
+    const BufferedSliceStream<AudioSample, float>& stream,
+    ContinuousTime<AudioSample>& position,
+    Direction direction,
+    float rate,
+    int count,
+    float* destination)
+{
+    Check(stream.IsShut());
+    Check(stream.SliceSize() == 1);
+    Check(count >= 0);
+    Check(rate > 0);
+
+    double exactDuration = stream.ExactDuration().Value();
+    Check(exactDuration >= 1);
+
+    if (&stream != _stream || direction != _direction || position.Value() != _lastPosition)
+    {
+        _stream = &stream;
+        _direction = direction;
+
+        double time = std::fmod((double)position.Value(), exactDuration);
+        Reset(time < 0 ? time + exactDuration : time);
+    }
+
+    int completed = 0;
+    while (completed < count)
+    {
+        if (_hopPlayed == HopSamples)
+        {
+            MakeHop(exactDuration, rate);
+        }
+
+        int run = std::min(count - completed, HopSamples - _hopPlayed);
+        std::memcpy(destination + completed, _hop + _hopPlayed, run * sizeof(float));
+        _hopPlayed += run;
+        completed += run;
+    }
+
+    // where the loop would be now, had it been played at the rate of the hop we are in
+    double advance = (double)_hopPlayed * _hopRate;
+    double time = std::fmod(direction == Direction::Forwards ? _hopTime + advance : _hopTime - advance, exactDuration);
+    if (time < 0)
+    {
+        time += exactDuration;
+    }
+
+    position = ContinuousTime<AudioSample>((float)time);
+    _lastPosition = position.Value();
+}
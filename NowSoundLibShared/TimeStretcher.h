@@ -0,0 +1,125 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include "stdafx.h"
+
+#include "stdint.h"
+
+#include "Interval.h"
+#include "LoopPlayhead.h"
+#include "NowSoundTime.h"
+#include "SliceStream.h"
+
+namespace NowSound
+{
+    // Plays a shut mono stream as a loop at another tempo without changing its pitch, by WSOLA (waveform
+    // similarity overlap-add).
+    //
+    // The output is built from Hann-windowed frames of the loop, FrameSamples long, overlapped every
+    // HopSamples.  Each frame is taken from near where the loop would be if played at the given rate, moved
+    // by up to SeekSamples to whichever offset best continues the waveform of the frame before (by normalized
+    // cross-correlation, searched coarsely and then refined), so the overlapping frames add up without
+    // phasing.  The window is computed once and shared; the correlations and the overlap-add are vectorized
+    // (Kernels::Dot and Kernels::MultiplyAccumulate); and nothing is allocated after construction, so a
+    // stretcher may run on the audio thread.
+    //
+    // Like LoopPlayhead, the stretcher does not own its position.  The position passed in and out is where
+    // the loop would be if played at the rate, and is kept in [0, ExactDuration); the audio actually heard
+    // is within SeekSamples of it.  If the position passed in is not the one last passed out (because the
+    // track was rewound, say), or the stream or direction changed, the stretcher starts afresh from there.
+    class TimeStretcher
+    {
+    public:
+        // The length of each frame; long enough to hold a few periods of low voices.
+        static constexpr int FrameSamples = 1024;
+
+        // The distance between frames in the output; half a frame, so the Hann windows sum to one.
+        static constexpr int HopSamples = FrameSamples / 2;
+
+        // How far each frame may move from its nominal position to best fit the frame before it.
+        static constexpr int SeekSamples = 128;
+
+        // The spacing of the coarse correlation search; the best coarse offset is then refined sample by sample.
+        static constexpr int CoarseSeekStep = 8;
+
+    private:
+        // Reads the loop, wrapping around its ends.
+        LoopPlayhead _reader;
+
+        // The stream and direction we are playing; null until the first Render.
+        const BufferedSliceStream<AudioSample, float>* _stream;
+        Direction _direction;
+
+        // The position Render last passed out; if the next Render is passed anything else, we start afresh.
+        float _lastPosition;
+
+        // The nominal loop time of the next hop to be made.
+        double _time;
+
+        // The start of the last frame added, in source samples (see ReadSource).
+        int64_t _previousStart;
+
+        // The overlapping frames added so far; the first HopSamples are complete once the next frame is added.
+        float _accumulator[FrameSamples];
+
+        // The frame being added.
+        float _frame[FrameSamples];
+
+        // The continuation of the previous frame, which the next frame should match.
+        float _template[HopSamples];
+
+        // The samples every candidate for the next frame's first hop is drawn from.
+        float _candidates[HopSamples + 2 * SeekSamples];
+
+        // Loop samples read backwards, before reversing them.
+        float _reversed[FrameSamples];
+
+        // The samples of the last hop made, and how many of them have been played.
+        float _hop[HopSamples];
+        int _hopPlayed;
+
+        // The nominal loop time of the first sample of _hop, and the rate it was made at.
+        double _hopTime;
+        float _hopRate;
+
+        // The shared Hann window, FrameSamples long.
+        static const float* Window();
+
+        // Read count samples of the source -- the loop as heard in our direction -- starting at source sample
+        // first, into destination.  Going forwards, source sample i is loop sample i; going backwards, it is
+        // loop sample -i - 1 (all modulo the loop's length).
+        void ReadSource(int64_t first, int count, float* destination);
+
+        // The source sample nearest a loop time.
+        int64_t SourceSample(double time) const;
+
+        // The offset, within [-SeekSamples, SeekSamples], of the candidate best matching _template.
+        int BestOffset();
+
+        // The normalized correlation of _template with the candidate at this offset.
+        float Similarity(int offset) const;
+
+        // Start afresh at this loop time, as though the loop had been played up to there at rate 1.
+        void Reset(double time);
+
+        // Add the next frame, and move the completed hop into _hop.
+        void MakeHop(double exactDuration, float rate);
+
+    public:
+        TimeStretcher();
+
+        // Render count samples of the stream's loop into destination, starting from position and moving in the
+        // given direction at the given rate (in loop samples per output sample); position is updated to the
+        // nominal position of the next sample.  The stream must be shut, and must not be changed while this
+        // stretcher is used with it.
+        void Render(
+            const BufferedSliceStream<AudioSample, float>& stream,
+            ContinuousTime<AudioSample>& position,
+            Direction direction,
+            float rate,
+            int count,
+            float* destination);
+    };
+}
@@ -0,0 +1,148 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Check.h"
+#include "TimingHistogram.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NOWSOUND_TIMER_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+using namespace NowSound;
+
+const int CycleTimer::CalibrationMilliseconds = 20;
+
+uint64_t CycleTimer::Now()
+{
+#ifdef NOWSOUND_TIMER_TSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+double CycleTimer::TicksPerSecond()
+{
+#ifdef NOWSOUND_TIMER_TSC
+    // measured once; thread-safe by the rules for function statics
+    static const double ticksPerSecond = []()
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        uint64_t startTicks = Now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(CalibrationMilliseconds));
+        uint64_t endTicks = Now();
+        auto endTime = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(endTime - startTime).count();
+        return (double)(endTicks - startTicks) / seconds;
+    }();
+    return ticksPerSecond;
+#else
+    return (double)std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+#endif
+}
+
+int TimingHistogram::BucketOf(uint64_t ticks)
+{
+    if (ticks < SubBucketCount)
+    {
+        return (int)ticks;
+    }
+
+    // the index of the highest set bit; at least 2 here
+    int highestBit = 0;
+    for (uint64_t remaining = ticks >> 1; remaining != 0; remaining >>= 1)
+    {
+        highestBit++;
+    }
+
+    // each power of two gets SubBucketCount buckets, split by the two bits below the highest
+    int bucket = (highestBit - 1) * SubBucketCount + (int)((ticks >> (highestBit - 2)) & (SubBucketCount - 1));
+    return bucket < BucketCount ? bucket : BucketCount - 1;
+}
+
+uint64_t TimingHistogram::BucketLowerBound(int bucket)
+{
+    Check(bucket >= 0 && bucket < BucketCount);
+
+    if (bucket < SubBucketCount)
+    {
+        return (uint64_t)bucket;
+    }
+
+    int highestBit = bucket / SubBucketCount + 1;
+    uint64_t subBucket = (uint64_t)(bucket % SubBucketCount);
+    return (SubBucketCount + subBucket) << (highestBit - 2);
+}
+
+TimingHistogram::TimingHistogram()
+    : _count{ 0 },
+    _totalTicks{ 0 },
+    _maximumTicks{ 0 }
+{
+    for (std::atomic<uint32_t>& bucket : _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void TimingHistogram::Record(uint64_t ticks)
+{
+    // Only this thread writes, so plain load-then-store is enough; no read-modify-write instructions needed.
+    std::atomic<uint32_t>& bucket = _buckets[BucketOf(ticks)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _totalTicks.store(_totalTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    if (ticks > _maximumTicks.load(std::memory_order_relaxed))
+    {
+        _maximumTicks.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+uint64_t TimingHistogram::PercentileTicks(double fraction) const
+{
+    Check(fraction >= 0 && fraction <= 1);
+
+    // sum the buckets themselves, so the result is consistent with what we walk below
+    uint64_t count = 0;
+    for (const std::atomic<uint32_t>& bucket : _buckets)
+    {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(fraction * count));
+    uint64_t seen = 0;
+    int bucket = 0;
+    for (; bucket < BucketCount - 1; bucket++)
+    {
+        seen += _buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            break;
+        }
+    }
+
+    uint64_t maximum = MaximumTicks();
+    if (bucket == BucketCount - 1)
+    {
+        return maximum;
+    }
+    return std::min<uint64_t>(BucketLowerBound(bucket + 1) - 1, maximum);
+}
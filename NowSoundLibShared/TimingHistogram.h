@@ -0,0 +1,81 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <atomic>
+
+#include "stdafx.h"
+
+#include "stdint.h"
+
+namespace NowSound
+{
+    // A cheap, high-resolution timestamp for timing audio callbacks: the CPU's timestamp counter on x86/x64
+    // (which ticks at a constant rate on every CPU we support), or the steady clock elsewhere.
+    class CycleTimer
+    {
+    public:
+        // The current timestamp, in ticks.
+        static uint64_t Now();
+
+        // The number of ticks per second.  On x86/x64 this is measured against the steady clock the first time
+        // it is called, which takes about CalibrationMilliseconds; so call it once before timing anything on the
+        // audio thread.
+        static double TicksPerSecond();
+
+        // How long the timestamp counter calibration runs.
+        static const int CalibrationMilliseconds;
+    };
+
+    // A lock-free histogram of durations: exactly one thread (e.g. the audio thread) records, and any thread
+    // may read.  Recording is a handful of relaxed atomic stores; it never blocks and never allocates.
+    //
+    // Durations are in CycleTimer ticks, bucketed logarithmically with SubBucketCount buckets per power of two,
+    // so percentiles are accurate to within 1/SubBucketCount of a power of two across the whole range from one
+    // tick to 2^41 ticks (over ten minutes at 3 GHz).  Readers may see a recording half-applied (e.g. the count
+    // updated but not yet the total), which is immaterial for monitoring.
+    class TimingHistogram
+    {
+    public:
+        // The number of buckets per power of two.
+        static constexpr int SubBucketCount = 4;
+
+        // The total number of buckets; durations beyond the last bucket are counted in it.
+        static constexpr int BucketCount = 160;
+
+    private:
+        std::atomic<uint32_t> _buckets[BucketCount];
+
+        std::atomic<uint64_t> _count;
+
+        std::atomic<uint64_t> _totalTicks;
+
+        std::atomic<uint64_t> _maximumTicks;
+
+    public:
+        // The bucket holding the given duration.
+        static int BucketOf(uint64_t ticks);
+
+        // The smallest duration in the given bucket.
+        static uint64_t BucketLowerBound(int bucket);
+
+        TimingHistogram();
+
+        // Record one duration.  Must only be called from one thread at a time.
+        void Record(uint64_t ticks);
+
+        // The number of durations recorded.
+        uint64_t Count() const { return _count.load(std::memory_order_relaxed); }
+
+        // The sum of all durations recorded.
+        uint64_t TotalTicks() const { return _totalTicks.load(std::memory_order_relaxed); }
+
+        // The longest duration recorded.
+        uint64_t MaximumTicks() const { return _maximumTicks.load(std::memory_order_relaxed); }
+
+        // The duration below which the given fraction (from 0 to 1) of recorded durations fall, rounded up to the
+        // top of its bucket (but never more than the maximum); 0 if nothing has been recorded.
+        uint64_t PercentileTicks(double fraction) const;
+    };
+}
@@ -0,0 +1,74 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <atomic>
+
+#include "stdafx.h"
+
+namespace NowSound
+{
+    // Wait-free publication of a value from one writer thread (e.g. the audio thread) to one reader thread
+    // (e.g. the UI thread).
+    //
+    // There are three copies of the value: one owned by the writer, one owned by the reader, and one in the
+    // middle.  Publishing swaps the writer's copy with the middle one; reading swaps the middle copy with the
+    // reader's, if something new was published since the last read.  Neither side ever waits for the other,
+    // the reader always sees a complete (never torn) value, and neither side allocates.
+    //
+    // Since each copy is reused, the writer must rewrite all of WriteBuffer() before every Publish().
+    template<typename T>
+    class TripleBuffer
+    {
+    private:
+        // Set in _middle when the middle copy was published and not yet read.
+        static constexpr int Dirty = 4;
+        static constexpr int IndexMask = 3;
+
+        T _buffers[3];
+
+        // The index of the copy the writer owns; touched only by the writer.
+        int _writeIndex;
+
+        // The index of the middle copy, plus the Dirty bit.
+        std::atomic<int> _middle;
+
+        // The index of the copy the reader owns; touched only by the reader.
+        int _readIndex;
+
+    public:
+        TripleBuffer(const T& initialValue)
+            : _buffers{ initialValue, initialValue, initialValue },
+            _writeIndex{ 0 },
+            _middle{ 1 },
+            _readIndex{ 2 }
+        {}
+
+        // no copying this
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // The writer's copy, to fill in before calling Publish().
+        T& WriteBuffer() { return _buffers[_writeIndex]; }
+
+        // Make the writer's copy the latest value, and take over a free copy for the next write.
+        void Publish()
+        {
+            int oldMiddle = _middle.exchange(_writeIndex | Dirty, std::memory_order_acq_rel);
+            _writeIndex = oldMiddle & IndexMask;
+        }
+
+        // The latest published value (or the initial value, if nothing was published yet).
+        // The returned reference is valid until the next call to Read().
+        const T& Read()
+        {
+            if ((_middle.load(std::memory_order_relaxed) & Dirty) != 0)
+            {
+                int oldMiddle = _middle.exchange(_readIndex, std::memory_order_acq_rel);
+                _readIndex = oldMiddle & IndexMask;
+            }
+            return _buffers[_readIndex];
+        }
+    };
+}
@@ -3,7 +3,10 @@
 
 #include "stdafx.h"
 
+#include <algorithm>
+
 #include "Check.h"
+#include "Kernels.h"
 #include "rosetta_fft.h"
 
 using namespace std;
@@ -146,17 +149,20 @@ namespace RosettaFFT
         results[results.size() - 1] = FrequencyBinBounds(final.LowerBound, fftBinCount / 2);
     }
 
-    void RescaleFFT(const vector<FrequencyBinBounds>& bounds, const CArray& fftData, float* outputVector, int outputCapacity)
+    void MakeBinMap(const vector<FrequencyBinBounds>& bounds, FrequencyBinMap& map)
     {
-        NowSound::Check(bounds.size() == outputCapacity);
+        NowSound::Check(bounds.size() > 0);
+
+        map.FirstFftBins.clear();
+        map.WeightOffsets.clear();
+        map.Weights.clear();
+        map.FftBinCount = 0;
 
+        vector<float> binWeights{};
         for (int i = 0; i < bounds.size(); i++)
         {
-            // Sum up all fftData slots.
-            double count = 0;
-            double total = 0;
-
-            // start with fractional part of lower bound
+            // Each FFT bin counts in proportion to how much of it lies within the bounds; the first output bin
+            // always starts with all of FFT bin 0.
             double lowerBound = bounds[i].LowerBound;
             int lowerBoundFloor = (int)std::floor(lowerBound);
             double lowerBoundFraction = lowerBound - lowerBoundFloor;
@@ -164,52 +170,88 @@ namespace RosettaFFT
             int upperBoundFloor = (int)std::floor(upperBound);
             double upperBoundFraction = upperBound - upperBoundFloor;
 
-            if (i > 0)
+            binWeights.clear();
+            int firstFftBin = lowerBoundFloor;
+            if (i > 0 && lowerBoundFloor == upperBoundFloor)
             {
-                double value = abs(fftData[lowerBoundFloor]);
-
-                if (lowerBoundFloor == upperBoundFloor)
+                // the whole output bin lies within one FFT bin
+                binWeights.push_back((float)(upperBoundFraction - lowerBoundFraction));
+            }
+            else
+            {
+                if (i > 0)
                 {
-                    // this is the only interval that matters
-                    count = upperBoundFraction - lowerBoundFraction;
-                    total = value * count;
-
-                    // set upperBoundFraction artificially to 0 to cause the final "if" to be skipped
-                    upperBoundFraction = 0;
+                    binWeights.push_back((float)(1 - lowerBoundFraction));
+                    lowerBoundFloor++;
                 }
-                else
+                for (int j = lowerBoundFloor; j < upperBoundFloor; j++)
                 {
-                    count += (1 - lowerBoundFraction);
-                    total += ((1 - lowerBoundFraction) * value);
-                    lowerBoundFloor++;
+                    binWeights.push_back(1);
+                }
+                if (upperBoundFraction > 0)
+                {
+                    binWeights.push_back((float)upperBoundFraction);
                 }
-
-                // wcout << fixed << setprecision(5) << L"lowerBound: " << lowerBound << L"; value " << value << L"; count " << count << L"; total " << total << endl;
             }
 
-            // now add in all full buckets up to upperBoundFloor
-            for (int j = lowerBoundFloor; j < upperBoundFloor; j++)
+            double totalWeight = 0;
+            for (float weight : binWeights)
             {
-                double value = abs(fftData[j]);
-                count += 1;
-                total += value;
+                totalWeight += weight;
+            }
+            if (totalWeight <= 0)
+            {
+                // degenerate (empty) bounds; just take the FFT bin they're in
+                binWeights.assign(1, 1);
+                totalWeight = 1;
+            }
 
-                // wcout << L"adding index " << j << L": " << value << L"; count " << count << L"; total " << total << endl;
+            map.FirstFftBins.push_back(firstFftBin);
+            map.WeightOffsets.push_back((int)map.Weights.size());
+            for (float weight : binWeights)
+            {
+                map.Weights.push_back((float)(weight / totalWeight));
             }
+            map.FftBinCount = std::max<int>(map.FftBinCount, firstFftBin + (int)binWeights.size());
+        }
+        map.WeightOffsets.push_back((int)map.Weights.size());
+    }
+
+    void RescaleFFT(
+        const FrequencyBinMap& map,
+        const std::complex<float>* fftData,
+        const RescaleOptions& options,
+        float* magnitudes,
+        float* peaks,
+        float* outputVector,
+        int outputCapacity)
+    {
+        NowSound::Check(map.OutputBinCount() == outputCapacity);
+        NowSound::Check(options.PeakDecay == 0 || peaks != nullptr);
+
+        // every magnitude once...
+        NowSound::Kernels::ComplexMagnitude(reinterpret_cast<const float*>(fftData), map.FftBinCount, magnitudes);
+
+        // ...then each output bin is a weighted sum of a run of them
+        const float minimumLinear = std::pow(10.0f, MinimumDecibels / 20);
+        for (int i = 0; i < outputCapacity; i++)
+        {
+            int weightOffset = map.WeightOffsets[i];
+            int weightCount = map.WeightOffsets[i + 1] - weightOffset;
+            float value = NowSound::Kernels::Dot(map.Weights.data() + weightOffset, magnitudes + map.FirstFftBins[i], weightCount);
 
-            // finally, add in the fractional part of upperBound, if any
-            if (upperBoundFraction > 0)
+            if (options.PeakDecay > 0)
             {
-                double value = abs(fftData[upperBoundFloor]);
-                count += upperBoundFraction;
-                total += value * upperBoundFraction;
+                value = std::max<float>(value, peaks[i] * options.PeakDecay);
+                peaks[i] = value;
+            }
 
-                // wcout << L"upperBound: " << upperBound << L"; value " << value << L"; count " << count << L"; total " << total << endl;
+            if (options.Decibels)
+            {
+                value = 20 * std::log10(std::max<float>(value, minimumLinear));
             }
 
-            // set the output bin to the average
-            outputVector[i] = (float)(total / count);
-            // wcout << L"outputVector[" << i << L"] = " << outputVector[i] << endl;
+            outputVector[i] = value;
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,109 @@
+// NowSound library by Rob Jellinghaus, https://github.com/RobJellinghaus/NowSound
+// Licensed under the MIT license
+
+#pragma once
+
+#include <complex>
+#include <iostream>
+#include <valarray>
+#include <vector>
+
+namespace RosettaFFT
+{
+    // C++ FFT code from http://rosettacode.org/wiki/Fast_Fourier_transform#C.2B.2B
+
+    const double PI = std::atan(1) * 4;
+
+    typedef std::complex<double> Complex;
+    typedef std::valarray<Complex> CArray;
+
+    void simple_fft(CArray& x);
+    void optimized_fft(CArray& x);
+
+    // Subsequent methods are not from rosettacode.
+
+    void CreateBlackmanHarrisWindow(int fftSize, double* data);
+
+    // The bounds of a particular output bin returned from the RescaleFFT method.
+    struct FrequencyBinBounds
+    {
+        double LowerBound;
+        double UpperBound;
+        FrequencyBinBounds() : LowerBound{}, UpperBound{} { }
+        FrequencyBinBounds(double l, double u) : LowerBound{ l }, UpperBound{ u } { }
+    };
+
+    // Return a vector of [lower, upper] bounds, in terms of indices into an FFT result array.
+    // This can be precalculated and reused for rescaling each new FFT.
+    void MakeBinBounds(
+        // The vector into which to place results (having more difficulty with && references here than expected...).
+        std::vector<FrequencyBinBounds>& results,
+        // The frequency on which this whole histogram is based.
+        double centralFrequency,
+        // The number of divisions to make in each octave.
+        // Preferably a factor of 12.
+        int octaveDivisions,
+        // The number of bins in the returned distribution.
+        size_t binCount,
+        // The index in the returned distribution of the bin centered on centralFrequency.
+        int centralBinIndex,
+        // The sample rate at which the FFT data was taken.
+        double sampleRate,
+        // The number of FFT bins in the FFT data.
+        int fftBinCount);
+
+    // A precompiled sparse mapping from FFT bins to output bins, built once from the bin bounds: each output
+    // bin is the weighted sum of the magnitudes of a contiguous run of FFT bins.
+    struct FrequencyBinMap
+    {
+        // For each output bin, the first FFT bin it covers.
+        std::vector<int> FirstFftBins;
+
+        // For each output bin, the index in Weights of its first weight; plus a final entry of Weights.size().
+        std::vector<int> WeightOffsets;
+
+        // The weights of each output bin's FFT bins, already normalized so each output bin is an average.
+        std::vector<float> Weights;
+
+        // The number of FFT bins any output bin covers (i.e. one more than the highest one).
+        int FftBinCount;
+
+        FrequencyBinMap() : FirstFftBins{}, WeightOffsets{}, Weights{}, FftBinCount{ 0 } { }
+
+        int OutputBinCount() const { return (int)FirstFftBins.size(); }
+    };
+
+    // Compile the bin bounds (as made by MakeBinBounds) into a FrequencyBinMap.
+    void MakeBinMap(const std::vector<FrequencyBinBounds>& bounds, FrequencyBinMap& map);
+
+    // The decibel value of silence, when RescaleOptions::Decibels is set.
+    const float MinimumDecibels = -120;
+
+    // Post-processing RescaleFFT can do as it computes each output bin.
+    struct RescaleOptions
+    {
+        // Output 20 log10(value) (no lower than MinimumDecibels) rather than the linear value.
+        bool Decibels;
+
+        // If nonzero, hold peaks: each output bin is max(value, previous output * PeakDecay).
+        float PeakDecay;
+
+        RescaleOptions() : Decibels{ false }, PeakDecay{ 0 } { }
+        RescaleOptions(bool decibels, float peakDecay) : Decibels{ decibels }, PeakDecay{ peakDecay } { }
+    };
+
+    // Given a precompiled FrequencyBinMap and some FFT data, populate the output vector, in one pass that
+    // computes each FFT bin's magnitude only once.
+    // fftData holds the non-negative frequency bins of a real FFT (as produced by NowSound::RealFft).
+    // magnitudes is scratch space for map.FftBinCount values; peaks holds the held (linear) peak of each
+    // output bin from frame to frame, and may be null if options.PeakDecay is zero.
+    // The output vector must be the same length as the map.
+    void RescaleFFT(
+        const FrequencyBinMap& map,
+        const std::complex<float>* fftData,
+        const RescaleOptions& options,
+        float* magnitudes,
+        float* peaks,
+        float* outputVector,
+        int outputCapacity);
+}
@@ -39,6 +39,41 @@ namespace NowSoundLib
         public float BeatInMeasure;
     };
 
+    // Statistics about the graph's audio buffer allocator.
+    public struct NowSoundAllocatorInfo
+    {
+        public Int32 BufferLength;
+        public Int32 LiveBufferCount;
+        public Int32 FreeBufferCount;
+        public Int32 PeakLiveBufferCount;
+        public Int32 TotalBufferCount;
+        public Int32 FailedAllocationCount;
+    }
+
+    // Statistics about the time one node of the graph has spent processing audio.
+    public struct NowSoundNodeTimingInfo
+    {
+        public Int64 CallCount;
+        public float AverageMicroseconds;
+        public float MedianMicroseconds;
+        public float Percentile99Microseconds;
+        public float MaximumMicroseconds;
+    }
+
+    // Statistics about the time the whole graph has spent in audio device callbacks.
+    public struct NowSoundCallbackTimingInfo
+    {
+        public Int64 CallCount;
+        public float AverageMicroseconds;
+        public float MedianMicroseconds;
+        public float Percentile99Microseconds;
+        public float MaximumMicroseconds;
+        public float BudgetMicroseconds;
+        public Int64 OverBudgetCount;
+        public Int64 XrunCount;
+        public Int64 DeviceXrunCount;
+    }
+
     // Information about an input in a created or running graph; all inputs are mono
     // (and can be panned at will).
     public struct NowSoundInputInfo
@@ -110,6 +145,7 @@ namespace NowSoundLib
         internal float Volume;
         internal float BeatsPerMinute;
         internal Int64 BeatsPerMeasure;
+        internal Int64 DroppedSampleCount;
     };
 
     // Information about a track's time in NowSound terms.
@@ -136,6 +172,9 @@ namespace NowSoundLib
         public readonly float BeatsPerMinute;
         // The time signature.
         public readonly Duration<Beat> BeatsPerMeasure;
+        // Samples of input the track failed to record because the audio buffer pool was exhausted; if nonzero,
+        // the loop is shifted against the beat by that much.
+        public readonly Int64 DroppedSampleCount;
 
         internal TrackInfo(NowSoundTrackInfo pinvokeTrackInfo)
         {
@@ -149,6 +188,7 @@ namespace NowSoundLib
             Volume = pinvokeTrackInfo.Volume;
             BeatsPerMinute = pinvokeTrackInfo.BeatsPerMinute;
             BeatsPerMeasure = pinvokeTrackInfo.BeatsPerMeasure;
+            DroppedSampleCount = pinvokeTrackInfo.DroppedSampleCount;
         }
 
         public TrackInfo(
@@ -161,7 +201,8 @@ namespace NowSoundLib
             float pan,
             float volume,
             float beatsPerMinute,
-            Duration<Beat> beatsPerMeasure
+            Duration<Beat> beatsPerMeasure,
+            Int64 droppedSampleCount = 0
             )
         {
             IsTrackLooping = isTrackLooping;
@@ -174,6 +215,7 @@ namespace NowSoundLib
             Volume = volume;
             BeatsPerMinute = beatsPerMinute;
             BeatsPerMeasure = beatsPerMeasure;
+            DroppedSampleCount = droppedSampleCount;
         }
     };
 
@@ -192,6 +234,82 @@ namespace NowSoundLib
         GraphRunning,
     };
 
+    // The kinds of audio device a graph can run on.
+    public enum NowSoundAudioDevice
+    {
+        // The default ASIO hardware device.
+        AudioDeviceAsio,
+
+        // A software device calling back in real time, with silent inputs.
+        AudioDeviceNull,
+
+        // A software device calling back in real time, with inputs read from audio files.
+        AudioDeviceLoopback,
+
+        // No device at all; the graph processes audio only when RenderOffline is called.
+        AudioDeviceOffline,
+    };
+
+    // How to set up a graph, passed to NowSoundGraphAPI.InitializeInstance.
+    // This marshalable struct corresponds to the C++ P/Invokable type.  Every field after PreRecordingDuration may
+    // be 0 (the default) to get the library's default, and AudioDevice defaults to ASIO.
+    public struct NowSoundGraphOptions
+    {
+        // How many output bins in the (logarithmic) frequency histogram?
+        public Int32 OutputBinCount;
+        // What central frequency to use for the histogram?
+        public float CentralFrequency;
+        // How many divisions to make in each octave?
+        public Int32 OctaveDivisions;
+        // Which bin index should be centered on CentralFrequency?
+        public Int32 CentralBinIndex;
+        // How many samples as input to and output from the FFT?
+        public Int32 FftSize;
+        // How many seconds to pre-record, as latency compensation?
+        public float PreRecordingDuration;
+        // How many floats in each audio buffer? (0 = the device's sample rate, i.e. one second of mono audio or
+        // half a second of stereo)
+        public Int32 AudioBufferLengthInFloats;
+        // How many audio buffers to preallocate? (0 = default)
+        public Int32 InitialAudioBufferCount;
+        // How many audio buffers may ever be allocated? (0 = default)
+        public Int32 MaximumAudioBufferCount;
+        // How many audio buffers to allocate at once when the free list runs low? (0 = default)
+        public Int32 AudioBufferGrowthStep;
+        // How many samples from the start of one FFT frame to the start of the next? (0 = half the FFT size)
+        public Int32 FftHopSize;
+        // How many FFT frames per second, e.g. to match the UI frame rate? (0 = as set by FftHopSize)
+        public float FftFramesPerSecond;
+        // Nonzero if the frequency bins should be in decibels rather than linear magnitudes; an Int32 rather than
+        // a bool, to keep this struct blittable.
+        public Int32 FftOutputDecibels;
+        // How many seconds should held frequency bin peaks take to decay by 20 dB? (0 = no peak hold)
+        public float FftPeakHoldSeconds;
+        // Which kind of audio device should the graph run on?
+        public NowSoundAudioDevice AudioDevice;
+        // At what sample rate should a software (null, loopback or offline) device run? (ignored for ASIO)
+        public Int32 SoftwareSampleRateHz;
+        // How many samples per block should a software device process? (ignored for ASIO)
+        public Int32 SoftwareSamplesPerQuantum;
+
+        // Options with the given frequency histogram, FFT and pre-recording settings, and defaults for the rest.
+        public NowSoundGraphOptions(
+            int outputBinCount,
+            float centralFrequency,
+            int octaveDivisions,
+            int centralBinIndex,
+            int fftSize,
+            float preRecordingDuration) : this()
+        {
+            OutputBinCount = outputBinCount;
+            CentralFrequency = centralFrequency;
+            OctaveDivisions = octaveDivisions;
+            CentralBinIndex = centralBinIndex;
+            FftSize = fftSize;
+            PreRecordingDuration = preRecordingDuration;
+        }
+    }
+
     // The state of a particular IHolofunkAudioTrack.
     // Note that since this is extern "C", this is not an enum class, so these identifiers have to begin with Track
     // to disambiguate them from the GraphState identifiers.
@@ -211,6 +329,19 @@ namespace NowSoundLib
         TrackLooping,
     };
 
+    // How a looping track follows the graph's tempo, once that differs from the tempo it was recorded at.
+    public enum NowSoundTrackTempoMode
+    {
+        // Keep playing at the recorded tempo, ignoring the graph's.
+        TrackTempoFixed,
+
+        // Play faster or slower to match the graph's tempo, changing pitch too (like a turntable); cheap.
+        TrackTempoVarispeed,
+
+        // Stretch the loop to match the graph's tempo, keeping its pitch.  Mono tracks only; stereo tracks varispeed.
+        TrackTempoTimeStretch,
+    };
+
     // The audio inputs known to the app.
     /// Prevents confusing an audio input with some other int value.
     // 
@@ -267,6 +398,14 @@ namespace NowSoundLib
         Undefined = 0
     }
 
+    /// <summary>
+    /// 1-based ID of an additional voice (playhead) on a looping track.
+    /// </summary>
+    public enum TrackVoiceId
+    {
+        Undefined = 0
+    }
+
     public struct PluginInstanceInfo
     {
         public readonly PluginId NowSoundPluginId;
@@ -306,6 +445,11 @@ namespace NowSoundLib
         {
             Check((int)index);
         }
+
+        public static void Check(TrackVoiceId id)
+        {
+            Check((int)id);
+        }
     }
 
     /// <summary>
@@ -360,42 +504,45 @@ namespace NowSoundLib
 
         [DllImport("NowSoundLib")]
         static extern void NowSoundGraph_InitializeInstance(
-            int outputBinCount,
-            float centralFrequency,
-            int octaveDivisions,
-            int centralBinIndex,
-            int fftSize,
-            float preRecordingDuration);
+            NowSoundGraphOptions options,
+            [MarshalAs(UnmanagedType.LPWStr)] string loopbackFileNames);
 
         /// <summary>
         /// Initialize the audio graph subsystem such that device information can be queried.
         /// Graph must be Uninitialized.  On completion, graph becomes Initialized.
         /// Must be called from message/UI thread. May have a momentary delay as JUCE doesn't support
         /// async initialization.
+        /// The audio buffer pool options may each be 0 to use the library's defaults; a buffer length of 0
+        /// means as many floats as the device's sample rate: one second of mono audio, or half a second of stereo.
+        /// FFT frames start every FftHopSize samples (0 = half the FFT size); if FftFramesPerSecond is nonzero,
+        /// the hop is instead chosen to produce that many frames per second, e.g. to match the UI frame rate.
+        /// The frequency bins are in decibels if FftOutputDecibels is nonzero, and hold their peaks (decaying by
+        /// 20 dB every FftPeakHoldSeconds) if FftPeakHoldSeconds is nonzero.
+        /// The graph runs on options.AudioDevice.  The software devices (null, loopback and offline) run at
+        /// SoftwareSampleRateHz in blocks of SoftwareSamplesPerQuantum; the loopback device reads its inputs
+        /// from the '|'-separated loopbackFileNames; and an offline graph renders only via RenderOffline.
         /// </summary>
-        public static void InitializeInstance(
-            int outputBinCount,
-            float centralFrequency,
-            int octaveDivisions,
-            int centralBinIndex,
-            int fftSize,
-            float preRecordingDuration)
+        public static void InitializeInstance(NowSoundGraphOptions options, string loopbackFileNames = "")
         {
-            Contract.Requires(outputBinCount > 0);
-            Contract.Requires(centralFrequency > 20); // hz
-            Contract.Requires(octaveDivisions > 0);
-            Contract.Requires(centralBinIndex > 0);
-            Contract.Requires(fftSize > 0);
+            Contract.Requires(options.OutputBinCount > 0);
+            Contract.Requires(options.CentralFrequency > 20); // hz
+            Contract.Requires(options.OctaveDivisions > 0);
+            Contract.Requires(options.CentralBinIndex > 0);
+            Contract.Requires(options.FftSize > 0);
             // power of two (should check for just one 1-bit but oh well)
-            Contract.Requires((fftSize & 0xff) == 0);
+            Contract.Requires((options.FftSize & 0xff) == 0);
+            Contract.Requires(options.AudioBufferLengthInFloats >= 0);
+            Contract.Requires(options.InitialAudioBufferCount >= 0);
+            Contract.Requires(options.MaximumAudioBufferCount >= 0);
+            Contract.Requires(options.AudioBufferGrowthStep >= 0);
+            Contract.Requires(options.FftHopSize >= 0);
+            Contract.Requires(options.FftFramesPerSecond >= 0);
+            Contract.Requires(options.FftPeakHoldSeconds >= 0);
+            Contract.Requires(options.AudioDevice == NowSoundAudioDevice.AudioDeviceAsio
+                || (options.SoftwareSampleRateHz > 0 && options.SoftwareSamplesPerQuantum > 0));
+            Contract.Requires(options.AudioDevice != NowSoundAudioDevice.AudioDeviceLoopback || !string.IsNullOrEmpty(loopbackFileNames));
 
-            NowSoundGraph_InitializeInstance(
-                outputBinCount,
-                centralFrequency,
-                octaveDivisions,
-                centralBinIndex,
-                fftSize,
-                preRecordingDuration);
+            NowSoundGraph_InitializeInstance(options, loopbackFileNames ?? "");
         }
 
         [DllImport("NowSoundLib")]
@@ -410,7 +557,7 @@ namespace NowSoundLib
             NowSoundGraphInfo info = NowSoundGraph_Info();
             Contract.Assert(info.BitsPerSample == 32);
             Contract.Assert(info.ChannelCount == 2);
-            Contract.Assert(info.LatencyInSamples > 0);
+            Contract.Assert(info.LatencyInSamples >= 0);
             Contract.Assert(info.SampleRate > 0);
             Contract.Assert(info.SamplesPerQuantum > 0);
             return info;
@@ -527,6 +674,21 @@ namespace NowSoundLib
             NowSoundGraph_SetInputPan(audioInputId, pan);
         }
 
+        [DllImport("NowSoundLib")]
+        static extern bool NowSoundGraph_ScheduleInputPan(AudioInputId audioInputId, long timeInSamples, float pan);
+
+        /// <summary>
+        /// Start moving the pan value of this input to the given value at exactly the given audio time.
+        /// Changes must be scheduled in time order; returns false if too many are already waiting.
+        /// </summary>
+        public static bool ScheduleInputPan(AudioInputId audioInputId, Time<AudioSample> time, float pan)
+        {
+            Contract.Requires(pan >= 0);
+            Contract.Requires(pan <= 1);
+
+            return NowSoundGraph_ScheduleInputPan(audioInputId, (long)time, pan);
+        }
+
         [DllImport("NowSoundLib")]
         static extern NowSoundTimeInfo NowSoundGraph_TimeInfo();
 
@@ -545,6 +707,73 @@ namespace NowSoundLib
             return result;
         }
 
+        [DllImport("NowSoundLib")]
+        static extern NowSoundAllocatorInfo NowSoundGraph_AllocatorInfo();
+
+        /// <summary>
+        /// Get statistics about the audio buffer allocator.
+        /// Graph must be Initialized or Running.
+        /// </summary>
+        public static NowSoundAllocatorInfo AllocatorInfo()
+        {
+            return NowSoundGraph_AllocatorInfo();
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern Int32 NowSoundGraph_NodeTimingCount();
+
+        /// <summary>
+        /// Get the number of nodes whose processing times are recorded: every live NowSound processor in the
+        /// graph, in creation order; deleting a node shifts the indices of the nodes created after it down by one.
+        /// Graph must be Initialized or Running.
+        /// </summary>
+        public static int NodeTimingCount()
+        {
+            return NowSoundGraph_NodeTimingCount();
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern NowSoundNodeTimingInfo NowSoundGraph_NodeTimingInfo(Int32 nodeIndex);
+
+        /// <summary>
+        /// Get the processing time statistics of the given node.
+        /// Graph must be Initialized or Running.
+        /// </summary>
+        public static NowSoundNodeTimingInfo NodeTimingInfo(int nodeIndex)
+        {
+            Contract.Requires(nodeIndex >= 0);
+
+            return NowSoundGraph_NodeTimingInfo(nodeIndex);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundGraph_NodeTimingName(Int32 nodeIndex, [MarshalAs(UnmanagedType.LPWStr)] StringBuilder buffer, Int32 bufferCapacity);
+
+        /// <summary>
+        /// Get the name of the given node.
+        /// Graph must be Initialized or Running.
+        /// </summary>
+        public static void NodeTimingName(int nodeIndex, StringBuilder buffer)
+        {
+            Contract.Requires(nodeIndex >= 0);
+            Contract.Requires(buffer != null);
+
+            NowSoundGraph_NodeTimingName(nodeIndex, buffer, buffer.Capacity);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern NowSoundCallbackTimingInfo NowSoundGraph_CallbackTimingInfo();
+
+        /// <summary>
+        /// Get statistics about the time spent in each audio device callback, against the time available,
+        /// with counts of overrunning callbacks and lost blocks.
+        /// Graph must be Initialized or Running.
+        /// </summary>
+        public static NowSoundCallbackTimingInfo CallbackTimingInfo()
+        {
+            return NowSoundGraph_CallbackTimingInfo();
+        }
+
         [DllImport("NowSoundLib")]
         static extern void NowSoundGraph_SetTempo(float beatsPerMinute, int beatsPerMeasure);
 
@@ -572,6 +801,18 @@ namespace NowSoundLib
             return NowSoundGraph_GetInputFrequencies(audioInputId, floatBuffer, floatBufferCapacity);
         }
 
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundGraph_SetInputFrequencyAnalysisEnabled(AudioInputId audioInputId, bool isEnabled);
+
+        // Start or stop frequency analysis of this input (enabled by default); while stopped,
+        // GetInputFrequencies keeps returning the last histogram.
+        public static void SetInputFrequencyAnalysisEnabled(AudioInputId audioInputId, bool isEnabled)
+        {
+            Id.Check(audioInputId);
+
+            NowSoundGraph_SetInputFrequencyAnalysisEnabled(audioInputId, isEnabled);
+        }
+
         [DllImport("NowSoundLib")]
         static extern void NowSoundGraph_MessageTick();
 
@@ -610,6 +851,27 @@ namespace NowSoundLib
             NowSoundGraph_StopRecording();
         }
 
+        [DllImport("NowSoundLib")]
+        static extern float NowSoundGraph_RenderOffline(
+            [MarshalAs(UnmanagedType.LPWStr)] string inputFileName,
+            [MarshalAs(UnmanagedType.LPWStr)] string outputFileName,
+            float durationSeconds);
+
+        /// <summary>
+        /// Run the graph for durationSeconds of audio as fast as possible, feeding all inputs from inputFileName
+        /// (or a test tone if it is empty) and writing the output mix to outputFileName (WAV format).
+        /// Returns how many times faster than real time the render ran, or 0 if either file could not be opened.
+        /// Graph must be Running, and must have been initialized with AudioDeviceOffline.
+        /// </summary>
+        public static float RenderOffline(string inputFileName, string outputFileName, float durationSeconds)
+        {
+            Contract.Requires(inputFileName != null);
+            Contract.Requires(!string.IsNullOrEmpty(outputFileName));
+            Contract.Requires(durationSeconds > 0);
+
+            return NowSoundGraph_RenderOffline(inputFileName, outputFileName, durationSeconds);
+        }
+
         [DllImport("NowSoundLib")]
         static extern TrackId NowSoundGraph_CreateRecordingTrackAsync(AudioInputId id);
 
@@ -630,6 +892,27 @@ namespace NowSoundLib
             return result;
         }
 
+        [DllImport("NowSoundLib")]
+        static extern TrackId NowSoundGraph_CreateMultichannelRecordingTrackAsync(AudioInputId id, int channelCount);
+
+        /// <summary>
+        /// Create a new multichannel track and begin recording, with one channel from each of channelCount
+        /// consecutive inputs starting at id.
+        /// </summary>
+        /// <remarks>
+        /// Graph must be Running.  The graph is stereo, so channelCount must be 1 or 2.
+        /// </remarks>
+        public static TrackId CreateMultichannelRecordingTrackAsync(AudioInputId id, int channelCount)
+        {
+            Id.Check(id);
+            Contract.Requires(channelCount >= 1);
+            Contract.Requires(channelCount <= 2);
+
+            TrackId result = NowSoundGraph_CreateMultichannelRecordingTrackAsync(id, channelCount);
+            Id.Check(result);
+            return result;
+        }
+
 
         [DllImport("NowSoundLib")]
         static extern TrackId NowSoundGraph_CopyLoopingTrack(TrackId id);
@@ -828,6 +1111,20 @@ namespace NowSoundLib
             NowSoundGraph_SetInputPluginInstanceDryWet(audioInputId, pluginInstanceIndex, dryWet_0_100);
         }
 
+        // Schedule the dry/wet balance on the given plugin to change at exactly the given audio time.
+        [DllImport("NowSoundLib")]
+        static extern bool NowSoundGraph_ScheduleInputPluginInstanceDryWet(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex, long timeInSamples, int dryWet_0_100);
+
+        public static bool ScheduleInputPluginInstanceDryWet(AudioInputId audioInputId, PluginInstanceIndex pluginInstanceIndex, Time<AudioSample> time, int dryWet_0_100)
+        {
+            Id.Check(audioInputId);
+            Id.Check(pluginInstanceIndex);
+            Contract.Requires(dryWet_0_100 >= 0);
+            Contract.Requires(dryWet_0_100 <= 100);
+
+            return NowSoundGraph_ScheduleInputPluginInstanceDryWet(audioInputId, pluginInstanceIndex, (long)time, dryWet_0_100);
+        }
+
         [DllImport("NowSoundLib")]
         static extern void NowSoundGraph_DeleteInputPluginInstance(AudioInputId audioInputId, PluginInstanceIndex index);
 
@@ -940,6 +1237,70 @@ namespace NowSoundLib
             NowSoundTrack_Rewind(trackId);
         }
 
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundTrack_SetTempoMode(TrackId trackId, NowSoundTrackTempoMode tempoMode);
+
+        // Set how this track follows the graph's tempo, once that differs from the tempo it was recorded at.
+        public static void SetTempoMode(TrackId trackId, NowSoundTrackTempoMode tempoMode)
+        {
+            Id.Check(trackId);
+            Contract.Requires(tempoMode >= NowSoundTrackTempoMode.TrackTempoFixed);
+            Contract.Requires(tempoMode <= NowSoundTrackTempoMode.TrackTempoTimeStretch);
+
+            NowSoundTrack_SetTempoMode(trackId, tempoMode);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern TrackVoiceId NowSoundTrack_AddVoice(TrackId trackId, float offsetBeats, bool isPlaybackBackwards, float volume, float pan);
+
+        // Add a voice playing this track's audio, starting offsetBeats ahead of the track's current position.
+        // Contractually requires State == NowSoundTrack_State.Looping.
+        // Returns TrackVoiceId.Undefined, adding nothing, if the track already has as many voices as it can hold;
+        // a deleted voice counts until the audio thread finishes its current block.
+        public static TrackVoiceId AddVoice(TrackId trackId, float offsetBeats, bool isPlaybackBackwards, float volume, float pan)
+        {
+            Id.Check(trackId);
+            Contract.Requires(volume >= 0);
+            Contract.Requires(pan >= 0 && pan <= 1);
+
+            return NowSoundTrack_AddVoice(trackId, offsetBeats, isPlaybackBackwards, volume, pan);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundTrack_SetVoiceVolume(TrackId trackId, TrackVoiceId voiceId, float volume);
+
+        public static void SetVoiceVolume(TrackId trackId, TrackVoiceId voiceId, float volume)
+        {
+            Id.Check(trackId);
+            Id.Check(voiceId);
+            Contract.Requires(volume >= 0);
+
+            NowSoundTrack_SetVoiceVolume(trackId, voiceId, volume);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundTrack_SetVoicePan(TrackId trackId, TrackVoiceId voiceId, float pan);
+
+        public static void SetVoicePan(TrackId trackId, TrackVoiceId voiceId, float pan)
+        {
+            Id.Check(trackId);
+            Id.Check(voiceId);
+            Contract.Requires(pan >= 0 && pan <= 1);
+
+            NowSoundTrack_SetVoicePan(trackId, voiceId, pan);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundTrack_DeleteVoice(TrackId trackId, TrackVoiceId voiceId);
+
+        public static void DeleteVoice(TrackId trackId, TrackVoiceId voiceId)
+        {
+            Id.Check(trackId);
+            Id.Check(voiceId);
+
+            NowSoundTrack_DeleteVoice(trackId, voiceId);
+        }
+
         [DllImport("NowSoundLib")]
         static extern bool NowSoundTrack_GetFrequencies(TrackId trackId, float[] floatBuffer, int floatBufferCapacity);
 
@@ -956,6 +1317,18 @@ namespace NowSoundLib
             return NowSoundTrack_GetFrequencies(trackId, floatBuffer, floatBuffer.Length);
         }
 
+        [DllImport("NowSoundLib")]
+        static extern void NowSoundTrack_SetFrequencyAnalysisEnabled(TrackId trackId, bool isEnabled);
+
+        // Start or stop frequency analysis of this track (enabled by default); while stopped,
+        // GetFrequencies keeps returning the last histogram.
+        public static void SetFrequencyAnalysisEnabled(TrackId trackId, bool isEnabled)
+        {
+            Id.Check(trackId);
+
+            NowSoundTrack_SetFrequencyAnalysisEnabled(trackId, isEnabled);
+        }
+
         [DllImport("NowSoundLib")]
         static extern bool NowSoundTrack_IsMuted(TrackId trackId);
 
@@ -1020,6 +1393,37 @@ namespace NowSoundLib
             NowSoundTrack_SetVolume(trackId, volume);
         }
 
+        [DllImport("NowSoundLib")]
+        static extern bool NowSoundTrack_SchedulePan(TrackId trackId, long timeInSamples, float pan);
+
+        /// <summary>
+        /// Start moving the track's pan to the given value at exactly the given audio time.
+        /// Changes must be scheduled in time order; returns false if too many are already waiting.
+        /// </summary>
+        public static bool SchedulePan(TrackId trackId, Time<AudioSample> time, float pan)
+        {
+            Id.Check(trackId);
+            Contract.Requires(pan >= 0);
+            Contract.Requires(pan <= 1);
+
+            return NowSoundTrack_SchedulePan(trackId, (long)time, pan);
+        }
+
+        [DllImport("NowSoundLib")]
+        static extern bool NowSoundTrack_ScheduleVolume(TrackId trackId, long timeInSamples, float volume);
+
+        /// <summary>
+        /// Start moving the track's volume to the given value at exactly the given audio time.
+        /// Changes must be scheduled in time order; returns false if too many are already waiting.
+        /// </summary>
+        public static bool ScheduleVolume(TrackId trackId, Time<AudioSample> time, float volume)
+        {
+            Id.Check(trackId);
+            Contract.Requires(volume >= 0);
+
+            return NowSoundTrack_ScheduleVolume(trackId, (long)time, volume);
+        }
+
         // Add an instance of the given plugin on the given track.
         [DllImport("NowSoundLib")]
         static extern PluginInstanceIndex NowSoundTrack_AddPluginInstance(TrackId trackId, PluginId pluginId, ProgramId programId, int dryWet_0_100);
@@ -1081,6 +1485,20 @@ namespace NowSoundLib
             NowSoundTrack_SetPluginInstanceDryWet(trackId, pluginInstanceIndex, dryWet_0_100);
         }
 
+        // Schedule the dry/wet balance on the given plugin to change at exactly the given audio time.
+        [DllImport("NowSoundLib")]
+        static extern bool NowSoundTrack_SchedulePluginInstanceDryWet(TrackId trackId, PluginInstanceIndex pluginInstanceIndex, long timeInSamples, int dryWet_0_100);
+
+        public static bool SchedulePluginInstanceDryWet(TrackId trackId, PluginInstanceIndex pluginInstanceIndex, Time<AudioSample> time, int dryWet_0_100)
+        {
+            Id.Check(trackId);
+            Id.Check(pluginInstanceIndex);
+            Contract.Requires(dryWet_0_100 >= 0);
+            Contract.Requires(dryWet_0_100 <= 100);
+
+            return NowSoundTrack_SchedulePluginInstanceDryWet(trackId, pluginInstanceIndex, (long)time, dryWet_0_100);
+        }
+
         [DllImport("NowSoundLib")]
         static extern void NowSoundTrack_DeletePluginInstance(TrackId trackId, PluginInstanceIndex index);
 
@@ -77,13 +77,13 @@ namespace NowSoundWinFormsApp
 
             // These constant values obtained by experiment relative to my personal baritone :-P
             // and let's P/Invoke up in here!
-            NowSoundGraphAPI.InitializeInstance(
+            NowSoundGraphAPI.InitializeInstance(new NowSoundGraphOptions(
                 MagicConstants.OutputBinCount,
                 MagicConstants.CentralFrequency,
                 MagicConstants.OctaveDivisions,
                 MagicConstants.CentralFrequencyBin,
                 MagicConstants.FftBinSize,
-                MagicConstants.PreRecordingDuration);
+                MagicConstants.PreRecordingDuration));
 
             // set to a tempo with a fractional number of beats, to debug backwards fractional beat handling
             NowSoundGraphAPI.SetTempo(61, 4);
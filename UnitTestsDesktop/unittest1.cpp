@@ -1,13 +1,29 @@
 #include "stdafx.h"
 #include "CppUnitTest.h"
 
+#include <sstream>
+#include <thread>
+
 #include "BufferAllocator.h"
 #include "Check.h"
+#include "EventLog.h"
 #include "Histogram.h"
 #include "Interval.h"
+#include "Kernels.h"
+#include "LoopPlayhead.h"
+#include "RealFft.h"
+#include "RingSliceStream.h"
+#include "RingVector.h"
+#include "rosetta_fft.h"
 #include "Slice.h"
+#include "SmoothedParameter.h"
 #include "SliceStream.h"
+#include "SlotTable.h"
+#include "SpscRing.h"
 #include "NowSoundTime.h"
+#include "TimeStretcher.h"
+#include "TimingHistogram.h"
+#include "TripleBuffer.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace NowSound;
@@ -56,6 +72,90 @@ namespace UnitTestsDesktop
             Check(h.Average() == -15);
         }
 
+        TEST_METHOD(TestHistogramAddAll)
+        {
+            // same sequence as TestHistogram, added in batches that wrap around the histogram's storage
+            float values[] = { 10, 20, 30, 0, -10, -20, -30 };
+            Histogram h(4);
+            h.AddAll(values, 2, false);
+            Check(h.Min() == 10);
+            Check(h.Max() == 20);
+            Check(h.Average() == 15);
+            h.AddAll(values + 2, 3, false);
+            Check(h.Min() == -10);
+            Check(h.Max() == 30);
+            Check(h.Average() == 10);
+            h.AddAll(values + 5, 2, false);
+            Check(h.Min() == -30);
+            Check(h.Max() == 0);
+            Check(h.Average() == -15);
+
+            // absolute values
+            Histogram abs(4);
+            abs.AddAll(values + 4, 3, true);
+            Check(abs.Min() == 10);
+            Check(abs.Max() == 30);
+            Check(abs.Average() == 20);
+        }
+
+        TEST_METHOD(TestHistogramDecimated)
+        {
+            // a window of three blocks of four values each
+            Histogram h(12, 4);
+            float values[] = { 1, 2, 3, -4, -5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+            h.AddAll(values, 3, false);
+            // the incomplete first block counts
+            Check(h.Min() == 1);
+            Check(h.Max() == 3);
+            h.AddAll(values + 3, 9, true);
+            Check(h.Min() == 1);
+            Check(h.Max() == 12);
+            Check(h.Average() == 6.5f);
+            // completing the next block pushes out the first (but two values in, it still counts)
+            h.AddAll(values + 12, 2, false);
+            Check(h.Min() == 1);
+            Check(h.Max() == 14);
+            h.AddAll(values + 12, 2, false);
+            Check(h.Min() == 5);
+            Check(h.Max() == 14);
+            Check(std::abs(h.Average() - 122.0f / 12) < 1e-5f);
+        }
+
+        // Microbenchmark: sliding min/max over half a second at 48Khz, on a signal whose window extremes
+        // keep leaving the window (the case that used to force full rescans).
+        TEST_METHOD(TestHistogramBenchmark)
+        {
+            const int windowSamples = 24000;
+            const int quantumSamples = 256;
+            const int quantumCount = 2000;
+
+            std::vector<float> quantum(quantumSamples);
+            for (int decimation : { 1, quantumSamples })
+            {
+                Histogram h(windowSamples, decimation);
+                float sink = 0;
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int q = 0; q < quantumCount; q++)
+                {
+                    // a slowly decaying ramp: the oldest value in the window is always the max
+                    for (int i = 0; i < quantumSamples; i++)
+                    {
+                        quantum[i] = 1.0f / (float)(q * quantumSamples + i + 1);
+                    }
+                    h.AddAll(quantum.data(), quantumSamples, false);
+                    sink += h.Max() + h.Min();
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                Check(sink > 0);
+
+                std::wstringstream wstr;
+                wstr << L"TestHistogramBenchmark: decimation " << decimation << L": "
+                    << (std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / quantumCount)
+                    << L" ns per " << quantumSamples << L"-sample AddAll + Min + Max";
+                Logger::WriteMessage(wstr.str().c_str());
+            }
+        }
+
         static const int FloatSliceSize = 2;
         static const int FloatNumSlices = 128;
 
@@ -75,6 +175,183 @@ namespace UnitTestsDesktop
             Check(f2ptr == f3.Data()); // need to pull from free list first
         }
 
+        // Test live/free/peak buffer accounting.
+        TEST_METHOD(TestBufferAllocatorAccounting)
+        {
+            BufferAllocator<float> bufferAllocator(FloatSliceSize * 16, 2);
+            Check(bufferAllocator.LiveBufferCount() == 0);
+            Check(bufferAllocator.FreeListCount() == 2);
+
+            OwningBuf<float> f1(bufferAllocator.Allocate());
+            OwningBuf<float> f2(bufferAllocator.Allocate());
+            OwningBuf<float> f3(bufferAllocator.Allocate());
+            Check(bufferAllocator.LiveBufferCount() == 3);
+            Check(bufferAllocator.FreeListCount() == 0);
+            Check(bufferAllocator.TotalBufferCount() == 3);
+            Check(bufferAllocator.PeakLiveBufferCount() == 3);
+
+            bufferAllocator.Free(std::move(f1));
+            bufferAllocator.Free(std::move(f2));
+            Check(bufferAllocator.LiveBufferCount() == 1);
+            Check(bufferAllocator.FreeListCount() == 2);
+            Check(bufferAllocator.PeakLiveBufferCount() == 3);
+
+            // reallocating a freed buffer bumps its generation, so the new owner is distinguishable from the old one
+            OwningBuf<float> f4(bufferAllocator.Allocate());
+            Check(bufferAllocator.LiveBufferCount() == 2);
+            Check(bufferAllocator.TotalBufferCount() == 3);
+            Check(bufferAllocator.PeakLiveBufferCount() == 3);
+#ifdef _DEBUG
+            Check(f4.Generation() == 3);
+            Check(f3.Generation() == 1);
+#endif
+        }
+
+        // Test carving buffers out of a pre-faulted arena, with heap overflow beyond the arena.
+        TEST_METHOD(TestBufferAllocatorArena)
+        {
+            const int bufferLength = FloatSliceSize * 1024;
+            const int arenaBufferCount = 3;
+            BufferAllocator<float> bufferAllocator(BufferAllocatorPolicy(bufferLength, 2, 16, 0, 1, arenaBufferCount, /*useLargePages:*/ true, /*lockArenaPages:*/ true));
+            Check(bufferAllocator.Arena() != nullptr);
+            Check(bufferAllocator.Arena()->Size() >= arenaBufferCount * bufferLength * sizeof(float));
+
+            OwningBuf<float> f1(bufferAllocator.Allocate());
+            OwningBuf<float> f2(bufferAllocator.Allocate());
+            OwningBuf<float> f3(bufferAllocator.Allocate());
+            OwningBuf<float> f4(bufferAllocator.Allocate());
+
+            // the arena buffers are contiguous; the fourth buffer overflows onto the heap
+            float* arenaBase = (float*)bufferAllocator.Arena()->Base();
+            float* arenaEnd = arenaBase + arenaBufferCount * bufferLength;
+            Check(f1.Data() >= arenaBase && f1.Data() < arenaEnd);
+            Check(f2.Data() >= arenaBase && f2.Data() < arenaEnd);
+            Check(f3.Data() >= arenaBase && f3.Data() < arenaEnd);
+            Check(f4.Data() < arenaBase || f4.Data() >= arenaEnd);
+            Check(std::abs(f1.Data() - f2.Data()) == bufferLength);
+
+            // arena buffers are writable and recycle through the free list like any other
+            f3.Data()[bufferLength - 1] = 1.0f;
+            float* f3ptr = f3.Data();
+            bufferAllocator.Free(std::move(f3));
+            OwningBuf<float> f5(bufferAllocator.Allocate());
+            Check(f5.Data() == f3ptr);
+            Check(f5.Data()[bufferLength - 1] == 1.0f);
+
+            bufferAllocator.Free(std::move(f4));
+            bufferAllocator.Free(std::move(f5));
+            // f1 and f2 are simply destroyed without being freed; they must not try to delete arena memory
+        }
+
+        // Test the refill thread and concurrent allocation/freeing through the lock-free free list.
+        TEST_METHOD(TestBufferAllocatorRefill)
+        {
+            const int lowWaterMark = 4;
+            BufferAllocator<float> bufferAllocator(FloatSliceSize * 16, 1, 256, lowWaterMark);
+
+            // wait for the refill thread to top up the free list
+            while (bufferAllocator.FreeListCount() < lowWaterMark)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            Check(bufferAllocator.TotalReservedSpace() == (long)(lowWaterMark * FloatSliceSize * 16 * sizeof(float)));
+
+            // take two buffers; the refill thread should replace them
+            OwningBuf<float> held1(bufferAllocator.Allocate());
+            OwningBuf<float> held2(bufferAllocator.Allocate());
+            while (bufferAllocator.FreeListCount() < lowWaterMark)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            bufferAllocator.Free(std::move(held1));
+            bufferAllocator.Free(std::move(held2));
+            Check(bufferAllocator.FreeListCount() == lowWaterMark + 2);
+
+            // hammer the free list from two threads at once; every buffer must be handed out to only one owner,
+            // and the free list never drops below the low-water mark so the refill thread stays idle
+            auto churn = [&bufferAllocator](float marker)
+            {
+                for (int i = 0; i < 10000; i++)
+                {
+                    OwningBuf<float> buf(bufferAllocator.Allocate());
+                    buf.Data()[0] = marker;
+                    std::this_thread::yield();
+                    Check(buf.Data()[0] == marker);
+                    bufferAllocator.Free(std::move(buf));
+                }
+            };
+            std::thread other(churn, 1.0f);
+            churn(2.0f);
+            other.join();
+
+            Check((long)(bufferAllocator.FreeListCount() * FloatSliceSize * 16 * sizeof(float)) == bufferAllocator.TotalReservedSpace());
+        }
+
+        // Test that an exhausted allocator hands out empty buffers rather than failing, even when racing threads
+        // are growing it, and that streams drop (and count) what they cannot store.
+        TEST_METHOD(TestBufferAllocatorExhaustion)
+        {
+            const int maximumBufferCount = 64;
+            BufferAllocator<float> bufferAllocator(FloatSliceSize * 4, 1, maximumBufferCount);
+
+            // grow the pool from two threads at once until it is exhausted; exactly the maximum must be handed out
+            std::atomic<int> allocatedCount{ 0 };
+            std::vector<OwningBuf<float>> held1;
+            std::vector<OwningBuf<float>> held2;
+            auto grow = [&bufferAllocator, &allocatedCount](std::vector<OwningBuf<float>>* held)
+            {
+                for (int i = 0; i < maximumBufferCount; i++)
+                {
+                    OwningBuf<float> buf(bufferAllocator.Allocate());
+                    if (!buf.IsEmpty())
+                    {
+                        allocatedCount++;
+                        held->push_back(std::move(buf));
+                    }
+                }
+            };
+            std::thread other(grow, &held2);
+            grow(&held1);
+            other.join();
+
+            Check(allocatedCount == maximumBufferCount);
+            Check(bufferAllocator.TotalBufferCount() == maximumBufferCount);
+            Check(bufferAllocator.FailedAllocationCount() == maximumBufferCount);
+
+            OwningBuf<float> empty(bufferAllocator.Allocate());
+            Check(empty.IsEmpty());
+            Check(empty.Id() == 0);
+            Check(bufferAllocator.FailedAllocationCount() == maximumBufferCount + 1);
+
+            // once a buffer comes back, it can be allocated again; either thread may have won every allocation
+            std::vector<OwningBuf<float>>& nonempty = held1.empty() ? held2 : held1;
+            bufferAllocator.Free(std::move(nonempty.back()));
+            nonempty.pop_back();
+            OwningBuf<float> reused(bufferAllocator.Allocate());
+            Check(!reused.IsEmpty());
+            nonempty.push_back(std::move(reused));
+
+            for (OwningBuf<float>& buf : held1)
+            {
+                bufferAllocator.Free(std::move(buf));
+            }
+            for (OwningBuf<float>& buf : held2)
+            {
+                bufferAllocator.Free(std::move(buf));
+            }
+
+            // a stream whose allocator runs dry keeps what it has room for, and drops the rest
+            BufferAllocator<float> tinyAllocator(FloatSliceSize * 4, 1, 1);
+            BufferedSliceStream<AudioSample, float> stream(FloatSliceSize, &tinyAllocator);
+            std::vector<float> data(FloatSliceSize * 6, 1.0f);
+            stream.Append(6, data.data());
+            Check(stream.DiscreteDuration() == 4);
+            Check(stream.DroppedDuration() == 2);
+            stream.Append(3, data.data());
+            Check(stream.DiscreteDuration() == 4);
+            Check(stream.DroppedDuration() == 5);
+        }
+
         // Fill a slice with simple linear data.
         static void PopulateFloatSlice(Slice<AudioSample, float> slice)
         {
@@ -263,6 +540,36 @@ namespace UnitTestsDesktop
             Check(Verify4SliceFloatStream(stream2, 0) == 11);
         }
 
+        TEST_METHOD(TestStreamAppendingChannels)
+        {
+            // stereo slices, 11 to a buffer, appended in pieces which keep crossing buffers
+            const int sliceSize = 2;
+            BufferAllocator<float> bufferAllocator(11 * sliceSize, 1);
+            BufferedSliceStream<AudioSample, float> stream(sliceSize, &bufferAllocator);
+
+            std::vector<float> left(30);
+            std::vector<float> right(30);
+            for (int i = 0; i < 30; i++)
+            {
+                left[i] = (float)i;
+                right[i] = (float)-i;
+            }
+            const float* channels[] = { left.data(), right.data() };
+            stream.AppendChannels(Duration<AudioSample>(7), channels);
+            const float* laterChannels[] = { left.data() + 7, right.data() + 7 };
+            stream.AppendChannels(Duration<AudioSample>(23), laterChannels);
+
+            Check(stream.DiscreteDuration() == 30);
+
+            std::vector<float> interleaved(60);
+            stream.CopyTo(stream.DiscreteInterval(), interleaved.data());
+            for (int i = 0; i < 30; i++)
+            {
+                Check(interleaved[i * 2] == i);
+                Check(interleaved[i * 2 + 1] == -i);
+            }
+        }
+
         // Test getting slices of stream data using forwards intervals (the norm).
         // Note that in comments we write a forwards interval with initial time 5 and duration 7 as [5, 7)
         // to denote that it is a closed-open interval.
@@ -524,6 +831,1373 @@ namespace UnitTestsDesktop
             Check(slice.Get(0, 0) == 11);
         }
 
+        // Trim a stream of many small buffers repeatedly, verifying every lookup lands on the right data.
+        TEST_METHOD(TestStreamTrimmingLookup)
+        {
+            const int bufferLength = 7; // mono samples per buffer; deliberately doesn't divide the append size
+            const int maxBuffered = 50;
+            BufferAllocator<float> bufferAllocator(bufferLength, 1);
+            BufferedSliceStream<AudioSample, float> stream(1, &bufferAllocator, maxBuffered);
+
+            float quantum[3];
+            float nextValue = 0;
+            for (int i = 0; i < 100; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    quantum[j] = nextValue++;
+                }
+                stream.Append(3, quantum);
+
+                // every sample in the stream must be findable in both directions
+                int64_t duration = stream.DiscreteDuration().Value();
+                Check(duration <= maxBuffered);
+                float firstValue = nextValue - duration;
+                for (int64_t t = 0; t < duration; t++)
+                {
+                    Slice<AudioSample, float> forwards = stream.GetSliceIntersecting(Interval<AudioSample>(t, 1, Direction::Forwards));
+                    Check(forwards.SliceDuration() == 1);
+                    Check(forwards.Get(0, 0) == firstValue + t);
+
+                    Slice<AudioSample, float> backwards = stream.GetSliceIntersecting(Interval<AudioSample>(t + 1, 1, Direction::Backwards));
+                    Check(backwards.SliceDuration() == 1);
+                    Check(backwards.Get(0, 0) == firstValue + t);
+                }
+
+                // and copying the whole stream yields contiguous values
+                float copy[maxBuffered];
+                stream.CopyTo(stream.DiscreteInterval(), copy);
+                for (int64_t t = 0; t < duration; t++)
+                {
+                    Check(copy[t] == firstValue + t);
+                }
+            }
+
+            // trimmed buffers went back to the allocator
+            Check(stream.BufferCount() <= (maxBuffered / bufferLength) + 2);
+            Check(bufferAllocator.LiveBufferCount() == stream.BufferCount());
+        }
+
+        // A cursor steps between neighbouring segments, wraps to the first, and survives the stream being trimmed.
+        TEST_METHOD(TestSliceStreamCursor)
+        {
+            const int bufferLength = 8;
+            BufferAllocator<float> bufferAllocator(bufferLength, 1);
+            BufferedSliceStream<AudioSample, float> stream(1, &bufferAllocator, 30);
+
+            float values[40];
+            for (int i = 0; i < 40; i++)
+            {
+                values[i] = (float)i;
+            }
+            stream.Append(20, values);
+
+            SliceStreamCursor<AudioSample, float> cursor(stream);
+            for (int t = 0; t < 20; t++)
+            {
+                cursor.MoveTo(t);
+                Check(cursor.SegmentStart() == (t / bufferLength) * bufferLength);
+                Check(cursor.SegmentEnd() == std::min((t / bufferLength + 1) * bufferLength, 20));
+                Check(*cursor.DataAt(t) == t);
+            }
+            for (int t = 19; t >= 0; t--)
+            {
+                cursor.MoveTo(t);
+                Check(*cursor.DataAt(t) == t);
+            }
+
+            // wrap from the end straight back to the start, and jump into the middle
+            cursor.MoveTo(19);
+            cursor.MoveTo(2);
+            Check(*cursor.DataAt(2) == 2);
+            cursor.MoveTo(12);
+            Check(*cursor.DataAt(12) == 12);
+
+            // prefetching is only a hint, but must stay within the data in both directions
+            cursor.Prefetch(18, 64, Direction::Forwards);
+            cursor.Prefetch(1, 64, Direction::Backwards);
+
+            // appending past the buffering limit trims the front; stream times shift, and the cursor follows
+            stream.Append(20, values + 20);
+            Check(stream.DiscreteDuration() == 30);
+            for (int t = 0; t < 30; t++)
+            {
+                cursor.MoveTo(t);
+                Check(*cursor.DataAt(t) == t + 10);
+            }
+
+            // copying across segments goes through a cursor too
+            float copy[30];
+            stream.CopyTo(Interval<AudioSample>(3, 25, Direction::Forwards), copy);
+            for (int i = 0; i < 25; i++)
+            {
+                Check(copy[i] == i + 13);
+            }
+        }
+
+        // Move a wrapped ring vector, checking the destination keeps the elements and the source is left empty but usable.
+        TEST_METHOD(TestRingVectorMove)
+        {
+            RingVector<int> ring(4);
+            for (int i = 0; i < 6; i++)
+            {
+                ring.PushBack(i);
+                if (i < 2)
+                {
+                    ring.PopFront();
+                }
+            }
+            Check(ring.Size() == 4);
+            Check(ring.Front() == 2);
+
+            RingVector<int> moved(std::move(ring));
+            Check(moved.Size() == 4);
+            Check(moved.Front() == 2);
+            Check(moved.Back() == 5);
+            Check(ring.IsEmpty());
+
+            // the moved-from ring grows again from nothing
+            for (int i = 0; i < 10; i++)
+            {
+                ring.PushBack(i);
+            }
+            Check(ring.Size() == 10);
+            Check(ring[9] == 9);
+
+            ring = std::move(moved);
+            Check(ring.Size() == 4);
+            Check(ring[3] == 5);
+            Check(moved.IsEmpty());
+            moved.PushBack(7);
+            Check(moved.Front() == 7);
+        }
+
+        // Fill a ring stream past its capacity, checking wraparound lookups, copies, and appending to a buffered stream.
+        TEST_METHOD(TestRingSliceStream)
+        {
+            RingSliceStream<AudioSample, float> ring(1, /*minimumCapacity:*/ 12);
+            Check(ring.Capacity() == 16);
+
+            float quantum[5];
+            float nextValue = 0;
+            for (int i = 0; i < 20; i++)
+            {
+                for (int j = 0; j < 5; j++)
+                {
+                    quantum[j] = nextValue++;
+                }
+                ring.Append(5, quantum);
+
+                int64_t duration = ring.DiscreteDuration().Value();
+                Check(duration == std::min<int64_t>(nextValue, 16));
+                float firstValue = nextValue - duration;
+                for (int64_t t = 0; t < duration; t++)
+                {
+                    Slice<AudioSample, float> forwards = ring.GetSliceIntersecting(Interval<AudioSample>(t, 1, Direction::Forwards));
+                    Check(forwards.SliceDuration() == 1);
+                    Check(forwards.Get(0, 0) == firstValue + t);
+
+                    Slice<AudioSample, float> backwards = ring.GetSliceIntersecting(Interval<AudioSample>(t + 1, 1, Direction::Backwards));
+                    Check(backwards.SliceDuration() == 1);
+                    Check(backwards.Get(0, 0) == firstValue + t);
+                }
+
+                float copy[16];
+                ring.CopyTo(ring.DiscreteInterval(), copy);
+                for (int64_t t = 0; t < duration; t++)
+                {
+                    Check(copy[t] == firstValue + t);
+                }
+            }
+
+            // 100 values appended to a 16-slice ring: the wrap point is at stream time 12
+            Slice<AudioSample, float> beforeWrap = ring.GetSliceIntersecting(ring.DiscreteInterval());
+            Check(beforeWrap.SliceDuration() == 12);
+            Check(beforeWrap.Get(0, 0) == 84);
+            Slice<AudioSample, float> endOfRing = ring.GetSliceIntersecting(Interval<AudioSample>(16, 16, Direction::Backwards));
+            Check(endOfRing.SliceDuration() == 4);
+            Check(endOfRing.Get(0, 0) == 96);
+
+            // appending more than the capacity at once keeps only the tail
+            float big[40];
+            for (int j = 0; j < 40; j++)
+            {
+                big[j] = nextValue++;
+            }
+            ring.Append(40, big);
+            Check(ring.DiscreteDuration() == 16);
+            Check(ring.GetSliceIntersecting(Interval<AudioSample>(0, 1, Direction::Forwards)).Get(0, 0) == nextValue - 16);
+
+            // AppendTo a buffered stream, as a recording track does with its input's pre-recording
+            BufferAllocator<float> bufferAllocator(7, 1);
+            BufferedSliceStream<AudioSample, float> stream(1, &bufferAllocator);
+            ring.AppendTo(Interval<AudioSample>(2, 14, Direction::Forwards), &stream);
+            Check(stream.DiscreteDuration() == 14);
+            float copy[14];
+            stream.CopyTo(stream.DiscreteInterval(), copy);
+            for (int j = 0; j < 14; j++)
+            {
+                Check(copy[j] == nextValue - 14 + j);
+            }
+        }
+
+        // Microbenchmark: Append + Trim on a pre-recording style stream, at 48Khz in 64-sample quanta.
+        TEST_METHOD(TestStreamAppendTrimBenchmark)
+        {
+            const int sampleRateHz = 48000;
+            const int quantumSamples = 64;
+            const int seconds = 60;
+
+            // small buffers and a ten second limit, so the stream holds hundreds of segments at once
+            BufferAllocator<float> bufferAllocator(1024, 1);
+            BufferedSliceStream<AudioSample, float> stream(1, &bufferAllocator, sampleRateHz * 10);
+
+            std::vector<float> quantum(quantumSamples);
+            int quantumCount = sampleRateHz * seconds / quantumSamples;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < quantumCount; i++)
+            {
+                stream.Append(quantumSamples, quantum.data());
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            Check(stream.DiscreteDuration() == sampleRateHz * 10);
+
+            std::wstringstream wstr;
+            wstr << L"TestStreamAppendTrimBenchmark: " << stream.BufferCount() << L" segments, "
+                << (std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / quantumCount)
+                << L" ns per " << quantumSamples << L"-sample Append";
+            Logger::WriteMessage(wstr.str().c_str());
+        }
+
+        // Append sampleCount samples, each holding its own index, then shut the stream at exactDuration.
+        static void FillLoopStream(BufferedSliceStream<AudioSample, float>& stream, int sampleCount, float exactDuration)
+        {
+            std::vector<float> samples(sampleCount);
+            for (int i = 0; i < sampleCount; i++)
+            {
+                samples[i] = (float)i;
+            }
+            stream.Append(sampleCount, samples.data());
+            stream.Shut(exactDuration, /* fade: */false);
+        }
+
+        // Play a loop from startTime at the given rate through one LoopPlayhead, in blocks of assorted sizes.
+        static std::vector<float> RenderLoop(
+            const BufferedSliceStream<AudioSample, float>& stream,
+            Direction direction,
+            int sampleCount,
+            LoopInterpolation interpolation = LoopInterpolation::Nearest,
+            float startTime = 0,
+            float rate = 1)
+        {
+            const int blockSizes[] = { 7, 1, 13, 64, 300 };
+
+            LoopPlayhead playhead{ interpolation };
+            ContinuousTime<AudioSample> position{ startTime };
+            std::vector<float> output(sampleCount);
+            int rendered = 0;
+            for (int block = 0; rendered < sampleCount; block++)
+            {
+                int count = std::min(blockSizes[block % 5], sampleCount - rendered);
+                playhead.Render(stream, position, direction, count, output.data() + rendered, rate);
+                Check(position.Value() >= 0 && position.Value() < stream.ExactDuration().Value());
+                rendered += count;
+            }
+            return output;
+        }
+
+        TEST_METHOD(TestLoopPlayhead)
+        {
+            // small buffers, so blocks keep crossing from one segment to the next
+            BufferAllocator<float> bufferAllocator(16, 1);
+
+            // an integral loop plays every sample on every pass, in either direction
+            BufferedSliceStream<AudioSample, float> integral(1, &bufferAllocator, 0);
+            FillLoopStream(integral, 50, 50);
+            std::vector<float> forwards = RenderLoop(integral, Direction::Forwards, 200);
+            std::vector<float> backwards = RenderLoop(integral, Direction::Backwards, 200);
+            for (int i = 0; i < 200; i++)
+            {
+                Check(forwards[i] == i % 50);
+                Check(backwards[i] == 49 - i % 50);
+            }
+
+            // a fractional loop alternates between the rounded-up and rounded-down number of samples
+            BufferedSliceStream<AudioSample, float> fractional(1, &bufferAllocator, 0);
+            FillLoopStream(fractional, 21, 20.5f);
+            forwards = RenderLoop(fractional, Direction::Forwards, 41 * 3);
+            backwards = RenderLoop(fractional, Direction::Backwards, 41 * 3);
+            for (int i = 0; i < 41 * 3; i++)
+            {
+                int pairOffset = i % 41;
+                // forwards: 0..20, then 0..19
+                Check(forwards[i] == (pairOffset < 21 ? pairOffset : pairOffset - 21));
+                // backwards: 19..0, then 20..0
+                Check(backwards[i] == (pairOffset < 20 ? 19 - pairOffset : 40 - pairOffset));
+            }
+
+            // interpolation reads between samples; both kinds reproduce a straight line exactly
+            for (LoopInterpolation interpolation : { LoopInterpolation::Linear, LoopInterpolation::CubicHermite })
+            {
+                forwards = RenderLoop(integral, Direction::Forwards, 30, interpolation, 10.25f);
+                backwards = RenderLoop(integral, Direction::Backwards, 30, interpolation, 40.25f);
+                for (int i = 0; i < 30; i++)
+                {
+                    Check(std::abs(forwards[i] - (10.25f + i)) < 1e-4f);
+                    Check(std::abs(backwards[i] - (39.25f - i)) < 1e-4f);
+                }
+            }
+
+            // a fractional loop of constant signal stays constant through every wrap, including the
+            // interpolation across the loop point, in both directions
+            BufferedSliceStream<AudioSample, float> constant(1, &bufferAllocator, 0);
+            std::vector<float> ones(21, 1.0f);
+            constant.Append(21, ones.data());
+            constant.Shut(20.5f, /* fade: */false);
+            forwards = RenderLoop(constant, Direction::Forwards, 1000, LoopInterpolation::CubicHermite, 0.3f);
+            backwards = RenderLoop(constant, Direction::Backwards, 1000, LoopInterpolation::CubicHermite, 0.3f);
+            for (int i = 0; i < 1000; i++)
+            {
+                Check(std::abs(forwards[i] - 1) < 1e-5f);
+                Check(std::abs(backwards[i] - 1) < 1e-5f);
+            }
+
+            // varispeed reads the line at rate samples per output sample, slower or faster, either way
+            forwards = RenderLoop(integral, Direction::Forwards, 60, LoopInterpolation::Nearest, 10.25f, 0.5f);
+            backwards = RenderLoop(integral, Direction::Backwards, 60, LoopInterpolation::Nearest, 40.25f, 0.5f);
+            for (int i = 0; i < 60; i++)
+            {
+                Check(std::abs(forwards[i] - (10.25f + i * 0.5f)) < 1e-4f);
+                Check(std::abs(backwards[i] - (39.75f - i * 0.5f)) < 1e-4f);
+            }
+            forwards = RenderLoop(integral, Direction::Forwards, 20, LoopInterpolation::Nearest, 5.5f, 2);
+            backwards = RenderLoop(integral, Direction::Backwards, 20, LoopInterpolation::Nearest, 45.5f, 2);
+            for (int i = 0; i < 20; i++)
+            {
+                Check(std::abs(forwards[i] - (5.5f + i * 2)) < 1e-4f);
+                Check(std::abs(backwards[i] - (43.5f - i * 2)) < 1e-4f);
+            }
+
+            // and keeps constant signal constant through every wrap of a fractional loop
+            forwards = RenderLoop(constant, Direction::Forwards, 1000, LoopInterpolation::Nearest, 0.3f, 1.7f);
+            backwards = RenderLoop(constant, Direction::Backwards, 1000, LoopInterpolation::Nearest, 0.3f, 1.7f);
+            for (int i = 0; i < 1000; i++)
+            {
+                Check(std::abs(forwards[i] - 1) < 1e-5f);
+                Check(std::abs(backwards[i] - 1) < 1e-5f);
+            }
+
+            // a stereo loop plays each channel exactly as a mono loop of that channel would, whichever way it is read
+            std::vector<float> leftSamples(41);
+            std::vector<float> rightSamples(41);
+            for (int i = 0; i < 41; i++)
+            {
+                leftSamples[i] = (float)i;
+                rightSamples[i] = (float)((i * 7) % 41) - 20;
+            }
+            BufferedSliceStream<AudioSample, float> left(1, &bufferAllocator, 0);
+            BufferedSliceStream<AudioSample, float> right(1, &bufferAllocator, 0);
+            BufferedSliceStream<AudioSample, float> stereo(2, &bufferAllocator, 0);
+            left.Append(41, leftSamples.data());
+            right.Append(41, rightSamples.data());
+            const float* channels[] = { leftSamples.data(), rightSamples.data() };
+            stereo.AppendChannels(41, channels);
+            left.Shut(40.5f, /* fade: */false);
+            right.Shut(40.5f, /* fade: */false);
+            stereo.Shut(40.5f, /* fade: */false);
+
+            const int blockSizes[] = { 7, 1, 13, 64, 300 };
+            for (Direction direction : { Direction::Forwards, Direction::Backwards })
+            {
+                for (LoopInterpolation interpolation : { LoopInterpolation::Nearest, LoopInterpolation::CubicHermite })
+                {
+                    for (float rate : { 1.0f, 0.7f, 2.5f })
+                    {
+                        std::vector<float> expectedLeft = RenderLoop(left, direction, 500, interpolation, 3.25f, rate);
+                        std::vector<float> expectedRight = RenderLoop(right, direction, 500, interpolation, 3.25f, rate);
+
+                        LoopPlayhead playhead{ interpolation, 2 };
+                        ContinuousTime<AudioSample> position{ 3.25f };
+                        std::vector<float> actualLeft(500);
+                        std::vector<float> actualRight(500);
+                        int rendered = 0;
+                        for (int block = 0; rendered < 500; block++)
+                        {
+                            int count = std::min(blockSizes[block % 5], 500 - rendered);
+                            float* destinations[] = { actualLeft.data() + rendered, actualRight.data() + rendered };
+                            playhead.Render(stereo, position, direction, count, destinations, rate);
+                            rendered += count;
+                        }
+
+                        Check(actualLeft == expectedLeft);
+                        Check(actualRight == expectedRight);
+                    }
+                }
+            }
+        }
+
+        // Benchmark: many looping tracks rendered and panned into one stereo bus, a quantum at a time.
+        TEST_METHOD(TestLoopPlayheadBenchmark)
+        {
+            const int sampleRateHz = 48000;
+            const int quantumSamples = 64;
+            const int quanta = 750;
+
+            for (LoopInterpolation interpolation : { LoopInterpolation::Nearest, LoopInterpolation::CubicHermite })
+            {
+                for (int trackCount : { 1, 16, 128 })
+                {
+                    BufferAllocator<float> bufferAllocator(sampleRateHz, trackCount * 2);
+
+                    // two-second loops of slightly different fractional lengths, so the tracks drift apart; every
+                    // other one backwards
+                    std::vector<std::unique_ptr<BufferedSliceStream<AudioSample, float>>> streams;
+                    std::vector<LoopPlayhead> playheads(trackCount, LoopPlayhead(interpolation));
+                    std::vector<ContinuousTime<AudioSample>> positions;
+                    for (int i = 0; i < trackCount; i++)
+                    {
+                        int sampleCount = sampleRateHz * 2 + i * 37;
+                        streams.push_back(std::unique_ptr<BufferedSliceStream<AudioSample, float>>(
+                            new BufferedSliceStream<AudioSample, float>(1, &bufferAllocator, 0)));
+                        FillLoopStream(*streams.back(), sampleCount, sampleCount - 0.25f);
+                        positions.push_back(ContinuousTime<AudioSample>((float)(i * 1009) + 0.5f));
+                    }
+
+                    std::vector<float> mono(quantumSamples);
+                    std::vector<float> left(quantumSamples);
+                    std::vector<float> right(quantumSamples);
+                    float sink = 0;
+
+                    auto start = std::chrono::high_resolution_clock::now();
+                    for (int quantum = 0; quantum < quanta; quantum++)
+                    {
+                        std::fill(left.begin(), left.end(), 0.0f);
+                        std::fill(right.begin(), right.end(), 0.0f);
+                        for (int i = 0; i < trackCount; i++)
+                        {
+                            Direction direction = (i % 2) == 0 ? Direction::Forwards : Direction::Backwards;
+                            playheads[i].Render(*streams[i], positions[i], direction, quantumSamples, mono.data());
+                            Kernels::GainPanAccumulate(mono.data(), quantumSamples, 0.7f, 0.7f, left.data(), right.data());
+                        }
+                        sink += left[0] + right[quantumSamples - 1];
+                    }
+                    auto end = std::chrono::high_resolution_clock::now();
+
+                    // keep the optimizer from discarding the loops
+                    Check(sink != 0);
+
+                    std::wstringstream wstr;
+                    wstr << L"TestLoopPlayheadBenchmark: " << (interpolation == LoopInterpolation::Nearest ? L"nearest, " : L"cubic Hermite, ")
+                        << trackCount << L" tracks, "
+                        << ((double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / ((double)quanta * quantumSamples * trackCount))
+                        << L" ns per track per sample";
+                    Logger::WriteMessage(wstr.str().c_str());
+                }
+            }
+        }
+
+        // Append a sine wave with the given period (in samples), then shut the stream at sampleCount.
+        static void FillSineLoopStream(BufferedSliceStream<AudioSample, float>& stream, int sampleCount, int period)
+        {
+            std::vector<float> samples(sampleCount);
+            for (int i = 0; i < sampleCount; i++)
+            {
+                samples[i] = (float)std::sin(2 * 3.14159265358979323846 * i / period);
+            }
+            stream.Append(sampleCount, samples.data());
+            stream.Shut((float)sampleCount, /* fade: */false);
+        }
+
+        // Play a loop from startTime at the given rate through one TimeStretcher, in blocks of assorted sizes;
+        // position is left where the stretcher says the loop has got to.
+        static std::vector<float> StretchLoop(
+            const BufferedSliceStream<AudioSample, float>& stream,
+            Direction direction,
+            int sampleCount,
+            float rate,
+            ContinuousTime<AudioSample>& position)
+        {
+            const int blockSizes[] = { 7, 1, 13, 64, 300 };
+
+            std::unique_ptr<TimeStretcher> stretcher{ new TimeStretcher() };
+            std::vector<float> output(sampleCount);
+            int rendered = 0;
+            for (int block = 0; rendered < sampleCount; block++)
+            {
+                int count = std::min(blockSizes[block % 5], sampleCount - rendered);
+                stretcher->Render(stream, position, direction, rate, count, output.data() + rendered);
+                Check(position.Value() >= 0 && position.Value() < stream.ExactDuration().Value());
+                rendered += count;
+            }
+            return output;
+        }
+
+        TEST_METHOD(TestTimeStretcher)
+        {
+            const int sampleCount = 48000;
+            const int period = 100;
+            BufferAllocator<float> bufferAllocator(4096, 1);
+            BufferedSliceStream<AudioSample, float> sine(1, &bufferAllocator, 0);
+            FillSineLoopStream(sine, sampleCount, period);
+
+            // at rate 1 the windows sum to one, so the loop plays exactly, in either direction
+            ContinuousTime<AudioSample> position{ 1000 };
+            std::vector<float> forwards = StretchLoop(sine, Direction::Forwards, 5000, 1, position);
+            Check(std::abs(position.Value() - 6000) < 1e-2f);
+            position = 1000;
+            std::vector<float> backwards = StretchLoop(sine, Direction::Backwards, 5000, 1, position);
+            Check(std::abs(position.Value() - (sampleCount - 4000)) < 1e-2f);
+            for (int i = 0; i < 5000; i++)
+            {
+                Check(std::abs(forwards[i] - std::sin(2 * 3.14159265358979323846 * (1000 + i) / period)) < 1e-4f);
+                Check(std::abs(backwards[i] - std::sin(2 * 3.14159265358979323846 * (999 - i) / period)) < 1e-4f);
+            }
+
+            // faster or slower, the position moves at the rate but the pitch and level stay put
+            for (float rate : { 0.75f, 1.5f })
+            {
+                for (Direction direction : { Direction::Forwards, Direction::Backwards })
+                {
+                    position = 1000;
+                    std::vector<float> output = StretchLoop(sine, direction, 20000, rate, position);
+
+                    float expectedPosition = direction == Direction::Forwards ? 1000 + 20000 * rate : sampleCount + 1000 - 20000 * rate;
+                    Check(std::abs(position.Value() - expectedPosition) < 1e-1f);
+
+                    int crossings = 0;
+                    float peak = 0;
+                    for (int i = 10000; i < 20000; i++)
+                    {
+                        if (output[i - 1] < 0 && output[i] >= 0)
+                        {
+                            crossings++;
+                        }
+                        peak = std::max(peak, std::abs(output[i]));
+                    }
+                    Check(std::abs(crossings - 10000 / period) <= 2);
+                    Check(peak > 0.9f && peak < 1.1f);
+                }
+            }
+        }
+
+        // Benchmark: many time stretched tracks rendered and panned into one stereo bus, a quantum at a time.
+        TEST_METHOD(TestTimeStretcherBenchmark)
+        {
+            const int sampleRateHz = 48000;
+            const int quantumSamples = 64;
+            const int quanta = 750;
+
+            for (int trackCount : { 1, 32 })
+            {
+                BufferAllocator<float> bufferAllocator(sampleRateHz, trackCount * 2);
+
+                // two-second loops, at assorted rates; every other one backwards
+                std::vector<std::unique_ptr<BufferedSliceStream<AudioSample, float>>> streams;
+                std::vector<std::unique_ptr<TimeStretcher>> stretchers;
+                std::vector<ContinuousTime<AudioSample>> positions;
+                for (int i = 0; i < trackCount; i++)
+                {
+                    streams.push_back(std::unique_ptr<BufferedSliceStream<AudioSample, float>>(
+                        new BufferedSliceStream<AudioSample, float>(1, &bufferAllocator, 0)));
+                    FillSineLoopStream(*streams.back(), sampleRateHz * 2, 50 + i);
+                    stretchers.push_back(std::unique_ptr<TimeStretcher>(new TimeStretcher()));
+                    positions.push_back(ContinuousTime<AudioSample>((float)(i * 1009)));
+                }
+
+                std::vector<float> mono(quantumSamples);
+                std::vector<float> left(quantumSamples);
+                std::vector<float> right(quantumSamples);
+                float sink = 0;
+
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int quantum = 0; quantum < quanta; quantum++)
+                {
+                    std::fill(left.begin(), left.end(), 0.0f);
+                    std::fill(right.begin(), right.end(), 0.0f);
+                    for (int i = 0; i < trackCount; i++)
+                    {
+                        Direction direction = (i % 2) == 0 ? Direction::Forwards : Direction::Backwards;
+                        float rate = 0.8f + (i % 5) * 0.1f;
+                        stretchers[i]->Render(*streams[i], positions[i], direction, rate, quantumSamples, mono.data());
+                        Kernels::GainPanAccumulate(mono.data(), quantumSamples, 0.7f, 0.7f, left.data(), right.data());
+                    }
+                    sink += left[0] + right[quantumSamples - 1];
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+
+                // keep the optimizer from discarding the loops
+                Check(sink != 0);
+
+                std::wstringstream wstr;
+                wstr << L"TestTimeStretcherBenchmark: " << trackCount << L" tracks, "
+                    << ((double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / ((double)quanta * quantumSamples * trackCount))
+                    << L" ns per track per sample";
+                Logger::WriteMessage(wstr.str().c_str());
+            }
+        }
+
+        // Stress test: a simulated audio thread publishes as fast as it can while the reader polls; every value
+        // read must be complete (all fields from one write) and no older than the last one read.
+        TEST_METHOD(TestTripleBufferStress)
+        {
+            const int fieldCount = 64;
+            const int writeCount = 1000000;
+
+            TripleBuffer<std::vector<int>> buffer{ std::vector<int>(fieldCount, 0) };
+
+            std::thread writer([&]()
+            {
+                for (int value = 1; value <= writeCount; value++)
+                {
+                    std::vector<int>& fields = buffer.WriteBuffer();
+                    for (int i = 0; i < fieldCount; i++)
+                    {
+                        fields[i] = value;
+                    }
+                    buffer.Publish();
+                }
+            });
+
+            int lastValue = 0;
+            int distinctReads = 0;
+            while (lastValue < writeCount)
+            {
+                const std::vector<int>& fields = buffer.Read();
+                int value = fields[0];
+                for (int i = 1; i < fieldCount; i++)
+                {
+                    Check(fields[i] == value);
+                }
+                Check(value >= lastValue);
+                if (value > lastValue)
+                {
+                    distinctReads++;
+                }
+                lastValue = value;
+            }
+
+            writer.join();
+
+            std::wstringstream wstr;
+            wstr << L"TestTripleBufferStress: " << distinctReads << L" distinct values read out of " << writeCount << L" written";
+            Logger::WriteMessage(wstr.str().c_str());
+        }
+
+        // Fill a slot table, check that a full table reports no free slot rather than failing, and that freed
+        // slots are found again once the reader acknowledges them.
+        TEST_METHOD(TestSlotTable)
+        {
+            SlotTable<int> slots(4);
+            Check(slots.Capacity() == 4);
+            Check(!slots.AnyActive());
+
+            for (int i = 0; i < 4; i++)
+            {
+                int index = slots.FindFree();
+                Check(index == i);
+                slots[index] = i * 10;
+                slots.Activate(index);
+                Check(slots.IsActive(index));
+            }
+            Check(slots.AnyActive());
+
+            // full
+            Check(slots.FindFree() == -1);
+            Check(slots.FindFree() == -1);
+
+            // a deactivated slot is not free until the reader has acknowledged it
+            slots.Deactivate(2);
+            Check(!slots.IsActive(2));
+            Check(slots.FindFree() == -1);
+            slots.Acknowledge();
+
+            // then it (and only it) is available again, with its old contents intact
+            Check(slots.FindFree() == 2);
+            Check(slots[2] == 20);
+            slots.Activate(2);
+            Check(slots.FindFree() == -1);
+
+            for (int i = 0; i < 4; i++)
+            {
+                slots.Deactivate(i);
+            }
+            Check(!slots.AnyActive());
+            Check(slots.FindFree() == -1);
+            slots.Acknowledge();
+            Check(slots.FindFree() == 0);
+        }
+
+        // Delete and re-add slots as fast as possible while another thread reads them, as the audio thread renders
+        // voices; the reader must never see a slot's contents change during a pass in which it found it active.
+        TEST_METHOD(TestSlotTableReuse)
+        {
+            struct ReusedSlot
+            {
+                int Value = 0;
+                int Twice = 0;
+            };
+            SlotTable<ReusedSlot> slots(2);
+
+            const int reuseCount = 20000;
+            std::atomic<bool> done{ false };
+            std::atomic<int> passCount{ 0 };
+            std::thread reader([&slots, &done, &passCount]()
+            {
+                while (!done)
+                {
+                    for (int i = 0; i < slots.Capacity(); i++)
+                    {
+                        if (!slots.IsActive(i))
+                        {
+                            continue;
+                        }
+                        int value = slots[i].Value;
+                        Check(slots[i].Twice == value * 2);
+                        std::this_thread::yield();
+                        Check(slots[i].Value == value);
+                        Check(slots[i].Twice == value * 2);
+                    }
+                    slots.Acknowledge();
+                    passCount++;
+                }
+            });
+
+            for (int k = 1; k <= reuseCount; k++)
+            {
+                int index;
+                while ((index = slots.FindFree()) == -1)
+                {
+                    std::this_thread::yield();
+                }
+                slots[index].Value = k;
+                slots[index].Twice = k * 2;
+                slots.Activate(index);
+                std::this_thread::yield();
+                slots.Deactivate(index);
+            }
+            done = true;
+            reader.join();
+
+            std::wstringstream wstr;
+            wstr << L"TestSlotTableReuse: " << reuseCount << L" reuses over " << passCount << L" reader passes";
+            Logger::WriteMessage(wstr.str().c_str());
+        }
+
+        // Push a long sequence through a small ring from another thread, in ragged chunk sizes, and check it
+        // arrives complete and in order.
+        TEST_METHOD(TestSpscRingStress)
+        {
+            const int valueCount = 1000000;
+
+            SpscRing<int> ring{ 64 };
+            Check(ring.Capacity() == 64);
+
+            std::thread producer([&]()
+            {
+                int chunk[37];
+                int nextValue = 0;
+                while (nextValue < valueCount)
+                {
+                    int chunkSize = std::min<int>(1 + nextValue % 37, valueCount - nextValue);
+                    for (int i = 0; i < chunkSize; i++)
+                    {
+                        chunk[i] = nextValue + i;
+                    }
+                    int pushed = ring.Push(chunk, chunkSize);
+                    if (pushed == 0)
+                    {
+                        // ring is full; let the consumer catch up
+                        std::this_thread::yield();
+                    }
+                    nextValue += pushed;
+                }
+            });
+
+            int chunk[29];
+            int expectedValue = 0;
+            while (expectedValue < valueCount)
+            {
+                int popped = ring.Pop(chunk, 1 + expectedValue % 29);
+                if (popped == 0)
+                {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < popped; i++)
+                {
+                    Check(chunk[i] == expectedValue);
+                    expectedValue++;
+                }
+            }
+
+            producer.join();
+
+            Check(ring.Pop(chunk, 29) == 0);
+
+            // skipped values are never popped
+            int values[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+            Check(ring.Push(values, 10) == 10);
+            Check(ring.Skip(4) == 4);
+            Check(ring.Pop(chunk, 29) == 6);
+            Check(chunk[0] == 4 && chunk[5] == 9);
+            Check(ring.Skip(1) == 0);
+        }
+
+        // Check the histogram's bucketing is an exact, monotonic inverse pair, and its percentiles on known data.
+        TEST_METHOD(TestTimingHistogram)
+        {
+            for (int bucket = 0; bucket < TimingHistogram::BucketCount; bucket++)
+            {
+                uint64_t lowerBound = TimingHistogram::BucketLowerBound(bucket);
+                Check(TimingHistogram::BucketOf(lowerBound) == bucket);
+                if (bucket > 0)
+                {
+                    Check(lowerBound > TimingHistogram::BucketLowerBound(bucket - 1));
+                    Check(TimingHistogram::BucketOf(lowerBound - 1) == bucket - 1);
+                }
+            }
+            Check(TimingHistogram::BucketOf(UINT64_MAX) == TimingHistogram::BucketCount - 1);
+
+            TimingHistogram histogram;
+            Check(histogram.Count() == 0);
+            Check(histogram.PercentileTicks(0.5) == 0);
+
+            // 1000 durations from 1000 to 1999 ticks, and one slow outlier
+            uint64_t total = 0;
+            for (uint64_t ticks = 1000; ticks < 2000; ticks++)
+            {
+                histogram.Record(ticks);
+                total += ticks;
+            }
+            histogram.Record(100000);
+            total += 100000;
+
+            Check(histogram.Count() == 1001);
+            Check(histogram.TotalTicks() == total);
+            Check(histogram.MaximumTicks() == 100000);
+
+            // percentiles land within one bucket (a quarter of a power of two) above the true value
+            uint64_t median = histogram.PercentileTicks(0.5);
+            Check(median >= 1500 && median < 1500 + 256);
+            uint64_t p99 = histogram.PercentileTicks(0.99);
+            Check(p99 >= 1990 && p99 < 1990 + 256);
+            Check(histogram.PercentileTicks(1) == 100000);
+            Check(histogram.PercentileTicks(0) <= 1023);
+        }
+
+        // Log from several threads at once, and check every message comes out formatted, in order per thread,
+        // and that overflow is counted rather than blocking.
+        TEST_METHOD(TestEventLog)
+        {
+            const int threadCount = 3;
+            const int eventsPerThread = 1000;
+
+            // one ring per logging thread, plus one for this thread
+            EventLog log{ threadCount + 1, 1024 };
+            int countFormat = log.RegisterFormat(L"thread {} event {}");
+            int realFormat = log.RegisterFormat(L"value {} and {} then {}");
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; t++)
+            {
+                threads.emplace_back([&log, countFormat, t]()
+                {
+                    for (int i = 0; i < eventsPerThread; i++)
+                    {
+                        log.Log(countFormat, t, i);
+                    }
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            std::vector<std::wstring> messages;
+            Check(log.Drain([&](const std::wstring& message) { messages.push_back(message); }) == threadCount * eventsPerThread);
+            Check(messages.size() == threadCount * eventsPerThread);
+            Check(log.DroppedCount() == 0);
+
+            std::vector<int> nextEvent(threadCount, 0);
+            for (const std::wstring& message : messages)
+            {
+                int thread, event;
+                Check(swscanf_s(message.c_str(), L"thread %d event %d", &thread, &event) == 2);
+                Check(event == nextEvent[thread]);
+                nextEvent[thread]++;
+            }
+
+            // arguments may be integers or reals; placeholders past the last argument stay as they are
+            messages.clear();
+            log.Log(realFormat, 1.5f, (int64_t)1 << 40);
+            Check(log.Drain([&](const std::wstring& message) { messages.push_back(message); }) == 1);
+            Check(messages[0] == L"value 1.5 and 1099511627776 then {}");
+
+            // every ring is claimed now, so a new thread's events are dropped, and the drop is reported
+            std::thread extraThread([&]() { log.Log(countFormat, 99, 99); });
+            extraThread.join();
+            Check(log.DroppedCount() == 1);
+
+            // as are events which overflow a ring
+            for (int i = 0; i < 1025; i++)
+            {
+                log.Log(countFormat, 0, i);
+            }
+            Check(log.DroppedCount() == 2);
+
+            messages.clear();
+            Check(log.Drain([&](const std::wstring& message) { messages.push_back(message); }) == 1024);
+            Check(messages.back() == L"EventLog: dropped 2 events");
+        }
+
+        TEST_METHOD(TestSmoothedParameter)
+        {
+            const int rampSamples = 100;
+            float values[64];
+
+            // a constant parameter never renders
+            SmoothedParameter<float> linear{ 0.5f, rampSamples, SmoothingCurve::Linear, 8 };
+            Check(!linear.Advance(0, 64, values));
+            Check(linear.Current() == 0.5f);
+
+            // a new target ramps linearly across blocks, then lands exactly
+            linear.SetTarget(1.5f);
+            Check(linear.Target() == 1.5f);
+            Check(linear.Advance(64, 64, values));
+            Check(std::abs(values[0] - 0.51f) < 1e-5f);
+            Check(std::abs(values[63] - 1.14f) < 1e-5f);
+            Check(linear.Advance(128, 64, values));
+            Check(values[35] == 1.5f);
+            Check(values[63] == 1.5f);
+            Check(!linear.Advance(192, 64, values));
+            Check(linear.Current() == 1.5f);
+
+            // an exponential ramp moves fastest first, and also lands exactly
+            SmoothedParameter<float> exponential{ 0, rampSamples, SmoothingCurve::Exponential, 8 };
+            exponential.SetTarget(1);
+            Check(exponential.Advance(0, 64, values));
+            Check(values[1] - values[0] > values[63] - values[62]);
+            Check(values[63] > 0.9f && values[63] < 1);
+            Check(exponential.Advance(64, 64, values));
+            Check(values[35] == 1);
+            Check(!exponential.Advance(128, 64, values));
+
+            // a scheduled change starts at exactly its sample, and becomes the target
+            SmoothedParameter<float> scheduled{ 0, 0, SmoothingCurve::Linear, 8 };
+            Check(scheduled.Schedule(1000, 1));
+            Check(scheduled.Schedule(1010, 0.25f));
+            Check(!scheduled.Advance(936, 64, values));
+            Check(scheduled.Advance(1000 - 17, 64, values));
+            Check(values[16] == 0);
+            Check(values[17] == 1);
+            Check(values[26] == 1);
+            Check(values[27] == 0.25f);
+            Check(values[63] == 0.25f);
+            Check(scheduled.Target() == 0.25f);
+
+            // changes whose time has passed apply at the start of the next block (here, without varying within it)
+            Check(scheduled.Schedule(0, 0.75f));
+            Check(!scheduled.Advance(2000, 64, values));
+            Check(scheduled.Current() == 0.75f);
+
+            // a scheduled ramp starts mid-block
+            SmoothedParameter<float> scheduledRamp{ 0, rampSamples, SmoothingCurve::Linear, 8 };
+            Check(scheduledRamp.Schedule(32, 1));
+            Check(scheduledRamp.Advance(0, 64, values));
+            Check(values[31] == 0);
+            Check(std::abs(values[32] - 0.01f) < 1e-5f);
+            Check(std::abs(values[63] - 0.32f) < 1e-5f);
+
+            // the ring of scheduled changes is bounded
+            SmoothedParameter<float> full{ 0, 0, SmoothingCurve::Linear, 2 };
+            Check(full.Schedule(10, 1));
+            Check(full.Schedule(20, 2));
+            Check(!full.Schedule(30, 3));
+        }
+
+        // Check every supported vector kernel set against the scalar kernels, at lengths that exercise the tails.
+        TEST_METHOD(TestKernels)
+        {
+            Kernels::KernelSet original = Kernels::ActiveKernelSet();
+
+            for (Kernels::KernelSet kernelSet : { Kernels::KernelSet::Sse2, Kernels::KernelSet::Avx2, Kernels::KernelSet::Neon })
+            {
+                if (!Kernels::IsSupported(kernelSet))
+                {
+                    continue;
+                }
+
+                for (int count : { 1, 3, 4, 7, 8, 9, 17, 64, 511 })
+                {
+                    std::vector<float> a(count);
+                    std::vector<float> b(count);
+                    std::vector<float> mixes(count);
+                    for (int i = 0; i < count; i++)
+                    {
+                        a[i] = (float)((i * 37) % 23 - 11) / 5;
+                        b[i] = (float)((i * 13) % 17 - 8) / 3;
+                        mixes[i] = (float)(i % 11) / 10;
+                    }
+                    std::vector<float> padded(a);
+                    padded.insert(padded.end(), { 0.5f, -0.25f, 1 });
+                    const float taps[] = { -0.0625f, 0.5625f, 0.5625f, -0.0625f };
+
+                    const int outputCount = 15;
+                    std::vector<std::vector<float>> expected(outputCount, std::vector<float>(count));
+                    std::vector<std::vector<float>> actual(outputCount, std::vector<float>(count));
+                    float expectedMin, expectedMax, actualMin, actualMax;
+
+                    Kernels::UseKernelSet(Kernels::KernelSet::Scalar);
+                    Kernels::GainPanClamp(a.data(), count, 0.7f, 1.3f, 0.99f, expected[0].data(), expected[1].data());
+                    Kernels::Crossfade(a.data(), b.data(), count, 0.3f, expected[2].data());
+                    Kernels::AbsMean(a.data(), b.data(), count, expected[3].data());
+                    Kernels::GainPanClampPerSample(a.data(), count, b.data(), mixes.data(), 0.99f, expected[4].data(), expected[5].data());
+                    Kernels::CrossfadePerSample(a.data(), b.data(), count, mixes.data(), expected[6].data());
+                    Kernels::LinearRamp(0.5f, 0.001f, count, expected[7].data());
+                    Kernels::ExponentialRamp(1, 0.25f, 0.99f, count, expected[8].data());
+                    expected[9] = b;
+                    expected[10] = mixes;
+                    Kernels::GainPanAccumulate(a.data(), count, 0.7f, 1.3f, expected[9].data(), expected[10].data());
+                    Kernels::Reverse(a.data(), count, expected[11].data());
+                    Kernels::FourTapFilter(padded.data(), count, taps, expected[12].data());
+                    Kernels::ResampleCubic(padded.data(), 1.25f, 0.6f, count, expected[13].data());
+                    expected[14] = b;
+                    Kernels::MultiplyAccumulate(a.data(), mixes.data(), count, expected[14].data());
+                    float expectedSum = Kernels::Sum(a.data(), count);
+                    Kernels::MinMax(a.data(), count, &expectedMin, &expectedMax);
+                    float expectedDot = Kernels::Dot(a.data(), b.data(), count);
+                    std::vector<float> expectedMagnitudes(count / 2);
+                    Kernels::ComplexMagnitude(a.data(), count / 2, expectedMagnitudes.data());
+
+                    Kernels::UseKernelSet(kernelSet);
+                    Kernels::GainPanClamp(a.data(), count, 0.7f, 1.3f, 0.99f, actual[0].data(), actual[1].data());
+                    Kernels::Crossfade(a.data(), b.data(), count, 0.3f, actual[2].data());
+                    Kernels::AbsMean(a.data(), b.data(), count, actual[3].data());
+                    Kernels::GainPanClampPerSample(a.data(), count, b.data(), mixes.data(), 0.99f, actual[4].data(), actual[5].data());
+                    Kernels::CrossfadePerSample(a.data(), b.data(), count, mixes.data(), actual[6].data());
+                    Kernels::LinearRamp(0.5f, 0.001f, count, actual[7].data());
+                    Kernels::ExponentialRamp(1, 0.25f, 0.99f, count, actual[8].data());
+                    actual[9] = b;
+                    actual[10] = mixes;
+                    Kernels::GainPanAccumulate(a.data(), count, 0.7f, 1.3f, actual[9].data(), actual[10].data());
+                    Kernels::Reverse(a.data(), count, actual[11].data());
+                    Kernels::FourTapFilter(padded.data(), count, taps, actual[12].data());
+                    Kernels::ResampleCubic(padded.data(), 1.25f, 0.6f, count, actual[13].data());
+                    actual[14] = b;
+                    Kernels::MultiplyAccumulate(a.data(), mixes.data(), count, actual[14].data());
+                    float actualSum = Kernels::Sum(a.data(), count);
+                    Kernels::MinMax(a.data(), count, &actualMin, &actualMax);
+                    float actualDot = Kernels::Dot(a.data(), b.data(), count);
+                    std::vector<float> actualMagnitudes(count / 2);
+                    Kernels::ComplexMagnitude(a.data(), count / 2, actualMagnitudes.data());
+
+                    for (int j = 0; j < outputCount; j++)
+                    {
+                        // ramps and resampling compute their lanes' values in a different order
+                        float tolerance = j == 7 || j == 8 || j == 13 ? 1e-5f : 1e-6f;
+                        for (int i = 0; i < count; i++)
+                        {
+                            Check(std::abs(expected[j][i] - actual[j][i]) < tolerance);
+                        }
+                    }
+                    // vector sums add in a different order
+                    Check(std::abs(expectedSum - actualSum) < 1e-3f);
+                    Check(expectedMin == actualMin);
+                    Check(expectedMax == actualMax);
+                    Check(std::abs(expectedDot - actualDot) < 1e-3f);
+                    for (int i = 0; i < count / 2; i++)
+                    {
+                        Check(std::abs(expectedMagnitudes[i] - actualMagnitudes[i]) < 1e-5f);
+                    }
+
+                    // interleaving only moves values, so must be exact; read and write at an offset, to check it
+                    const int offset = 2;
+                    for (int channelCount : { 1, 2, 3 })
+                    {
+                        std::vector<std::vector<float>> channels(channelCount, std::vector<float>(count + offset));
+                        for (int c = 0; c < channelCount; c++)
+                        {
+                            for (int i = 0; i < count + offset; i++)
+                            {
+                                channels[c][i] = (c == 0 ? a : b)[(i + c) % count] + c;
+                            }
+                        }
+                        const float* channelPointers[3] = { channels[0].data(), channels[channelCount > 1].data(), channels[channelCount - 1].data() };
+                        std::vector<float> interleaved(count * channelCount);
+                        Kernels::Interleave(channelPointers, offset, channelCount, count, interleaved.data());
+                        for (int i = 0; i < count; i++)
+                        {
+                            for (int c = 0; c < channelCount; c++)
+                            {
+                                Check(interleaved[i * channelCount + c] == channels[c][offset + i]);
+                            }
+                        }
+
+                        std::vector<std::vector<float>> split(channelCount, std::vector<float>(count + offset));
+                        float* splitPointers[3] = { split[0].data(), split[channelCount > 1].data(), split[channelCount - 1].data() };
+                        Kernels::Deinterleave(interleaved.data(), channelCount, count, splitPointers, offset);
+                        for (int c = 0; c < channelCount; c++)
+                        {
+                            for (int i = 0; i < count; i++)
+                            {
+                                Check(split[c][offset + i] == channels[c][offset + i]);
+                            }
+                        }
+                    }
+                }
+            }
+
+            Kernels::UseKernelSet(original);
+        }
+
+        // Microbenchmark: each kernel, scalar versus every supported vector kernel set, at typical quantum sizes.
+        TEST_METHOD(TestKernelsBenchmark)
+        {
+            const int iterations = 100000;
+            Kernels::KernelSet original = Kernels::ActiveKernelSet();
+
+            for (int count : { 16, 64, 128, 256, 512 })
+            {
+                std::vector<float> a(count, 0.25f);
+                std::vector<float> b(count, -0.5f);
+                std::vector<float> left(count);
+                std::vector<float> right(count);
+                float sink = 0;
+
+                std::wstringstream wstr;
+                wstr << L"TestKernelsBenchmark: " << count << L" samples, ns per call (GainPanClamp / Crossfade / AbsMean / MinMax):";
+
+                for (Kernels::KernelSet kernelSet : { Kernels::KernelSet::Scalar, Kernels::KernelSet::Sse2, Kernels::KernelSet::Avx2, Kernels::KernelSet::Neon })
+                {
+                    if (!Kernels::IsSupported(kernelSet))
+                    {
+                        continue;
+                    }
+                    Kernels::UseKernelSet(kernelSet);
+
+                    long long nanoseconds[4];
+                    for (int kernel = 0; kernel < 4; kernel++)
+                    {
+                        auto start = std::chrono::high_resolution_clock::now();
+                        for (int i = 0; i < iterations; i++)
+                        {
+                            switch (kernel)
+                            {
+                            case 0: Kernels::GainPanClamp(a.data(), count, 0.7f, 0.7f, 0.99f, left.data(), right.data()); break;
+                            case 1: Kernels::Crossfade(a.data(), b.data(), count, 0.5f, left.data()); break;
+                            case 2: Kernels::AbsMean(a.data(), b.data(), count, left.data()); break;
+                            case 3: { float min, max; Kernels::MinMax(a.data(), count, &min, &max); sink += min; } break;
+                            }
+                        }
+                        auto end = std::chrono::high_resolution_clock::now();
+                        nanoseconds[kernel] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations;
+                        sink += left[0];
+                    }
+
+                    wstr << L" [" << (int)kernelSet << L"] " << nanoseconds[0] << L" / " << nanoseconds[1] << L" / " << nanoseconds[2] << L" / " << nanoseconds[3];
+                }
+
+                // keep the optimizer from discarding the loops
+                Check(sink != 0);
+                Logger::WriteMessage(wstr.str().c_str());
+            }
+
+            Kernels::UseKernelSet(original);
+        }
+
+        // Fill an FFT test signal: a few sinusoids plus some deterministic noise.
+        static void FillFftInput(std::vector<float>& input)
+        {
+            int size = (int)input.size();
+            for (int i = 0; i < size; i++)
+            {
+                input[i] = (float)(0.5 * std::sin(2 * RosettaFFT::PI * 3 * i / size)
+                    + 0.25 * std::cos(2 * RosettaFFT::PI * (size / 5) * i / size)
+                    + ((i * 7919) % 101 - 50) / 500.0);
+            }
+        }
+
+        // RealFft must match the reference double-precision complex FFT, for every supported kernel set.
+        TEST_METHOD(TestRealFft)
+        {
+            Kernels::KernelSet original = Kernels::ActiveKernelSet();
+
+            for (int size : { 8, 16, 32, 64, 512, 4096, 8192 })
+            {
+                std::vector<float> input(size);
+                FillFftInput(input);
+
+                RosettaFFT::CArray reference(size);
+                for (int i = 0; i < size; i++)
+                {
+                    reference[i] = input[i];
+                }
+                RosettaFFT::optimized_fft(reference);
+
+                double maxMagnitude = 0;
+                for (int i = 0; i <= size / 2; i++)
+                {
+                    maxMagnitude = std::max(maxMagnitude, std::abs(reference[i]));
+                }
+
+                RealFft fft(size);
+                Check(fft.Size() == size);
+                Check(fft.BinCount() == size / 2 + 1);
+                std::vector<std::complex<float>> output(fft.BinCount());
+
+                for (Kernels::KernelSet kernelSet : { Kernels::KernelSet::Scalar, Kernels::KernelSet::Sse2, Kernels::KernelSet::Avx2, Kernels::KernelSet::Neon })
+                {
+                    if (!Kernels::IsSupported(kernelSet))
+                    {
+                        continue;
+                    }
+                    Kernels::UseKernelSet(kernelSet);
+
+                    fft.Transform(input.data(), output.data());
+
+                    for (int i = 0; i <= size / 2; i++)
+                    {
+                        // single precision, relative to the largest bin
+                        Check(std::abs(output[i].real() - reference[i].real()) < maxMagnitude * 1e-5);
+                        Check(std::abs(output[i].imag() - reference[i].imag()) < maxMagnitude * 1e-5);
+                    }
+                }
+            }
+
+            Kernels::UseKernelSet(original);
+        }
+
+        // The compiled bin map must weight each FFT bin by how much of it lies within each output bin's bounds.
+        TEST_METHOD(TestRescaleFFT)
+        {
+            std::vector<RosettaFFT::FrequencyBinBounds> bounds{
+                RosettaFFT::FrequencyBinBounds(0, 1.5),
+                // within one FFT bin
+                RosettaFFT::FrequencyBinBounds(1.5, 1.75),
+                RosettaFFT::FrequencyBinBounds(1.75, 2.25),
+                RosettaFFT::FrequencyBinBounds(2.25, 4) };
+            RosettaFFT::FrequencyBinMap map;
+            RosettaFFT::MakeBinMap(bounds, map);
+            Check(map.OutputBinCount() == 4);
+            Check(map.FftBinCount == 4);
+
+            // FFT bin k has magnitude k + 1
+            std::vector<std::complex<float>> fftData{ { 1, 0 }, { 0, 2 }, { -3, 0 }, { 0, -4 }, { 100, 100 } };
+            std::vector<float> magnitudes(map.FftBinCount);
+            std::vector<float> peaks(map.OutputBinCount(), 0);
+            std::vector<float> output(map.OutputBinCount());
+
+            RosettaFFT::RescaleFFT(map, fftData.data(), RosettaFFT::RescaleOptions(), magnitudes.data(), nullptr, output.data(), 4);
+            float expected[4] = { (1 + 0.5f * 2) / 1.5f, 2, (0.25f * 2 + 0.25f * 3) / 0.5f, (0.75f * 3 + 4) / 1.75f };
+            for (int i = 0; i < 4; i++)
+            {
+                Check(std::abs(output[i] - expected[i]) < 1e-5f);
+            }
+
+            // decibels
+            RosettaFFT::RescaleFFT(map, fftData.data(), RosettaFFT::RescaleOptions(true, 0), magnitudes.data(), nullptr, output.data(), 4);
+            for (int i = 0; i < 4; i++)
+            {
+                Check(std::abs(output[i] - 20 * std::log10(expected[i])) < 1e-4f);
+            }
+
+            // peak hold: after silence, each bin has decayed by half from its peak
+            RosettaFFT::RescaleOptions peakHold(false, 0.5f);
+            RosettaFFT::RescaleFFT(map, fftData.data(), peakHold, magnitudes.data(), peaks.data(), output.data(), 4);
+            std::vector<std::complex<float>> silence(fftData.size());
+            RosettaFFT::RescaleFFT(map, silence.data(), peakHold, magnitudes.data(), peaks.data(), output.data(), 4);
+            for (int i = 0; i < 4; i++)
+            {
+                Check(std::abs(output[i] - expected[i] / 2) < 1e-5f);
+            }
+        }
+
+        // Microbenchmark: the reference double-precision complex FFT versus RealFft, at typical FFT sizes.
+        TEST_METHOD(TestRealFftBenchmark)
+        {
+            for (int size : { 512, 1024, 2048, 4096, 8192 })
+            {
+                const int iterations = 2000000 / size;
+
+                std::vector<float> input(size);
+                FillFftInput(input);
+                RosettaFFT::CArray reference(size);
+                RealFft fft(size);
+                std::vector<std::complex<float>> output(fft.BinCount());
+                double sink = 0;
+
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < iterations; i++)
+                {
+                    for (int j = 0; j < size; j++)
+                    {
+                        reference[j] = input[j];
+                    }
+                    RosettaFFT::optimized_fft(reference);
+                    sink += reference[1].real();
+                }
+                auto middle = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < iterations; i++)
+                {
+                    fft.Transform(input.data(), output.data());
+                    sink += output[1].real();
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+
+                // keep the optimizer from discarding the loops
+                Check(sink != 0);
+
+                std::wstringstream wstr;
+                wstr << L"TestRealFftBenchmark: " << size << L" points, ns per FFT: reference "
+                    << std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count() / iterations
+                    << L", RealFft "
+                    << std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count() / iterations;
+                Logger::WriteMessage(wstr.str().c_str());
+            }
+        }
+
+        // Record the number of bytes reserved for one mono loop of the given length (at 48Khz, in 64-sample quanta)
+        // when the audio allocator uses the given buffer length.
+        static long LoopFootprint(int bufferLength, float loopSeconds)
+        {
+            const int sampleRateHz = 48000;
+            const int quantumSamples = 64;
+            BufferAllocator<float> bufferAllocator(BufferAllocatorPolicy(bufferLength, 1, 256, 0, 1));
+            BufferedSliceStream<AudioSample, float> stream(1, &bufferAllocator);
+
+            std::vector<float> quantum(quantumSamples);
+            int64_t loopSamples = (int64_t)(loopSeconds * sampleRateHz);
+            for (int64_t i = 0; i < loopSamples; i += quantumSamples)
+            {
+                stream.Append(quantumSamples, quantum.data());
+            }
+
+            return bufferAllocator.LiveBufferCount() * bufferLength * (long)sizeof(float);
+        }
+
+        // Memory footprint benchmark: compare resident bytes per loop when buffers are sized in bytes-per-second
+        // (the old, mistaken sizing) versus mono samples per second.
+        TEST_METHOD(TestBufferAllocatorFootprint)
+        {
+            const int bytesPerSecondSizing = 48000 * 2 * sizeof(float);
+            const int samplesPerSecondSizing = 48000;
+
+            for (float loopSeconds : { 0.5f, 2.5f, 10.0f })
+            {
+                long before = LoopFootprint(bytesPerSecondSizing, loopSeconds);
+                long after = LoopFootprint(samplesPerSecondSizing, loopSeconds);
+
+                std::wstringstream wstr;
+                wstr << L"TestBufferAllocatorFootprint: " << loopSeconds << L" sec loop: "
+                    << before << L" bytes with byte-sized buffers, " << after << L" bytes with sample-sized buffers";
+                Logger::WriteMessage(wstr.str().c_str());
+
+                // a sample-sized buffer never wastes more than one second of mono audio per loop
+                Check(after <= before);
+                Check(after - (long)(loopSeconds * samplesPerSecondSizing * sizeof(float)) <= samplesPerSecondSizing * (long)sizeof(float));
+            }
+        }
+
         /*
         [TestMethod]
         public void TestSparseSampleByteStream()